@@ -1,3 +1,6 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // F_GETPIPE_SZ
+#endif
 #include "collector_hub.h"
 
 #include <stdio.h>
@@ -9,9 +12,43 @@
 #include <pthread.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <signal.h>
+#include <poll.h>
 
 #include <cjson/cJSON.h>
-#include "th_sensor.h"
+#include "th_module.h"
+#include "th_sched.h"
+#include "timer_wheel.h"
+#include "ts_parse.h"
+#include "mq_batch.h"
+#include "common.h"
+#include "hub_snapshot.h"
+#include "hub_config.h"
+#include "mem_pool.h"
+#include "flow_ctl.h"
+#include "io_engine.h"
+#include "hub_result.h"
+#include "hub_archive.h"
+#include "dev_intern.h"
+#include "channel_reg.h"
+#include "hub_emit.h"
+#include "hub_query.h"
+
+#define HUB_TICK_MS 100   // rule_in 스레드가 만료/emit 타이머를 확인하는 주기
+#define HUB_MQ_WAIT_MS 500 // watch MQ 수신 대기 (flow 측정 / 설정 확인 주기, 종료는 eventfd로 바로)
+#define HUB_IO_WAIT_MS 500 // FIFO 리더 대기 (경로 변경 확인 주기, 종료는 eventfd로 바로)
+#define HUB_STOP_TH_MS 5   // stop이 TH 소켓 shutdown(th_module_abort)을 다시 하는 주기 (connect 직전 틈 대비)
+#define HUB_ARENA_BYTES (64 * 1024) // 스레드별 cJSON arena (watch: 라인마다, rule_in: tick마다 reset)
+#define HUB_LINE_MAX 1024           // SENSOR 1줄 출력 버퍼 (cJSON_PrintPreallocated)
+#define HUB_WARM_TICKS 50           // 이 tick 이후를 steady-state로 봄 (MEM_POOL_DEBUG 카운터)
+#define HUB_OUT_BYTES (64 * 1024)   // rulebase_in 출력 대기 버퍼 (pipe가 차면 여기 쌓임, 넘치면 버림)
+#define HUB_FLOW_LAG_MS 2000        // flow_rule_in.lag_high_ms 기본값
+#define HUB_FLOW_SAMPLE_MS 100      // watch 입력 큐 깊이 측정 주기
 
 // ============================
 // 내부 유틸
@@ -31,17 +68,16 @@ static void ensure_fifo(const char* path) {
     }
 }
 
-static double now_unix(void) {
+static uint64_t now_mono_ms(void) {
     struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000ULL);
 }
 
-static void now_local_iso(char* out, size_t outsz) {
-    time_t t = time(NULL);
-    struct tm lt;
-    localtime_r(&t, &lt);
-    strftime(out, outsz, "%Y-%m-%dT%H:%M:%S", &lt);
+static uint64_t now_mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000ULL);
 }
 
 // RuleEngine과 동일 Heat Index 공식 (소수2자리)
@@ -64,283 +100,1519 @@ static double calc_heat_index(double T, double RH) {
 // ============================
 typedef struct {
     int used;
-    char deviceId[64];
+    DevHandle dev;          // dev_intern 핸들
+    const char* deviceId;   // dev_intern shm 안 문자열 (SENSOR/로그/상태 파일에서만 씀)
+                            // 채널 값은 hub->vals (슬롯 번호 그대로)
 
-    int has_hr;
-    int has_st;
-    double hr;
-    double st;
+    int64_t dev_ts_ms;      // 마지막 watch ts (epoch ms)
+    int64_t rx_ts_ms;       // 마지막 수신 시각 (epoch ms)
+    int64_t skew_ms;        // rx - dev (워치 시계 오차 + 전달 지연)
 
-    char last_ts[64];
+    uint64_t last_seen_ms;  // CLOCK_MONOTONIC, 마지막 watch 수신 시각
+    uint64_t next_emit_ms;  // CLOCK_MONOTONIC, 다음 SENSOR 전송 시각
+    int64_t emit_rx_ms;     // 마지막으로 보낸 SENSOR의 rx_ts_ms (같으면 새 데이터 없음 → 흐름 제어 LOW)
 } WatchCache;
 
-struct CollectorHub {
-    CollectorHubConfig cfg;
+// ============================
+// 설정 (RCU 스타일)
+//   - 읽는 쪽: hub->conf 포인터를 한 번 load 해서 사용 (락 없음)
+//   - 바꾸는 쪽: 새 HubConf를 만들어 포인터 교체, 이전 것은 retired 목록으로
+//   - 스레드마다 루프 처음에 "지금 보고 있는 generation"을 기록 (quiescent point)
+//     모든 스레드가 더 새 generation을 본 뒤에만 retired HubConf 해제
+// ============================
+enum { HUB_T_TH, HUB_T_WATCH, HUB_T_RULE_IN, HUB_T_RULE_OUT, HUB_T_COUNT };
+
+#define HUB_QS_OFFLINE UINT64_MAX
+
+typedef struct HubConf {
+    CollectorHubConfig cfg;    // 문자열 필드는 아래 버퍼를 가리킴 (NULL은 그대로)
+    uint64_t gen;
+    struct HubConf* retired_next;
+
+    char watch_fifo[256];
+    char rule_in[256];
+    char rule_out[256];
+    char watch_mq[256];
+    char th_ip[64];
+    char state_file[256];
+    char reload_file[256];
+    char archive_dir[256];
+    char dev_intern[64];
+    char channels[256];
+    char query_socket[108];
+} HubConf;
 
-    // 콜백
+struct CollectorHub {
+    _Atomic(HubConf*) conf;
+    pthread_mutex_t conf_mtx;          // reconfigure 직렬화 + retired 목록
+    HubConf* retired;
+    _Atomic uint64_t qs_gen[HUB_T_COUNT];
+    atomic_int ext_readers;            // 허브 스레드 밖에서 설정을 읽는 중 (collector_hub_ingest_line)
+    atomic_int reload_req;             // collector_hub_request_reload (시그널 핸들러에서 set)
+    time_t reload_mtime;               // reload_file_path 마지막 mtime (rule_in 스레드 전용)
+
+    // RESULT 구독자 (create에 넘긴 콜백도 구독 1개)
     CollectorHubResultCallback cb;
     void* cb_ctx;
+    HubResultBus* results;
 
-    // 실행 상태
+    // 실행 상태 (running은 start/stop을 부르는 쪽만, 스레드는 life의 정지 플래그 / eventfd)
     int running;
+    HubLife life;
+    int ep_th, ep_watch, ep_rule_in, ep_rule_out;  // life endpoint 번호 (-1 안 씀)
+    uint64_t th_aborts;       // stop 때 modbus connect / 응답 대기를 shutdown으로 깨운 횟수
     pthread_mutex_t mtx;
 
     // env(TH)
     int has_env;
     double temp;
     double humi;
+    THSensor* th;       // TH 폴링 스레드 전용 핸들 (다른 스레드는 th_mtx 잡고 th_module_abort만)
+    pthread_mutex_t th_mtx;
+    struct CollectorHub* env_src; // NULL이 아니면 이 허브의 env를 tick마다 복사 (샤드 그룹)
+    int64_t env_ts_ms;  // 마지막 env 갱신 시각 (epoch ms)
 
     // watch cache
     WatchCache* watch;
     int watch_cap;
+    DevIntern* ids;           // deviceId ↔ 핸들 (워치 모듈과 같은 shm)
+    int* slot_of;             // 핸들 → 슬롯 (-1 없음, hub->mtx로 보호), dev_intern capacity + 1개
+    ChanReg* chans;           // 채널 번호 ↔ type / SENSOR key / watch 라인 필드 (생성 후 읽기 전용)
+    ChanStore vals;           // 슬롯별 채널 값 (watch_cap 슬롯, hub->mtx로 보호)
+
+    // 디바이스별 타이머 (id = 슬롯 번호, hub->mtx로 보호)
+    TimerWheel* stale_wheel;  // 마지막 수신 후 device_stale_sec 지나면 슬롯 해제
+    TimerWheel* emit_wheel;   // 디바이스별 SENSOR 전송 deadline
+
+    // 상태 파일 (state_file_path 있을 때만, hub->mtx로 보호)
+    HubSnapshot* snap;
+    unsigned char* dirty;     // 슬롯별: 마지막 checkpoint 이후 바뀜
+    int dirty_count;
+    int env_dirty;
+    uint64_t next_ckpt_ms;
+
+    // 측정값 아카이브 (archive_dir 있을 때만, 자체 락)
+    HubArchive* archive;
+
+    // 상태 조회 (query_socket_path 있을 때만): 값이 바뀔 때 hub->mtx 안에서 live에 같이 씀, 서버는 live만 읽음
+    HubLive* live;
+    HubQueryServer* query;
 
     // threads
     pthread_t t_th;
     pthread_t t_watch;
     pthread_t t_rule_in;
     pthread_t t_rule_out;
+
+    // rule_in tick 지연 (rule_in 스레드만 씀, stop에서 출력)
+    TickJitter tick_jitter;
+    // MQ 레코드 수신→반영 지연 (watch 스레드만 씀, stop에서 출력, rx_ts_ms 기준이라 워치 쪽 지연까지 포함)
+    TickJitter watch_lat;
+
+    // 스레드별 cJSON arena (각 스레드만 씀)
+    MemArena arena_watch;
+    MemArena arena_rule_in;
+    uint64_t line_overflow;   // HUB_LINE_MAX 넘어서 못 보낸 SENSOR 수
+
+    // 흐름 제어
+    //   - rule_in: SENSOR는 락 안에서 out_buf에 쌓고, 락 밖에서 non-blocking write
+    //     (rulebase가 느려도 hub->mtx를 잡은 채 막히지 않음 → watch 입력 안 멈춤)
+    //   - pipe + out_buf 대기량이 차면 COALESCE → SAMPLE → DROP_LOW
+    FlowStage flow_rule_in;   // rule_in 스레드만 update
+    FlowStage flow_ingest;    // watch 스레드만 update
+    char* out_buf;            // rule_in 스레드 전용 (HUB_OUT_BYTES)
+    size_t out_len;
+    uint64_t out_oldest_ms;   // out_buf가 비어 있지 않게 된(또는 마지막으로 일부 써진) 시각 → lag
+
+    // SENSOR emit: 락 안에서 스냅샷 → 락 밖에서 shard 병렬 포맷 (rule_in 스레드만 씀, 크기는 hub->mtx 안에서)
+    HubEmit* emit;
+    struct EmitRec* emit_recs;
+    ChanStore emit_vals;      // 스냅샷 채널 값 (레코드 번호 = 슬롯 자리)
+    int emit_cap;
 };
 
 // ============================
-// 내부: device slot
+// 내부: 설정 publish / 읽기 / 해제
 // ============================
-static int find_or_create_slot(struct CollectorHub* hub, const char* deviceId) {
-    for (int i = 0; i < hub->watch_cap; i++) {
-        if (hub->watch[i].used && strcmp(hub->watch[i].deviceId, deviceId) == 0) return i;
+static const char* conf_str(char* dst, size_t sz, const char* src) {
+    if (!src) return NULL;
+    snprintf(dst, sz, "%s", src);
+    return dst;
+}
+
+// cfg를 복사해서 새 HubConf 생성 (문자열도 복사, 기본값 채움)
+static HubConf* conf_build(const CollectorHubConfig* cfg, uint64_t gen) {
+    HubConf* c = (HubConf*)calloc(1, sizeof(HubConf));
+    if (!c) return NULL;
+
+    c->cfg = *cfg;
+    c->gen = gen;
+
+    CollectorHubConfig* k = &c->cfg;
+    k->watch_fifo_path = conf_str(c->watch_fifo, sizeof(c->watch_fifo), cfg->watch_fifo_path);
+    k->rulebase_in_fifo_path = conf_str(c->rule_in, sizeof(c->rule_in), cfg->rulebase_in_fifo_path);
+    k->rulebase_out_fifo_path = conf_str(c->rule_out, sizeof(c->rule_out), cfg->rulebase_out_fifo_path);
+    k->watch_mq_name = conf_str(c->watch_mq, sizeof(c->watch_mq), cfg->watch_mq_name);
+    k->th_ip = conf_str(c->th_ip, sizeof(c->th_ip), cfg->th_ip);
+    k->state_file_path = conf_str(c->state_file, sizeof(c->state_file), cfg->state_file_path);
+    k->reload_file_path = conf_str(c->reload_file, sizeof(c->reload_file), cfg->reload_file_path);
+    k->archive_dir = conf_str(c->archive_dir, sizeof(c->archive_dir), cfg->archive_dir);
+    k->dev_intern_name = conf_str(c->dev_intern, sizeof(c->dev_intern), cfg->dev_intern_name);
+    k->channels = conf_str(c->channels, sizeof(c->channels), cfg->channels);
+    k->query_socket_path = conf_str(c->query_socket, sizeof(c->query_socket), cfg->query_socket_path);
+
+    // defaults
+    if (!k->watch_fifo_path) k->watch_fifo_path = "/tmp/th_fifo";
+    if (!k->rulebase_in_fifo_path) k->rulebase_in_fifo_path = "/tmp/rulebase_in.fifo";
+    if (!k->rulebase_out_fifo_path) k->rulebase_out_fifo_path = "/tmp/rulebase_out.fifo";
+
+    if (!k->th_ip) k->th_ip = "192.168.0.20";
+    if (k->th_port <= 0) k->th_port = 8887;
+
+    if (k->collect_interval_sec <= 0) k->collect_interval_sec = 5;
+    if (k->th_min_interval_ms <= 0) k->th_min_interval_ms = 1000;
+    if (k->th_max_interval_ms <= 0) k->th_max_interval_ms = 60000;
+    if (k->max_devices <= 0) k->max_devices = 64;
+    if (k->device_stale_sec <= 0) k->device_stale_sec = 300;
+    if (k->state_max_age_sec <= 0) k->state_max_age_sec = 600;
+    if (k->state_checkpoint_ms <= 0) k->state_checkpoint_ms = 1000;
+    if (k->emit_workers <= 0) k->emit_workers = 1;
+    if (k->emit_parallel_min <= 0) k->emit_parallel_min = HUB_EMIT_PAR_MIN;
+    return c;
+}
+
+// 현재 설정 (허브 스레드 안, hub->mtx 안, 또는 ext_readers 올린 상태에서만)
+static const CollectorHubConfig* hub_cfg(struct CollectorHub* hub) {
+    return &atomic_load(&hub->conf)->cfg;
+}
+
+// 스레드 루프 처음: 이전에 들고 있던 설정은 더 이상 안 씀
+static const CollectorHubConfig* conf_enter(struct CollectorHub* hub, int t) {
+    HubConf* c = atomic_load(&hub->conf);
+    atomic_store(&hub->qs_gen[t], c->gen);
+    return &c->cfg;
+}
+
+static void conf_offline(struct CollectorHub* hub, int t) {
+    atomic_store(&hub->qs_gen[t], HUB_QS_OFFLINE);
+}
+
+// 모든 스레드가 지나간 retired 설정 해제 (conf_mtx 잡고 호출)
+static void conf_reclaim(struct CollectorHub* hub) {
+    if (!hub->retired || atomic_load(&hub->ext_readers) != 0) return;
+
+    uint64_t min_gen = HUB_QS_OFFLINE;
+    for (int t = 0; t < HUB_T_COUNT; t++) {
+        uint64_t g = atomic_load(&hub->qs_gen[t]);
+        if (g < min_gen) min_gen = g;
+    }
+
+    HubConf** pp = &hub->retired;
+    while (*pp) {
+        HubConf* c = *pp;
+        if (c->gen < min_gen) {
+            *pp = c->retired_next;
+            free(c);
+        } else {
+            pp = &c->retired_next;
+        }
     }
+}
+
+// ============================
+// 내부: device slot
+// ============================
+// 있는 디바이스는 핸들로 바로, 새 디바이스만 빈 슬롯 탐색 (hub->mtx 잡고 호출)
+// 슬롯을 잡는 동안 핸들 ref (놓을 때 unref → 워치 모듈도 놓으면 dev_intern이 회수)
+static int find_or_create_slot(struct CollectorHub* hub, DevHandle dev) {
+    int s = hub->slot_of[dev];
+    if (s >= 0) return s;
+
     for (int i = 0; i < hub->watch_cap; i++) {
         if (!hub->watch[i].used) {
+            if (dev_intern_ref(hub->ids, dev) != 0) return -1; // 그 사이에 놓인 핸들
             hub->watch[i].used = 1;
-            snprintf(hub->watch[i].deviceId, sizeof(hub->watch[i].deviceId), "%s", deviceId);
-            hub->watch[i].has_hr = 0;
-            hub->watch[i].has_st = 0;
-            hub->watch[i].hr = 0;
-            hub->watch[i].st = 0;
-            hub->watch[i].last_ts[0] = '\0';
+            hub->watch[i].dev = dev;
+            hub->watch[i].deviceId = dev_intern_name(hub->ids, dev);
+            hub->slot_of[dev] = i;
+            chan_store_clear(&hub->vals, i);
+            hub->watch[i].dev_ts_ms = 0;
+            hub->watch[i].rx_ts_ms = 0;
+            hub->watch[i].skew_ms = 0;
+            hub->watch[i].last_seen_ms = 0;
+            hub->watch[i].next_emit_ms = 0;
+            hub->watch[i].emit_rx_ms = 0;
             return i;
         }
     }
     return -1;
 }
 
+// 수신 시각 갱신 + 만료 타이머 재설정, 새 디바이스면 첫 emit deadline 설정 (hub->mtx 잡고 호출)
+static void touch_slot(struct CollectorHub* hub, int slot, uint64_t now) {
+    WatchCache* wc = &hub->watch[slot];
+    wc->last_seen_ms = now;
+    const CollectorHubConfig* cfg = hub_cfg(hub);
+    timer_wheel_schedule(hub->stale_wheel, slot, now + (uint64_t)cfg->device_stale_sec * 1000ULL);
+
+    if (!timer_wheel_pending(hub->emit_wheel, slot)) {
+        wc->next_emit_ms = now + (uint64_t)cfg->collect_interval_sec * 1000ULL;
+        timer_wheel_schedule(hub->emit_wheel, slot, wc->next_emit_ms);
+    }
+}
+
+// 상태 파일에 다시 써야 하는 슬롯 표시 (hub->mtx 잡고 호출)
+static void mark_dirty(struct CollectorHub* hub, int slot) {
+    if (!hub->dirty || hub->dirty[slot]) return;
+    hub->dirty[slot] = 1;
+    hub->dirty_count++;
+}
+
+// 조회용 live 테이블에 슬롯 현재 값 반영 (hub->mtx 잡고 호출 → 쓰는 쪽은 항상 1개)
+static void live_put_locked(struct CollectorHub* hub, int slot) {
+    if (!hub->live) return;
+    const WatchCache* wc = &hub->watch[slot];
+    double v[CHAN_MAX];
+    uint32_t present = hub->vals.present[slot];
+    for (uint32_t p = present; p; p &= p - 1) {
+        int c = __builtin_ctz(p);
+        v[c] = chan_store_get(&hub->vals, slot, c);
+    }
+    hub_live_put(hub->live, wc->dev, present, v, wc->dev_ts_ms, wc->rx_ts_ms);
+}
+
+static void live_env_locked(struct CollectorHub* hub) {
+    if (!hub->live) return;
+    double hi = hub->has_env ? calc_heat_index(hub->temp, hub->humi) : 0.0;
+    hub_live_put_env(hub->live, hub->has_env, hub->temp, hub->humi, hi, hub->env_ts_ms);
+}
+
+// stale_wheel 콜백: 슬롯 해제 (hub->mtx 잡힌 상태)
+static void on_device_stale(void* ctx, int slot, uint64_t now_ms) {
+    struct CollectorHub* hub = (struct CollectorHub*)ctx;
+    WatchCache* wc = &hub->watch[slot];
+    if (!wc->used) return;
+
+    if (hub_cfg(hub)->log_watch) {
+        printf("⌛ [HUB][WATCH] %s stale (%llu ms) → slot %d freed\n", wc->deviceId,
+               (unsigned long long)(now_ms - wc->last_seen_ms), slot);
+    }
+    timer_wheel_cancel(hub->emit_wheel, slot);
+    hub->slot_of[wc->dev] = -1;
+    if (hub->live) hub_live_remove(hub->live, wc->dev);
+    dev_intern_unref(hub->ids, wc->dev);
+    chan_store_clear(&hub->vals, slot);
+    memset(wc, 0, sizeof(*wc));
+    mark_dirty(hub, slot);
+}
+
 // ============================
-// 스레드 1) TH 폴링
+// 상태 파일 checkpoint / warm restart
 // ============================
-static void* th_thread(void* arg) {
-    struct CollectorHub* hub = (struct CollectorHub*)arg;
+// 바뀐 슬롯/env만 mmap 파일에 반영 (hub->mtx 잡고 호출)
+static void checkpoint_locked(struct CollectorHub* hub) {
+    if (!hub->snap || (hub->dirty_count == 0 && !hub->env_dirty)) return;
+
+    for (int i = 0; i < hub->watch_cap && hub->dirty_count > 0; i++) {
+        if (!hub->dirty[i]) continue;
+        hub->dirty[i] = 0;
+        hub->dirty_count--;
+
+        const WatchCache* wc = &hub->watch[i];
+        if (!wc->used) {
+            hub_snapshot_clear(hub->snap, i);
+            continue;
+        }
+
+        HubSnapRec r;
+        memset(&r, 0, sizeof(r));
+        snprintf(r.deviceId, sizeof(r.deviceId), "%s", wc->deviceId);
+        r.present = hub->vals.present[i];
+        for (uint32_t p = r.present; p; p &= p - 1) {
+            int c = __builtin_ctz(p);
+            r.val[c] = chan_store_get(&hub->vals, i, c);
+        }
+        r.dev_ts_ms = wc->dev_ts_ms;
+        r.rx_ts_ms = wc->rx_ts_ms;
+        r.skew_ms = wc->skew_ms;
+        hub_snapshot_put(hub->snap, i, &r);
+    }
+
+    if (hub->env_dirty) {
+        hub_snapshot_put_env(hub->snap, hub->has_env, hub->temp, hub->humi, hub->env_ts_ms);
+        hub->env_dirty = 0;
+    }
+
+    hub_snapshot_commit(hub->snap, ts_now_ms());
+}
+
+// 상태 파일에서 디바이스/env 복원 (create에서, 스레드 시작 전)
+static void warm_restart(struct CollectorHub* hub) {
+    const CollectorHubConfig* cfg = hub_cfg(hub);
+    hub->snap = hub_snapshot_open(cfg->state_file_path, hub->watch_cap);
+    if (!hub->snap) {
+        fprintf(stderr, "❌ [HUB][STATE] %s open failed → cold start\n", cfg->state_file_path);
+        return;
+    }
+
+    int64_t now_ms = ts_now_ms();
+    uint64_t mono = now_mono_ms();
+    int64_t stale_ms = (int64_t)cfg->device_stale_sec * 1000;
+    uint64_t interval = (uint64_t)cfg->collect_interval_sec * 1000ULL;
+    int restored = 0, dropped = 0;
+
+    for (int i = 0; i < hub->watch_cap; i++) {
+        HubSnapRec r;
+        if (hub_snapshot_get(hub->snap, i, &r) != 0) {
+            hub_snapshot_clear(hub->snap, i); // 빈 슬롯/찢어진 레코드 정리
+            continue;
+        }
+
+        // 마지막 수신 후 device_stale_sec 지났으면 복원 안 함 (시계가 거꾸로 가도 버림)
+        int64_t age = now_ms - r.rx_ts_ms;
+        if (r.rx_ts_ms <= 0 || age < 0 || age >= stale_ms) {
+            hub_snapshot_clear(hub->snap, i);
+            dropped++;
+            continue;
+        }
 
-    if (th_init(hub->cfg.th_ip, hub->cfg.th_port) != 0) {
-        fprintf(stderr, "❌ [HUB][TH] th_init failed (%s:%d)\n",
-                hub->cfg.th_ip, hub->cfg.th_port);
+        // 상태 파일은 문자열로 저장 (shm이 새로 만들어져 핸들이 바뀌어도 복원됨)
+        DevHandle dev = dev_intern_get(hub->ids, r.deviceId);
+        if (dev == DEV_HANDLE_NONE || hub->slot_of[dev] >= 0 || dev_intern_ref(hub->ids, dev) != 0) {
+            hub_snapshot_clear(hub->snap, i);
+            dropped++;
+            continue;
+        }
+
+        WatchCache* wc = &hub->watch[i];
+        wc->used = 1;
+        wc->dev = dev;
+        wc->deviceId = dev_intern_name(hub->ids, dev);
+        hub->slot_of[dev] = i;
+        chan_store_clear(&hub->vals, i);
+        for (int c = 0; c < hub->vals.n_ch; c++) {
+            if ((r.present >> c) & 1u) chan_store_set(&hub->vals, i, c, r.val[c]);
+        }
+        wc->dev_ts_ms = r.dev_ts_ms;
+        wc->rx_ts_ms = r.rx_ts_ms;
+        wc->skew_ms = r.skew_ms;
+
+        // 남은 수명 그대로 만료 예약, 첫 emit은 슬롯마다 tick 단위로 흩어서
+        wc->last_seen_ms = mono - (uint64_t)age;
+        timer_wheel_schedule(hub->stale_wheel, i, wc->last_seen_ms + (uint64_t)stale_ms);
+        wc->next_emit_ms = mono + interval + (uint64_t)(i % 10) * HUB_TICK_MS;
+        timer_wheel_schedule(hub->emit_wheel, i, wc->next_emit_ms);
+        live_put_locked(hub, i);
+        restored++;
+    }
+
+    double t, h;
+    int64_t env_ts;
+    if (hub_snapshot_get_env(hub->snap, &t, &h, &env_ts) == 0) {
+        int64_t age = now_ms - env_ts;
+        if (age >= 0 && age < (int64_t)cfg->state_max_age_sec * 1000) {
+            hub->has_env = 1;
+            hub->temp = t;
+            hub->humi = h;
+            hub->env_ts_ms = env_ts;
+            live_env_locked(hub);
+        }
+    }
+
+    printf("🗂️ [HUB][STATE] warm restart %s: %d devices restored, %d stale dropped, env=%s (gen %llu)\n",
+           cfg->state_file_path, restored, dropped, hub->has_env ? "yes" : "no",
+           (unsigned long long)hub_snapshot_header(hub->snap)->generation);
+}
+
+// ============================
+// 스레드 1) TH 폴링
+// ============================
+// TH 핸들 열기 (ip/port/slave는 th_thread 지역 변수에 기억해서 설정 변경 감지)
+static THSensor* th_open(const CollectorHubConfig* cfg) {
+    THSensorConfig tc;
+    th_module_default_config(&tc);
+    tc.ip = cfg->th_ip;
+    tc.port = cfg->th_port;
+    if (cfg->th_slave_id > 0) tc.slave_id = cfg->th_slave_id;
+
+    // 연결은 첫 read에서 (핸들을 먼저 hub->th에 걸어야 stop이 connect 대기를 깨울 수 있음)
+    THSensor* th = th_module_create(&tc);
+    if (!th) {
+        fprintf(stderr, "❌ [HUB][TH] th_module_create failed (%s:%d)\n", cfg->th_ip, cfg->th_port);
         // 그래도 루프는 돌면서 재시도/마지막값 유지 가능
     }
+    return th;
+}
+
+// hub->th 교체 (읽기 / 통신은 TH 스레드만, stop은 th_mtx 잡고 th_module_abort만)
+static void th_set(struct CollectorHub* hub, THSensor* th) {
+    pthread_mutex_lock(&hub->th_mtx);
+    THSensor* old = hub->th;
+    hub->th = th;
+    pthread_mutex_unlock(&hub->th_mtx);
+    th_module_close(old);
+}
 
-    while (hub->running) {
-        THData d = th_read_once();
+// stop에서: TH 스레드가 modbus connect / 응답 대기 중이면 소켓 shutdown으로 바로 실패하게
+static void th_abort(struct CollectorHub* hub) {
+    pthread_mutex_lock(&hub->th_mtx);
+    th_module_abort(hub->th);
+    pthread_mutex_unlock(&hub->th_mtx);
+}
+
+static void th_sched_from_cfg(THSched* sched, const CollectorHubConfig* cfg) {
+    THSchedConfig sc;
+    memset(&sc, 0, sizeof(sc));
+    sc.min_interval_ms = cfg->th_min_interval_ms;
+    sc.max_interval_ms = cfg->th_max_interval_ms;
+    th_sched_init(sched, &sc);
+}
+
+static void* th_thread(void* arg) {
+    struct CollectorHub* hub = (struct CollectorHub*)arg;
+    const CollectorHubConfig* cfg = conf_enter(hub, HUB_T_TH);
+    thread_place_apply(&cfg->place_th, "hub-th");
+
+    // 지금 열려있는 endpoint / 스케줄 (reconfigure로 바뀌면 다시 열기)
+    char th_ip[64];
+    snprintf(th_ip, sizeof(th_ip), "%s", cfg->th_ip);
+    int th_port = cfg->th_port;
+    int th_slave = cfg->th_slave_id;
+    int min_ms = cfg->th_min_interval_ms;
+    int max_ms = cfg->th_max_interval_ms;
+
+    th_set(hub, th_open(cfg));
+
+    // 고정 sleep 대신 변화율 기반 간격 + CLOCK_MONOTONIC deadline
+    THSched sched;
+    th_sched_from_cfg(&sched, cfg);
+
+    while (!hub_life_stopping(&hub->life)) {
+        cfg = conf_enter(hub, HUB_T_TH);
+
+        // TH endpoint hot-swap (통신은 이 스레드만, 교체는 stop의 abort와 th_mtx로)
+        if (strcmp(th_ip, cfg->th_ip) != 0 || th_port != cfg->th_port || th_slave != cfg->th_slave_id) {
+            printf("🔁 [HUB][TH] endpoint %s:%d → %s:%d\n", th_ip, th_port, cfg->th_ip, cfg->th_port);
+            snprintf(th_ip, sizeof(th_ip), "%s", cfg->th_ip);
+            th_port = cfg->th_port;
+            th_slave = cfg->th_slave_id;
+            th_set(hub, th_open(cfg));
+        }
+        if (min_ms != cfg->th_min_interval_ms || max_ms != cfg->th_max_interval_ms) {
+            min_ms = cfg->th_min_interval_ms;
+            max_ms = cfg->th_max_interval_ms;
+            th_sched_from_cfg(&sched, cfg);
+        }
+
+        THData d = th_module_read(hub->th);
+        if (d.error_code == TH_OK) hub_life_up(&hub->life, hub->ep_th, now_mono_ms());
+        else hub_life_fail(&hub->life, hub->ep_th, d.sys_errno ? d.sys_errno : EIO, now_mono_ms(), "[HUB][TH]");
 
         pthread_mutex_lock(&hub->mtx);
         if (d.error_code == TH_OK) {
             hub->has_env = 1;
             hub->temp = d.temperature;
             hub->humi = d.humidity;
+            hub->env_ts_ms = ts_now_ms();
+            hub->env_dirty = 1;
+            live_env_locked(hub);
         }
+        int64_t env_ts = hub->env_ts_ms;
         pthread_mutex_unlock(&hub->mtx);
 
-        if (hub->cfg.log_th) {
+        if (d.error_code == TH_OK && hub->archive) {
+            hub_archive_append(hub->archive, HUB_ARCHIVE_ENV_ID, HUB_CH_TEMP, env_ts, d.temperature);
+            hub_archive_append(hub->archive, HUB_ARCHIVE_ENV_ID, HUB_CH_HUMI, env_ts, d.humidity);
+        }
+
+        if (cfg->log_th) {
             if (d.error_code == TH_OK) {
                 printf("🌦️ [HUB][TH] T=%.2f H=%.2f\n", d.temperature, d.humidity);
-            } else {
-                printf("⚠️ [HUB][TH] read fail code=%d errno=%d\n", d.error_code, d.sys_errno);
+            } else if (d.error_code != TH_ERR_CIRCUIT_OPEN) {
+                THHealthStats hs;
+                th_module_get_stats(hub->th, &hs);
+                printf("⚠️ [HUB][TH] read fail code=%d errno=%d (state=%d backoff=%dms trips=%llu recover=%llums)\n",
+                       d.error_code, d.sys_errno, hs.state, hs.backoff_ms,
+                       (unsigned long long)hs.trips, (unsigned long long)hs.recover_ms_total);
             }
         }
 
-        sleep(hub->cfg.collect_interval_sec);
+        int next_ms = th_sched_update(&sched, &d);
+        if (cfg->log_th) {
+            printf("⏱️ [HUB][TH] next poll in %d ms\n", next_ms);
+        }
+
+        // 다음 폴링까지 (정지 요청이 오면 바로 깨어남)
+        hub_life_wait_until(&hub->life, &sched.deadline);
     }
 
-    th_close();
+    th_set(hub, NULL);
+    conf_offline(hub, HUB_T_TH);
     return NULL;
 }
 
 // ============================
-// 스레드 2) watch FIFO 리더
-//   - watch_udp 모듈이 /tmp/th_fifo에 쓰는
-//     {"deviceId","ts","heartRate","skin_temperature"} 라인을 읽음
+// watch 입력 반영 (FIFO 라인 / MQ 레코드 / 샤드 라우터 공용)
 // ============================
-static void* watch_thread(void* arg) {
-    struct CollectorHub* hub = (struct CollectorHub*)arg;
+// vals: present 비트 순서(낮은 채널부터)로 채운 값, 허브가 모르는 채널 번호는 건너뜀
+static int apply_watch(struct CollectorHub* hub, DevHandle dev, uint32_t present, const double* vals,
+                       int64_t dev_ms, int64_t rx_ms) {
+    // 다른 shm에서 온 핸들 등 모르는 핸들은 버림
+    const char* name = dev_intern_name(hub->ids, dev);
+    if (!name) return -2;
+
+    pthread_mutex_lock(&hub->mtx);
+    int slot = find_or_create_slot(hub, dev);
+    if (slot >= 0) {
+        WatchCache* wc = &hub->watch[slot];
+        touch_slot(hub, slot, now_mono_ms());
+
+        wc->dev_ts_ms = dev_ms;
+        wc->rx_ts_ms = rx_ms;
+        wc->skew_ms = rx_ms - dev_ms;
+
+        int i = 0;
+        for (uint32_t p = present; p; p &= p - 1, i++) {
+            int c = __builtin_ctz(p);
+            if (c < hub->vals.n_ch) chan_store_set(&hub->vals, slot, c, vals[i]);
+        }
+        mark_dirty(hub, slot);
+        live_put_locked(hub, slot);
+    }
+    pthread_mutex_unlock(&hub->mtx);
+
+    // 아카이브는 자기 락 (hub->mtx 밖에서, 슬롯이 없어도 기록)
+    if (hub->archive) {
+        int i = 0;
+        for (uint32_t p = present; p; p &= p - 1, i++) {
+            int c = __builtin_ctz(p);
+            if (c < hub->vals.n_ch) hub_archive_append(hub->archive, name, c, dev_ms, vals[i]);
+        }
+    }
+    return slot >= 0 ? 0 : -2;
+}
 
-    ensure_fifo(hub->cfg.watch_fifo_path);
+// WatchMsg 1개 (MQ 리더 / 통합 실행 링 drain 공용)
+static int apply_watch_msg(struct CollectorHub* hub, const WatchMsg* m) {
+    // 값 개수보다 비트가 많은 레코드는 깨진 것 (vals 밖을 읽게 됨)
+    if (__builtin_popcount(m->present) > WATCH_MSG_VALS) return -1;
+    return apply_watch(hub, m->dev, m->present, m->vals, m->dev_ts_ms, m->rx_ts_ms);
+}
 
-    FILE* fp = fopen(hub->cfg.watch_fifo_path, "r");
-    if (!fp) {
-        perror("fopen watch_fifo");
-        return NULL;
+// {"deviceId","ts","heartRate","skin_temperature",...} 라인 1개 (채널 필드 이름은 channel_reg)
+static int apply_watch_line(struct CollectorHub* hub, const char* line) {
+    cJSON* root = cJSON_Parse(line);
+    if (!root) return -1;
+
+    const cJSON* jDev = cJSON_GetObjectItemCaseSensitive(root, "deviceId");
+    const cJSON* jTs  = cJSON_GetObjectItemCaseSensitive(root, "ts");
+
+    uint32_t present = 0;
+    double vals[CHAN_MAX];
+    int n_vals = 0;
+    for (int c = 0; c < hub->vals.n_ch; c++) {
+        const cJSON* jv = cJSON_GetObjectItemCaseSensitive(root, chan_reg_field(hub->chans, c));
+        if (!cJSON_IsNumber(jv)) continue;
+        present |= 1u << c;
+        vals[n_vals++] = jv->valuedouble;
+    }
+
+    const char* dev = (cJSON_IsString(jDev) && jDev->valuestring) ? jDev->valuestring : "unknown";
+
+    int64_t rx_ms = ts_now_ms();
+
+    // ts 문자열은 들어올 때 한 번만 epoch ms로 변환 (형식 오류면 수신 시각)
+    int64_t dev_ms = rx_ms;
+    if (cJSON_IsNumber(jTs)) {
+        dev_ms = (int64_t)jTs->valuedouble;
+    } else if (cJSON_IsString(jTs) && jTs->valuestring &&
+               ts_parse_local(jTs->valuestring, 0, rx_ms, &dev_ms) != 0) {
+        dev_ms = rx_ms;
+    }
+
+    // 문자열 → 핸들은 여기서 한 번 (이후 캐시는 핸들로)
+    int rc = apply_watch(hub, dev_intern_get(hub->ids, dev), present, vals, dev_ms, rx_ms);
+
+    if (hub_cfg(hub)->log_watch) {
+        printf("⌚ [HUB][WATCH] %s", line);
+    }
+
+    cJSON_Delete(root);
+    return rc;
+}
+
+// ============================
+// 스레드 2) watch 리더
+//   - FIFO: watch_udp 모듈이 /tmp/th_fifo에 쓰는
+//     {"deviceId","ts","heartRate","skin_temperature"} 라인을 읽음
+//   - MQ: watch_mq_name이 있으면 워치 모듈이 보내는 배치 WatchMsg를 읽음
+// ============================
+static void watch_mq_loop(struct CollectorHub* hub) {
+    // 허브가 먼저 큐를 만들어 둠 (이미 있으면 기존 속성 그대로 오픈)
+    struct mq_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = 10;
+    attr.mq_msgsize = (long)MQ_BATCH_MSGSIZE(sizeof(WatchMsg), MQ_BATCH_DEFAULT_RECS);
+
+    // 못 열면 (권한 / 한도 등) 재시도 timer, 받는 건 poll(mq fd + 정지 eventfd) 뒤 non-blocking
+    const char* name = hub_cfg(hub)->watch_mq_name; // watch_mq_name은 reconfigure로 안 바뀜
+    mqd_t q = (mqd_t)-1;
+    while (!hub_life_stopping(&hub->life)) {
+        uint64_t now = now_mono_ms();
+        q = mq_open(name, O_RDONLY | O_CREAT | O_NONBLOCK, 0666, &attr);
+        if (q != (mqd_t)-1) break;
+        hub_life_fail(&hub->life, hub->ep_watch, errno, now, "[HUB][WATCH]");
+        hub_life_wait_ms(&hub->life, hub_life_retry_in_ms(&hub->life, hub->ep_watch, now_mono_ms()));
+    }
+    if (q == (mqd_t)-1) return;
+    if (mq_getattr(q, &attr) != 0) {
+        perror("mq_getattr");
+        mq_close(q);
+        return;
+    }
+    unsigned char* buf = (unsigned char*)malloc((size_t)attr.mq_msgsize);
+    if (!buf) {
+        mq_close(q);
+        return;
     }
 
-    char line[4096];
+    // 큐는 허브가 만들어서 열기만으로는 상대(워치 프로세스)가 있는지 모름 → 첫 레코드가 올 때까지 RETRY
+    // (POSIX MQ는 상대가 닫는 걸 알려주지 않아서 한 번 UP이면 정지까지 UP)
+    hub_life_fail(&hub->life, hub->ep_watch, ENXIO, now_mono_ms(), "[HUB][WATCH]");
 
-    while (hub->running) {
-        if (!fgets(line, sizeof(line), fp)) {
-            if (feof(fp)) {
-                fclose(fp);
-                fp = fopen(hub->cfg.watch_fifo_path, "r");
-                if (!fp) { perror("reopen watch_fifo"); sleep(1); continue; }
+    uint64_t next_flow = 0;
+    int64_t lag_ms = 0;
+
+    while (!hub_life_stopping(&hub->life)) {
+        const CollectorHubConfig* cfg = conf_enter(hub, HUB_T_WATCH);
+
+        // 큐 깊이 + 마지막 레코드의 수신→반영 지연 publish
+        uint64_t now = now_mono_ms();
+        if (now >= next_flow) {
+            struct mq_attr cur;
+            if (mq_getattr(q, &cur) == 0) {
+                flow_stage_update(&hub->flow_ingest, (int)cur.mq_curmsgs, (int)cur.mq_maxmsg, lag_ms, now);
             }
-            continue;
+            next_flow = now + HUB_FLOW_SAMPLE_MS;
         }
 
-        cJSON* root = cJSON_Parse(line);
-        if (!root) continue;
+        // mqd_t는 fd (Linux) → 정지 eventfd와 같이 대기
+        ssize_t n = mq_receive(q, (char*)buf, (size_t)attr.mq_msgsize, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN) {
+                struct pollfd pf[2] = { { (int)q, POLLIN, 0 }, { hub_life_fd(&hub->life), POLLIN, 0 } };
+                poll(pf, 2, HUB_MQ_WAIT_MS);
+            } else if (errno != EINTR) {
+                perror("mq_receive");
+                hub_life_wait_ms(&hub->life, 1000);
+            }
+            continue;
+        }
 
-        const cJSON* jDev = cJSON_GetObjectItemCaseSensitive(root, "deviceId");
-        const cJSON* jTs  = cJSON_GetObjectItemCaseSensitive(root, "ts");
-        const cJSON* jHr  = cJSON_GetObjectItemCaseSensitive(root, "heartRate");
-        const cJSON* jSt  = cJSON_GetObjectItemCaseSensitive(root, "skin_temperature");
+        hub_life_up(&hub->life, hub->ep_watch, now_mono_ms());
 
-        const char* dev = (cJSON_IsString(jDev) && jDev->valuestring) ? jDev->valuestring : "unknown";
+        const unsigned char* rec;
+        int cnt = mq_batch_unpack(buf, (size_t)n, sizeof(WatchMsg), &rec);
+        for (int i = 0; i < cnt; i++) {
+            WatchMsg m;
+            memcpy(&m, rec + (size_t)i * sizeof(WatchMsg), sizeof(m));
 
-        pthread_mutex_lock(&hub->mtx);
-        int slot = find_or_create_slot(hub, dev);
-        if (slot >= 0) {
-            WatchCache* wc = &hub->watch[slot];
+            apply_watch_msg(hub, &m);
+            int64_t lat = ts_now_ms() - m.rx_ts_ms;
+            tick_jitter_record_us(&hub->watch_lat, lat > 0 ? (uint64_t)lat * 1000ULL : 0);
+            if (i == cnt - 1) lag_ms = lat;
 
-            if (cJSON_IsString(jTs) && jTs->valuestring) {
-                snprintf(wc->last_ts, sizeof(wc->last_ts), "%s", jTs->valuestring);
+            if (cfg->log_watch) {
+                const char* name = dev_intern_name(hub->ids, m.dev);
+                printf("⌚ [HUB][WATCH] mq %s ch=0x%x v0=%.2f skew=%lld\n", name ? name : "?",
+                       m.present, m.present ? m.vals[0] : 0.0, (long long)(m.rx_ts_ms - m.dev_ts_ms));
             }
+        }
+    }
 
-            if (cJSON_IsNumber(jHr)) { wc->hr = jHr->valuedouble; wc->has_hr = 1; }
-            if (cJSON_IsNumber(jSt)) { wc->st = jSt->valuedouble; wc->has_st = 1; }
+    free(buf);
+    mq_close(q);
+}
+
+// rulebase_in writer: non-blocking open (reader가 아직 없으면 ENXIO로 바로 실패 → 재시도 timer)
+static int fifo_open_writer(const char* path) {
+    ensure_fifo(path);
+    return open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+}
+
+// FIFO 리더: non-blocking open (writer 없어도 안 멈춤), 상대 writer는 hub_life_fifo_writer로 따로 확인
+// 상대가 없는 동안에도 fd는 열어둠 → 상대 writer의 non-blocking open이 ENXIO 없이 바로 됨
+static int fifo_open_reader(const char* path) {
+    ensure_fifo(path);
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    // 읽기는 blocking으로 되돌림 (io_uring read가 EAGAIN으로 바로 돌아오지 않게, epoll은 엔진이 다시 켬)
+    int fl = fcntl(fd, F_GETFL);
+    if (fl >= 0) fcntl(fd, F_SETFL, fl & ~O_NONBLOCK);
+    return fd;
+}
+
+// ============================
+// FIFO 라인 리더 (watch FIFO / rulebase_out 공용)
+//   - io_engine(io_uring 또는 epoll)으로 읽어서 줄마다 on_line
+//   - 줄이 없어도 HUB_IO_WAIT_MS마다 깨어나서 경로 변경 확인, 정지 eventfd가 엔진을 바로 깨움
+//   - 열기는 non-blocking (fifo_open_reader), 실패하면 endpoint 재시도 timer
+//   - 상대 writer가 있을 때만 엔진에 올리고 UP, 상대가 닫으면(EOF) 엔진에서 내리고 RETRY
+//     (fd는 열어둔 채 재시도 timer마다 hub_life_fifo_writer로 다시 확인)
+// ============================
+typedef struct {
+    struct CollectorHub* hub;
+    void (*on_line)(struct CollectorHub* hub, char* line);
+    int eof;
+} FifoLines;
+
+static void fifo_lines_on_line(void* ctx, char* line, size_t len) {
+    (void)len;
+    FifoLines* fl = (FifoLines*)ctx;
+    fl->on_line(fl->hub, line);
+}
+
+static void fifo_lines_on_eof(void* ctx, int fd) {
+    (void)fd;
+    ((FifoLines*)ctx)->eof = 1;
+}
+
+// flow: NULL이 아니면 FIFO에 쌓인 바이트를 HUB_FLOW_SAMPLE_MS마다 publish
+static void fifo_line_loop(struct CollectorHub* hub, int t, int ep, const char* (*path_of)(const CollectorHubConfig*),
+                           void (*on_line)(struct CollectorHub*, char*), size_t max_line,
+                           FlowStage* flow, const char* tag) {
+    const CollectorHubConfig* cfg = conf_enter(hub, t);
+    IoEngine* io = io_engine_create((IoBackend)cfg->io_backend, 0);
+    if (!io || io_engine_set_wakeup(io, hub_life_fd(&hub->life)) != 0) {
+        fprintf(stderr, "❌ %s io_engine_create failed\n", tag);
+        hub_life_fail(&hub->life, ep, ENOMEM, now_mono_ms(), tag);
+        io_engine_destroy(io);
+        return;
+    }
+
+    FifoLines fl = { hub, on_line, 0 };
+    char path[256] = "";
+    int fd = -1;
+    int attached = 0;   // 엔진에 올라가 있음 (상대 writer 있음)
+    int pipe_cap = 0;
+    uint64_t next_flow = 0;
+
+    while (!hub_life_stopping(&hub->life)) {
+        cfg = conf_enter(hub, t);
+        const char* want = path_of(cfg);
+
+        if (attached && fl.eof) {
+            io_engine_remove(io, fd);
+            attached = 0;
+            fl.eof = 0;
+            hub_life_fail(&hub->life, ep, EPIPE, now_mono_ms(), tag);
+        }
+        if (fd >= 0 && strcmp(path, want) != 0) {
+            printf("🔁 [HUB] FIFO %s → %s\n", path, want);
+            if (attached) io_engine_remove(io, fd);
+            close(fd);
+            fd = -1;
+            attached = 0;
+            fl.eof = 0;
+        }
+        if (!attached) {
+            uint64_t now = now_mono_ms();
+            if (!hub_life_due(&hub->life, ep, now)) {
+                hub_life_wait_ms(&hub->life, hub_life_retry_in_ms(&hub->life, ep, now));
+                continue;
+            }
+            if (fd < 0) {
+                snprintf(path, sizeof(path), "%s", want);
+                fd = fifo_open_reader(path);
+                if (fd < 0) {
+                    hub_life_fail(&hub->life, ep, errno, now, tag);
+                    continue;
+                }
+            }
+            int peer = hub_life_fifo_writer(fd);
+            if (peer <= 0) {
+                hub_life_fail(&hub->life, ep, peer < 0 ? errno : ENXIO, now, tag);
+                continue;
+            }
+            if (io_engine_add_lines(io, fd, max_line, fifo_lines_on_line, fifo_lines_on_eof, &fl) != 0) {
+                fprintf(stderr, "❌ %s io_engine_add_lines failed\n", tag);
+                hub_life_fail(&hub->life, ep, EIO, now, tag);
+                continue;
+            }
+            attached = 1;
+            pipe_cap = fcntl(fd, F_GETPIPE_SZ);
+            hub_life_up(&hub->life, ep, now);
         }
-        pthread_mutex_unlock(&hub->mtx);
 
-        if (hub->cfg.log_watch) {
-            printf("⌚ [HUB][WATCH] %s", line);
+        io_engine_run_once(io, HUB_IO_WAIT_MS);
+
+        // FIFO에 쌓인 바이트 publish (라인 JSON이라 lag는 안 봄)
+        uint64_t now = now_mono_ms();
+        if (flow && now >= next_flow) {
+            int pending = 0;
+            if (pipe_cap > 0 && ioctl(fd, FIONREAD, &pending) == 0) {
+                flow_stage_update(flow, pending, pipe_cap, 0, now);
+            }
+            next_flow = now + HUB_FLOW_SAMPLE_MS;
         }
+    }
 
-        cJSON_Delete(root);
+    io_engine_print_stats(io, tag);
+    if (fd >= 0) {
+        if (attached) io_engine_remove(io, fd);
+        close(fd);
     }
+    io_engine_destroy(io);
+}
+
+static const char* watch_fifo_of(const CollectorHubConfig* cfg) {
+    return cfg->watch_fifo_path;
+}
+
+static void watch_on_line(struct CollectorHub* hub, char* line) {
+    mem_arena_reset(&hub->arena_watch);
+    apply_watch_line(hub, line);
+}
+
+static void* watch_thread(void* arg) {
+    struct CollectorHub* hub = (struct CollectorHub*)arg;
+    const CollectorHubConfig* cfg = conf_enter(hub, HUB_T_WATCH);
+    thread_place_apply(&cfg->place_watch, "hub-watch");
+    mem_arena_bind(&hub->arena_watch);
+
+    if (cfg->watch_mq_name) {
+        watch_mq_loop(hub);
+        mem_arena_bind(NULL);
+        conf_offline(hub, HUB_T_WATCH);
+        return NULL;
+    }
+
+    fifo_line_loop(hub, HUB_T_WATCH, hub->ep_watch, watch_fifo_of, watch_on_line, 4096, &hub->flow_ingest,
+                   "[HUB][WATCH]");
 
-    fclose(fp);
+    mem_arena_bind(NULL);
+    conf_offline(hub, HUB_T_WATCH);
     return NULL;
 }
 
 // ============================
 // 스레드 3) rulebase_in writer
-//   - 5초마다 deviceId별로 SENSOR 메시지 1줄씩 전송
+//   - 디바이스마다 collect_interval_sec 주기로 SENSOR 메시지 1줄씩 전송
+//     (emit_wheel에 디바이스별 deadline, 매 tick에는 deadline 된 것만 처리)
 //   - 룰베이스 입력 포맷:
-//     {"type":"SENSOR","seq":..,"deviceId":"..","hi":..,"hr":..,"st":..,"now_unix":..,"now_local":".."}
+//     {"type":"SENSOR","seq":..,"deviceId":"..","hi":..,"hr":..,"st":..,<channels key>:..,"ts_ms":..,"skew_ms":..,"now_unix":..,"now_local":".."}
+//     (채널 값은 channel_reg 순서대로 key: 값, 아직 안 받은 채널은 null)
+//     (ts_ms: 워치 측정 시각 epoch ms, skew_ms: 수신 시각 - 측정 시각)
+//   - hub->mtx 안에서는 deadline 된 디바이스 스냅샷만 모으고, 포맷은 락 밖에서
+//     (많으면 hub_emit이 연속 구간 shard로 나눠 워커들이 각자 버퍼에, seq는 써진 줄에만 빈 번호 없이)
+//     → out_buf(밀린 것) + shard 버퍼들을 writev 한 번
 // ============================
-static void* rule_in_thread(void* arg) {
-    struct CollectorHub* hub = (struct CollectorHub*)arg;
 
-    ensure_fifo(hub->cfg.rulebase_in_fifo_path);
+// tick에 보낼 디바이스 스냅샷 (락 안에서 복사 → 락 밖에서 포맷), 채널 값은 hub->emit_vals의 같은 번호
+typedef struct EmitRec {
+    int slot;
+    DevHandle dev;
+    const char* deviceId;     // dev_intern shm 안 (핸들이 살아있는 동안 안 바뀜)
+    int has_rx;
+    int64_t dev_ts_ms;
+    int64_t skew_ms;
+    int64_t prev_emit_rx_ms;  // out_buf가 차서 버렸을 때 되돌릴 값
+    int ok;                   // 포맷 성공 (포맷한 스레드가 씀)
+} EmitRec;
 
-    // 주의: reader(rulebase)가 아직 없으면 open("w")가 block 될 수 있음
-    FILE* out = fopen(hub->cfg.rulebase_in_fifo_path, "w");
-    if (!out) {
-        perror("fopen rulebase_in");
-        return NULL;
+typedef struct {
+    struct CollectorHub* hub;
+    int n;            // 이번 tick에 모은 레코드 수 (hub->emit_recs)
+    double hi;        // env는 tick마다 한 번
+
+    // 포맷 전에 한 번만 계산 (보낼 디바이스가 있을 때만, localtime 호출 없음)
+    int64_t now_ms;
+    char local_iso[32];
+} EmitCtx;
+
+// 다음 주기 예약 (이전 deadline 기준, 밀렸으면 지금부터)
+static void schedule_next_emit(struct CollectorHub* hub, int slot, uint64_t now_ms) {
+    WatchCache* wc = &hub->watch[slot];
+    uint64_t interval = (uint64_t)hub_cfg(hub)->collect_interval_sec * 1000ULL;
+    wc->next_emit_ms += interval;
+    if (wc->next_emit_ms <= now_ms) wc->next_emit_ms = now_ms + interval;
+    timer_wheel_schedule(hub->emit_wheel, slot, wc->next_emit_ms);
+}
+
+// 흐름 제어: 이번 SENSOR를 보낼지 (새 데이터 없으면 LOW)
+//   COALESCE 이상이면 새 데이터 없는 SENSOR는 다음 주기로 합침, SAMPLE/DROP_LOW는 flow_stage_admit
+static int emit_admit(struct CollectorHub* hub, const WatchCache* wc) {
+    FlowStage* fs = &hub->flow_rule_in;
+    int fresh = wc->rx_ts_ms != wc->emit_rx_ms;
+
+    if (!fresh && flow_stage_level(fs) >= FLOW_COALESCE) {
+        flow_stage_count_coalesced(fs);
+        return 0;
     }
+    return flow_stage_admit(fs, fresh ? FLOW_PRIO_NORMAL : FLOW_PRIO_LOW);
+}
 
-    long seq = 0;
+// 스냅샷 배열을 슬롯 수만큼 (max_devices가 늘었을 때만 다시 잡음, hub->mtx 잡고 호출)
+static int emit_reserve_locked(struct CollectorHub* hub) {
+    if (hub->emit_cap >= hub->watch_cap) return 0;
 
-    while (hub->running) {
-        double nu = now_unix();
-        char local_iso[64];
-        now_local_iso(local_iso, sizeof(local_iso));
+    EmitRec* r = (EmitRec*)realloc(hub->emit_recs, (size_t)hub->watch_cap * sizeof(EmitRec));
+    if (!r) return -1;
+    hub->emit_recs = r;
+    if (chan_store_resize(&hub->emit_vals, hub->watch_cap) != 0) return -1;
+    hub->emit_cap = hub->watch_cap;
+    return 0;
+}
 
-        pthread_mutex_lock(&hub->mtx);
+// emit_wheel 콜백: 디바이스 1개를 스냅샷에 담고 다음 deadline 예약 (hub->mtx 잡힌 상태)
+static void on_device_emit(void* arg, int slot, uint64_t now_ms) {
+    EmitCtx* ec = (EmitCtx*)arg;
+    struct CollectorHub* hub = ec->hub;
+    WatchCache* wc = &hub->watch[slot];
+    if (!wc->used) return;
 
-        int has_env = hub->has_env;
-        double temp = hub->temp;
-        double humi = hub->humi;
+    if (!emit_admit(hub, wc)) {
+        schedule_next_emit(hub, slot, now_ms);
+        return;
+    }
+    if (ec->n >= hub->emit_cap) {
+        // 스냅샷 배열을 못 늘림 (메모리 부족)
+        flow_stage_count_dropped(&hub->flow_rule_in, 1);
+        schedule_next_emit(hub, slot, now_ms);
+        return;
+    }
+
+    int i = ec->n++;
+    EmitRec* r = &hub->emit_recs[i];
+    r->slot = slot;
+    r->dev = wc->dev;
+    r->deviceId = wc->deviceId;
+    r->has_rx = wc->rx_ts_ms != 0;
+    r->dev_ts_ms = wc->dev_ts_ms;
+    r->skew_ms = wc->skew_ms;
+    r->prev_emit_rx_ms = wc->emit_rx_ms;
+    r->ok = 0;
+
+    ChanStore* ev = &hub->emit_vals;
+    uint32_t m = hub->vals.present[slot];
+    ev->present[i] = m;
+    while (m) {
+        int c = __builtin_ctz(m);
+        ev->val[(size_t)c * (size_t)ev->cap + (size_t)i] = chan_store_get(&hub->vals, slot, c);
+        m &= m - 1;
+    }
 
-        for (int i = 0; i < hub->watch_cap; i++) {
-            if (!hub->watch[i].used) continue;
+    wc->emit_rx_ms = wc->rx_ts_ms; // 못 보내면 emit_unsend에서 되돌림
+    schedule_next_emit(hub, slot, now_ms);
+}
+
+// hub_emit 포맷 콜백: 스냅샷 i → SENSOR 1줄 (락 없음, shard 워커 여러 개가 동시에)
+static int format_sensor(void* arg, int i, long seq, char* line, int cap) {
+    const EmitCtx* ec = (const EmitCtx*)arg;
+    struct CollectorHub* hub = ec->hub;
+    EmitRec* r = &hub->emit_recs[i];
+    const ChanStore* ev = &hub->emit_vals;
+
+    cJSON* msg = cJSON_CreateObject();
+    cJSON_AddStringToObject(msg, "type", "SENSOR");
+    cJSON_AddNumberToObject(msg, "seq", (double)seq);
+    cJSON_AddStringToObject(msg, "deviceId", r->deviceId);
+    cJSON_AddNumberToObject(msg, "hi", ec->hi);
+
+    for (int c = 0; c < ev->n_ch; c++) {
+        const char* key = chan_reg_key(hub->chans, c);
+        if (chan_store_has(ev, i, c)) cJSON_AddNumberToObject(msg, key, chan_store_get(ev, i, c));
+        else cJSON_AddNullToObject(msg, key);
+    }
 
-            double hi = has_env ? calc_heat_index(temp, humi) : 0.0;
+    if (r->has_rx) {
+        cJSON_AddNumberToObject(msg, "ts_ms", (double)r->dev_ts_ms);
+        cJSON_AddNumberToObject(msg, "skew_ms", (double)r->skew_ms);
+    } else {
+        cJSON_AddNullToObject(msg, "ts_ms");
+        cJSON_AddNullToObject(msg, "skew_ms");
+    }
 
-            cJSON* msg = cJSON_CreateObject();
-            cJSON_AddStringToObject(msg, "type", "SENSOR");
-            cJSON_AddNumberToObject(msg, "seq", (double)(++seq));
-            cJSON_AddStringToObject(msg, "deviceId", hub->watch[i].deviceId);
-            cJSON_AddNumberToObject(msg, "hi", hi);
+    cJSON_AddNumberToObject(msg, "now_unix", (double)ec->now_ms / 1000.0);
+    cJSON_AddStringToObject(msg, "now_local", ec->local_iso);
 
-            if (hub->watch[i].has_hr) cJSON_AddNumberToObject(msg, "hr", hub->watch[i].hr);
-            else cJSON_AddNullToObject(msg, "hr");
+    // shard 버퍼 끝에 바로 출력 (문자열 할당 없음), 트리는 shard arena에서 줄마다 reset
+    int ok = cJSON_PrintPreallocated(msg, line, cap, 0);
+    cJSON_Delete(msg);
+    r->ok = ok != 0;
+    return ok ? (int)strlen(line) : -1;
+}
 
-            if (hub->watch[i].has_st) cJSON_AddNumberToObject(msg, "st", hub->watch[i].st);
-            else cJSON_AddNullToObject(msg, "st");
+// out_buf가 차서 버린 줄 (이번 tick 뒤쪽 dropped개): 새 데이터로 다시 보내도록 emit_rx_ms 되돌림
+static void emit_unsend(struct CollectorHub* hub, int n, int dropped) {
+    pthread_mutex_lock(&hub->mtx);
+    for (int i = n - 1; i >= 0 && dropped > 0; i--) {
+        const EmitRec* r = &hub->emit_recs[i];
+        if (!r->ok) continue;
+        dropped--;
+        // 그 사이 resize로 옮겨졌거나 해제됐으면 그대로 둠
+        if (r->slot < hub->watch_cap && hub->watch[r->slot].used && hub->watch[r->slot].dev == r->dev) {
+            hub->watch[r->slot].emit_rx_ms = r->prev_emit_rx_ms;
+        }
+    }
+    pthread_mutex_unlock(&hub->mtx);
+}
 
-            cJSON_AddNumberToObject(msg, "now_unix", nu);
-            cJSON_AddStringToObject(msg, "now_local", local_iso);
+static void log_emitted(struct CollectorHub* hub) {
+    struct iovec iov[HUB_EMIT_MAX_WORKERS];
+    int n = hub_emit_iov(hub->emit, iov, HUB_EMIT_MAX_WORKERS);
+    for (int k = 0; k < n; k++) {
+        const char* p = (const char*)iov[k].iov_base;
+        const char* end = p + iov[k].iov_len;
+        while (p < end) {
+            const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (!nl) nl = end;
+            printf("➡️ [HUB][RB_IN] %.*s\n", (int)(nl - p), p);
+            p = nl + 1;
+        }
+    }
+}
 
-            char* line = cJSON_PrintUnformatted(msg);
-            if (line) {
-                fprintf(out, "%s\n", line);
-                fflush(out);
+static uint64_t count_lines(const struct iovec* v, int n) {
+    uint64_t lines = 0;
+    for (int k = 0; k < n; k++) {
+        const char* p = (const char*)v[k].iov_base;
+        for (size_t i = 0; i < v[k].iov_len; i++) lines += (p[i] == '\n');
+    }
+    return lines;
+}
 
-                if (hub->cfg.log_rule_in) {
-                    printf("➡️ [HUB][RB_IN] %s\n", line);
-                }
+// 밀린 out_buf + 이번 tick shard 버퍼들을 writev 한 번으로 rulebase_in FIFO에 (non-blocking)
+// 못 쓴 나머지는 out_buf로: 쓰다 만 줄은 통째로, 그 뒤는 HUB_OUT_BYTES까지 줄 단위, 넘치는 줄은 버림
+// return: 0 (다 썼거나 pipe가 참, *dropped = 이번 tick에서 버린 줄 수),
+//         -1 쓰기 오류 (reader가 닫힘 등 → 전부 버리고 다시 열기, *dropped = 밀린 줄 포함 못 쓴 줄 수)
+// 못 쓴 줄은 항상 번호 붙은 줄들의 끝쪽 → 호출자가 seq를 *dropped만큼 되돌리면 빈 번호 없음
+static int out_write(struct CollectorHub* hub, int fd, uint64_t now, int* dropped) {
+    struct iovec iov[HUB_EMIT_MAX_WORKERS + 1];
+    int n = 0;
+    int backlog = hub->out_len > 0;
+    *dropped = 0;
+
+    if (backlog) {
+        iov[n].iov_base = hub->out_buf;
+        iov[n].iov_len = hub->out_len;
+        n++;
+    }
+    n += hub_emit_iov(hub->emit, iov + n, HUB_EMIT_MAX_WORKERS);
+    if (n == 0) return 0;
+
+    struct iovec* v = iov;
+    int vn = n;
+    size_t done = 0;
+    int rc = 0;
+    while (vn > 0) {
+        ssize_t w = writev(fd, v, vn);
+        if (w > 0) {
+            done += (size_t)w;
+            size_t left = (size_t)w;
+            while (vn > 0 && left >= v->iov_len) {
+                left -= v->iov_len;
+                v++;
+                vn--;
+            }
+            if (vn > 0) {
+                v->iov_base = (char*)v->iov_base + left;
+                v->iov_len -= left;
+            }
+            continue;
+        }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && errno != EAGAIN) {
+            perror("writev rulebase_in");
+            rc = -1;
+        }
+        break;
+    }
+
+    if (rc != 0) {
+        // 쓰다 만 줄도 '\n'이 안 나갔으니 못 쓴 줄로 셈 (새 reader는 그 번호부터 받음)
+        *dropped = (int)count_lines(v, vn);
+        hub->out_len = 0;
+        return -1;
+    }
+    if (vn == 0) {
+        hub->out_len = 0;
+        return 0;
+    }
 
-                free(line);
+    // lag = rulebase가 진행 없이 멈춰 있던 시간 (비어 있다가 쌓이기 시작했거나 일부라도 써졌으면 지금부터)
+    if (!backlog || done > 0) hub->out_oldest_ms = now;
+
+    size_t len = 0;
+    int k = 0;
+    if (backlog && v == iov) {
+        // 밀린 것의 나머지 (줄 중간에서 끊겼어도 앞으로 당겨서 이어 씀)
+        memmove(hub->out_buf, v->iov_base, v->iov_len);
+        len = v->iov_len;
+        k = 1;
+    }
+    int full = 0;
+    for (; k < vn; k++) {
+        const char* p = (const char*)v[k].iov_base;
+        size_t left = v[k].iov_len;
+        while (left > 0) {
+            const char* nl = (const char*)memchr(p, '\n', left);
+            size_t l = nl ? (size_t)(nl - p) + 1 : left;
+            // rulebase가 못 따라와서 대기 버퍼까지 참 (쓰다 만 줄은 out_buf가 비어 있을 때라 항상 들어감)
+            if (!full && len + l <= HUB_OUT_BYTES) {
+                memcpy(hub->out_buf + len, p, l);
+                len += l;
+            } else {
+                full = 1;
+                (*dropped)++;
             }
-            cJSON_Delete(msg);
+            p += l;
+            left -= l;
         }
+    }
+    hub->out_len = len;
+    return 0;
+}
 
+// rulebase 쪽 대기량 = pipe에 아직 안 읽힌 바이트 + out_buf
+static void out_flow_update(struct CollectorHub* hub, int fd, int pipe_cap, uint64_t now) {
+    int in_pipe = 0;
+    if (ioctl(fd, FIONREAD, &in_pipe) != 0) in_pipe = 0;
+
+    int64_t lag = hub->out_len ? (int64_t)(now - hub->out_oldest_ms) : 0;
+    flow_stage_update(&hub->flow_rule_in, in_pipe + (int)hub->out_len,
+                      (pipe_cap > 0 ? pipe_cap : 0) + HUB_OUT_BYTES, lag, now);
+}
+
+// rulebase_in 열기 (non-blocking, reader가 없으면 재시도 timer → 그동안 tick은 emit만 건너뜀)
+// return: fd, -1 아직 없음 / 재시도 차례 아님
+static int out_open(struct CollectorHub* hub, char* path, size_t path_sz, const char* want, int* pipe_cap,
+                    uint64_t now) {
+    if (!hub_life_due(&hub->life, hub->ep_rule_in, now)) return -1;
+
+    snprintf(path, path_sz, "%s", want);
+    int fd = fifo_open_writer(path);
+    if (fd < 0) {
+        hub_life_fail(&hub->life, hub->ep_rule_in, errno, now, "[HUB][RB_IN]");
+        return -1;
+    }
+    *pipe_cap = fcntl(fd, F_GETPIPE_SZ);
+    hub_life_up(&hub->life, hub->ep_rule_in, now);
+    return fd;
+}
+
+// reload_file_path가 바뀌었거나 reload 요청이 있으면 다시 읽어서 reconfigure (rule_in 스레드, 락 없이)
+static void check_reload(struct CollectorHub* hub, const CollectorHubConfig* cfg) {
+    int req = atomic_exchange(&hub->reload_req, 0);
+    if (!cfg->reload_file_path) {
+        if (req) fprintf(stderr, "⚠️ [HUB][CONF] reload requested but reload_file_path not set\n");
+        return;
+    }
+
+    struct stat st;
+    if (stat(cfg->reload_file_path, &st) != 0) return;
+    if (!req && st.st_mtime == hub->reload_mtime) return;
+    hub->reload_mtime = st.st_mtime;
+
+    collector_hub_reload_file(hub, cfg->reload_file_path);
+}
+
+static void* rule_in_thread(void* arg) {
+    struct CollectorHub* hub = (struct CollectorHub*)arg;
+    const CollectorHubConfig* cfg = conf_enter(hub, HUB_T_RULE_IN);
+    thread_place_apply(&cfg->place_rule_in, "hub-rule-in");
+    mem_arena_bind(&hub->arena_rule_in);
+
+    // reader(rulebase)가 사라진 뒤의 write는 SIGPIPE 대신 EPIPE로 (이 스레드에서 block, pending으로 남음)
+    sigset_t pipe_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, NULL);
+
+    // reader가 아직 없어도 여기서 안 멈춤 (out_open이 tick마다 재시도 차례인지 봄)
+    char path[256] = "";
+    int pipe_cap = 0;
+    int out_fd = -1;
+
+    long seq = 0;
+    uint64_t next_reload_check = 0;
+    uint64_t ticks = 0;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!hub_life_stopping(&hub->life)) {
+        cfg = conf_enter(hub, HUB_T_RULE_IN);
+
+        uint64_t now = now_mono_ms();
+
+        // 설정 파일 확인은 1초에 한 번
+        if (now >= next_reload_check) {
+            check_reload(hub, cfg);
+            cfg = conf_enter(hub, HUB_T_RULE_IN);
+            next_reload_check = now + 1000;
+        }
+
+        if (out_fd >= 0 && strcmp(path, cfg->rulebase_in_fifo_path) != 0) {
+            printf("🔁 [HUB] FIFO %s → %s\n", path, cfg->rulebase_in_fifo_path);
+            close(out_fd);
+            out_fd = -1;
+        }
+        if (out_fd < 0) out_fd = out_open(hub, path, sizeof(path), cfg->rulebase_in_fifo_path, &pipe_cap, now);
+
+        uint64_t t_tick = now_mono_us();
+        EmitCtx ec;
+        memset(&ec, 0, sizeof(ec));
+        ec.hub = hub;
+        mem_arena_reset(&hub->arena_rule_in);
+        if (++ticks == HUB_WARM_TICKS) mem_pool_mark_warm();
+
+        // 샤드 그룹: TH 폴링하는 허브의 env를 tick마다 한 번 복사 (src 락 → 자기 락 순서, 겹쳐 잡지 않음)
+        int src_has_env = 0;
+        double src_temp = 0, src_humi = 0;
+        if (hub->env_src) {
+            pthread_mutex_lock(&hub->env_src->mtx);
+            src_has_env = hub->env_src->has_env;
+            src_temp = hub->env_src->temp;
+            src_humi = hub->env_src->humi;
+            pthread_mutex_unlock(&hub->env_src->mtx);
+        }
+
+        pthread_mutex_lock(&hub->mtx);
+        if (hub->env_src && (src_has_env != hub->has_env || src_temp != hub->temp || src_humi != hub->humi)) {
+            hub->has_env = src_has_env;
+            hub->temp = src_temp;
+            hub->humi = src_humi;
+            hub->env_ts_ms = ts_now_ms();
+            hub->env_dirty = 1;
+            live_env_locked(hub);
+        }
+        // 만료 먼저 (해제된 디바이스는 emit 안 함) → deadline 된 디바이스만 스냅샷
+        // rulebase가 아직 없으면 emit deadline은 그대로 두고 (붙으면 밀린 것부터) 만료 / checkpoint만
+        timer_wheel_advance(hub->stale_wheel, now, on_device_stale, hub);
+        if (out_fd >= 0) {
+            if (emit_reserve_locked(hub) != 0) fprintf(stderr, "⚠️ [HUB][EMIT] snapshot resize failed\n");
+            ec.hi = hub->has_env ? calc_heat_index(hub->temp, hub->humi) : 0.0;
+            timer_wheel_advance(hub->emit_wheel, now, on_device_emit, &ec);
+        }
+        if (hub->snap && now >= hub->next_ckpt_ms) {
+            checkpoint_locked(hub);
+            hub->next_ckpt_ms = now + (uint64_t)cfg->state_checkpoint_ms;
+        }
         pthread_mutex_unlock(&hub->mtx);
 
-        sleep(hub->cfg.collect_interval_sec);
+        // SENSOR 포맷 / FIFO write는 락 밖에서 (rulebase가 느려도 watch 입력은 계속)
+        int failed = 0, dropped = 0;
+        if (ec.n) {
+            ec.now_ms = ts_now_ms();
+            ts_format_local_iso(ec.now_ms, ec.local_iso, sizeof(ec.local_iso));
+        }
+        int lines = hub_emit_run(hub->emit, ec.n, cfg->emit_parallel_min, seq, format_sensor, &ec, &failed);
+        hub->line_overflow += (uint64_t)failed;
+        if (ec.n && cfg->log_rule_in) log_emitted(hub);
+
+        int wrc = out_fd >= 0 ? out_write(hub, out_fd, now, &dropped) : 0;
+        if (dropped) {
+            flow_stage_count_dropped(&hub->flow_rule_in, (uint64_t)dropped);
+            if (wrc == 0) flow_stage_on_full(&hub->flow_rule_in, now);
+            // 쓰기 오류면 밀린 줄까지 포함 → 이번 tick 디바이스는 전부 되돌림 (이전 tick 것은 다음 데이터 때)
+            emit_unsend(hub, ec.n, dropped);
+        }
+        // 써진 줄은 seq + 1 .. seq + lines (포맷 실패는 번호 없음), 버린 줄은 그 끝쪽 dropped개
+        // (쓰기 오류면 out_buf에 밀려 있던 이전 tick 줄도) → 다음 tick은 처음 버린 줄의 seq부터 다시 씀 (빈 번호 없음)
+        seq += lines - dropped;
+        if (ec.n) hub_emit_record_tick(hub->emit, ec.n, now_mono_us() - t_tick);
+
+        if (wrc != 0) {
+            // reader가 사라짐: 쌓인 줄은 버리고 (seq / emit은 위에서 되돌림) 재시도 timer로 다시 열기
+            close(out_fd);
+            out_fd = -1;
+            hub_life_fail(&hub->life, hub->ep_rule_in, EPIPE, now, "[HUB][RB_IN]");
+        } else if (out_fd >= 0) {
+            out_flow_update(hub, out_fd, pipe_cap, now);
+        }
+
+        // 아카이브: 오래된 chunk 닫기 / 파일 write / rotate (자기 락, hub->mtx 밖)
+        if (hub->archive) hub_archive_tick(hub->archive, ts_now_ms());
+
+        // 다른 스레드가 지나간 예전 설정 정리
+        if (hub->retired && pthread_mutex_trylock(&hub->conf_mtx) == 0) {
+            conf_reclaim(hub);
+            pthread_mutex_unlock(&hub->conf_mtx);
+        }
+
+        // 고정 tick (deadline 기준, drift 없음), 정지 요청이면 바로 깨어남
+        next.tv_nsec += HUB_TICK_MS * 1000000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec += 1;
+            next.tv_nsec -= 1000000000L;
+        }
+        if (hub_life_wait_until(&hub->life, &next)) break;
+        tick_jitter_record(&hub->tick_jitter, &next);
     }
 
-    fclose(out);
+    if (out_fd >= 0) close(out_fd);
+    mem_arena_bind(NULL);
+    conf_offline(hub, HUB_T_RULE_IN);
     return NULL;
 }
 
 // ============================
 // 스레드 4) rulebase_out reader
-//   - RESULT 라인을 콜백으로 넘김
+//   - RESULT 라인을 구독자들에게 fan-out (hub_result)
 // ============================
+static const char* rule_out_fifo_of(const CollectorHubConfig* cfg) {
+    return cfg->rulebase_out_fifo_path;
+}
+
+static void rule_out_on_line(struct CollectorHub* hub, char* line) {
+    if (hub_cfg(hub)->log_rule_out) {
+        printf("⬅️ [HUB][RB_OUT] %s", line);
+    }
+
+    // 파싱 1번 + 구독자 큐에 넣기만 (콜백은 구독자 워커 스레드에서)
+    hub_result_publish_line(hub->results, line);
+}
+
 static void* rule_out_thread(void* arg) {
     struct CollectorHub* hub = (struct CollectorHub*)arg;
+    const CollectorHubConfig* cfg = conf_enter(hub, HUB_T_RULE_OUT);
+    thread_place_apply(&cfg->place_rule_out, "hub-rule-out");
 
-    ensure_fifo(hub->cfg.rulebase_out_fifo_path);
+    fifo_line_loop(hub, HUB_T_RULE_OUT, hub->ep_rule_out, rule_out_fifo_of, rule_out_on_line, 8192, NULL,
+                   "[HUB][RB_OUT]");
 
-    FILE* in = fopen(hub->cfg.rulebase_out_fifo_path, "r");
-    if (!in) {
-        perror("fopen rulebase_out");
-        return NULL;
-    }
+    conf_offline(hub, HUB_T_RULE_OUT);
+    return NULL;
+}
 
-    char line[8192];
+// ============================
+// 내부: 실행 중 테이블 크기 / 주기 변경 (hub->mtx 잡고 호출)
+// ============================
+// 슬롯 from → to 이동 (타이머 deadline 유지)
+static void move_slot_locked(struct CollectorHub* hub, const CollectorHubConfig* cfg, int from, int to) {
+    int emit_pending = timer_wheel_pending(hub->emit_wheel, from);
+    timer_wheel_cancel(hub->stale_wheel, from);
+    timer_wheel_cancel(hub->emit_wheel, from);
+
+    hub->watch[to] = hub->watch[from];
+    memset(&hub->watch[from], 0, sizeof(WatchCache));
+    chan_store_move(&hub->vals, from, to);
+    hub->slot_of[hub->watch[to].dev] = to;
+
+    const WatchCache* wc = &hub->watch[to];
+    timer_wheel_schedule(hub->stale_wheel, to,
+                         wc->last_seen_ms + (uint64_t)cfg->device_stale_sec * 1000ULL);
+    if (emit_pending) timer_wheel_schedule(hub->emit_wheel, to, wc->next_emit_ms);
+}
 
-    while (hub->running) {
-        if (!fgets(line, sizeof(line), in)) {
-            if (feof(in)) {
-                fclose(in);
-                in = fopen(hub->cfg.rulebase_out_fifo_path, "r");
-                if (!in) { perror("reopen rulebase_out"); sleep(1); continue; }
+static void free_slot_locked(struct CollectorHub* hub, int slot) {
+    timer_wheel_cancel(hub->stale_wheel, slot);
+    timer_wheel_cancel(hub->emit_wheel, slot);
+    hub->slot_of[hub->watch[slot].dev] = -1;
+    if (hub->live) hub_live_remove(hub->live, hub->watch[slot].dev);
+    dev_intern_unref(hub->ids, hub->watch[slot].dev);
+    chan_store_clear(&hub->vals, slot);
+    memset(&hub->watch[slot], 0, sizeof(WatchCache));
+}
+
+// 디바이스 테이블 크기 변경 (줄일 때: 넘치면 오래된 디바이스부터 버리고, 뒤쪽 슬롯을 앞으로 당김)
+static int resize_table_locked(struct CollectorHub* hub, const CollectorHubConfig* cfg, int cap) {
+    int old = hub->watch_cap;
+    if (cap == old) return 0;
+
+    if (cap > old) {
+        if (timer_wheel_resize(hub->stale_wheel, cap) != 0 ||
+            timer_wheel_resize(hub->emit_wheel, cap) != 0 ||
+            chan_store_resize(&hub->vals, cap) != 0) return -1;
+
+        WatchCache* w = (WatchCache*)realloc(hub->watch, (size_t)cap * sizeof(WatchCache));
+        if (!w) return -1;
+        memset(w + old, 0, (size_t)(cap - old) * sizeof(WatchCache));
+        hub->watch = w;
+
+        if (hub->dirty) {
+            unsigned char* d = (unsigned char*)realloc(hub->dirty, (size_t)cap);
+            if (!d) return -1;
+            memset(d + old, 0, (size_t)(cap - old));
+            hub->dirty = d;
+        }
+        hub->watch_cap = cap;
+    } else {
+        int used = 0;
+        for (int i = 0; i < old; i++) used += hub->watch[i].used ? 1 : 0;
+
+        int evicted = 0;
+        while (used > cap) {
+            int victim = -1;
+            for (int i = 0; i < old; i++) {
+                if (!hub->watch[i].used) continue;
+                if (victim < 0 || hub->watch[i].last_seen_ms < hub->watch[victim].last_seen_ms) victim = i;
             }
-            continue;
+            free_slot_locked(hub, victim);
+            used--;
+            evicted++;
         }
 
-        if (hub->cfg.log_rule_out) {
-            printf("⬅️ [HUB][RB_OUT] %s", line);
+        int free_i = 0;
+        for (int j = cap; j < old; j++) {
+            if (!hub->watch[j].used) continue;
+            while (hub->watch[free_i].used) free_i++;
+            move_slot_locked(hub, cfg, j, free_i);
         }
 
-        if (hub->cb) {
-            hub->cb(line, hub->cb_ctx);
+        timer_wheel_resize(hub->stale_wheel, cap);
+        timer_wheel_resize(hub->emit_wheel, cap);
+        chan_store_resize(&hub->vals, cap); // 실패하면 큰 배열 그대로 (cap은 store 안에 따로 있음)
+
+        // 줄이는 realloc은 실패해도 기존 버퍼 그대로 쓰면 됨
+        WatchCache* w = (WatchCache*)realloc(hub->watch, (size_t)cap * sizeof(WatchCache));
+        if (w) hub->watch = w;
+        hub->watch_cap = cap;
+
+        if (evicted > 0) {
+            printf("⚠️ [HUB][CONF] max_devices %d → %d: %d oldest devices evicted\n", old, cap, evicted);
         }
     }
 
-    fclose(in);
-    return NULL;
+    // 상태 파일도 새 크기로, 슬롯 번호가 바뀌었으니 전부 다시 씀
+    if (hub->snap) {
+        hub_snapshot_close(hub->snap);
+        hub->snap = hub_snapshot_open(cfg->state_file_path, cap);
+        memset(hub->dirty, 1, (size_t)cap);
+        hub->dirty_count = cap;
+        checkpoint_locked(hub);
+    }
+    return 0;
+}
+
+// 만료 시간 / 전송 주기가 바뀌면 대기 중인 deadline 다시 계산
+static void retime_locked(struct CollectorHub* hub, const CollectorHubConfig* cfg, uint64_t now) {
+    uint64_t stale = (uint64_t)cfg->device_stale_sec * 1000ULL;
+    uint64_t interval = (uint64_t)cfg->collect_interval_sec * 1000ULL;
+
+    for (int i = 0; i < hub->watch_cap; i++) {
+        WatchCache* wc = &hub->watch[i];
+        if (!wc->used) continue;
+
+        timer_wheel_schedule(hub->stale_wheel, i, wc->last_seen_ms + stale);
+
+        // 주기가 짧아졌으면 다음 전송을 당김 (길어진 건 다음 emit부터 적용)
+        if (timer_wheel_pending(hub->emit_wheel, i) && wc->next_emit_ms > now + interval) {
+            wc->next_emit_ms = now + interval;
+            timer_wheel_schedule(hub->emit_wheel, i, wc->next_emit_ms);
+        }
+    }
 }
 
 // ============================
 // 외부 API
 // ============================
+static void legacy_result_handler(const HubResult* r, void* ctx) {
+    struct CollectorHub* hub = (struct CollectorHub*)ctx;
+    hub->cb(r->line, hub->cb_ctx);
+}
+
 CollectorHub* collector_hub_create(const CollectorHubConfig* cfg,
                                    CollectorHubResultCallback cb,
                                    void* cb_ctx) {
@@ -349,71 +1621,448 @@ CollectorHub* collector_hub_create(const CollectorHubConfig* cfg,
     struct CollectorHub* hub = (struct CollectorHub*)calloc(1, sizeof(struct CollectorHub));
     if (!hub) return NULL;
 
-    hub->cfg = *cfg;
+    // 문자열 복사 + defaults
+    HubConf* conf = conf_build(cfg, 1);
+    if (!conf) {
+        free(hub);
+        return NULL;
+    }
+    atomic_init(&hub->conf, conf);
+    for (int t = 0; t < HUB_T_COUNT; t++) atomic_init(&hub->qs_gen[t], HUB_QS_OFFLINE);
+    atomic_init(&hub->ext_readers, 0);
+    atomic_init(&hub->reload_req, 0);
+    pthread_mutex_init(&hub->conf_mtx, NULL);
+
     hub->cb = cb;
     hub->cb_ctx = cb_ctx;
 
     hub->running = 0;
     pthread_mutex_init(&hub->mtx, NULL);
-
-    // defaults
-    if (!hub->cfg.watch_fifo_path) hub->cfg.watch_fifo_path = "/tmp/th_fifo";
-    if (!hub->cfg.rulebase_in_fifo_path) hub->cfg.rulebase_in_fifo_path = "/tmp/rulebase_in.fifo";
-    if (!hub->cfg.rulebase_out_fifo_path) hub->cfg.rulebase_out_fifo_path = "/tmp/rulebase_out.fifo";
-
-    if (!hub->cfg.th_ip) hub->cfg.th_ip = "192.168.0.20";
-    if (hub->cfg.th_port <= 0) hub->cfg.th_port = 8887;
-
-    if (hub->cfg.collect_interval_sec <= 0) hub->cfg.collect_interval_sec = 5;
-    if (hub->cfg.max_devices <= 0) hub->cfg.max_devices = 64;
-
-    hub->watch_cap = hub->cfg.max_devices;
+    pthread_mutex_init(&hub->th_mtx, NULL);
+    int life_ok = hub_life_init(&hub->life) == 0;
+
+    // cJSON은 스레드별 arena에서 (시작할 때 한 번 잡고 이후 reset만)
+    mem_pool_install_cjson_hooks();
+    int arena_ok = mem_arena_init(&hub->arena_watch, HUB_ARENA_BYTES) == 0 &&
+                   mem_arena_init(&hub->arena_rule_in, HUB_ARENA_BYTES) == 0;
+
+    // 흐름 제어 (rule_in lag 기본값만 허브가 정함)
+    FlowConfig fc = conf->cfg.flow_rule_in;
+    if (fc.lag_high_ms <= 0) fc.lag_high_ms = HUB_FLOW_LAG_MS;
+    flow_stage_init(&hub->flow_rule_in, "hub.rule_in", &fc);
+    flow_stage_init(&hub->flow_ingest, "hub.ingest", &conf->cfg.flow_ingest);
+    hub->out_buf = (char*)malloc(HUB_OUT_BYTES);
+    hub->results = hub_result_bus_create();
+
+    hub->ids = dev_intern_open(conf->cfg.dev_intern_name, conf->cfg.dev_intern_capacity);
+    int n_handles = hub->ids ? dev_intern_capacity(hub->ids) + 1 : 0;
+    hub->slot_of = n_handles ? (int*)malloc((size_t)n_handles * sizeof(int)) : NULL;
+    if (hub->slot_of) memset(hub->slot_of, 0xff, (size_t)n_handles * sizeof(int));
+
+    hub->watch_cap = conf->cfg.max_devices;
     hub->watch = (WatchCache*)calloc((size_t)hub->watch_cap, sizeof(WatchCache));
-    if (!hub->watch) {
+    hub->chans = chan_reg_create(conf->cfg.channels);
+    // 워치 모듈과 채널 번호가 다르면 값이 엉뚱한 채널로 들어감 → 시작 안 함
+    int spec_ok = hub->ids && hub->chans && dev_intern_bind_spec(hub->ids, chan_reg_spec_hash(hub->chans)) == 0;
+    int vals_ok = hub->chans && chan_store_init(&hub->vals, chan_reg_count(hub->chans), hub->watch_cap) == 0;
+    hub->stale_wheel = timer_wheel_create(hub->watch_cap, HUB_TICK_MS, now_mono_ms());
+    hub->emit_wheel = timer_wheel_create(hub->watch_cap, HUB_TICK_MS, now_mono_ms());
+    hub->emit = hub_emit_create(conf->cfg.emit_workers, HUB_LINE_MAX, HUB_ARENA_BYTES);
+    int emit_ok = hub->emit && vals_ok && chan_store_init(&hub->emit_vals, hub->vals.n_ch, hub->watch_cap) == 0;
+    hub->emit_recs = (struct EmitRec*)malloc((size_t)hub->watch_cap * sizeof(struct EmitRec));
+    if (hub->emit_recs) hub->emit_cap = hub->watch_cap;
+    if (!arena_ok || !life_ok || !spec_ok || !hub->out_buf || !hub->results || !hub->slot_of || !hub->watch || !vals_ok ||
+        !hub->stale_wheel || !hub->emit_wheel || !emit_ok || !hub->emit_recs) {
+        if (life_ok) hub_life_destroy(&hub->life);
+        hub_result_bus_destroy(hub->results);
+        hub_emit_destroy(hub->emit);
+        free(hub->emit_recs);
+        chan_store_free(&hub->emit_vals);
+        chan_store_free(&hub->vals);
+        chan_reg_destroy(hub->chans);
+        dev_intern_close(hub->ids);
+        free(hub->slot_of);
+        free(hub->out_buf);
+        mem_arena_destroy(&hub->arena_watch);
+        mem_arena_destroy(&hub->arena_rule_in);
+        timer_wheel_destroy(hub->stale_wheel);
+        timer_wheel_destroy(hub->emit_wheel);
+        free(hub->watch);
         pthread_mutex_destroy(&hub->mtx);
+        pthread_mutex_destroy(&hub->th_mtx);
+        pthread_mutex_destroy(&hub->conf_mtx);
+        free(conf);
         free(hub);
         return NULL;
     }
 
+    // 준비 상태를 볼 endpoint (th_disabled / watch_* 는 재시작해야 바뀜)
+    hub->ep_th = conf->cfg.th_disabled ? -1 : hub_life_add(&hub->life, "th");
+    hub->ep_watch = conf->cfg.watch_ingest_external ? -1
+                    : hub_life_add(&hub->life, conf->cfg.watch_mq_name ? "watch_mq" : "watch_fifo");
+    hub->ep_rule_in = hub_life_add(&hub->life, "rb_in");
+    hub->ep_rule_out = hub_life_add(&hub->life, "rb_out");
+
+    // 예전 콜백 = 필터 없는 구독 1개 (워커에서 호출, 예전 동기 콜백처럼 라인을 버리지 않음 → 꽉 차면 리더가 기다림)
+    if (cb) {
+        HubSubscribeOptions so;
+        memset(&so, 0, sizeof(so));
+        so.min_level = HUB_LEVEL_UNKNOWN;
+        so.block_when_full = 1;
+        so.name = "callback";
+        if (hub_result_subscribe(hub->results, legacy_result_handler, hub, &so) < 0) {
+            fprintf(stderr, "❌ [HUB][RESULT] callback subscribe failed\n");
+        }
+    }
+
+    // 조회 서버는 start에서, live 테이블은 warm restart 값도 담게 먼저 (핸들 번호 자리)
+    if (conf->cfg.query_socket_path) {
+        hub->live = hub_live_create(n_handles, hub->vals.n_ch);
+        if (!hub->live) fprintf(stderr, "⚠️ [HUB][QUERY] live table alloc failed → query disabled\n");
+    }
+
+    if (conf->cfg.state_file_path) {
+        hub->dirty = (unsigned char*)calloc((size_t)hub->watch_cap, 1);
+        if (hub->dirty) warm_restart(hub);
+    }
+
+    if (conf->cfg.archive_dir) {
+        HubArchiveConfig ac;
+        memset(&ac, 0, sizeof(ac));
+        ac.dir = conf->cfg.archive_dir;
+        ac.rotate_sec = conf->cfg.archive_rotate_sec;
+        ac.keep_sec = conf->cfg.archive_keep_sec;
+        ac.flush_sec = conf->cfg.archive_flush_sec;
+        hub->archive = hub_archive_open(&ac);
+        if (!hub->archive) fprintf(stderr, "⚠️ [HUB][ARCHIVE] disabled (%s)\n", ac.dir);
+    }
+
+    // 시작 시점 mtime 기억 (파일이 바뀔 때만 reload)
+    struct stat st;
+    if (conf->cfg.reload_file_path && stat(conf->cfg.reload_file_path, &st) == 0) {
+        hub->reload_mtime = st.st_mtime;
+    }
+
     return hub;
 }
 
+// TH 스레드 join: 대기 중이면 정지 eventfd로 바로 끝남, modbus connect / 응답 대기 중이면 소켓 shutdown으로 깨움
+// (소켓이 막 만들어지는 틈이면 shutdown이 빗나가므로 HUB_STOP_TH_MS마다 다시), return: abort 했으면 1
+static int th_join(struct CollectorHub* hub) {
+    int aborted = 0;
+    for (;;) {
+        struct timespec dl;
+        clock_gettime(CLOCK_REALTIME, &dl);
+        dl.tv_nsec += HUB_STOP_TH_MS * 1000000L;
+        if (dl.tv_nsec >= 1000000000L) {
+            dl.tv_sec += 1;
+            dl.tv_nsec -= 1000000000L;
+        }
+        if (pthread_timedjoin_np(hub->t_th, NULL, &dl) == 0) break;
+        th_abort(hub);
+        aborted = 1;
+    }
+    return aborted;
+}
+
+// start 도중 스레드 생성 실패: 만든 스레드만 정지 / join (나가면서 자기 qs 자리를 offline으로),
+// 못 만든 스레드 자리는 여기서 offline → retired 설정 해제가 없는 스레드를 기다리지 않게
+static int start_rollback(struct CollectorHub* hub, const int* started, int rc) {
+    fprintf(stderr, "❌ [HUB] thread create failed (%d) → stopping started threads\n", rc);
+    hub_life_request_stop(&hub->life);
+    if (started[HUB_T_WATCH]) pthread_join(hub->t_watch, NULL);
+    if (started[HUB_T_RULE_IN]) pthread_join(hub->t_rule_in, NULL);
+    if (started[HUB_T_RULE_OUT]) pthread_join(hub->t_rule_out, NULL);
+    if (started[HUB_T_TH]) hub->th_aborts += (uint64_t)th_join(hub);
+    for (int t = 0; t < HUB_T_COUNT; t++) {
+        if (!started[t]) conf_offline(hub, t);
+    }
+    hub_life_disarm(&hub->life);
+    hub->running = 0;
+    return rc;
+}
+
 int collector_hub_start(CollectorHub* hub) {
     if (!hub) return -1;
     if (hub->running) return 0;
 
+    const CollectorHubConfig* cfg = hub_cfg(hub);
+
     // FIFO 준비 (경로는 "허브 설정에서" 결정)
-    ensure_fifo(hub->cfg.watch_fifo_path);
-    ensure_fifo(hub->cfg.rulebase_in_fifo_path);
-    ensure_fifo(hub->cfg.rulebase_out_fifo_path);
+    if (!cfg->watch_ingest_external && !cfg->watch_mq_name) ensure_fifo(cfg->watch_fifo_path);
+    ensure_fifo(cfg->rulebase_in_fifo_path);
+    ensure_fifo(cfg->rulebase_out_fifo_path);
 
     hub->running = 1;
-
-    // 스레드 시작
-    if (pthread_create(&hub->t_th, NULL, th_thread, hub) != 0) return -2;
-    if (pthread_create(&hub->t_watch, NULL, watch_thread, hub) != 0) return -3;
-    if (pthread_create(&hub->t_rule_in, NULL, rule_in_thread, hub) != 0) return -4;
-    if (pthread_create(&hub->t_rule_out, NULL, rule_out_thread, hub) != 0) return -5;
+    hub_life_arm(&hub->life);
+
+    // 스레드가 첫 conf_enter 하기 전에 retired 해제가 일어나지 않도록 미리 online
+    uint64_t gen = atomic_load(&hub->conf)->gen;
+    if (!cfg->th_disabled) atomic_store(&hub->qs_gen[HUB_T_TH], gen);
+    if (!cfg->watch_ingest_external) atomic_store(&hub->qs_gen[HUB_T_WATCH], gen);
+    atomic_store(&hub->qs_gen[HUB_T_RULE_IN], gen);
+    atomic_store(&hub->qs_gen[HUB_T_RULE_OUT], gen);
+
+    // 스레드 시작 (TH / watch 리더는 설정에 따라 생략), 하나라도 실패하면 만든 것까지 되돌림
+    int started[HUB_T_COUNT] = { 0 };
+    if (!cfg->th_disabled) {
+        if (pthread_create(&hub->t_th, NULL, th_thread, hub) != 0) return start_rollback(hub, started, -2);
+        started[HUB_T_TH] = 1;
+    }
+    if (!cfg->watch_ingest_external) {
+        if (pthread_create(&hub->t_watch, NULL, watch_thread, hub) != 0) return start_rollback(hub, started, -3);
+        started[HUB_T_WATCH] = 1;
+    }
+    if (pthread_create(&hub->t_rule_in, NULL, rule_in_thread, hub) != 0) return start_rollback(hub, started, -4);
+    started[HUB_T_RULE_IN] = 1;
+    if (pthread_create(&hub->t_rule_out, NULL, rule_out_thread, hub) != 0) return start_rollback(hub, started, -5);
+
+    // 조회 서버는 실패해도 허브는 계속 (경로 문제 등)
+    if (hub->live) {
+        hub->query = hub_query_start(cfg->query_socket_path, hub->live, hub->ids, hub->chans);
+        if (!hub->query) fprintf(stderr, "⚠️ [HUB][QUERY] %s start failed\n", cfg->query_socket_path);
+    }
 
     return 0;
 }
 
+void collector_hub_request_stop(CollectorHub* hub) {
+    if (hub) hub_life_request_stop(&hub->life);
+}
+
 void collector_hub_stop(CollectorHub* hub) {
     if (!hub || !hub->running) return;
+    uint64_t t0 = now_mono_us();
+    hub_life_request_stop(&hub->life);
     hub->running = 0;
 
-    // 스레드 종료 대기
-    pthread_join(hub->t_th, NULL);
-    pthread_join(hub->t_watch, NULL);
+    // 스레드 종료 대기 (th_disabled / watch_ingest_external은 reconfigure로 안 바뀜)
+    // 대기는 전부 정지 eventfd로 깨어나므로 바로 끝남, TH만 modbus 통신 중일 수 있음 → 아래에서 abort
+    const CollectorHubConfig* cfg = hub_cfg(hub);
+    if (!cfg->watch_ingest_external) pthread_join(hub->t_watch, NULL);
     pthread_join(hub->t_rule_in, NULL);
     pthread_join(hub->t_rule_out, NULL);
+    if (hub->query) {
+        hub_query_print_stats(hub->query, "[HUB][QUERY]");
+        hub_query_stop(hub->query);
+        hub->query = NULL;
+    }
+    if (!cfg->th_disabled) hub->th_aborts += (uint64_t)th_join(hub);
+    uint64_t stop_us = now_mono_us() - t0;
+
+    hub_life_print(&hub->life, "[HUB][LIFE]");
+    hub_life_disarm(&hub->life);
+    printf("🛑 [HUB] stopped in %llu.%03llu ms (TH modbus aborted %llu)\n", (unsigned long long)(stop_us / 1000),
+           (unsigned long long)(stop_us % 1000), (unsigned long long)hub->th_aborts);
+
+    tick_jitter_print(&hub->tick_jitter, "[HUB][TICK]");
+    if (hub->watch_lat.n) tick_jitter_print(&hub->watch_lat, "[HUB][WATCH] mq rx→hub");
+    hub_emit_print_stats(hub->emit, "[HUB][EMIT]");
+    printf("🧮 [HUB][MEM] arena high watch=%zu rule_in=%zu / %d, overflow=%llu/%llu, line_overflow=%llu\n",
+           hub->arena_watch.high_water, hub->arena_rule_in.high_water, HUB_ARENA_BYTES,
+           (unsigned long long)hub->arena_watch.overflow, (unsigned long long)hub->arena_rule_in.overflow,
+           (unsigned long long)hub->line_overflow);
+#ifdef MEM_POOL_DEBUG
+    printf("🧮 [HUB][MEM] mallocs after warm-up (%d ticks): %llu\n", HUB_WARM_TICKS,
+           (unsigned long long)mem_pool_mallocs_since_warm());
+#endif
+    if (!cfg->watch_ingest_external) flow_stage_print(&hub->flow_ingest);
+    flow_stage_print(&hub->flow_rule_in);
+    hub_result_bus_print(hub->results, "[HUB][RESULT]");
+    if (hub->archive) hub_archive_print_stats(hub->archive, "[HUB][ARCHIVE]");
 }
 
 void collector_hub_destroy(CollectorHub* hub) {
     if (!hub) return;
     if (hub->running) collector_hub_stop(hub);
 
+    // 마지막 checkpoint (스레드 다 끝난 뒤라 락 필요 없지만 같은 경로로)
+    if (hub->snap) {
+        pthread_mutex_lock(&hub->mtx);
+        checkpoint_locked(hub);
+        pthread_mutex_unlock(&hub->mtx);
+        hub_snapshot_close(hub->snap);
+    }
+    free(hub->dirty);
+    hub_archive_close(hub->archive); // 열린 chunk까지 파일에 쓰고 세그먼트 닫음
+
+    // 잡고 있던 핸들 놓음 (다시 시작하면 상태 파일의 deviceId로 다시 잡음)
+    for (int i = 0; hub->watch && i < hub->watch_cap; i++) {
+        if (hub->watch[i].used) dev_intern_unref(hub->ids, hub->watch[i].dev);
+    }
     if (hub->watch) free(hub->watch);
+    chan_store_free(&hub->vals);
+    chan_reg_destroy(hub->chans);
+    free(hub->slot_of);
+    dev_intern_close(hub->ids);
+    timer_wheel_destroy(hub->stale_wheel);
+    timer_wheel_destroy(hub->emit_wheel);
+    mem_arena_destroy(&hub->arena_watch);
+    mem_arena_destroy(&hub->arena_rule_in);
+    free(hub->out_buf);
+    hub_emit_destroy(hub->emit);
+    free(hub->emit_recs);
+    chan_store_free(&hub->emit_vals);
+    hub_live_destroy(hub->live);
+    hub_result_bus_destroy(hub->results); // 구독 워커 정지 (큐에 남은 RESULT는 버림)
+
+    // 스레드가 다 끝났으니 retired 포함 전부 해제
+    while (hub->retired) {
+        HubConf* c = hub->retired;
+        hub->retired = c->retired_next;
+        free(c);
+    }
+    free(atomic_load(&hub->conf));
+    pthread_mutex_destroy(&hub->conf_mtx);
+
+    hub_life_destroy(&hub->life);
     pthread_mutex_destroy(&hub->mtx);
+    pthread_mutex_destroy(&hub->th_mtx);
     free(hub);
-}
\ No newline at end of file
+}
+
+HubLifeState collector_hub_state(CollectorHub* hub) {
+    return hub ? hub_life_state(&hub->life) : HUB_LIFE_STOPPED;
+}
+
+HubLifeState collector_hub_wait_ready(CollectorHub* hub, int timeout_ms) {
+    return hub ? hub_life_wait_state(&hub->life, HUB_LIFE_READY, timeout_ms) : HUB_LIFE_STOPPED;
+}
+
+int collector_hub_ingest_line(CollectorHub* hub, const char* line) {
+    if (!hub || !line) return -1;
+
+    atomic_fetch_add(&hub->ext_readers, 1);
+    int rc = apply_watch_line(hub, line);
+    atomic_fetch_sub(&hub->ext_readers, 1);
+    return rc;
+}
+
+int collector_hub_ingest_watch(CollectorHub* hub, const WatchMsg* recs, int n) {
+    if (!hub || !recs) return -1;
+
+    int applied = 0;
+    atomic_fetch_add(&hub->ext_readers, 1);
+    for (int i = 0; i < n; i++) {
+        if (apply_watch_msg(hub, &recs[i]) == 0) applied++;
+    }
+    atomic_fetch_sub(&hub->ext_readers, 1);
+    return applied;
+}
+
+int collector_hub_subscribe(CollectorHub* hub, HubResultHandler h, void* ctx, const HubSubscribeOptions* opt) {
+    if (!hub) return -1;
+    return hub_result_subscribe(hub->results, h, ctx, opt);
+}
+
+int collector_hub_unsubscribe(CollectorHub* hub, int id) {
+    if (!hub) return -1;
+    return hub_result_unsubscribe(hub->results, id);
+}
+
+int collector_hub_query(CollectorHub* hub, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                        HubArchiveVisit visit, void* ctx) {
+    if (!hub || !hub->archive) return -1;
+    return hub_archive_query(hub->archive, deviceId, t0_ms, t1_ms, visit, ctx);
+}
+
+int collector_hub_get_flow(CollectorHub* hub, FlowSnapshot* out, int max) {
+    if (!hub || !out || max <= 0) return 0;
+
+    // watch_ingest_external이면 ingest 단계는 0으로 남아 있음
+    int n = 0;
+    flow_stage_snapshot(&hub->flow_rule_in, &out[n++]);
+    if (n < max) flow_stage_snapshot(&hub->flow_ingest, &out[n++]);
+    return n;
+}
+
+void collector_hub_set_env_source(CollectorHub* hub, CollectorHub* src) {
+    if (!hub || src == hub) return;
+    hub->env_src = src;
+}
+
+int collector_hub_reconfigure(CollectorHub* hub, const CollectorHubConfig* cfg) {
+    if (!hub || !cfg) return -1;
+
+    pthread_mutex_lock(&hub->conf_mtx);
+    HubConf* old = atomic_load(&hub->conf);
+    const CollectorHubConfig* oc = &old->cfg;
+
+    // 실행 중에는 못 바꾸는 항목 (스레드 구성 / 상태 파일) → 이전 값 유지
+    CollectorHubConfig want = *cfg;
+    if ((want.watch_mq_name == NULL) != (oc->watch_mq_name == NULL) ||
+        (want.watch_mq_name && strcmp(want.watch_mq_name, oc->watch_mq_name) != 0) ||
+        want.watch_ingest_external != oc->watch_ingest_external ||
+        want.th_disabled != oc->th_disabled ||
+        (want.state_file_path == NULL) != (oc->state_file_path == NULL) ||
+        (want.state_file_path && strcmp(want.state_file_path, oc->state_file_path) != 0) ||
+        (want.query_socket_path == NULL) != (oc->query_socket_path == NULL) ||
+        (want.query_socket_path && strcmp(want.query_socket_path, oc->query_socket_path) != 0)) {
+        fprintf(stderr, "⚠️ [HUB][CONF] watch_mq_name/watch_ingest_external/th_disabled/state_file_path/"
+                        "query_socket_path need restart (ignored)\n");
+    }
+    want.watch_mq_name = oc->watch_mq_name;
+    want.watch_ingest_external = oc->watch_ingest_external;
+    want.th_disabled = oc->th_disabled;
+    want.state_file_path = oc->state_file_path;
+    want.query_socket_path = oc->query_socket_path;
+
+    HubConf* nc = conf_build(&want, old->gen + 1);
+    if (!nc) {
+        pthread_mutex_unlock(&hub->conf_mtx);
+        return -2;
+    }
+
+    pthread_mutex_lock(&hub->mtx);
+    int rc = 0;
+    int old_cap = hub->watch_cap;
+    if (nc->cfg.max_devices != old_cap) {
+        if (resize_table_locked(hub, &nc->cfg, nc->cfg.max_devices) != 0) {
+            fprintf(stderr, "❌ [HUB][CONF] max_devices %d → %d failed (keep %d)\n",
+                    old_cap, nc->cfg.max_devices, hub->watch_cap);
+            nc->cfg.max_devices = hub->watch_cap;
+            rc = -3;
+        }
+    }
+    if (nc->cfg.device_stale_sec != oc->device_stale_sec ||
+        nc->cfg.collect_interval_sec != oc->collect_interval_sec) {
+        retime_locked(hub, &nc->cfg, now_mono_ms());
+    }
+    atomic_store(&hub->conf, nc);
+    pthread_mutex_unlock(&hub->mtx);
+
+    // 이전 설정은 모든 스레드가 새 generation을 본 뒤 해제
+    old->retired_next = hub->retired;
+    hub->retired = old;
+    conf_reclaim(hub);
+    pthread_mutex_unlock(&hub->conf_mtx);
+
+    printf("🔧 [HUB][CONF] gen %llu: devices=%d interval=%ds stale=%ds th=%s:%d (%d~%dms) log=%d%d%d%d\n",
+           (unsigned long long)nc->gen, nc->cfg.max_devices, nc->cfg.collect_interval_sec,
+           nc->cfg.device_stale_sec, nc->cfg.th_ip, nc->cfg.th_port,
+           nc->cfg.th_min_interval_ms, nc->cfg.th_max_interval_ms,
+           nc->cfg.log_th, nc->cfg.log_watch, nc->cfg.log_rule_in, nc->cfg.log_rule_out);
+    return rc;
+}
+
+int collector_hub_reload_file(CollectorHub* hub, const char* path) {
+    if (!hub || !path) return -1;
+
+    // 현재 설정 위에 파일에 있는 키만 덮어씀
+    // (안 바뀐 문자열은 현재 HubConf를 가리킴 → ext_readers 올린 동안은 해제 안 됨)
+    atomic_fetch_add(&hub->ext_readers, 1);
+    CollectorHubConfig cfg = *hub_cfg(hub);
+    HubConfigStrings strs;
+    int rc = hub_config_load(path, &cfg, &strs);
+    if (rc < 0) {
+        fprintf(stderr, "❌ [HUB][CONF] reload %s failed\n", path);
+    } else {
+        rc = collector_hub_reconfigure(hub, &cfg);
+    }
+    atomic_fetch_sub(&hub->ext_readers, 1);
+    return rc;
+}
+
+void collector_hub_request_reload(CollectorHub* hub) {
+    if (hub) atomic_store(&hub->reload_req, 1);
+}
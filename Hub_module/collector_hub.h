@@ -6,6 +6,14 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "thread_place.h"
+#include "flow_ctl.h"
+#include "hub_result.h"
+#include "hub_archive.h"
+#include "hub_life.h"
 
 typedef struct {
     // ---------- FIFOs ----------
@@ -13,13 +21,59 @@ typedef struct {
     const char* rulebase_in_fifo_path; // C -> RuleBase (예: "/tmp/rulebase_in.fifo")
     const char* rulebase_out_fifo_path;// RuleBase -> C (예: "/tmp/rulebase_out.fifo")
 
+    // ---------- Watch 입력 ----------
+    const char* watch_mq_name;         // 지정하면 FIFO 대신 이 MQ에서 배치 WatchMsg를 읽음 (예: "/mq_vital.0")
+    int watch_ingest_external;         // 1이면 watch 리더 스레드 없음 (collector_hub_ingest_line으로만 입력)
+    const char* dev_intern_name;       // deviceId 핸들 shm 이름 (NULL이면 "/dev_intern", 워치 모듈과 같아야 함)
+    int dev_intern_capacity;           // 처음 만드는 쪽일 때 최대 디바이스 수 (0이면 65536)
+    const char* channels;              // HR/SKIN_TEMP 뒤에 붙일 채널 "TYPE=key,..." (워치 모듈과 같아야 함, 다르면 create 실패, 생성할 때만 적용)
+
     // ---------- TH(Modbus) ----------
     const char* th_ip;                 // 예: "192.168.0.20"
     int th_port;                       // 예: 8887
+    int th_slave_id;                   // Modbus slave ID (기본 1)
+    int th_min_interval_ms;            // 적응형 TH 폴링 최소 간격 (기본 1000)
+    int th_max_interval_ms;            // 적응형 TH 폴링 최대 간격 (기본 60000)
+    int th_disabled;                   // 1이면 TH 폴링 안 함 (샤드 그룹에서 shard 0만 폴링)
 
     // ---------- Hub behavior ----------
     int collect_interval_sec;          // Rule step 주기 (예: 5)
     int max_devices;                   // deviceId 캐시 수 (예: 64)
+    int device_stale_sec;              // 이 시간 동안 watch 데이터 없는 디바이스는 슬롯 해제 (기본 300)
+
+    // ---------- SENSOR 출력 (디바이스가 많을 때) ----------
+    int emit_workers;                  // tick마다 SENSOR 포맷을 나눠 할 스레드 수 (rule_in 포함, 기본 1, 생성할 때 적용)
+    int emit_parallel_min;             // shard 하나가 맡는 최소 디바이스 수 (기본 512, 이보다 적은 tick은 rule_in 혼자)
+
+    // ---------- 상태 조회 (생성할 때 적용, reconfigure로는 안 바뀜) ----------
+    const char* query_socket_path;     // 지정하면 이 Unix socket에서 현재 디바이스 상태 조회 (hub_query.h 프로토콜)
+
+    // ---------- 상태 파일 (warm restart) ----------
+    const char* state_file_path;       // 지정하면 디바이스 캐시/env를 mmap 파일에 checkpoint, 시작할 때 복원
+    int state_max_age_sec;             // 이보다 오래된 env는 복원 안 함 (기본 600, 디바이스는 device_stale_sec 기준)
+    int state_checkpoint_ms;           // 바뀐 슬롯을 파일에 반영하는 주기 (기본 1000)
+
+    // ---------- 측정값 아카이브 (생성할 때 적용, reconfigure로는 안 바뀜) ----------
+    const char* archive_dir;           // 지정하면 워치 채널/env를 압축 시계열 세그먼트로 저장 (collector_hub_query)
+    int archive_rotate_sec;            // 세그먼트 파일 길이 (기본 3600)
+    int archive_keep_sec;              // 이보다 오래된 세그먼트 삭제 (0이면 안 지움)
+    int archive_flush_sec;             // 메모리에 열린 chunk 최대 나이 (기본 60, 죽으면 이만큼 잃을 수 있음)
+
+    // ---------- 스레드 배치 (스레드 시작할 때 적용, reconfigure로는 안 바뀜) ----------
+    ThreadPlace place_th;              // TH 폴링
+    ThreadPlace place_watch;           // watch FIFO/MQ 리더
+    ThreadPlace place_rule_in;         // tick + SENSOR emit (지연에 가장 민감)
+    ThreadPlace place_rule_out;        // RESULT 리더
+
+    // ---------- I/O (리더 스레드 시작할 때 적용) ----------
+    int io_backend;                    // FIFO 리더 IoBackend: 0 자동(io_uring → 안 되면 epoll), 1 epoll, 2 io_uring
+
+    // ---------- 흐름 제어 (생성할 때 적용, reconfigure로는 안 바뀜) ----------
+    FlowConfig flow_rule_in;           // rulebase_in 출력: 대기 바이트 기준 degrade (0이면 기본값, lag 기본 2000ms)
+    FlowConfig flow_ingest;            // watch 입력 큐 깊이/lag publish (degrade는 생산자인 워치 모듈이 같은 깊이를 보고 함)
+
+    // ---------- 실행 중 설정 변경 ----------
+    const char* reload_file_path;      // key=value 설정 파일, mtime이 바뀌거나 reload 요청이 오면 다시 읽음
 
     // 로그 옵션
     int log_th;                        // 1이면 TH 폴링 로그
@@ -29,6 +83,7 @@ typedef struct {
 } CollectorHubConfig;
 
 // rulebase_out에서 RESULT 라인(JSON)을 받았을 때 호출되는 콜백
+// (create에 넘긴 콜백은 유실 없는 구독 1개로 등록됨 → 워커 스레드에서 호출, 큐가 꽉 차면 라인을 버리지 않고 리더가 기다림)
 typedef void (*CollectorHubResultCallback)(const char* json_line, void* user_ctx);
 
 // opaque handle
@@ -40,14 +95,68 @@ CollectorHub* collector_hub_create(const CollectorHubConfig* cfg,
                                    void* cb_ctx);
 
 // 내부 스레드 시작 (TH 폴링, watch FIFO 리더, rule_in writer, rule_out reader)
+// 상대 프로세스(rulebase / watch writer)를 기다리지 않고 바로 돌아옴 → 준비 상태는 collector_hub_state
+// return: 0 성공, -2..-5 스레드 생성 실패 (이미 만든 스레드는 정지 / join, 정지 상태로 되돌림 → 다시 start 가능)
 int collector_hub_start(CollectorHub* hub);
 
-// 종료 요청 + join
+// 종료 요청 + join (100ms 안, 스레드는 정지 eventfd로 바로 깨어남)
+// TH 스레드가 modbus connect / 응답을 기다리는 중이면 소켓 shutdown(th_module_abort)으로 깨우고 join (돌아오면 스레드는 전부 끝남)
 void collector_hub_stop(CollectorHub* hub);
 
+// 종료 요청만 (join 없음, 시그널 핸들러에서 불러도 됨) → 여러 허브를 한꺼번에 멈출 때 먼저 전부 요청
+void collector_hub_request_stop(CollectorHub* hub);
+
+// 준비 상태: STOPPED / STARTING(첫 연결 시도 전) / DEGRADED(재시도 중인 endpoint 있음) / READY
+// FIFO endpoint는 상대 프로세스가 반대쪽을 열고 있을 때만 UP, watch MQ는 첫 레코드를 받으면 UP
+HubLifeState collector_hub_state(CollectorHub* hub);
+// READY가 될 때까지 최대 timeout_ms 대기, return: 그때 상태
+HubLifeState collector_hub_wait_ready(CollectorHub* hub, int timeout_ms);
+
 // 메모리 해제( stop 이후 호출 권장 )
 void collector_hub_destroy(CollectorHub* hub);
 
+// watch JSON 라인 1개 반영 (watch 리더 스레드와 같은 경로, 0 성공 / -1 파싱 실패 / -2 슬롯 없음)
+int collector_hub_ingest_line(CollectorHub* hub, const char* line);
+
+// WatchMsg n개 반영 (MQ 리더와 같은 경로, 통합 실행에서 워치 링 drain이 호출)
+// return: 반영된 레코드 수 (모르는 핸들/슬롯 없음/깨진 레코드는 빠짐)
+int collector_hub_ingest_watch(CollectorHub* hub, const WatchMsg* recs, int n);
+
+// 실행 중 설정 변경 (stop/start 없이, 캐시 유지)
+// - max_devices: 테이블을 그 자리에서 늘리거나 줄임 (넘치면 오래된 디바이스부터 버림)
+// - collect_interval_sec / device_stale_sec: 대기 중인 deadline 다시 계산
+// - th_ip / th_port / th_slave_id / th_*_interval_ms: TH 스레드가 다음 폴링에서 교체
+// - FIFO 경로: rule_in은 다음 tick, watch/rule_out은 다음 라인(또는 writer가 닫은 뒤)부터
+// - log_*: 바로 적용
+// - watch_mq_name / watch_ingest_external / th_disabled / state_file_path는 재시작해야 바뀜 (무시)
+// return: 0 성공, 음수 실패 (실패해도 나머지 항목은 적용됨)
+int collector_hub_reconfigure(CollectorHub* hub, const CollectorHubConfig* cfg);
+
+// 설정 파일(key=value)을 읽어서 현재 설정 위에 덮어쓰고 reconfigure
+int collector_hub_reload_file(CollectorHub* hub, const char* path);
+
+// reload_file_path 다시 읽기 요청 (플래그만 세움, SIGHUP 핸들러에서 불러도 됨)
+void collector_hub_request_reload(CollectorHub* hub);
+
+// RESULT 구독 (구독마다 bounded 큐 + 워커 스레드, deviceId / 최소 level 필터)
+// 라인은 한 번만 파싱되어 HubResult로 공유됨, 핸들러 안에서 unsubscribe 하면 안 됨
+// return: 구독 id (>0), 실패 -1
+int collector_hub_subscribe(CollectorHub* hub, HubResultHandler h, void* ctx, const HubSubscribeOptions* opt);
+int collector_hub_unsubscribe(CollectorHub* hub, int id);
+
+// 아카이브 조회: deviceId의 [t0_ms, t1_ms] (epoch ms, watch ts 기준) 포인트를 visit으로
+// channel = channel_reg 번호 (CHAN_HR / CHAN_ST / channels 순서), env는 deviceId = HUB_ARCHIVE_ENV_ID (HUB_CH_TEMP / HUB_CH_HUMI)
+// 호출한 스레드에서 바로 읽음 (세그먼트 mmap), return: 포인트 수, -1 아카이브 없음/실패
+int collector_hub_query(CollectorHub* hub, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                        HubArchiveVisit visit, void* ctx);
+
+// 흐름 제어 단계별 깊이/lag/degrade 상태 (out에 최대 max개, return: 채운 개수)
+// name 포인터는 허브가 살아 있는 동안 유효
+int collector_hub_get_flow(CollectorHub* hub, FlowSnapshot* out, int max);
+
+// env(TH)를 다른 허브에서 가져옴 (src의 마지막 온습도를 tick마다 복사, NULL이면 자기 TH)
+void collector_hub_set_env_source(CollectorHub* hub, CollectorHub* src); // start 전에 호출
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,736 @@
+#include "hub_archive.h"
+#include "shard_ring.h"
+#include "ts_parse.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ARC_WBUF_BYTES  (64 * 1024) // 닫힌 chunk 모아서 한 번에 write
+#define ARC_POINT_BITS  128         // 포인트 1개 최대 비트 (ts 4+32, 값 2+5+6+64) + 여유
+#define ARC_SCAN_MS     1000        // 오래된 chunk 확인 주기
+#define ARC_PAD8(n)     (((n) + 7u) & ~(size_t)7u)
+
+// series 1개 = (deviceId, 채널) + 열린 chunk
+typedef struct {
+    char deviceId[64];
+    uint64_t dev_hash;
+    int channel;
+
+    uint16_t n;
+    size_t bits;
+    int64_t opened_ms;      // chunk 첫 포인트가 들어온 tick 시각 (flush_sec 기준)
+    int64_t t_min, t_max;
+    double v_min, v_max;
+
+    // 인코더 상태
+    int64_t prev_ts;
+    int64_t prev_delta;
+    uint64_t prev_bits;
+    int lead, trail;        // 마지막 XOR 창 (-1: 아직 없음)
+
+    uint8_t buf[HUB_ARCHIVE_CHUNK_BYTES];
+} Series;
+
+struct HubArchive {
+    pthread_mutex_t mtx;
+    char dir[256];
+    int64_t rotate_ms;
+    int64_t keep_ms;
+    int64_t flush_ms;
+    int64_t now_ms;         // 마지막 tick 시각
+    int64_t next_scan_ms;
+    int open_failed;        // 세그먼트 열기 실패 (로그 한 번만)
+
+    // 현재 세그먼트
+    int fd;
+    int64_t seg_start;
+    uint64_t seg_size;      // 파일에 다 쓴 크기 (조회는 여기까지만 봄)
+    HubArchiveSegHdr hdr;
+
+    // 아직 안 쓴 chunk들
+    unsigned char* wbuf;
+    size_t wlen;
+    int64_t w_tmin, w_tmax;
+    uint64_t w_chunks;
+
+    // series 테이블 (세그먼트마다 비움)
+    Series* series;
+    int n_series;
+    int cap_series;
+    int* index;             // open addressing, -1 = 빈 칸
+    unsigned index_mask;
+
+    HubArchiveStats st;
+};
+
+// ================================
+// 내부: 비트 입출력 (MSB부터)
+// ================================
+static void _bw_put(uint8_t* buf, size_t* pos, uint64_t v, int n) {
+    while (n > 0) {
+        size_t byte = *pos >> 3;
+        int room = 8 - (int)(*pos & 7);
+        int take = n < room ? n : room;
+        uint8_t b = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        buf[byte] |= (uint8_t)(b << (room - take));
+        *pos += (size_t)take;
+        n -= take;
+    }
+}
+
+typedef struct {
+    const uint8_t* p;
+    size_t len_bits;
+    size_t pos;
+    int err;
+} BitR;
+
+static uint64_t _br_get(BitR* r, int n) {
+    if (r->pos + (size_t)n > r->len_bits) {
+        r->err = 1;
+        return 0;
+    }
+    uint64_t v = 0;
+    while (n > 0) {
+        int room = 8 - (int)(r->pos & 7);
+        int take = n < room ? n : room;
+        uint8_t b = (uint8_t)(r->p[r->pos >> 3] >> (room - take)) & (uint8_t)((1u << take) - 1);
+        v = (v << take) | b;
+        r->pos += (size_t)take;
+        n -= take;
+    }
+    return v;
+}
+
+static uint64_t _dbl_bits(double v) {
+    uint64_t b;
+    memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+static double _bits_dbl(uint64_t b) {
+    double v;
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+static uint32_t _fnv1a(const void* p, size_t n) {
+    const unsigned char* b = (const unsigned char*)p;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// ================================
+// 내부: chunk 인코딩
+// ================================
+static void _chunk_first(Series* s, int64_t ts, double v, int64_t now_ms) {
+    memset(s->buf, 0, sizeof(s->buf));
+    s->bits = 0;
+    s->prev_bits = _dbl_bits(v);
+    _bw_put(s->buf, &s->bits, (uint64_t)ts, 64);
+    _bw_put(s->buf, &s->bits, s->prev_bits, 64);
+
+    s->n = 1;
+    s->opened_ms = now_ms;
+    s->prev_ts = ts;
+    s->prev_delta = 0;
+    s->lead = -1;
+    s->trail = 0;
+    s->t_min = s->t_max = ts;
+    s->v_min = s->v_max = v;
+}
+
+// return: 0 이 chunk에 못 넣음 (닫고 새로 시작해야 함)
+static int _chunk_put(Series* s, int64_t ts, double v) {
+    if (s->bits + ARC_POINT_BITS > (size_t)HUB_ARCHIVE_CHUNK_BYTES * 8 || s->n == UINT16_MAX) return 0;
+
+    // timestamp: delta-of-delta, zigzag 후 크기별 prefix
+    int64_t delta = ts - s->prev_ts;
+    int64_t dod = delta - s->prev_delta;
+    uint64_t zz = ((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63);
+    if (zz >= (1ull << 32)) return 0;
+
+    if (zz == 0) {
+        _bw_put(s->buf, &s->bits, 0x0, 1);
+    } else if (zz < (1u << 7)) {
+        _bw_put(s->buf, &s->bits, 0x2, 2);
+        _bw_put(s->buf, &s->bits, zz, 7);
+    } else if (zz < (1u << 9)) {
+        _bw_put(s->buf, &s->bits, 0x6, 3);
+        _bw_put(s->buf, &s->bits, zz, 9);
+    } else if (zz < (1u << 12)) {
+        _bw_put(s->buf, &s->bits, 0xE, 4);
+        _bw_put(s->buf, &s->bits, zz, 12);
+    } else {
+        _bw_put(s->buf, &s->bits, 0xF, 4);
+        _bw_put(s->buf, &s->bits, zz, 32);
+    }
+
+    // 값: 이전 값과 XOR
+    uint64_t b = _dbl_bits(v);
+    uint64_t x = b ^ s->prev_bits;
+    if (x == 0) {
+        _bw_put(s->buf, &s->bits, 0, 1);
+    } else {
+        int lead = __builtin_clzll(x);
+        int trail = __builtin_ctzll(x);
+        if (lead > 31) lead = 31;
+
+        if (s->lead >= 0 && lead >= s->lead && trail >= s->trail) {
+            // 이전 창 안에 들어감: 창 크기만큼만
+            _bw_put(s->buf, &s->bits, 0x2, 2);
+            _bw_put(s->buf, &s->bits, x >> s->trail, 64 - s->lead - s->trail);
+        } else {
+            int m = 64 - lead - trail;
+            _bw_put(s->buf, &s->bits, 0x3, 2);
+            _bw_put(s->buf, &s->bits, (uint64_t)lead, 5);
+            _bw_put(s->buf, &s->bits, (uint64_t)(m - 1), 6);
+            _bw_put(s->buf, &s->bits, x >> trail, m);
+            s->lead = lead;
+            s->trail = trail;
+        }
+    }
+
+    s->prev_bits = b;
+    s->prev_delta = delta;
+    s->prev_ts = ts;
+    s->n++;
+    if (ts < s->t_min) s->t_min = ts;
+    if (ts > s->t_max) s->t_max = ts;
+    if (v < s->v_min) s->v_min = v;
+    if (v > s->v_max) s->v_max = v;
+    return 1;
+}
+
+static void _chunk_header(const Series* s, HubArchiveChunkHdr* h) {
+    memset(h, 0, sizeof(*h));
+    h->magic = HUB_ARCHIVE_CHUNK_MAGIC;
+    h->channel = (uint16_t)s->channel;
+    h->n = s->n;
+    h->nbytes = (uint32_t)((s->bits + 7) / 8);
+    h->checksum = _fnv1a(s->buf, h->nbytes);
+    h->dev_hash = s->dev_hash;
+    memcpy(h->deviceId, s->deviceId, sizeof(h->deviceId));
+    h->t_min = s->t_min;
+    h->t_max = s->t_max;
+    h->v_min = s->v_min;
+    h->v_max = s->v_max;
+}
+
+// ================================
+// 내부: chunk 디코딩
+// ================================
+static int _chunk_decode(const HubArchiveChunkHdr* h, const uint8_t* bits,
+                         int64_t t0, int64_t t1, HubArchiveVisit visit, void* ctx) {
+    BitR r = { bits, (size_t)h->nbytes * 8, 0, 0 };
+    int hits = 0;
+
+    int64_t ts = (int64_t)_br_get(&r, 64);
+    uint64_t vb = _br_get(&r, 64);
+    if (r.err || h->n == 0) return 0;
+    if (ts >= t0 && ts <= t1) {
+        visit(ctx, h->channel, ts, _bits_dbl(vb));
+        hits++;
+    }
+
+    int64_t delta = 0;
+    int lead = 0, trail = 0;
+    for (int i = 1; i < h->n; i++) {
+        uint64_t zz = 0;
+        if (_br_get(&r, 1)) {
+            if (!_br_get(&r, 1)) zz = _br_get(&r, 7);
+            else if (!_br_get(&r, 1)) zz = _br_get(&r, 9);
+            else if (!_br_get(&r, 1)) zz = _br_get(&r, 12);
+            else zz = _br_get(&r, 32);
+        }
+        int64_t dod = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+        delta += dod;
+        ts += delta;
+
+        if (_br_get(&r, 1)) {
+            if (_br_get(&r, 1)) {
+                lead = (int)_br_get(&r, 5);
+                int m = (int)_br_get(&r, 6) + 1;
+                trail = 64 - lead - m;
+            }
+            if (trail < 0) r.err = 1;
+            if (r.err) break;
+            vb ^= _br_get(&r, 64 - lead - trail) << trail;
+        }
+        if (r.err) break;
+
+        if (ts >= t0 && ts <= t1) {
+            visit(ctx, h->channel, ts, _bits_dbl(vb));
+            hits++;
+        }
+    }
+    return hits;
+}
+
+// ================================
+// 내부: series 테이블
+// ================================
+static unsigned _slot_of(uint64_t hash, int channel, unsigned mask) {
+    return (unsigned)((hash ^ ((uint64_t)channel * 0x9E3779B97F4A7C15ull)) & mask);
+}
+
+static Series* _series_find(HubArchive* a, const char* dev, uint64_t hash, int channel) {
+    if (!a->index) return NULL;
+    for (unsigned i = _slot_of(hash, channel, a->index_mask);; i = (i + 1) & a->index_mask) {
+        int k = a->index[i];
+        if (k < 0) return NULL;
+        Series* s = &a->series[k];
+        if (s->dev_hash == hash && s->channel == channel && strcmp(s->deviceId, dev) == 0) return s;
+    }
+}
+
+static void _index_insert(HubArchive* a, int k) {
+    unsigned i = _slot_of(a->series[k].dev_hash, a->series[k].channel, a->index_mask);
+    while (a->index[i] >= 0) i = (i + 1) & a->index_mask;
+    a->index[i] = k;
+}
+
+static Series* _series_get(HubArchive* a, const char* dev, uint64_t hash, int channel) {
+    Series* s = _series_find(a, dev, hash, channel);
+    if (s) return s;
+
+    // 테이블 늘리기 (index는 항상 절반 이하로 채움)
+    // index를 먼저 잡음 → 어느 쪽이 실패해도 cap_series / index는 그대로 (index만 작은 채로 남으면 탐색이 안 끝남)
+    if (a->n_series == a->cap_series) {
+        int cap = a->cap_series ? a->cap_series * 2 : 64;
+        unsigned isz = 1;
+        while (isz < (unsigned)cap * 2) isz <<= 1;
+        int* ni = (int*)malloc(isz * sizeof(int));
+        if (!ni) return NULL;
+
+        Series* ns = (Series*)realloc(a->series, (size_t)cap * sizeof(Series));
+        if (!ns) {
+            free(ni);
+            return NULL;
+        }
+        a->series = ns;
+        a->cap_series = cap;
+
+        free(a->index);
+        a->index = ni;
+        a->index_mask = isz - 1;
+        memset(a->index, 0xff, isz * sizeof(int));
+        for (int k = 0; k < a->n_series; k++) _index_insert(a, k);
+    }
+
+    int k = a->n_series++;
+    s = &a->series[k];
+    memset(s, 0, offsetof(Series, buf));
+    snprintf(s->deviceId, sizeof(s->deviceId), "%s", dev);
+    s->dev_hash = hash;
+    s->channel = channel;
+    _index_insert(a, k);
+    return s;
+}
+
+static void _series_reset(HubArchive* a) {
+    a->n_series = 0;
+    if (a->index) memset(a->index, 0xff, (size_t)(a->index_mask + 1) * sizeof(int));
+}
+
+// ================================
+// 내부: 세그먼트 파일
+// ================================
+static int _pwrite_all(int fd, const void* p, size_t n, off_t off) {
+    const unsigned char* b = (const unsigned char*)p;
+    while (n > 0) {
+        ssize_t w = pwrite(fd, b, n, off);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        b += w;
+        n -= (size_t)w;
+        off += w;
+    }
+    return 0;
+}
+
+// 모은 chunk를 파일에 쓰고 헤더 시간 범위 갱신 (실패하면 버림)
+static int _flush(HubArchive* a) {
+    if (a->wlen == 0) return 0;
+
+    int rc = -1;
+    if (a->fd >= 0 && _pwrite_all(a->fd, a->wbuf, a->wlen, (off_t)a->seg_size) == 0) {
+        a->seg_size += a->wlen;
+        if (a->w_tmin < a->hdr.t_min) a->hdr.t_min = a->w_tmin;
+        if (a->w_tmax > a->hdr.t_max) a->hdr.t_max = a->w_tmax;
+        a->hdr.chunks += a->w_chunks;
+        _pwrite_all(a->fd, &a->hdr, sizeof(a->hdr), 0);
+        a->st.bytes_written += a->wlen;
+        rc = 0;
+    } else {
+        // 다음 write는 같은 위치에 덮어씀 (찢어진 chunk는 안 남음)
+        if (a->fd >= 0) perror("pwrite archive");
+        a->st.write_errors += a->w_chunks;
+    }
+
+    a->wlen = 0;
+    a->w_tmin = INT64_MAX;
+    a->w_tmax = INT64_MIN;
+    a->w_chunks = 0;
+    return rc;
+}
+
+static void _chunk_close(HubArchive* a, Series* s) {
+    if (s->n == 0) return;
+
+    HubArchiveChunkHdr h;
+    _chunk_header(s, &h);
+    size_t rec = sizeof(h) + ARC_PAD8(h.nbytes);
+    if (a->wlen + rec > ARC_WBUF_BYTES) _flush(a);
+
+    memcpy(a->wbuf + a->wlen, &h, sizeof(h));
+    memcpy(a->wbuf + a->wlen + sizeof(h), s->buf, h.nbytes);
+    memset(a->wbuf + a->wlen + sizeof(h) + h.nbytes, 0, rec - sizeof(h) - h.nbytes);
+    a->wlen += rec;
+
+    if (h.t_min < a->w_tmin) a->w_tmin = h.t_min;
+    if (h.t_max > a->w_tmax) a->w_tmax = h.t_max;
+    a->w_chunks++;
+    a->st.chunks++;
+    s->n = 0;
+}
+
+static void _seg_path(const HubArchive* a, int64_t start, char* out, size_t sz) {
+    snprintf(out, sz, "%s/seg-%lld.tsa", a->dir, (long long)start);
+}
+
+static int _seg_open(HubArchive* a, int64_t now) {
+    char path[320];
+    int64_t start = now;
+    int fd = -1;
+    for (int tries = 0; tries < 4 && fd < 0; tries++, start++) {
+        _seg_path(a, start, path, sizeof(path));
+        fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        if (!a->open_failed) fprintf(stderr, "❌ [HUB][ARCHIVE] open %s failed: %s\n", path, strerror(errno));
+        a->open_failed = 1;
+        a->seg_start = now; // 다음 scan에서 다시 시도
+        return -1;
+    }
+    start--;
+
+    memset(&a->hdr, 0, sizeof(a->hdr));
+    a->hdr.magic = HUB_ARCHIVE_SEG_MAGIC;
+    a->hdr.version = HUB_ARCHIVE_VERSION;
+    a->hdr.start_ms = start;
+    a->hdr.t_min = INT64_MAX;
+    a->hdr.t_max = INT64_MIN;
+    if (_pwrite_all(fd, &a->hdr, sizeof(a->hdr), 0) != 0) {
+        perror("pwrite archive header");
+        close(fd);
+        unlink(path);
+        a->open_failed = 1;
+        a->seg_start = now;
+        return -1;
+    }
+
+    a->fd = fd;
+    a->seg_start = start;
+    a->seg_size = sizeof(a->hdr);
+    a->open_failed = 0;
+    a->st.segments++;
+    a->st.bytes_written += sizeof(a->hdr);
+    return 0;
+}
+
+// 열린 chunk 다 닫고 파일 헤더에 closed 표시
+static void _seg_close(HubArchive* a) {
+    for (int k = 0; k < a->n_series; k++) _chunk_close(a, &a->series[k]);
+    _flush(a);
+    _series_reset(a);
+
+    if (a->fd < 0) return;
+    a->hdr.closed = 1;
+    _pwrite_all(a->fd, &a->hdr, sizeof(a->hdr), 0);
+    close(a->fd);
+    a->fd = -1;
+}
+
+static int _seg_name_start(const char* name, int64_t* start) {
+    long long v;
+    int end = 0;
+    if (sscanf(name, "seg-%lld.tsa%n", &v, &end) != 1 || end == 0 || name[end] != '\0') return -1;
+    *start = (int64_t)v;
+    return 0;
+}
+
+static int _cmp_i64(const void* x, const void* y) {
+    int64_t a = *(const int64_t*)x, b = *(const int64_t*)y;
+    return (a > b) - (a < b);
+}
+
+// 디렉터리의 세그먼트 시작 시각 목록 (오름차순, 호출한 쪽이 free)
+static int _seg_list(const char* dir, int64_t** out) {
+    *out = NULL;
+    DIR* d = opendir(dir);
+    if (!d) return -1;
+
+    int n = 0, cap = 0;
+    int64_t* v = NULL;
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        int64_t start;
+        if (_seg_name_start(e->d_name, &start) != 0) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 32;
+            int64_t* nv = (int64_t*)realloc(v, (size_t)cap * sizeof(int64_t));
+            if (!nv) break;
+            v = nv;
+        }
+        v[n++] = start;
+    }
+    closedir(d);
+
+    if (n > 1) qsort(v, (size_t)n, sizeof(int64_t), _cmp_i64);
+    *out = v;
+    return n;
+}
+
+// keep_ms보다 오래된 세그먼트 삭제 (지금 쓰는 파일은 빼고)
+static void _retention(HubArchive* a, int64_t now) {
+    if (a->keep_ms <= 0) return;
+
+    int64_t* starts;
+    int n = _seg_list(a->dir, &starts);
+    for (int i = 0; i < n; i++) {
+        if (starts[i] == a->seg_start) continue;
+        if (starts[i] + a->rotate_ms >= now - a->keep_ms) break; // 오름차순
+        char path[320];
+        _seg_path(a, starts[i], path, sizeof(path));
+        if (unlink(path) == 0) a->st.removed++;
+    }
+    free(starts);
+}
+
+// ================================
+// 외부 API
+// ================================
+HubArchive* hub_archive_open(const HubArchiveConfig* cfg) {
+    if (!cfg || !cfg->dir || !cfg->dir[0]) return NULL;
+
+    HubArchive* a = (HubArchive*)calloc(1, sizeof(HubArchive));
+    if (!a) return NULL;
+
+    snprintf(a->dir, sizeof(a->dir), "%s", cfg->dir);
+    a->rotate_ms = (int64_t)(cfg->rotate_sec > 0 ? cfg->rotate_sec : 3600) * 1000;
+    a->keep_ms = (int64_t)(cfg->keep_sec > 0 ? cfg->keep_sec : 0) * 1000;
+    a->flush_ms = (int64_t)(cfg->flush_sec > 0 ? cfg->flush_sec : 60) * 1000;
+    a->fd = -1;
+    a->w_tmin = INT64_MAX;
+    a->w_tmax = INT64_MIN;
+
+    if (mkdir(a->dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "❌ [HUB][ARCHIVE] mkdir %s failed: %s\n", a->dir, strerror(errno));
+        free(a);
+        return NULL;
+    }
+
+    a->wbuf = (unsigned char*)malloc(ARC_WBUF_BYTES);
+    if (!a->wbuf) {
+        free(a);
+        return NULL;
+    }
+    pthread_mutex_init(&a->mtx, NULL);
+
+    a->now_ms = ts_now_ms();
+    _seg_open(a, a->now_ms);
+    _retention(a, a->now_ms);
+    a->next_scan_ms = a->now_ms + ARC_SCAN_MS;
+    return a;
+}
+
+void hub_archive_close(HubArchive* a) {
+    if (!a) return;
+    pthread_mutex_lock(&a->mtx);
+    _seg_close(a);
+    pthread_mutex_unlock(&a->mtx);
+
+    pthread_mutex_destroy(&a->mtx);
+    free(a->series);
+    free(a->index);
+    free(a->wbuf);
+    free(a);
+}
+
+int hub_archive_append(HubArchive* a, const char* deviceId, int channel, int64_t ts_ms, double value) {
+    if (!a || !deviceId || channel < 0 || channel >= HUB_ARCHIVE_MAX_CH) return -1;
+    uint64_t hash = shard_hash(deviceId, strlen(deviceId));
+
+    pthread_mutex_lock(&a->mtx);
+    Series* s = _series_get(a, deviceId, hash, channel);
+    if (!s) {
+        pthread_mutex_unlock(&a->mtx);
+        return -1;
+    }
+    if (s->n > 0 && !_chunk_put(s, ts_ms, value)) _chunk_close(a, s);
+    if (s->n == 0) _chunk_first(s, ts_ms, value, a->now_ms);
+    a->st.points++;
+    pthread_mutex_unlock(&a->mtx);
+    return 0;
+}
+
+void hub_archive_tick(HubArchive* a, int64_t now_ms) {
+    if (!a) return;
+    pthread_mutex_lock(&a->mtx);
+    a->now_ms = now_ms;
+
+    int scan = now_ms >= a->next_scan_ms;
+    if (scan) a->next_scan_ms = now_ms + ARC_SCAN_MS;
+
+    if ((a->fd >= 0 && now_ms >= a->seg_start + a->rotate_ms) || (a->fd < 0 && scan)) {
+        _seg_close(a);
+        if (_seg_open(a, now_ms) == 0) _retention(a, now_ms);
+    } else if (scan) {
+        // flush_sec 지난 chunk는 닫아서 파일로 (죽어도 잃는 건 그 이후 것만)
+        for (int k = 0; k < a->n_series; k++) {
+            Series* s = &a->series[k];
+            if (s->n > 0 && now_ms - s->opened_ms >= a->flush_ms) _chunk_close(a, s);
+        }
+    }
+    _flush(a);
+    pthread_mutex_unlock(&a->mtx);
+}
+
+typedef struct {
+    HubArchiveChunkHdr hdr;
+    uint8_t buf[HUB_ARCHIVE_CHUNK_BYTES];
+} OpenChunk;
+
+int hub_archive_query(HubArchive* a, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                      HubArchiveVisit visit, void* ctx) {
+    if (!a || !deviceId || !visit || t1_ms < t0_ms) return -1;
+    uint64_t hash = shard_hash(deviceId, strlen(deviceId));
+
+    // 1) 락 안: 모아둔 chunk write + 지금 세그먼트 크기 + 열린 chunk 복사
+    OpenChunk* open_c = (OpenChunk*)malloc(HUB_ARCHIVE_MAX_CH * sizeof(OpenChunk));
+    if (!open_c) return -1;
+    int n_open = 0;
+
+    pthread_mutex_lock(&a->mtx);
+    _flush(a);
+    int64_t cur_start = a->fd >= 0 ? a->seg_start : INT64_MIN;
+    uint64_t cur_size = a->seg_size;
+    for (int ch = 0; ch < HUB_ARCHIVE_MAX_CH; ch++) {
+        Series* s = _series_find(a, deviceId, hash, ch);
+        if (!s || s->n == 0 || s->t_max < t0_ms || s->t_min > t1_ms) continue;
+        _chunk_header(s, &open_c[n_open].hdr);
+        memcpy(open_c[n_open].buf, s->buf, open_c[n_open].hdr.nbytes);
+        n_open++;
+    }
+    pthread_mutex_unlock(&a->mtx);
+
+    // 2) 락 밖: 세그먼트 파일 (오래된 것부터) mmap → chunk 헤더로 거르기
+    int total = 0;
+    uint64_t read_c = 0, skip_c = 0, skip_s = 0;
+    int64_t* starts;
+    int n = _seg_list(a->dir, &starts);
+    for (int i = 0; i < n; i++) {
+        char path[320];
+        _seg_path(a, starts[i], path, sizeof(path));
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) continue; // 그 사이에 retention으로 지워짐
+
+        struct stat st;
+        size_t len = 0;
+        if (fstat(fd, &st) == 0) len = (size_t)st.st_size;
+        if (starts[i] == cur_start && len > cur_size) len = (size_t)cur_size; // 쓰는 중인 부분은 안 봄
+        if (len < sizeof(HubArchiveSegHdr)) {
+            close(fd);
+            continue;
+        }
+
+        void* map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) continue;
+
+        const unsigned char* p = (const unsigned char*)map;
+        const HubArchiveSegHdr* sh = (const HubArchiveSegHdr*)p;
+        if (sh->magic != HUB_ARCHIVE_SEG_MAGIC || sh->version != HUB_ARCHIVE_VERSION) {
+            munmap(map, len);
+            continue;
+        }
+        if (sh->closed && (sh->chunks == 0 || sh->t_max < t0_ms || sh->t_min > t1_ms)) {
+            skip_s++;
+            munmap(map, len);
+            continue;
+        }
+
+        size_t off = sizeof(HubArchiveSegHdr);
+        while (off + sizeof(HubArchiveChunkHdr) <= len) {
+            const HubArchiveChunkHdr* h = (const HubArchiveChunkHdr*)(p + off);
+            if (h->magic != HUB_ARCHIVE_CHUNK_MAGIC || h->nbytes > HUB_ARCHIVE_CHUNK_BYTES) break;
+            size_t rec = sizeof(*h) + ARC_PAD8(h->nbytes);
+            if (off + rec > len) break;
+
+            const uint8_t* bits = p + off + sizeof(*h);
+            if (h->dev_hash != hash || h->t_max < t0_ms || h->t_min > t1_ms ||
+                strncmp(h->deviceId, deviceId, sizeof(h->deviceId)) != 0) {
+                skip_c++;
+            } else if (_fnv1a(bits, h->nbytes) == h->checksum) {
+                total += _chunk_decode(h, bits, t0_ms, t1_ms, visit, ctx);
+                read_c++;
+            }
+            off += rec;
+        }
+        munmap(map, len);
+    }
+    free(starts);
+
+    // 3) 아직 파일에 없는 열린 chunk
+    for (int k = 0; k < n_open; k++) {
+        total += _chunk_decode(&open_c[k].hdr, open_c[k].buf, t0_ms, t1_ms, visit, ctx);
+        read_c++;
+    }
+    free(open_c);
+
+    pthread_mutex_lock(&a->mtx);
+    a->st.q_chunks_read += read_c;
+    a->st.q_chunks_skipped += skip_c;
+    a->st.q_segs_skipped += skip_s;
+    pthread_mutex_unlock(&a->mtx);
+    return total;
+}
+
+void hub_archive_get_stats(HubArchive* a, HubArchiveStats* out) {
+    if (!a || !out) return;
+    pthread_mutex_lock(&a->mtx);
+    *out = a->st;
+    out->series = a->n_series;
+    pthread_mutex_unlock(&a->mtx);
+}
+
+void hub_archive_print_stats(HubArchive* a, const char* tag) {
+    if (!a) return;
+    HubArchiveStats s;
+    hub_archive_get_stats(a, &s);
+
+    double bpp = s.points ? (double)s.bytes_written / (double)s.points : 0.0;
+    printf("📊 %s points=%llu chunks=%llu bytes=%llu (%.2f B/pt) segments=%llu removed=%llu write_err=%llu\n",
+           tag ? tag : "[ARCHIVE]", (unsigned long long)s.points, (unsigned long long)s.chunks,
+           (unsigned long long)s.bytes_written, bpp, (unsigned long long)s.segments,
+           (unsigned long long)s.removed, (unsigned long long)s.write_errors);
+    printf("📊 %s query chunks read=%llu skipped=%llu segments skipped=%llu\n",
+           tag ? tag : "[ARCHIVE]", (unsigned long long)s.q_chunks_read,
+           (unsigned long long)s.q_chunks_skipped, (unsigned long long)s.q_segs_skipped);
+}
@@ -0,0 +1,110 @@
+#ifndef HUB_ARCHIVE_H
+#define HUB_ARCHIVE_H
+
+/*
+측정값 시계열 아카이브 (append-only, 압축 chunk, 시간 단위 세그먼트 파일)
+- series = (deviceId, 채널), 채널: 워치는 channel_reg 번호, env는 온도/습도 (deviceId = HUB_ARCHIVE_ENV_ID)
+- series마다 열린 chunk 1개 (메모리), 꽉 차거나 flush_sec 지나면 닫아서 세그먼트 파일에 append
+    timestamp: delta-of-delta (0이면 1bit, 보통 워치 주기 흔들림은 9~14bit)
+    값: 이전 값과 XOR (같으면 1bit, 아니면 leading/trailing zero 뺀 가운데 비트만)
+- chunk 헤더에 deviceId hash / 시간 min,max / 값 min,max → 조회는 헤더만 보고 건너뜀
+- 세그먼트 = "<dir>/seg-<시작 epoch ms>.tsa", rotate_sec마다 새 파일, keep_sec 지난 파일은 삭제
+  닫힌 세그먼트는 파일 헤더의 시간 범위로 통째로 건너뜀 (안 닫힌 건 chunk 헤더를 다 봄)
+- 조회는 세그먼트 파일을 mmap해서 읽고, 아직 열린 chunk도 같이 봄
+- append 경로에는 syscall 없음 (파일 write는 chunk가 닫힐 때 모아서, tick에서)
+- 스레드 안전 (내부 락 1개, 조회는 파일을 읽는 동안 락을 안 잡음)
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_ARCHIVE_SEG_MAGIC   0x41535448u // "HTSA"
+#define HUB_ARCHIVE_CHUNK_MAGIC 0x4B4E4843u // "CHNK"
+#define HUB_ARCHIVE_VERSION     1
+#define HUB_ARCHIVE_CHUNK_BYTES 1024        // chunk 1개 비트스트림 최대 크기
+#define HUB_ARCHIVE_ENV_ID      "_env"      // env(TH) series의 deviceId
+
+#define HUB_ARCHIVE_MAX_CH      32          // 채널 번호 0 ~ 31 (channel_reg CHAN_MAX와 같음)
+
+// env series 채널 (워치 series는 channel_reg 번호: CHAN_HR = 0, CHAN_ST = 1, ...)
+enum {
+    HUB_CH_TEMP = 0, // env 온도
+    HUB_CH_HUMI = 1  // env 습도
+};
+
+// 파일 맨 앞 (t_min / t_max / chunks는 버퍼를 파일에 쓸 때마다 갱신)
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t closed;     // 1: rotate/close로 정상 종료 (시간 범위 믿어도 됨)
+    int64_t start_ms;
+    int64_t t_min;
+    int64_t t_max;
+    uint64_t chunks;
+} HubArchiveSegHdr;
+
+// chunk 헤더 + 비트스트림 nbytes (8바이트 정렬로 padding)
+typedef struct {
+    uint32_t magic;
+    uint16_t channel;
+    uint16_t n;          // 포인트 수
+    uint32_t nbytes;
+    uint32_t checksum;   // 비트스트림 FNV-1a
+    uint64_t dev_hash;   // shard_hash(deviceId)
+    char deviceId[64];
+    int64_t t_min;
+    int64_t t_max;
+    double v_min;
+    double v_max;
+} HubArchiveChunkHdr;
+
+typedef struct {
+    const char* dir;     // 세그먼트 디렉터리 (없으면 만듦)
+    int rotate_sec;      // 세그먼트 길이 (<= 0 이면 3600)
+    int keep_sec;        // 이보다 오래된 세그먼트 삭제 (<= 0 이면 안 지움)
+    int flush_sec;       // 열린 chunk 최대 나이 (<= 0 이면 60)
+} HubArchiveConfig;
+
+typedef struct {
+    uint64_t points;
+    uint64_t chunks;
+    uint64_t bytes_written;  // 세그먼트 파일에 쓴 바이트 (헤더 포함)
+    uint64_t segments;       // 만든 세그먼트 수
+    uint64_t removed;        // keep_sec로 지운 세그먼트 수
+    uint64_t write_errors;
+    uint64_t q_chunks_read;  // 조회에서 디코딩한 chunk
+    uint64_t q_chunks_skipped; // 헤더만 보고 건너뛴 chunk
+    uint64_t q_segs_skipped;   // 파일 헤더만 보고 건너뛴 세그먼트
+    int series;              // 지금 세그먼트의 series 수
+} HubArchiveStats;
+
+// 조회 결과 1개 (chunk 단위로 시간순, 채널끼리는 섞여서 옴)
+typedef void (*HubArchiveVisit)(void* ctx, int channel, int64_t ts_ms, double value);
+
+typedef struct HubArchive HubArchive;
+
+HubArchive* hub_archive_open(const HubArchiveConfig* cfg); // 실패하면 NULL
+void hub_archive_close(HubArchive* a);                     // 열린 chunk 다 쓰고 세그먼트 닫음
+
+// 포인트 1개 추가 (0 성공, -1 실패)
+int hub_archive_append(HubArchive* a, const char* deviceId, int channel, int64_t ts_ms, double value);
+
+// 주기적으로 호출 (오래된 chunk 닫기, 버퍼 write, rotate, 오래된 세그먼트 삭제)
+void hub_archive_tick(HubArchive* a, int64_t now_ms);
+
+// [t0_ms, t1_ms] 안의 포인트를 visit으로 (return: 포인트 수, -1 실패)
+int hub_archive_query(HubArchive* a, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                      HubArchiveVisit visit, void* ctx);
+
+void hub_archive_get_stats(HubArchive* a, HubArchiveStats* out);
+void hub_archive_print_stats(HubArchive* a, const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+#include "hub_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
+
+typedef enum { KEY_INT, KEY_STR } KeyType;
+
+typedef struct {
+    const char* name;
+    KeyType type;
+    size_t cfg_off;   // CollectorHubConfig 안 위치
+    size_t str_off;   // KEY_STR: HubConfigStrings 안 버퍼 위치
+    size_t str_sz;
+} HubConfigKey;
+
+#define INT_KEY(f) { #f, KEY_INT, offsetof(CollectorHubConfig, f), 0, 0 }
+#define STR_KEY(f) { #f, KEY_STR, offsetof(CollectorHubConfig, f), \
+                     offsetof(HubConfigStrings, f), sizeof(((HubConfigStrings*)0)->f) }
+
+// 실행 중에 바꿀 수 있는 키만 (나머지는 collector_hub_reconfigure가 무시)
+static const HubConfigKey g_keys[] = {
+    STR_KEY(watch_fifo_path),
+    STR_KEY(rulebase_in_fifo_path),
+    STR_KEY(rulebase_out_fifo_path),
+    STR_KEY(th_ip),
+    INT_KEY(th_port),
+    INT_KEY(th_slave_id),
+    INT_KEY(th_min_interval_ms),
+    INT_KEY(th_max_interval_ms),
+    INT_KEY(collect_interval_sec),
+    INT_KEY(max_devices),
+    INT_KEY(device_stale_sec),
+    INT_KEY(emit_parallel_min),
+    INT_KEY(state_max_age_sec),
+    INT_KEY(state_checkpoint_ms),
+    INT_KEY(log_th),
+    INT_KEY(log_watch),
+    INT_KEY(log_rule_in),
+    INT_KEY(log_rule_out),
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static char* _trim(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) e--;
+    *e = '\0';
+    return s;
+}
+
+// ================================
+// 외부 API
+// ================================
+int hub_config_load(const char* path, CollectorHubConfig* cfg, HubConfigStrings* strs) {
+    if (!path || !cfg || !strs) return -1;
+
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        perror("fopen hub config");
+        return -1;
+    }
+    memset(strs, 0, sizeof(*strs));
+
+    char line[512];
+    int lineno = 0;
+    int applied = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char* eq = strchr(line, '=');
+        char* key = _trim(line);
+        if (*key == '\0') continue;
+        if (!eq) {
+            fprintf(stderr, "⚠️ [HUB][CONF] %s:%d no '='\n", path, lineno);
+            continue;
+        }
+        *eq = '\0';
+        key = _trim(key);
+        char* val = _trim(eq + 1);
+
+        const HubConfigKey* k = NULL;
+        for (size_t i = 0; i < sizeof(g_keys) / sizeof(g_keys[0]); i++) {
+            if (strcmp(g_keys[i].name, key) == 0) { k = &g_keys[i]; break; }
+        }
+        if (!k) {
+            fprintf(stderr, "⚠️ [HUB][CONF] %s:%d unknown key '%s'\n", path, lineno, key);
+            continue;
+        }
+
+        if (k->type == KEY_INT) {
+            char* end = NULL;
+            long v = strtol(val, &end, 10);
+            if (end == val || *end != '\0') {
+                fprintf(stderr, "⚠️ [HUB][CONF] %s:%d bad number '%s'\n", path, lineno, val);
+                continue;
+            }
+            *(int*)((char*)cfg + k->cfg_off) = (int)v;
+        } else {
+            char* buf = (char*)strs + k->str_off;
+            snprintf(buf, k->str_sz, "%s", val);
+            *(const char**)((char*)cfg + k->cfg_off) = buf;
+        }
+        applied++;
+    }
+
+    fclose(fp);
+    return applied;
+}
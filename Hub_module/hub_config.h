@@ -0,0 +1,33 @@
+#ifndef HUB_CONFIG_H
+#define HUB_CONFIG_H
+
+/*
+허브 설정 파일 (collector_hub_reload_file / reload_file_path)
+- 한 줄에 key = value, '#' 뒤는 주석
+- key는 CollectorHubConfig 필드 이름 그대로 (예: collect_interval_sec = 3)
+- 파일에 있는 키만 덮어쓰고 나머지는 그대로
+*/
+
+#include "collector_hub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 파일에서 읽은 문자열 값 보관 (cfg의 문자열 필드가 여기를 가리킴)
+typedef struct {
+    char watch_fifo_path[256];
+    char rulebase_in_fifo_path[256];
+    char rulebase_out_fifo_path[256];
+    char th_ip[64];
+} HubConfigStrings;
+
+// return: 적용한 키 수 (>=0), 파일을 못 열면 -1
+// 모르는 키 / 잘못된 값은 경고만 찍고 건너뜀
+int hub_config_load(const char* path, CollectorHubConfig* cfg, HubConfigStrings* strs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
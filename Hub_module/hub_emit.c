@@ -0,0 +1,253 @@
+#include "hub_emit.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "mem_pool.h"
+#include "rt_pool.h"
+
+typedef struct {
+    struct HubEmit* e;
+    int lo, hi;             // 레코드 구간 [lo, hi)
+    long seq_base;          // 이 shard 첫 줄 seq - 1 (앞 shard가 실패 없이 다 썼다고 보고 시작)
+
+    char* buf;              // 줄 + '\n' 연속
+    size_t len, cap;
+    int lines;
+    int failed;
+    MemArena arena;
+} HubEmitShard;
+
+typedef struct {
+    uint64_t ticks;
+    uint64_t devices;
+    uint64_t sum_us;
+    uint64_t max_us;
+    int max_devices;        // max_us였던 tick의 디바이스 수
+} HubEmitBucket;
+
+struct HubEmit {
+    int workers;
+    int line_max;
+    RtPool* pool;           // workers - 1개 (shard 0은 호출한 스레드)
+    HubEmitShard shard[HUB_EMIT_MAX_WORKERS];
+    int used;               // 마지막 run의 shard 수
+
+    HubEmitFormatFn fn;
+    void* ctx;
+
+    // 워커 shard 끝남 대기
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+    int remaining;
+
+    // rule_in 스레드만 씀
+    HubEmitBucket bucket[HUB_EMIT_BUCKETS];
+    uint64_t par_ticks;
+};
+
+// ================================
+// shard 실행
+// ================================
+static int _reserve(HubEmitShard* s, size_t need) {
+    if (s->cap - s->len >= need) return 0;
+    size_t cap = s->cap ? s->cap : 64 * 1024;
+    while (cap - s->len < need) cap *= 2;
+    char* n = (char*)realloc(s->buf, cap);
+    if (!n) return -1;
+    s->buf = n;
+    s->cap = cap;
+    return 0;
+}
+
+static void _shard_run(HubEmitShard* s) {
+    HubEmit* e = s->e;
+    MemArena* prev = mem_arena_bound();
+    mem_arena_bind(&s->arena);
+    s->len = 0;
+    s->lines = 0;
+    s->failed = 0;
+
+    for (int i = s->lo; i < s->hi; i++) {
+        // PrintPreallocated가 버퍼 끝에 바로 쓰도록 한 줄 + '\n' 자리를 미리
+        if (_reserve(s, (size_t)e->line_max + 1) != 0) {
+            s->failed += s->hi - i;
+            break;
+        }
+        // seq는 써진 줄에만 (실패한 레코드는 번호를 안 씀)
+        int n = e->fn(e->ctx, i, s->seq_base + 1 + (long)s->lines, s->buf + s->len, e->line_max);
+        mem_arena_reset(&s->arena);
+        if (n < 0) {
+            s->failed++;
+            continue;
+        }
+        s->len += (size_t)n;
+        s->buf[s->len++] = '\n';
+        s->lines++;
+    }
+
+    mem_arena_bind(prev);
+}
+
+static void _shard_task(void* arg) {
+    HubEmitShard* s = (HubEmitShard*)arg;
+    _shard_run(s);
+
+    HubEmit* e = s->e;
+    pthread_mutex_lock(&e->mtx);
+    if (--e->remaining == 0) pthread_cond_signal(&e->cv);
+    pthread_mutex_unlock(&e->mtx);
+}
+
+// ================================
+// 외부 API
+// ================================
+HubEmit* hub_emit_create(int workers, int line_max, size_t arena_bytes) {
+    if (workers < 1) workers = 1;
+    if (workers > HUB_EMIT_MAX_WORKERS) workers = HUB_EMIT_MAX_WORKERS;
+    if (line_max <= 0) return NULL;
+
+    HubEmit* e = (HubEmit*)calloc(1, sizeof(HubEmit));
+    if (!e) return NULL;
+    e->workers = workers;
+    e->line_max = line_max;
+    pthread_mutex_init(&e->mtx, NULL);
+    pthread_cond_init(&e->cv, NULL);
+
+    for (int k = 0; k < workers; k++) {
+        e->shard[k].e = e;
+        if (mem_arena_init(&e->shard[k].arena, arena_bytes) != 0) {
+            hub_emit_destroy(e);
+            return NULL;
+        }
+    }
+    if (workers > 1) {
+        e->pool = rt_pool_create(workers - 1, "hub-emit", NULL);
+        if (!e->pool) {
+            hub_emit_destroy(e);
+            return NULL;
+        }
+    }
+    return e;
+}
+
+void hub_emit_destroy(HubEmit* e) {
+    if (!e) return;
+    rt_pool_destroy(e->pool);
+    for (int k = 0; k < e->workers; k++) {
+        free(e->shard[k].buf);
+        mem_arena_destroy(&e->shard[k].arena);
+    }
+    pthread_cond_destroy(&e->cv);
+    pthread_mutex_destroy(&e->mtx);
+    free(e);
+}
+
+int hub_emit_run(HubEmit* e, int n, int par_min, long seq_base, HubEmitFormatFn fn, void* ctx, int* failed) {
+    if (failed) *failed = 0;
+    e->used = 0;
+    if (n <= 0 || !fn) return 0;
+
+    // shard 하나가 par_min 이상은 맡게 (작은 tick은 나눠도 깨우는 비용만 듦)
+    int k = 1;
+    if (e->pool && par_min > 0) {
+        k = n / par_min;
+        if (k < 1) k = 1;
+        if (k > e->workers) k = e->workers;
+    } else if (e->pool) {
+        k = e->workers;
+    }
+
+    e->fn = fn;
+    e->ctx = ctx;
+    e->used = k;
+    for (int s = 0; s < k; s++) {
+        HubEmitShard* sh = &e->shard[s];
+        sh->lo = (int)((int64_t)n * s / k);
+        sh->hi = (int)((int64_t)n * (s + 1) / k);
+        sh->seq_base = seq_base + sh->lo;
+    }
+
+    if (k > 1) {
+        e->par_ticks++;
+        pthread_mutex_lock(&e->mtx);
+        e->remaining = k - 1;
+        pthread_mutex_unlock(&e->mtx);
+
+        for (int s = 1; s < k; s++) {
+            if (rt_pool_submit(e->pool, _shard_task, &e->shard[s]) != 0) {
+                // 풀이 못 받으면 여기서 직접
+                _shard_task(&e->shard[s]);
+            }
+        }
+    }
+
+    _shard_run(&e->shard[0]);
+
+    if (k > 1) {
+        pthread_mutex_lock(&e->mtx);
+        while (e->remaining > 0) pthread_cond_wait(&e->cv, &e->mtx);
+        pthread_mutex_unlock(&e->mtx);
+    }
+
+    // 앞 shard에서 실패한 만큼 뒤 shard seq가 떠 있음 → 그 shard만 맞는 seq로 다시 포맷
+    // (포맷 실패는 줄이 line_max를 넘는 경우라 드묾, 같은 레코드는 다시 해도 같은 결과)
+    int lines = 0, fail = 0;
+    for (int s = 0; s < k; s++) {
+        HubEmitShard* sh = &e->shard[s];
+        if (sh->seq_base != seq_base + lines) {
+            sh->seq_base = seq_base + lines;
+            _shard_run(sh);
+        }
+        lines += sh->lines;
+        fail += sh->failed;
+    }
+    if (failed) *failed = fail;
+    return lines;
+}
+
+int hub_emit_iov(const HubEmit* e, struct iovec* iov, int max) {
+    int n = 0;
+    for (int s = 0; s < e->used && n < max; s++) {
+        if (e->shard[s].len == 0) continue;
+        iov[n].iov_base = e->shard[s].buf;
+        iov[n].iov_len = e->shard[s].len;
+        n++;
+    }
+    return n;
+}
+
+int hub_emit_workers(const HubEmit* e) {
+    return e ? e->workers : 0;
+}
+
+void hub_emit_record_tick(HubEmit* e, int devices, uint64_t us) {
+    if (!e || devices <= 0) return;
+
+    int b = devices < 100 ? 0 : devices < 1000 ? 1 : devices < 10000 ? 2 : 3;
+    HubEmitBucket* k = &e->bucket[b];
+    k->ticks++;
+    k->devices += (uint64_t)devices;
+    k->sum_us += us;
+    if (us > k->max_us) {
+        k->max_us = us;
+        k->max_devices = devices;
+    }
+}
+
+void hub_emit_print_stats(const HubEmit* e, const char* tag) {
+    static const char* names[HUB_EMIT_BUCKETS] = { "<100", "<1k", "<10k", ">=10k" };
+    if (!e) return;
+
+    printf("📊 %s workers=%d parallel_ticks=%llu\n", tag, e->workers, (unsigned long long)e->par_ticks);
+    for (int b = 0; b < HUB_EMIT_BUCKETS; b++) {
+        const HubEmitBucket* k = &e->bucket[b];
+        if (!k->ticks) continue;
+        printf("📊 %s devices %-5s ticks=%llu avg=%lluus (%llu dev) max=%lluus (%d dev) per_dev=%lluns\n", tag,
+               names[b], (unsigned long long)k->ticks, (unsigned long long)(k->sum_us / k->ticks),
+               (unsigned long long)(k->devices / k->ticks), (unsigned long long)k->max_us, k->max_devices,
+               (unsigned long long)(k->sum_us * 1000ULL / k->devices));
+    }
+}
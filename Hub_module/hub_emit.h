@@ -0,0 +1,54 @@
+#ifndef HUB_EMIT_H
+#define HUB_EMIT_H
+
+/*
+SENSOR 라인 병렬 포맷 (rule_in tick에서 deadline 된 디바이스가 많을 때)
+- 레코드 n개(디바이스 스냅샷, 허브가 락 안에서 모아둔 것)를 연속 구간 shard로 나눔
+  shard 0은 호출한 스레드(rule_in)가, 나머지는 워커(rt_pool)가 각자 버퍼에 포맷
+- seq는 써진 줄에만 빈 번호 없이: seq_base + 1, + 2, ... (포맷 실패한 레코드는 번호를 안 씀)
+  shard는 앞 구간이 다 써진다고 보고 시작, 앞에서 실패가 있었으면 끝나고 그 뒤 shard만 다시 포맷
+- 결과는 shard 순서대로 iovec → 허브가 writev 한 번으로 rulebase_in에
+- shard마다 cJSON arena (줄마다 reset) + 출력 버퍼 (모자라면 2배, 이후 재사용)
+- tick 시간은 디바이스 수 구간별로 집계 (hub_emit_record_tick / hub_emit_print_stats)
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_EMIT_MAX_WORKERS 16
+#define HUB_EMIT_PAR_MIN     512   // 이보다 적으면 나누지 않음 (emit_parallel_min 기본값)
+#define HUB_EMIT_BUCKETS     4     // tick 디바이스 수: < 100, < 1000, < 10000, 그 이상
+
+// 레코드 i 한 줄을 line(cap 바이트, '\n' 없이)에 씀, seq는 이 줄의 seq
+// return: 길이, 실패(cap 초과 등)면 -1 → 그 레코드는 건너뜀 (seq는 다음 레코드가 그대로 씀)
+// 여러 스레드에서 동시에 불림 (레코드/공용 값은 읽기만)
+typedef int (*HubEmitFormatFn)(void* ctx, int i, long seq, char* line, int cap);
+
+typedef struct HubEmit HubEmit;
+
+// workers: 포맷에 쓰는 스레드 수 (호출한 스레드 포함, 1이면 워커 없음)
+HubEmit* hub_emit_create(int workers, int line_max, size_t arena_bytes);
+void hub_emit_destroy(HubEmit* e);
+
+// n개 포맷 (n < par_min 이면 shard 1개), 끝날 때까지 block
+// return: 쓴 줄 수 (seq_base + 1 .. seq_base + 쓴 줄 수), *failed = fn 실패 수
+int hub_emit_run(HubEmit* e, int n, int par_min, long seq_base, HubEmitFormatFn fn, void* ctx, int* failed);
+
+// 마지막 run 결과 (빈 shard 빼고 순서대로, return: 개수)
+int hub_emit_iov(const HubEmit* e, struct iovec* iov, int max);
+
+int hub_emit_workers(const HubEmit* e);
+
+void hub_emit_record_tick(HubEmit* e, int devices, uint64_t us);
+void hub_emit_print_stats(const HubEmit* e, const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
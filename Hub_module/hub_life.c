@@ -0,0 +1,287 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // ppoll, tee
+#endif
+#include "hub_life.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+static uint64_t _now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+// ready_ms 기록 + 기다리는 쪽 깨우기 (l->mtx 잡고)
+static void _changed_locked(HubLife* l, uint64_t now_ms) {
+    if (!l->ready_ms && l->armed && l->n_ep > 0) {
+        int all_up = 1;
+        for (int i = 0; i < l->n_ep; i++) {
+            if (l->ep[i].state != HUB_EP_UP) all_up = 0;
+        }
+        if (all_up) l->ready_ms = now_ms - l->start_ms + 1;
+    }
+    pthread_cond_broadcast(&l->cv);
+}
+
+// ================================
+// 초기화 / 시작 / 정지
+// ================================
+int hub_life_init(HubLife* l) {
+    memset(l, 0, sizeof(*l));
+    atomic_init(&l->stop, 0);
+    l->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (l->efd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    pthread_mutex_init(&l->mtx, NULL);
+    pthread_cond_init(&l->cv, NULL);
+    return 0;
+}
+
+void hub_life_destroy(HubLife* l) {
+    if (l->efd < 0) return;
+    close(l->efd);
+    l->efd = -1;
+    pthread_cond_destroy(&l->cv);
+    pthread_mutex_destroy(&l->mtx);
+}
+
+int hub_life_add(HubLife* l, const char* name) {
+    pthread_mutex_lock(&l->mtx);
+    int id = -1;
+    for (int i = 0; i < l->n_ep; i++) {
+        if (strcmp(l->ep[i].name, name) == 0) id = i;
+    }
+    if (id < 0 && l->n_ep < HUB_LIFE_MAX_EP) {
+        id = l->n_ep++;
+        l->ep[id].name = name;
+    }
+    pthread_mutex_unlock(&l->mtx);
+    return id;
+}
+
+void hub_life_arm(HubLife* l) {
+    uint64_t v;
+    while (read(l->efd, &v, sizeof(v)) == (ssize_t)sizeof(v)) {}
+
+    uint64_t now = _now_ms();
+    pthread_mutex_lock(&l->mtx);
+    for (int i = 0; i < l->n_ep; i++) {
+        HubEndpoint* e = &l->ep[i];
+        const char* name = e->name;
+        memset(e, 0, sizeof(*e));
+        e->name = name;
+        e->since_ms = now;
+    }
+    l->start_ms = now;
+    l->ready_ms = 0;
+    l->armed = 1;
+    atomic_store_explicit(&l->stop, 0, memory_order_release);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+void hub_life_request_stop(HubLife* l) {
+    // 시그널 핸들러에서도 불림 → atomic store + write만
+    atomic_store_explicit(&l->stop, 1, memory_order_release);
+    uint64_t one = 1;
+    ssize_t w = write(l->efd, &one, sizeof(one));
+    (void)w;
+    // wait_state로 기다리는 쪽은 cv를 100ms마다 다시 확인
+}
+
+void hub_life_disarm(HubLife* l) {
+    pthread_mutex_lock(&l->mtx);
+    l->armed = 0;
+    pthread_cond_broadcast(&l->cv);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+// ================================
+// 대기
+// ================================
+int hub_life_wait_ms(HubLife* l, int timeout_ms) {
+    if (hub_life_stopping(l)) return 1;
+    struct pollfd pf = { l->efd, POLLIN, 0 };
+    int r;
+    do {
+        r = poll(&pf, 1, timeout_ms);
+    } while (r < 0 && errno == EINTR && !hub_life_stopping(l));
+    return hub_life_stopping(l);
+}
+
+int hub_life_wait_until(HubLife* l, const struct timespec* abs_mono) {
+    for (;;) {
+        if (hub_life_stopping(l)) return 1;
+
+        struct timespec now, rel;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        rel.tv_sec = abs_mono->tv_sec - now.tv_sec;
+        rel.tv_nsec = abs_mono->tv_nsec - now.tv_nsec;
+        if (rel.tv_nsec < 0) {
+            rel.tv_sec -= 1;
+            rel.tv_nsec += 1000000000L;
+        }
+        if (rel.tv_sec < 0) return 0;
+
+        struct pollfd pf = { l->efd, POLLIN, 0 };
+        int r = ppoll(&pf, 1, &rel, NULL);
+        if (r == 0) return 0;
+        if (r < 0 && errno != EINTR) return hub_life_stopping(l);
+    }
+}
+
+// ================================
+// endpoint
+// ================================
+int hub_life_due(HubLife* l, int ep, uint64_t now_ms) {
+    if (ep < 0) return 1;
+    return l->ep[ep].state != HUB_EP_RETRY || now_ms >= l->ep[ep].next_try_ms;
+}
+
+int hub_life_retry_in_ms(HubLife* l, int ep, uint64_t now_ms) {
+    if (ep < 0 || l->ep[ep].state != HUB_EP_RETRY || now_ms >= l->ep[ep].next_try_ms) return 0;
+    return (int)(l->ep[ep].next_try_ms - now_ms);
+}
+
+void hub_life_up(HubLife* l, int ep, uint64_t now_ms) {
+    if (ep < 0) return;
+    HubEndpoint* e = &l->ep[ep];
+    if (e->state == HUB_EP_UP) return;
+
+    pthread_mutex_lock(&l->mtx);
+    if (e->state == HUB_EP_RETRY) {
+        printf("🔁 [HUB][LIFE] %s up after %llu ms (%llu retries)\n", e->name,
+               (unsigned long long)(now_ms - e->since_ms), (unsigned long long)e->retries);
+    }
+    e->state = HUB_EP_UP;
+    e->since_ms = now_ms;
+    e->backoff_ms = 0;
+    e->ups++;
+    _changed_locked(l, now_ms);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+void hub_life_fail(HubLife* l, int ep, int err, uint64_t now_ms, const char* tag) {
+    if (ep < 0) return;
+    HubEndpoint* e = &l->ep[ep];
+
+    pthread_mutex_lock(&l->mtx);
+    if (e->state != HUB_EP_RETRY) {
+        // 상태가 바뀔 때만 로그 (재시도마다 찍지 않음)
+        fprintf(stderr, "⚠️ %s %s down: %s → retrying\n", tag, e->name, strerror(err));
+        e->state = HUB_EP_RETRY;
+        e->since_ms = now_ms;
+        e->backoff_ms = HUB_LIFE_RETRY_MIN_MS;
+    } else {
+        e->retries++;
+        e->backoff_ms *= 2;
+        if (e->backoff_ms > HUB_LIFE_RETRY_MAX_MS) e->backoff_ms = HUB_LIFE_RETRY_MAX_MS;
+    }
+    e->last_errno = err;
+    e->next_try_ms = now_ms + (uint64_t)e->backoff_ms;
+    _changed_locked(l, now_ms);
+    pthread_mutex_unlock(&l->mtx);
+}
+
+// 빈 FIFO에서 tee: writer가 없으면 0 (EOF), 있으면 EAGAIN, 데이터가 있으면 1바이트 복사 (원본은 그대로)
+// 복사받을 pipe는 확인할 때만 잠깐 (재시도 timer 주기라 자주 안 옴)
+int hub_life_fifo_writer(int fd) {
+    int p[2];
+    if (pipe2(p, O_NONBLOCK | O_CLOEXEC) != 0) return -1;
+    ssize_t n = tee(fd, p[1], 1, SPLICE_F_NONBLOCK);
+    int err = errno;
+    close(p[0]);
+    close(p[1]);
+    if (n > 0) return 1;
+    if (n == 0) return 0;
+    if (err == EAGAIN) return 1;
+    errno = err;
+    return -1;
+}
+
+// ================================
+// 상태
+// ================================
+static HubLifeState _state_locked(const HubLife* l) {
+    if (!l->armed || atomic_load(&l->stop)) return HUB_LIFE_STOPPED;
+    HubLifeState s = HUB_LIFE_READY;
+    for (int i = 0; i < l->n_ep; i++) {
+        if (l->ep[i].state == HUB_EP_INIT) return HUB_LIFE_STARTING;
+        if (l->ep[i].state == HUB_EP_RETRY) s = HUB_LIFE_DEGRADED;
+    }
+    return s;
+}
+
+HubLifeState hub_life_state(HubLife* l) {
+    pthread_mutex_lock(&l->mtx);
+    HubLifeState s = _state_locked(l);
+    pthread_mutex_unlock(&l->mtx);
+    return s;
+}
+
+const char* hub_life_state_name(HubLifeState s) {
+    switch (s) {
+    case HUB_LIFE_STOPPED: return "STOPPED";
+    case HUB_LIFE_STARTING: return "STARTING";
+    case HUB_LIFE_DEGRADED: return "DEGRADED";
+    case HUB_LIFE_READY: return "READY";
+    }
+    return "?";
+}
+
+HubLifeState hub_life_wait_state(HubLife* l, HubLifeState want, int timeout_ms) {
+    struct timespec dl;
+    clock_gettime(CLOCK_REALTIME, &dl);
+    dl.tv_sec += timeout_ms / 1000;
+    dl.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (dl.tv_nsec >= 1000000000L) {
+        dl.tv_sec += 1;
+        dl.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&l->mtx);
+    HubLifeState s = _state_locked(l);
+    while (s < want && l->armed && !atomic_load(&l->stop)) {
+        // request_stop은 cv를 안 깨우므로 (시그널 안전) 잘게 나눠서 확인
+        struct timespec step;
+        clock_gettime(CLOCK_REALTIME, &step);
+        step.tv_nsec += 100 * 1000000L;
+        if (step.tv_nsec >= 1000000000L) {
+            step.tv_sec += 1;
+            step.tv_nsec -= 1000000000L;
+        }
+        int last = step.tv_sec > dl.tv_sec || (step.tv_sec == dl.tv_sec && step.tv_nsec >= dl.tv_nsec);
+        pthread_cond_timedwait(&l->cv, &l->mtx, last ? &dl : &step);
+        s = _state_locked(l);
+        if (last) {
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            if (now.tv_sec > dl.tv_sec || (now.tv_sec == dl.tv_sec && now.tv_nsec >= dl.tv_nsec)) break;
+        }
+    }
+    pthread_mutex_unlock(&l->mtx);
+    return s;
+}
+
+void hub_life_print(HubLife* l, const char* tag) {
+    uint64_t now = _now_ms();
+    pthread_mutex_lock(&l->mtx);
+    HubLifeState s = _state_locked(l);
+    printf("🚦 %s state=%s ready_after=%llums\n", tag, hub_life_state_name(s), (unsigned long long)l->ready_ms);
+    for (int i = 0; i < l->n_ep; i++) {
+        const HubEndpoint* e = &l->ep[i];
+        static const char* names[] = { "INIT", "RETRY", "UP" };
+        printf("🚦 %s   %-10s %-5s for %llums ups=%llu retries=%llu%s%s\n", tag, e->name, names[e->state],
+               (unsigned long long)(now - e->since_ms), (unsigned long long)e->ups,
+               (unsigned long long)e->retries, e->last_errno ? " last=" : "",
+               e->last_errno ? strerror(e->last_errno) : "");
+    }
+    pthread_mutex_unlock(&l->mtx);
+}
@@ -0,0 +1,112 @@
+#ifndef HUB_LIFE_H
+#define HUB_LIFE_H
+
+/*
+허브 시작 / 정지 / 준비 상태 (collector_hub, 샤드 라우터)
+- 정지: atomic 플래그 + eventfd 하나 (request_stop이 write)
+  스레드는 sleep / poll / io_engine 대기에 이 fd를 같이 걸어서 바로 깨어남 (fd는 읽지 않음 → 계속 readable)
+- endpoint: 스레드마다 붙는 바깥쪽 끝 (FIFO 상대 프로세스, MQ, TH 장비)
+    INIT  → 첫 시도 전
+    RETRY → 상대가 없거나 실패, backoff(100ms → 2배 → 최대 2s) 뒤 다시 (그동안 스레드는 나머지 일 계속)
+    UP    → 연결됨 (FIFO는 상대 프로세스가 반대쪽을 열고 있을 때만, 자기 fd로 끝을 채워두지 않음)
+- 상태: STOPPED / STARTING(INIT인 endpoint 있음) / DEGRADED(RETRY 있음) / READY(전부 UP)
+  (샤드 그룹은 shard 중 가장 낮은 상태)
+*/
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_LIFE_MAX_EP       8
+#define HUB_LIFE_RETRY_MIN_MS 100
+#define HUB_LIFE_RETRY_MAX_MS 2000
+
+typedef enum {
+    HUB_LIFE_STOPPED = 0,
+    HUB_LIFE_STARTING,
+    HUB_LIFE_DEGRADED,
+    HUB_LIFE_READY
+} HubLifeState;
+
+typedef enum {
+    HUB_EP_INIT = 0,
+    HUB_EP_RETRY,
+    HUB_EP_UP
+} HubEpState;
+
+typedef struct {
+    const char* name;
+    HubEpState state;
+    int backoff_ms;
+    uint64_t next_try_ms;  // CLOCK_MONOTONIC
+    uint64_t since_ms;     // 지금 상태가 된 시각
+    int last_errno;
+    uint64_t retries;
+    uint64_t ups;          // UP이 된 횟수 (다시 붙은 것 포함)
+} HubEndpoint;
+
+typedef struct {
+    atomic_int stop;
+    int efd;                 // 정지 eventfd (EFD_NONBLOCK)
+    int armed;               // start ~ stop 사이
+
+    // endpoint / 상태 (상태 바뀔 때만 락, 기다리는 쪽은 cv)
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+    int n_ep;
+    HubEndpoint ep[HUB_LIFE_MAX_EP];
+    uint64_t start_ms;
+    uint64_t ready_ms;       // 처음 READY까지 걸린 시간 (0이면 아직)
+} HubLife;
+
+// return: 0 성공, -1 eventfd 실패
+int hub_life_init(HubLife* l);
+void hub_life_destroy(HubLife* l);
+
+// endpoint 등록 (스레드 시작 전, name은 계속 살아있는 문자열), return: 번호 / -1 꽉 참
+int hub_life_add(HubLife* l, const char* name);
+
+// 시작: 정지 플래그 / eventfd 비우고 endpoint 전부 INIT
+void hub_life_arm(HubLife* l);
+// 정지 요청 (아무 스레드에서나, 시그널 핸들러에서도 됨)
+void hub_life_request_stop(HubLife* l);
+// join 끝난 뒤 STOPPED로
+void hub_life_disarm(HubLife* l);
+
+static inline int hub_life_stopping(HubLife* l) {
+    return atomic_load_explicit(&l->stop, memory_order_acquire);
+}
+static inline int hub_life_fd(const HubLife* l) {
+    return l->efd;
+}
+
+// 대기 (정지 요청이 오면 바로 깨어남), return: 1 정지 요청, 0 시간 다 됨
+int hub_life_wait_ms(HubLife* l, int timeout_ms);
+int hub_life_wait_until(HubLife* l, const struct timespec* abs_mono);
+
+// endpoint 상태 (그 endpoint를 쓰는 스레드가 호출)
+int hub_life_due(HubLife* l, int ep, uint64_t now_ms);      // 지금 (다시) 시도할 차례인지
+int hub_life_retry_in_ms(HubLife* l, int ep, uint64_t now_ms);
+void hub_life_up(HubLife* l, int ep, uint64_t now_ms);
+void hub_life_fail(HubLife* l, int ep, int err, uint64_t now_ms, const char* tag);
+
+// FIFO 리더 fd에 상대 writer가 있는지 (tee로 들여다보기만 함, 데이터는 안 읽음)
+// return: 1 writer 있음 또는 읽을 데이터 남음, 0 writer 없음, -1 오류(errno)
+int hub_life_fifo_writer(int fd);
+
+HubLifeState hub_life_state(HubLife* l);
+const char* hub_life_state_name(HubLifeState s);
+// want 이상이 될 때까지 (또는 정지), return: 도달한 상태 / timeout이면 그때 상태
+HubLifeState hub_life_wait_state(HubLife* l, HubLifeState want, int timeout_ms);
+void hub_life_print(HubLife* l, const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
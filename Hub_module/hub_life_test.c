@@ -0,0 +1,449 @@
+/*
+상대 프로세스가 없을 때 허브 준비 상태 / 정지 시간 확인 (rulebase / 워치 프로세스 / TH 장비 없이)
+
+빌드 (저장소 루트에서)
+gcc -O2 -o hub_life_test Hub_module/hub_life_test.c \
+    Hub_module/collector_hub.c Hub_module/hub_shard.c Hub_module/hub_snapshot.c Hub_module/hub_config.c \
+    Hub_module/hub_result.c Hub_module/hub_archive.c Hub_module/hub_emit.c Hub_module/hub_query.c \
+    Hub_module/hub_life.c \
+    TH_Module/th_module.c TH_Module/th_health.c TH_Module/th_filter.c TH_Module/th_sched.c \
+    mq_batch.c timer_wheel.c ts_parse.c shard_ring.c mem_pool.c thread_place.c flow_ctl.c io_engine.c \
+    dev_intern.c channel_reg.c rt_pool.c \
+    -I. -IHub_module -ITH_Module $(pkg-config --cflags --libs libmodbus) -lcjson -lpthread -lrt -lm
+
+실행
+./hub_life_test
+- fifo:   watch FIFO / rulebase_in / rulebase_out 상대를 하나씩 붙였다 떼면서
+          상대가 하나라도 없으면 READY가 아니고, 다 붙으면 READY, watch writer가 닫으면 다시 DEGRADED
+- router: 샤드 그룹(2) 라우터도 같은 식 (watch writer 없으면 READY 아님 → 붙으면 READY → 닫으면 DEGRADED)
+- mq:     watch MQ는 워치 프로세스가 레코드를 보내기 전엔 READY 아님
+- th:     응답 안 하는 TH 장비(accept만 하는 TCP)로 modbus 응답 대기 중에 stop → 100ms 안에 끝나야 함
+- th_bh:  SYN을 버리는 주소(accept 큐가 찬 listen 소켓)로 첫 connect 대기 중에 stop을 여러 번
+          매번 100ms 안, warm-up 뒤로 fd 수 / 힙 사용량(mallinfo2)이 안 늘어야 함 (센서 핸들 / modbus ctx / 소켓 누수)
+실패한 단계마다 ❌ 한 줄, 종료 코드 = 실패 수
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <dirent.h>
+#include <malloc.h>
+#include <mqueue.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "collector_hub.h"
+#include "hub_shard.h"
+#include "mq_batch.h"
+#include "ts_parse.h"
+
+#define TEST_DIR      "/tmp/hub_life_test"
+#define TEST_MQ       "/hub_life_test.mq"
+#define TEST_UP_MS    3000   // 상대가 붙은 뒤 UP까지 (재시도 backoff 최대 2s)
+#define TEST_DOWN_MS  1000   // 상대가 닫은 뒤 DEGRADED까지 (EOF는 바로 옴)
+#define TEST_IDLE_MS  500    // 상대 없이 이만큼 지나도 READY면 실패
+#define TEST_STOP_MS  100
+#define TEST_BH_RUNS  12     // th_bh start/stop 횟수
+#define TEST_BH_WARM  6      // 이 횟수 뒤를 기준으로 (스레드 생성 초반엔 glibc TLS 관리 할당이 조금씩 늘어남)
+#define TEST_BH_HEAP  256    // 기준 뒤 힙 증가 허용 (바이트, 새는 THSensor + ctx 하나보다 작게)
+
+typedef HubLifeState (*StateFn)(void* h);
+
+static int g_fail;
+
+static uint64_t _mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static HubLifeState _hub_state(void* h) {
+    return collector_hub_state((CollectorHub*)h);
+}
+
+static HubLifeState _group_state(void* h) {
+    return collector_hub_group_state((CollectorHubGroup*)h);
+}
+
+// want가 될 때까지 최대 ms (10ms마다 확인), return: 마지막 상태
+static HubLifeState _wait(StateFn fn, void* h, HubLifeState want, int ms) {
+    uint64_t end = _mono_ms() + (uint64_t)ms;
+    HubLifeState s = fn(h);
+    while (s != want && _mono_ms() < end) {
+        usleep(10000);
+        s = fn(h);
+    }
+    return s;
+}
+
+static void _expect(const char* step, HubLifeState got, HubLifeState want) {
+    if (got == want) {
+        printf("✅ [TEST] %s: %s\n", step, hub_life_state_name(got));
+        return;
+    }
+    printf("❌ [TEST] %s: %s (want %s)\n", step, hub_life_state_name(got), hub_life_state_name(want));
+    g_fail++;
+}
+
+// 상대 없이 TEST_IDLE_MS 동안 READY가 한 번도 안 되는지
+static void _expect_not_ready(const char* step, StateFn fn, void* h) {
+    HubLifeState s = _wait(fn, h, HUB_LIFE_READY, TEST_IDLE_MS);
+    if (s != HUB_LIFE_READY) {
+        printf("✅ [TEST] %s: %s\n", step, hub_life_state_name(s));
+        return;
+    }
+    printf("❌ [TEST] %s: READY without peer\n", step);
+    g_fail++;
+}
+
+static void _expect_stop(const char* step, uint64_t ms) {
+    if (ms < TEST_STOP_MS) {
+        printf("✅ [TEST] %s: stopped in %llu ms\n", step, (unsigned long long)ms);
+        return;
+    }
+    printf("❌ [TEST] %s: stopped in %llu ms (want < %d)\n", step, (unsigned long long)ms, TEST_STOP_MS);
+    g_fail++;
+}
+
+static int _count_fds(void) {
+    DIR* d = opendir("/proc/self/fd");
+    if (!d) return -1;
+    int n = 0;
+    while (readdir(d)) n++;
+    closedir(d);
+    return n;
+}
+
+static void _base_config(CollectorHubConfig* c, const char* tag, char* paths, size_t cap) {
+    memset(c, 0, sizeof(*c));
+    snprintf(paths, cap, "%s/%s.watch", TEST_DIR, tag);
+    snprintf(paths + cap, cap, "%s/%s.rule_in", TEST_DIR, tag);
+    snprintf(paths + 2 * cap, cap, "%s/%s.rule_out", TEST_DIR, tag);
+    snprintf(paths + 3 * cap, cap, "/hub_life_test.%s.%d", tag, (int)getpid());
+    shm_unlink(paths + 3 * cap);
+    c->watch_fifo_path = paths;
+    c->rulebase_in_fifo_path = paths + cap;
+    c->rulebase_out_fifo_path = paths + 2 * cap;
+    c->th_disabled = 1;
+    c->collect_interval_sec = 1;
+    c->max_devices = 64;
+    c->device_stale_sec = 60;
+    c->dev_intern_name = paths + 3 * cap;
+    c->dev_intern_capacity = 80;
+}
+
+static int _open_reader(const char* path) {
+    mkfifo(path, 0666);
+    return open(path, O_RDONLY | O_NONBLOCK);
+}
+
+// 허브 리더가 열릴 때까지 (ENXIO) 잠깐씩 다시
+static int _open_writer(const char* path) {
+    mkfifo(path, 0666);
+    for (int i = 0; i < 300; i++) {
+        int fd = open(path, O_WRONLY | O_NONBLOCK);
+        if (fd >= 0 || errno != ENXIO) return fd;
+        usleep(10000);
+    }
+    return -1;
+}
+
+// ================================
+// 단일 허브: FIFO endpoint 3개
+// ================================
+static void _test_fifo(void) {
+    char p[4][128];
+    CollectorHubConfig c;
+    _base_config(&c, "fifo", p[0], sizeof(p[0]));
+    CollectorHub* h = collector_hub_create(&c, NULL, NULL);
+    if (!h || collector_hub_start(h) != 0) {
+        printf("❌ [TEST] fifo: start failed\n");
+        g_fail++;
+        collector_hub_destroy(h);
+        return;
+    }
+
+    _expect_not_ready("fifo no peers", _hub_state, h);
+
+    // rulebase 쪽만 (watch writer 없음)
+    int rin = _open_reader(c.rulebase_in_fifo_path);
+    int rout = _open_writer(c.rulebase_out_fifo_path);
+    _expect_not_ready("fifo rulebase only (no watch writer)", _hub_state, h);
+
+    // watch writer + rulebase_in 리더만 (rulebase_out writer 없음)
+    int w = _open_writer(c.watch_fifo_path);
+    close(rout);
+    rout = -1;
+    _expect_not_ready("fifo without rulebase_out writer", _hub_state, h);
+
+    rout = _open_writer(c.rulebase_out_fifo_path);
+    _expect("fifo all peers", _wait(_hub_state, h, HUB_LIFE_READY, TEST_UP_MS), HUB_LIFE_READY);
+
+    close(w);
+    _expect("fifo watch writer closed", _wait(_hub_state, h, HUB_LIFE_DEGRADED, TEST_DOWN_MS), HUB_LIFE_DEGRADED);
+
+    w = _open_writer(c.watch_fifo_path);
+    _expect("fifo watch writer back", _wait(_hub_state, h, HUB_LIFE_READY, TEST_UP_MS), HUB_LIFE_READY);
+
+    uint64_t t0 = _mono_ms();
+    collector_hub_stop(h);
+    _expect_stop("fifo stop", _mono_ms() - t0);
+    collector_hub_destroy(h);
+
+    close(w);
+    close(rin);
+    close(rout);
+    shm_unlink(c.dev_intern_name);
+}
+
+// ================================
+// 샤드 그룹: 라우터 endpoint
+// ================================
+static void _test_router(void) {
+    char p[4][128];
+    CollectorHubConfig c;
+    _base_config(&c, "router", p[0], sizeof(p[0]));
+    CollectorHubGroup* g = collector_hub_group_create(&c, 2, 0, NULL, NULL);
+    if (!g || collector_hub_group_start(g) != 0) {
+        printf("❌ [TEST] router: start failed\n");
+        g_fail++;
+        collector_hub_group_destroy(g);
+        return;
+    }
+
+    // shard별 rulebase 상대는 다 붙여두고 watch writer만 빼봄
+    int rin[2], rout[2];
+    for (int k = 0; k < 2; k++) {
+        char path[160];
+        snprintf(path, sizeof(path), "%s.%d", c.rulebase_in_fifo_path, k);
+        rin[k] = _open_reader(path);
+        snprintf(path, sizeof(path), "%s.%d", c.rulebase_out_fifo_path, k);
+        rout[k] = _open_writer(path);
+    }
+    _expect_not_ready("router no watch writer", _group_state, g);
+
+    int w = _open_writer(c.watch_fifo_path);
+    _expect("router watch writer", _wait(_group_state, g, HUB_LIFE_READY, TEST_UP_MS), HUB_LIFE_READY);
+
+    close(w);
+    _expect("router watch writer closed", _wait(_group_state, g, HUB_LIFE_DEGRADED, TEST_DOWN_MS),
+            HUB_LIFE_DEGRADED);
+
+    uint64_t t0 = _mono_ms();
+    collector_hub_group_stop(g);
+    _expect_stop("router stop", _mono_ms() - t0);
+    collector_hub_group_destroy(g);
+
+    for (int k = 0; k < 2; k++) {
+        close(rin[k]);
+        close(rout[k]);
+    }
+    shm_unlink(c.dev_intern_name);
+}
+
+// ================================
+// watch MQ: 첫 레코드 전엔 상대 없음
+// ================================
+static void _test_mq(void) {
+    char p[4][128];
+    CollectorHubConfig c;
+    _base_config(&c, "mq", p[0], sizeof(p[0]));
+    c.watch_mq_name = TEST_MQ;
+    mq_unlink(TEST_MQ);
+    CollectorHub* h = collector_hub_create(&c, NULL, NULL);
+    if (!h || collector_hub_start(h) != 0) {
+        printf("❌ [TEST] mq: start failed\n");
+        g_fail++;
+        collector_hub_destroy(h);
+        return;
+    }
+    int rin = _open_reader(c.rulebase_in_fifo_path);
+    int rout = _open_writer(c.rulebase_out_fifo_path);
+    _expect_not_ready("mq no records", _hub_state, h);
+
+    // 워치 프로세스 역할: 레코드 1개
+    mqd_t q = (mqd_t)-1;
+    for (int i = 0; i < 100 && q == (mqd_t)-1; i++) {
+        q = mq_open(TEST_MQ, O_WRONLY | O_NONBLOCK);
+        if (q == (mqd_t)-1) usleep(10000);
+    }
+    MQBatcher b;
+    if (q == (mqd_t)-1 || mq_batch_init(&b, q, sizeof(WatchMsg), 8, 0) != 0) {
+        printf("❌ [TEST] mq: producer open failed (%s)\n", strerror(errno));
+        g_fail++;
+    } else {
+        WatchMsg m;
+        memset(&m, 0, sizeof(m));
+        m.present = 1;
+        m.dev_ts_ms = m.rx_ts_ms = ts_now_ms();
+        m.vals[0] = 70.0;
+        mq_batch_push(&b, &m);
+        mq_batch_flush(&b);
+        _expect("mq first record", _wait(_hub_state, h, HUB_LIFE_READY, TEST_UP_MS), HUB_LIFE_READY);
+        mq_batch_destroy(&b);
+    }
+
+    uint64_t t0 = _mono_ms();
+    collector_hub_stop(h);
+    _expect_stop("mq stop", _mono_ms() - t0);
+    collector_hub_destroy(h);
+
+    if (q != (mqd_t)-1) mq_close(q);
+    mq_unlink(TEST_MQ);
+    close(rin);
+    close(rout);
+    shm_unlink(c.dev_intern_name);
+}
+
+// ================================
+// TH: 응답 없는 장비 → modbus 응답 대기 중 stop
+// ================================
+static void _test_th(void) {
+    // accept 안 해도 listen backlog로 connect는 됨 → modbus는 응답 timeout(1s)까지 대기
+    int ls = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(a);
+    if (ls < 0 || bind(ls, (struct sockaddr*)&a, sizeof(a)) != 0 || listen(ls, 8) != 0 ||
+        getsockname(ls, (struct sockaddr*)&a, &alen) != 0) {
+        printf("❌ [TEST] th: listen failed (%s)\n", strerror(errno));
+        g_fail++;
+        if (ls >= 0) close(ls);
+        return;
+    }
+
+    char p[4][128];
+    CollectorHubConfig c;
+    _base_config(&c, "th", p[0], sizeof(p[0]));
+    c.watch_ingest_external = 1;
+    c.th_disabled = 0;
+    c.th_ip = "127.0.0.1";
+    c.th_port = ntohs(a.sin_port);
+    c.th_min_interval_ms = 100;
+    c.th_max_interval_ms = 100;
+    CollectorHub* h = collector_hub_create(&c, NULL, NULL);
+    if (!h || collector_hub_start(h) != 0) {
+        printf("❌ [TEST] th: start failed\n");
+        g_fail++;
+        collector_hub_destroy(h);
+        close(ls);
+        return;
+    }
+    int rin = _open_reader(c.rulebase_in_fifo_path);
+    int rout = _open_writer(c.rulebase_out_fifo_path);
+    _expect_not_ready("th device silent", _hub_state, h);
+
+    // 첫 read의 응답 timeout(1s) 안에서 stop
+    uint64_t t0 = _mono_ms();
+    collector_hub_stop(h);
+    _expect_stop("th stop during modbus wait", _mono_ms() - t0);
+    collector_hub_destroy(h);
+
+    close(rin);
+    close(rout);
+    close(ls);
+    shm_unlink(c.dev_intern_name);
+}
+
+// ================================
+// TH: SYN이 버려지는 장비 → 첫 connect 대기 중 stop (누수 확인)
+// ================================
+static void _test_th_blackhole(void) {
+    // backlog 0 + 먼저 연결 2개로 accept 큐를 채움 → 이후 SYN은 버려져서 connect가 timeout까지 대기
+    int ls = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(a);
+    if (ls < 0 || bind(ls, (struct sockaddr*)&a, sizeof(a)) != 0 || listen(ls, 0) != 0 ||
+        getsockname(ls, (struct sockaddr*)&a, &alen) != 0) {
+        printf("❌ [TEST] th_bh: listen failed (%s)\n", strerror(errno));
+        g_fail++;
+        if (ls >= 0) close(ls);
+        return;
+    }
+    int fill[2];
+    for (int i = 0; i < 2; i++) {
+        fill[i] = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        connect(fill[i], (struct sockaddr*)&a, sizeof(a));
+    }
+    usleep(50000);
+
+    char p[4][128];
+    CollectorHubConfig c;
+    _base_config(&c, "th_bh", p[0], sizeof(p[0]));
+    c.watch_ingest_external = 1;
+    c.th_disabled = 0;
+    c.th_ip = "127.0.0.1";
+    c.th_port = ntohs(a.sin_port);
+    c.th_min_interval_ms = 100;
+    c.th_max_interval_ms = 100;
+
+    int fds0 = -1;
+    size_t heap0 = 0;
+    uint64_t worst = 0;
+    for (int run = 0; run < TEST_BH_RUNS; run++) {
+        CollectorHub* h = collector_hub_create(&c, NULL, NULL);
+        if (!h || collector_hub_start(h) != 0) {
+            printf("❌ [TEST] th_bh: start failed\n");
+            g_fail++;
+            collector_hub_destroy(h);
+            break;
+        }
+        usleep(200000); // TH 스레드가 connect 대기에 들어갈 때까지 (connect timeout 1s 안)
+        uint64_t t0 = _mono_ms();
+        collector_hub_stop(h);
+        uint64_t ms = _mono_ms() - t0;
+        if (ms > worst) worst = ms;
+        collector_hub_destroy(h);
+        shm_unlink(c.dev_intern_name);
+
+        // 앞쪽은 stdio 버퍼 / 스레드 TLS 관리처럼 처음 몇 번만 잡히는 것 때문에 기준으로만
+        if (run == TEST_BH_WARM - 1) {
+            fds0 = _count_fds();
+            heap0 = mallinfo2().uordblks;
+        }
+    }
+    _expect_stop("th_bh stop during connect (worst)", worst);
+
+    int fds = _count_fds();
+    size_t heap = mallinfo2().uordblks;
+    long long grow = (long long)heap - (long long)heap0;
+    if (fds == fds0 && grow < TEST_BH_HEAP) {
+        printf("✅ [TEST] th_bh no leak: fds=%d heap %+lld bytes over %d runs\n", fds, grow, TEST_BH_RUNS - TEST_BH_WARM);
+    } else {
+        printf("❌ [TEST] th_bh leak: fds %d → %d, heap %+lld bytes over %d runs\n", fds0, fds, grow,
+               TEST_BH_RUNS - TEST_BH_WARM);
+        g_fail++;
+    }
+
+    close(fill[0]);
+    close(fill[1]);
+    close(ls);
+}
+
+int main(void) {
+    mkdir(TEST_DIR, 0777);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    // 스레드마다 malloc arena가 새로 생기면 그 관리용 할당이 힙 증가로 보임 → arena 하나로 (th_bh 누수 확인용)
+    mallopt(M_ARENA_MAX, 1);
+
+    _test_fifo();
+    _test_router();
+    _test_mq();
+    _test_th();
+    _test_th_blackhole();
+
+    printf("%s [TEST] %d failed\n", g_fail ? "❌" : "✅", g_fail);
+    return g_fail;
+}
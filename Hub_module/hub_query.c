@@ -0,0 +1,688 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // accept4
+#endif
+#include "hub_query.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <time.h>
+
+#include "ts_parse.h"
+
+#define HUB_QUERY_LINE_MAX 256
+#define HUB_QUERY_POLL_MS  200    // 종료 확인 주기
+#define HUB_QUERY_SEND_MS  1000   // 느린 클라이언트: 남은 응답이 이만큼 하나도 안 나가면 연결 끊음
+
+_Static_assert(sizeof(HubQueryHeader) == 72, "HubQueryHeader layout");
+_Static_assert(sizeof(HubQueryRec) == 40 + DEV_INTERN_ID_LEN, "HubQueryRec layout");
+
+// ================================
+// live 테이블
+//   항목 = uint64 word 배열: [seq][version][dev | alive << 32][present][dev_ts][rx_ts][val n_ch개]
+//   모든 word를 atomic relaxed로 읽고/써서 seqlock 재시도 중에도 data race 없음
+// ================================
+enum { W_SEQ, W_VER, W_DEV, W_PRES, W_DEV_TS, W_RX_TS, W_VAL };
+enum { E_SEQ, E_VER, E_HAS, E_TEMP, E_HUMI, E_HI, E_TS, E_WORDS };
+
+struct HubLive {
+    int cap;
+    int n_ch;
+    int stride;                  // 항목당 word 수
+    _Atomic uint64_t* w;         // cap * stride
+    _Atomic uint64_t env[E_WORDS];
+    _Atomic uint64_t version;
+    _Atomic uint32_t max_dev;
+    _Atomic uint64_t retries;
+};
+
+static uint64_t _d2u(double d) {
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return u;
+}
+
+static double _u2d(uint64_t u) {
+    double d;
+    memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+static void _write_begin(_Atomic uint64_t* seq) {
+    uint64_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);   // 홀수 = 쓰는 중
+    atomic_thread_fence(memory_order_release);
+}
+
+static void _write_end(_Atomic uint64_t* seq) {
+    uint64_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+// 전역 version은 항목을 다 쓴 뒤에 올림 (쓰는 쪽 1개)
+// → 읽는 쪽이 version V를 봤으면 V 이하 항목은 전부 다 써진 상태 (SINCE V로 놓치는 것 없음)
+static void _publish(HubLive* l, uint64_t v) {
+    atomic_store_explicit(&l->version, v, memory_order_release);
+}
+
+// seq 안 바뀐 채로 n word 읽을 때까지 (return: 읽은 seq, 0이면 한 번도 안 씀)
+static uint64_t _read(HubLive* l, _Atomic uint64_t* e, uint64_t* out, int n) {
+    for (;;) {
+        uint64_t s1 = atomic_load_explicit(&e[0], memory_order_acquire);
+        if (s1 & 1u) {
+            atomic_fetch_add_explicit(&l->retries, 1, memory_order_relaxed);
+            continue;
+        }
+        for (int i = 1; i < n; i++) out[i] = atomic_load_explicit(&e[i], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&e[0], memory_order_relaxed) == s1) return s1;
+        atomic_fetch_add_explicit(&l->retries, 1, memory_order_relaxed);
+    }
+}
+
+HubLive* hub_live_create(int capacity, int n_ch) {
+    if (capacity <= 0 || n_ch <= 0 || n_ch > CHAN_MAX) return NULL;
+
+    HubLive* l = (HubLive*)calloc(1, sizeof(HubLive));
+    if (!l) return NULL;
+    l->cap = capacity;
+    l->n_ch = n_ch;
+    l->stride = W_VAL + n_ch;
+    // 큰 calloc은 안 쓴 핸들 자리만큼 실제 메모리를 안 씀
+    l->w = (_Atomic uint64_t*)calloc((size_t)capacity * (size_t)l->stride, sizeof(uint64_t));
+    if (!l->w) {
+        free(l);
+        return NULL;
+    }
+    return l;
+}
+
+void hub_live_destroy(HubLive* l) {
+    if (!l) return;
+    free(l->w);
+    free(l);
+}
+
+void hub_live_put(HubLive* l, uint32_t dev, uint32_t present, const double* val, int64_t dev_ts_ms, int64_t rx_ts_ms) {
+    if (!l || dev == 0 || dev >= (uint32_t)l->cap) return;
+
+    _Atomic uint64_t* e = l->w + (size_t)dev * (size_t)l->stride;
+    uint64_t v = atomic_load_explicit(&l->version, memory_order_relaxed) + 1;
+
+    _write_begin(&e[W_SEQ]);
+    atomic_store_explicit(&e[W_VER], v, memory_order_relaxed);
+    atomic_store_explicit(&e[W_DEV], (uint64_t)dev | (1ULL << 32), memory_order_relaxed);
+    atomic_store_explicit(&e[W_PRES], present, memory_order_relaxed);
+    atomic_store_explicit(&e[W_DEV_TS], (uint64_t)dev_ts_ms, memory_order_relaxed);
+    atomic_store_explicit(&e[W_RX_TS], (uint64_t)rx_ts_ms, memory_order_relaxed);
+    for (int c = 0; c < l->n_ch; c++) {
+        uint64_t u = ((present >> c) & 1u) ? _d2u(val[c]) : 0;
+        atomic_store_explicit(&e[W_VAL + c], u, memory_order_relaxed);
+    }
+    _write_end(&e[W_SEQ]);
+
+    if (dev > atomic_load_explicit(&l->max_dev, memory_order_relaxed)) {
+        atomic_store_explicit(&l->max_dev, dev, memory_order_release);
+    }
+    _publish(l, v);
+}
+
+void hub_live_remove(HubLive* l, uint32_t dev) {
+    if (!l || dev == 0 || dev >= (uint32_t)l->cap) return;
+
+    _Atomic uint64_t* e = l->w + (size_t)dev * (size_t)l->stride;
+    if (atomic_load_explicit(&e[W_SEQ], memory_order_relaxed) == 0) return;   // 한 번도 안 씀
+    uint64_t v = atomic_load_explicit(&l->version, memory_order_relaxed) + 1;
+
+    // 값은 그대로 두고 alive만 내림 (SINCE로 해제를 알림)
+    _write_begin(&e[W_SEQ]);
+    atomic_store_explicit(&e[W_VER], v, memory_order_relaxed);
+    atomic_store_explicit(&e[W_DEV], (uint64_t)dev, memory_order_relaxed);
+    _write_end(&e[W_SEQ]);
+    _publish(l, v);
+}
+
+void hub_live_put_env(HubLive* l, int has_env, double temp, double humi, double hi, int64_t ts_ms) {
+    if (!l) return;
+    uint64_t v = atomic_load_explicit(&l->version, memory_order_relaxed) + 1;
+
+    _write_begin(&l->env[E_SEQ]);
+    atomic_store_explicit(&l->env[E_VER], v, memory_order_relaxed);
+    atomic_store_explicit(&l->env[E_HAS], (uint64_t)(has_env != 0), memory_order_relaxed);
+    atomic_store_explicit(&l->env[E_TEMP], _d2u(temp), memory_order_relaxed);
+    atomic_store_explicit(&l->env[E_HUMI], _d2u(humi), memory_order_relaxed);
+    atomic_store_explicit(&l->env[E_HI], _d2u(hi), memory_order_relaxed);
+    atomic_store_explicit(&l->env[E_TS], (uint64_t)ts_ms, memory_order_relaxed);
+    _write_end(&l->env[E_SEQ]);
+    _publish(l, v);
+}
+
+int hub_live_get(HubLive* l, uint32_t dev, HubLiveRec* out) {
+    if (!l || dev == 0 || dev >= (uint32_t)l->cap) return 0;
+
+    uint64_t w[W_VAL + CHAN_MAX];
+    if (_read(l, l->w + (size_t)dev * (size_t)l->stride, w, l->stride) == 0) return 0;
+
+    out->dev = (uint32_t)w[W_DEV];
+    out->alive = (int)(w[W_DEV] >> 32);
+    out->present = (uint32_t)w[W_PRES];
+    out->version = w[W_VER];
+    out->dev_ts_ms = (int64_t)w[W_DEV_TS];
+    out->rx_ts_ms = (int64_t)w[W_RX_TS];
+    for (int c = 0; c < l->n_ch; c++) out->val[c] = _u2d(w[W_VAL + c]);
+    return 1;
+}
+
+void hub_live_get_env(HubLive* l, HubLiveEnv* out) {
+    memset(out, 0, sizeof(*out));
+    if (!l) return;
+
+    uint64_t w[E_WORDS];
+    if (_read(l, l->env, w, E_WORDS) == 0) return;
+    out->version = w[E_VER];
+    out->has_env = (int)w[E_HAS];
+    out->temp = _u2d(w[E_TEMP]);
+    out->humi = _u2d(w[E_HUMI]);
+    out->hi = _u2d(w[E_HI]);
+    out->ts_ms = (int64_t)w[E_TS];
+}
+
+uint64_t hub_live_version(const HubLive* l) {
+    return l ? atomic_load_explicit(&((HubLive*)l)->version, memory_order_acquire) : 0;
+}
+
+uint32_t hub_live_max_dev(const HubLive* l) {
+    return l ? atomic_load_explicit(&((HubLive*)l)->max_dev, memory_order_acquire) : 0;
+}
+
+int hub_live_channels(const HubLive* l) {
+    return l ? l->n_ch : 0;
+}
+
+uint64_t hub_live_retries(const HubLive* l) {
+    return l ? atomic_load_explicit(&((HubLive*)l)->retries, memory_order_relaxed) : 0;
+}
+
+// ================================
+// 조회 서버
+// ================================
+// fd는 non-blocking, 못 보낸 응답은 클라이언트 out에 남겨 POLLOUT에 이어서
+// (남은 게 있는 동안은 다음 요청을 안 읽음 → 클라이언트당 응답 1개 분량까지만 쌓임)
+typedef struct {
+    int fd;
+    char in[HUB_QUERY_LINE_MAX];
+    int in_len;
+    char* out;
+    size_t out_len, out_off, out_cap;
+    uint64_t stall_ms;        // out이 마지막으로 줄어든 시각 (mono)
+} QueryClient;
+
+typedef enum { Q_ALL, Q_DEV, Q_SINCE } QueryKind;
+
+struct HubQueryServer {
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int lfd;
+    HubLive* live;
+    const DevIntern* ids;
+    const ChanReg* chans;
+
+    pthread_t th;
+    atomic_int stop;
+    int wfd;                   // 정지 eventfd (poll을 바로 깨움)
+
+    QueryClient cl[HUB_QUERY_MAX_CLIENTS];
+    int n_cl;
+
+    // 응답 버퍼 (서버 스레드 전용, 커지면 그대로 재사용, 다 못 보내면 클라이언트 out과 바꿈)
+    char* out;
+    size_t out_len;
+    size_t out_cap;
+    int out_err;               // 이번 응답 만드는 중 할당 실패 (응답이 잘렸음 → 안 보내고 연결 끊음)
+
+    // 서버 스레드만 씀 (stop 뒤에 출력)
+    uint64_t accepted;
+    uint64_t rejected;
+    uint64_t queries;
+    uint64_t bad;
+    uint64_t bytes;
+    uint64_t max_bytes;
+    uint64_t slow;             // 응답을 HUB_QUERY_SEND_MS 동안 못 받아가서 끊은 연결
+    uint64_t oom;              // 응답 버퍼 할당 실패로 끊은 연결
+};
+
+static uint64_t _mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static int _out_reserve(HubQueryServer* s, size_t n) {
+    if (s->out_err) return -1;
+    if (s->out_cap - s->out_len >= n) return 0;
+    size_t cap = s->out_cap ? s->out_cap : 64 * 1024;
+    while (cap - s->out_len < n) cap *= 2;
+    char* p = (char*)realloc(s->out, cap);
+    if (!p) {
+        s->out_err = 1;
+        return -1;
+    }
+    s->out = p;
+    s->out_cap = cap;
+    return 0;
+}
+
+static int _out_put(HubQueryServer* s, const void* p, size_t n) {
+    if (_out_reserve(s, n) != 0) return -1;
+    memcpy(s->out + s->out_len, p, n);
+    s->out_len += n;
+    return 0;
+}
+
+static int _out_printf(HubQueryServer* s, const char* fmt, ...) {
+    if (s->out_err) return -1;
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        size_t room = s->out_cap - s->out_len;
+        int n = vsnprintf(s->out ? s->out + s->out_len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) return -1;
+        if ((size_t)n < room) {
+            s->out_len += (size_t)n;
+            return 0;
+        }
+        if (_out_reserve(s, (size_t)n + 1) != 0) return -1;
+    }
+}
+
+static int _out_json_str(HubQueryServer* s, const char* str) {
+    if (_out_put(s, "\"", 1) != 0) return -1;
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        int rc;
+        if (*p == '"' || *p == '\\') rc = _out_printf(s, "\\%c", *p);
+        else if (*p < 0x20) rc = _out_printf(s, "\\u%04x", *p);
+        else rc = _out_put(s, p, 1);
+        if (rc != 0) return -1;
+    }
+    return _out_put(s, "\"", 1);
+}
+
+// 요청 조건에 맞는 항목인지 (ALL: 살아있는 것, SINCE: version 뒤에 바뀐 것)
+static int _match(QueryKind kind, uint64_t since, const HubLiveRec* r) {
+    if (kind == Q_SINCE) return r->version > since;
+    return r->alive;
+}
+
+static void _build_binary(HubQueryServer* s, QueryKind kind, uint32_t dev, uint64_t since, int status) {
+    int n_ch = hub_live_channels(s->live);
+    size_t rec_size = sizeof(HubQueryRec) + (size_t)n_ch * sizeof(double);
+
+    HubQueryHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = HUB_QUERY_MAGIC;
+    h.proto = HUB_QUERY_PROTO;
+    h.n_ch = (uint16_t)n_ch;
+    h.status = status;
+    h.rec_size = (uint32_t)rec_size;
+    h.version = hub_live_version(s->live);
+    h.now_ms = ts_now_ms();
+
+    HubLiveEnv env;
+    hub_live_get_env(s->live, &env);
+    h.env_flags = env.has_env ? 1u : 0u;
+    h.temp = env.temp;
+    h.humi = env.humi;
+    h.hi = env.hi;
+    h.env_ts_ms = env.ts_ms;
+
+    // 할당 실패면 out_err만 남기고 그만 (s->out이 NULL일 수 있음 → 호출한 쪽이 연결 끊음)
+    size_t hdr_off = s->out_len;
+    if (_out_put(s, &h, sizeof(h)) != 0) return;
+    for (int c = 0; c < n_ch; c++) {
+        char key[HUB_QUERY_KEY_LEN];
+        memset(key, 0, sizeof(key));
+        snprintf(key, sizeof(key), "%s", chan_reg_key(s->chans, c));
+        if (_out_put(s, key, sizeof(key)) != 0) return;
+    }
+    if (status != HUB_QUERY_OK) {
+        memcpy(s->out + hdr_off, &h, sizeof(h));
+        return;
+    }
+
+    uint32_t lo = dev ? dev : 1;
+    uint32_t hi = dev ? dev : hub_live_max_dev(s->live);
+    for (uint32_t d = lo; d <= hi; d++) {
+        HubLiveRec r;
+        if (!hub_live_get(s->live, d, &r)) continue;
+        if (!dev && !_match(kind, since, &r)) continue;
+        if (_out_reserve(s, rec_size) != 0) return;
+
+        HubQueryRec* q = (HubQueryRec*)(s->out + s->out_len);
+        memset(q, 0, sizeof(*q));
+        q->dev = d;
+        q->flags = r.alive ? HUB_QUERY_ALIVE : 0;
+        q->present = r.present;
+        q->version = r.version;
+        q->dev_ts_ms = r.dev_ts_ms;
+        q->rx_ts_ms = r.rx_ts_ms;
+        const char* name = dev_intern_name(s->ids, d);
+        snprintf(q->deviceId, sizeof(q->deviceId), "%s", name ? name : "");
+        memcpy(s->out + s->out_len + sizeof(*q), r.val, (size_t)n_ch * sizeof(double));
+        s->out_len += rec_size;
+        h.count++;
+    }
+
+    // out 버퍼가 커지면서 옮겨졌을 수 있어서 offset으로
+    memcpy(s->out + hdr_off, &h, sizeof(h));
+}
+
+static void _build_json(HubQueryServer* s, QueryKind kind, uint32_t dev, uint64_t since, int status) {
+    int n_ch = hub_live_channels(s->live);
+    HubLiveEnv env;
+    hub_live_get_env(s->live, &env);
+
+    _out_printf(s, "{\"status\":%d,\"version\":%llu,\"now_ms\":%lld,\"env\":", status,
+                (unsigned long long)hub_live_version(s->live), (long long)ts_now_ms());
+    if (env.has_env) {
+        _out_printf(s, "{\"temp\":%.10g,\"humi\":%.10g,\"hi\":%.10g,\"ts_ms\":%lld}", env.temp, env.humi, env.hi,
+                    (long long)env.ts_ms);
+    } else {
+        _out_printf(s, "null");
+    }
+    _out_printf(s, ",\"devices\":[");
+
+    int count = 0;
+    uint32_t lo = dev ? dev : 1;
+    uint32_t hi = dev ? dev : hub_live_max_dev(s->live);
+    for (uint32_t d = lo; status == HUB_QUERY_OK && d <= hi; d++) {
+        HubLiveRec r;
+        if (!hub_live_get(s->live, d, &r)) continue;
+        if (!dev && !_match(kind, since, &r)) continue;
+
+        const char* name = dev_intern_name(s->ids, d);
+        _out_printf(s, "%s{\"deviceId\":", count ? "," : "");
+        _out_json_str(s, name ? name : "");
+        _out_printf(s, ",\"dev\":%u,\"alive\":%s,\"version\":%llu,\"ts_ms\":%lld,\"rx_ms\":%lld", d,
+                    r.alive ? "true" : "false", (unsigned long long)r.version, (long long)r.dev_ts_ms,
+                    (long long)r.rx_ts_ms);
+        for (int c = 0; c < n_ch; c++) {
+            if ((r.present >> c) & 1u) _out_printf(s, ",\"%s\":%.10g", chan_reg_key(s->chans, c), r.val[c]);
+            else _out_printf(s, ",\"%s\":null", chan_reg_key(s->chans, c));
+        }
+        _out_printf(s, "}");
+        count++;
+    }
+    _out_printf(s, "],\"count\":%d}\n", count);
+}
+
+// 요청 한 줄 → s->out (할당 실패면 s->out_err)
+static void _handle(HubQueryServer* s, char* line) {
+    char* save = NULL;
+    char* cmd = strtok_r(line, " \t\r", &save);
+    char* arg = strtok_r(NULL, " \t\r", &save);
+    char* opt = strtok_r(NULL, " \t\r", &save);
+
+    // "ALL json"처럼 인자 없는 명령 뒤의 json
+    int json = 0;
+    if (opt && strcasecmp(opt, "json") == 0) json = 1;
+    if (arg && strcasecmp(arg, "json") == 0 && cmd && strcasecmp(cmd, "ALL") == 0) {
+        json = 1;
+        arg = NULL;
+    }
+
+    QueryKind kind = Q_ALL;
+    uint32_t dev = 0;
+    uint64_t since = 0;
+    int status = HUB_QUERY_OK;
+
+    if (!cmd) {
+        status = HUB_QUERY_EBADREQ;
+    } else if (strcasecmp(cmd, "ALL") == 0 && !arg) {
+        kind = Q_ALL;
+    } else if (strcasecmp(cmd, "DEV") == 0 && arg) {
+        kind = Q_DEV;
+        dev = dev_intern_find(s->ids, arg);
+        HubLiveRec r;
+        if (dev == DEV_HANDLE_NONE || !hub_live_get(s->live, dev, &r)) status = HUB_QUERY_ENODEV;
+    } else if (strcasecmp(cmd, "SINCE") == 0 && arg) {
+        char* end = NULL;
+        since = strtoull(arg, &end, 10);
+        kind = Q_SINCE;
+        if (!end || *end != '\0') status = HUB_QUERY_EBADREQ;
+    } else {
+        status = HUB_QUERY_EBADREQ;
+    }
+    if (status == HUB_QUERY_EBADREQ) s->bad++;
+
+    s->queries++;
+    if (json) _build_json(s, kind, dev, since, status);
+    else _build_binary(s, kind, dev, since, status);
+}
+
+// non-blocking send: 보낼 수 있는 만큼 (*off 진행), return: -1 끊김
+static int _send_some(int fd, const char* p, size_t n, size_t* off) {
+    while (*off < n) {
+        ssize_t w = send(fd, p + *off, n - *off, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (w > 0) {
+            *off += (size_t)w;
+            continue;
+        }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        return -1;
+    }
+    return 0;
+}
+
+static void _client_close(HubQueryServer* s, int i) {
+    close(s->cl[i].fd);
+    free(s->cl[i].out);
+    s->cl[i] = s->cl[--s->n_cl];
+}
+
+// s->out 응답을 바로 보내보고, 남으면 버퍼째 클라이언트에 넘김 (복사 없이 빈 out과 서로 바꿈)
+static int _client_send(HubQueryServer* s, QueryClient* c) {
+    size_t off = 0;
+    if (_send_some(c->fd, s->out, s->out_len, &off) != 0) return -1;
+    if (off == s->out_len) return 0;
+
+    char* p = c->out;
+    size_t cap = c->out_cap;
+    c->out = s->out;
+    c->out_cap = s->out_cap;
+    c->out_len = s->out_len;
+    c->out_off = off;
+    c->stall_ms = _mono_ms();
+    s->out = p;
+    s->out_cap = cap;
+    s->out_len = 0;
+    return 0;
+}
+
+// 받아둔 요청 줄 처리 (남은 응답이 있으면 다 나갈 때까지 멈춤), return: -1이면 연결 닫기
+static int _client_process(HubQueryServer* s, QueryClient* c) {
+    char* start = c->in;
+    char* nl;
+    while (c->out_len == 0 && (nl = memchr(start, '\n', (size_t)(c->in + c->in_len - start))) != NULL) {
+        *nl = '\0';
+        s->out_len = 0;
+        s->out_err = 0;
+        _handle(s, start);
+        if (s->out_err) {
+            s->oom++;
+            return -1;
+        }
+        s->bytes += s->out_len;
+        if (s->out_len > s->max_bytes) s->max_bytes = s->out_len;
+        if (_client_send(s, c) != 0) return -1;
+        start = nl + 1;
+    }
+
+    int left = (int)(c->in + c->in_len - start);
+    memmove(c->in, start, (size_t)left);
+    c->in_len = left;
+    // 버퍼가 찼는데 줄 끝이 없음 = 줄이 너무 김
+    if (left == (int)sizeof(c->in) - 1 && !memchr(c->in, '\n', (size_t)left)) return -1;
+    return 0;
+}
+
+// return: -1이면 연결 닫기
+static int _client_read(HubQueryServer* s, QueryClient* c) {
+    ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - (size_t)c->in_len, 0);
+    if (n <= 0) return (n < 0 && (errno == EINTR || errno == EAGAIN)) ? 0 : -1;
+    c->in_len += (int)n;
+    return _client_process(s, c);
+}
+
+// POLLOUT: 남은 응답 이어서, 다 나가면 밀려 있던 요청 줄 처리
+static int _client_write(HubQueryServer* s, QueryClient* c) {
+    size_t off = c->out_off;
+    if (_send_some(c->fd, c->out, c->out_len, &off) != 0) return -1;
+    if (off > c->out_off) c->stall_ms = _mono_ms();
+    c->out_off = off;
+    if (off < c->out_len) return 0;
+    c->out_len = 0;
+    c->out_off = 0;
+    return _client_process(s, c);
+}
+
+static void _accept(HubQueryServer* s) {
+    int fd = accept4(s->lfd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) return;
+    if (s->n_cl >= HUB_QUERY_MAX_CLIENTS) {
+        close(fd);
+        s->rejected++;
+        return;
+    }
+
+    QueryClient* c = &s->cl[s->n_cl++];
+    memset(c, 0, sizeof(*c));
+    c->fd = fd;
+    s->accepted++;
+}
+
+static void* _server_main(void* arg) {
+    HubQueryServer* s = (HubQueryServer*)arg;
+    struct pollfd pf[2 + HUB_QUERY_MAX_CLIENTS];
+
+    while (!atomic_load(&s->stop)) {
+        pf[0].fd = s->lfd;
+        pf[0].events = POLLIN;
+        // 남은 응답이 있는 클라이언트는 POLLOUT만 (다 받아갈 때까지 다음 요청 안 읽음)
+        for (int i = 0; i < s->n_cl; i++) {
+            pf[1 + i].fd = s->cl[i].fd;
+            pf[1 + i].events = s->cl[i].out_len ? POLLOUT : POLLIN;
+        }
+        int n_cl = s->n_cl;
+        pf[1 + n_cl].fd = s->wfd;
+        pf[1 + n_cl].events = POLLIN;
+        int r = poll(pf, (nfds_t)(2 + n_cl), HUB_QUERY_POLL_MS);
+        if (r < 0 || (r > 0 && pf[1 + n_cl].revents)) continue;
+
+        // 뒤에서부터 (닫으면 마지막 클라이언트가 그 자리로 옴)
+        uint64_t now = _mono_ms();
+        for (int i = n_cl - 1; i >= 0; i--) {
+            QueryClient* c = &s->cl[i];
+            short ev = pf[1 + i].revents;
+            int rc = 0;
+            if (ev & (POLLERR | POLLNVAL)) rc = -1;
+            else if (ev & POLLOUT) rc = _client_write(s, c);
+            else if (ev & (POLLIN | POLLHUP)) rc = _client_read(s, c);
+            if (rc == 0 && c->out_len && c->stall_ms + HUB_QUERY_SEND_MS <= now) {
+                s->slow++;
+                rc = -1;
+            }
+            if (rc != 0) _client_close(s, i);
+        }
+        if (pf[0].revents & POLLIN) _accept(s);
+    }
+
+    while (s->n_cl > 0) _client_close(s, s->n_cl - 1);
+    return NULL;
+}
+
+HubQueryServer* hub_query_start(const char* path, HubLive* live, const DevIntern* ids, const ChanReg* chans) {
+    if (!path || !live || !ids || !chans) return NULL;
+
+    HubQueryServer* s = (HubQueryServer*)calloc(1, sizeof(HubQueryServer));
+    if (!s) return NULL;
+    if (strlen(path) >= sizeof(s->path)) {
+        fprintf(stderr, "❌ [HUB][QUERY] socket path too long: %s\n", path);
+        free(s);
+        return NULL;
+    }
+    snprintf(s->path, sizeof(s->path), "%s", path);
+    s->live = live;
+    s->ids = ids;
+    s->chans = chans;
+
+    s->wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s->wfd < 0) {
+        perror("eventfd query");
+        free(s);
+        return NULL;
+    }
+    s->lfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (s->lfd < 0) {
+        perror("socket query");
+        close(s->wfd);
+        free(s);
+        return NULL;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, s->path, strlen(s->path) + 1);
+    unlink(s->path);   // 예전 프로세스가 남긴 socket 파일
+    if (bind(s->lfd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s->lfd, 16) != 0) {
+        perror("bind/listen query");
+        close(s->lfd);
+        close(s->wfd);
+        free(s);
+        return NULL;
+    }
+
+    if (pthread_create(&s->th, NULL, _server_main, s) != 0) {
+        perror("pthread_create query");
+        close(s->lfd);
+        close(s->wfd);
+        unlink(s->path);
+        free(s);
+        return NULL;
+    }
+    printf("🔎 [HUB][QUERY] listening %s\n", s->path);
+    return s;
+}
+
+void hub_query_stop(HubQueryServer* s) {
+    if (!s) return;
+    atomic_store(&s->stop, 1);
+    uint64_t one = 1;
+    ssize_t w = write(s->wfd, &one, sizeof(one));
+    (void)w;
+    pthread_join(s->th, NULL);
+    close(s->lfd);
+    close(s->wfd);
+    unlink(s->path);
+    free(s->out);
+    free(s);
+}
+
+void hub_query_print_stats(const HubQueryServer* s, const char* tag) {
+    if (!s) return;
+    printf("📊 %s clients=%llu rejected=%llu queries=%llu bad=%llu bytes=%llu max_resp=%llu slow=%llu oom=%llu seqlock_retries=%llu\n",
+           tag, (unsigned long long)s->accepted, (unsigned long long)s->rejected, (unsigned long long)s->queries,
+           (unsigned long long)s->bad, (unsigned long long)s->bytes, (unsigned long long)s->max_bytes,
+           (unsigned long long)s->slow, (unsigned long long)s->oom, (unsigned long long)hub_live_retries(s->live));
+}
@@ -0,0 +1,121 @@
+#ifndef HUB_QUERY_H
+#define HUB_QUERY_H
+
+/*
+현재 디바이스 상태 조회 (대시보드용, 허브 락 / ingest 스레드와 무관하게)
+- HubLive: deviceId 핸들 번호 자리의 상태 복사본 (seqlock)
+  허브가 값을 바꿀 때 hub->mtx 안에서 같이 씀 → 쓰는 쪽은 항상 1개, 읽는 쪽은 락 없이 재시도만
+  바뀔 때마다 전역 version +1, 항목마다 마지막 version (해제된 디바이스는 alive = 0으로 남김)
+- HubQueryServer: Unix domain socket (SOCK_STREAM) 서버 스레드 1개, HubLive만 읽음
+  요청은 텍스트 한 줄 (같은 연결로 여러 번), 뒤에 " json"을 붙이면 JSON 한 줄로 응답
+    ALL                  살아있는 디바이스 전부
+    DEV <deviceId>       디바이스 1개
+    SINCE <version>      version보다 뒤에 바뀐 것 (해제된 것 포함) → 응답 header.version을 다음 SINCE에
+  binary 응답 = HubQueryHeader + 채널 key n_ch개 (HUB_QUERY_KEY_LEN씩) + 레코드 count개 (rec_size씩)
+    레코드 = HubQueryRec + double val[n_ch] (present 비트가 없는 채널은 0)
+  env(TH)와 heat index는 header에 (디바이스 공통)
+*/
+
+#include <stdint.h>
+
+#include "dev_intern.h"
+#include "channel_reg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_QUERY_MAGIC       0x59525148u   // "HQRY" (little endian)
+#define HUB_QUERY_PROTO       1
+#define HUB_QUERY_KEY_LEN     16
+#define HUB_QUERY_MAX_CLIENTS 32
+
+#define HUB_QUERY_OK       0
+#define HUB_QUERY_EBADREQ  (-1)   // 모르는 명령 / 형식 오류
+#define HUB_QUERY_ENODEV   (-2)   // DEV: 모르는 deviceId
+
+#define HUB_QUERY_ALIVE    1u     // HubQueryRec.flags
+
+// ============================
+// live 테이블
+// ============================
+typedef struct HubLive HubLive;
+
+typedef struct {
+    uint32_t dev;
+    int alive;
+    uint32_t present;
+    uint64_t version;
+    int64_t dev_ts_ms;
+    int64_t rx_ts_ms;
+    double val[CHAN_MAX];    // 채널 번호 자리
+} HubLiveRec;
+
+typedef struct {
+    int has_env;
+    double temp;
+    double humi;
+    double hi;
+    int64_t ts_ms;
+    uint64_t version;
+} HubLiveEnv;
+
+// capacity: 핸들 수 + 1 (dev_intern_capacity + 1)
+HubLive* hub_live_create(int capacity, int n_ch);
+void hub_live_destroy(HubLive* l);
+
+// 쓰는 쪽 (한 번에 한 스레드만, 허브는 hub->mtx 안에서), val은 채널 번호 자리
+void hub_live_put(HubLive* l, uint32_t dev, uint32_t present, const double* val, int64_t dev_ts_ms, int64_t rx_ts_ms);
+void hub_live_remove(HubLive* l, uint32_t dev);
+void hub_live_put_env(HubLive* l, int has_env, double temp, double humi, double hi, int64_t ts_ms);
+
+// 읽는 쪽 (락 없음): 1 있음 (해제된 것 포함), 0 한 번도 안 씀
+int hub_live_get(HubLive* l, uint32_t dev, HubLiveRec* out);
+void hub_live_get_env(HubLive* l, HubLiveEnv* out);
+uint64_t hub_live_version(const HubLive* l);
+uint32_t hub_live_max_dev(const HubLive* l);   // 지금까지 쓴 가장 큰 핸들 (스캔 범위)
+int hub_live_channels(const HubLive* l);
+uint64_t hub_live_retries(const HubLive* l);   // 쓰는 중이라 다시 읽은 횟수
+
+// ============================
+// 조회 서버
+// ============================
+typedef struct {
+    uint32_t magic;          // HUB_QUERY_MAGIC
+    uint16_t proto;          // HUB_QUERY_PROTO
+    uint16_t n_ch;
+    int32_t status;          // HUB_QUERY_OK / HUB_QUERY_E*
+    uint32_t count;          // 레코드 수
+    uint32_t rec_size;       // sizeof(HubQueryRec) + n_ch * 8
+    uint32_t env_flags;      // 1 = env 있음
+    uint64_t version;        // 이 응답을 만들기 시작한 시점 version
+    int64_t now_ms;
+    double temp;
+    double humi;
+    double hi;
+    int64_t env_ts_ms;
+} HubQueryHeader;
+
+typedef struct {
+    uint32_t dev;                      // dev_intern 핸들
+    uint32_t flags;                    // HUB_QUERY_ALIVE
+    uint32_t present;                  // 채널 bitmask
+    uint32_t reserved;
+    uint64_t version;
+    int64_t dev_ts_ms;
+    int64_t rx_ts_ms;
+    char deviceId[DEV_INTERN_ID_LEN];
+} HubQueryRec;
+
+typedef struct HubQueryServer HubQueryServer;
+
+// path에 socket을 만들고 서버 스레드 시작 (같은 경로의 예전 socket 파일은 지움)
+HubQueryServer* hub_query_start(const char* path, HubLive* live, const DevIntern* ids, const ChanReg* chans);
+void hub_query_stop(HubQueryServer* s);     // 스레드 join + socket 파일 삭제
+void hub_query_print_stats(const HubQueryServer* s, const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,455 @@
+#include "hub_result.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+#include <cjson/cJSON.h>
+#include "mem_pool.h"
+#include "shard_ring.h"
+#include "ts_parse.h"
+
+typedef struct HubSub {
+    int id;
+    char name[32];
+    HubResultHandler h;
+    void* ctx;
+
+    // 필터 (생성 후 안 바뀜 → 리더 스레드에서 락 없이 읽음)
+    int ndev;
+    uint64_t dev_hash[HUB_RESULT_MAX_DEVICES];
+    char dev[HUB_RESULT_MAX_DEVICES][64];
+    int min_level;
+    int drop_oldest;
+    int block_when_full;
+
+    // bounded 큐 (mtx로 보호)
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+    pthread_cond_t space;    // block_when_full: 워커가 하나 꺼낼 때
+    const HubResult** q;
+    int cap;
+    int head;
+    int count;
+    int stop;
+    pthread_t th;
+
+    // 통계 (mtx로 보호)
+    uint64_t delivered;
+    uint64_t filtered;
+    uint64_t dropped;
+    int high;
+
+    struct HubSub* next;
+} HubSub;
+
+// HubResult slab (리더 스레드가 alloc, 워커들이 free → 락)
+// 버스가 없어진 뒤에도 남은 HubResult가 있을 수 있어서 참조 카운트 (버스 1 + 나간 HubResult 수)
+typedef struct {
+    pthread_mutex_t mtx;
+    MemSlab slab;
+    atomic_int refs;
+    atomic_ullong heap_allocs; // 라인이 길거나 slab이 다 차서 heap으로 간 수
+} ResultPool;
+
+struct HubResultBus {
+    pthread_rwlock_t lock;   // 구독 목록 (publish: read, subscribe/unsubscribe: write)
+    HubSub* subs;
+    int next_id;
+    atomic_int nsubs;        // 구독자 없으면 파싱도 건너뜀
+    ResultPool* pool;
+    MemArena arena;          // _parse의 cJSON (publish 스레드 전용)
+    int has_arena;
+};
+
+typedef struct {
+    const char* name;
+    int level;
+} LevelName;
+
+static const LevelName g_levels[] = {
+    { "NORMAL", HUB_LEVEL_NORMAL },     { "SAFE", HUB_LEVEL_NORMAL },        { "OK", HUB_LEVEL_NORMAL },
+    { "CAUTION", HUB_LEVEL_CAUTION },   { "ATTENTION", HUB_LEVEL_CAUTION },  { "INFO", HUB_LEVEL_CAUTION },
+    { "WARNING", HUB_LEVEL_WARNING },   { "WARN", HUB_LEVEL_WARNING },
+    { "DANGER", HUB_LEVEL_DANGER },     { "ALERT", HUB_LEVEL_DANGER },
+    { "CRITICAL", HUB_LEVEL_CRITICAL }, { "EMERGENCY", HUB_LEVEL_CRITICAL },
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static ResultPool* _pool_create(void) {
+    ResultPool* p = (ResultPool*)calloc(1, sizeof(ResultPool));
+    if (!p) return NULL;
+    if (mem_slab_init(&p->slab, sizeof(HubResult) + HUB_RESULT_SLAB_LINE, HUB_RESULT_SLAB_COUNT) != 0) {
+        free(p);
+        return NULL;
+    }
+    pthread_mutex_init(&p->mtx, NULL);
+    atomic_init(&p->refs, 1);
+    atomic_init(&p->heap_allocs, 0);
+    return p;
+}
+
+static void _pool_unref(ResultPool* p) {
+    if (!p || atomic_fetch_sub_explicit(&p->refs, 1, memory_order_acq_rel) != 1) return;
+    pthread_mutex_destroy(&p->mtx);
+    mem_slab_destroy(&p->slab);
+    free(p);
+}
+
+static HubResult* _alloc(ResultPool* p, size_t len) {
+    HubResult* r = NULL;
+    if (p && len < HUB_RESULT_SLAB_LINE) {
+        pthread_mutex_lock(&p->mtx);
+        r = (HubResult*)mem_slab_alloc(&p->slab);
+        pthread_mutex_unlock(&p->mtx);
+    }
+    if (r) {
+        atomic_fetch_add(&p->refs, 1);
+        memset(r, 0, sizeof(*r));
+        r->pool = p;
+        return r;
+    }
+
+    if (p) atomic_fetch_add(&p->heap_allocs, 1);
+    r = (HubResult*)malloc(sizeof(HubResult) + len + 1);
+    if (r) memset(r, 0, sizeof(*r));
+    return r;
+}
+
+static HubResult* _parse(HubResultBus* b, const char* line) {
+    size_t len = strlen(line);
+    HubResult* r = _alloc(b->pool, len);
+    if (!r) return NULL;
+
+    atomic_init(&r->refs, 1);
+    r->rx_ms = ts_now_ms();
+    r->level = HUB_LEVEL_UNKNOWN;
+    r->len = len;
+    memcpy(r->line, line, len + 1);
+
+    // 필터에 쓰는 필드만 한 번 꺼내 둠 (JSON이 아니면 필드 없이 그대로 전달)
+    MemArena* prev = mem_arena_bound();
+    if (b->has_arena) mem_arena_bind(&b->arena);
+    cJSON* root = cJSON_Parse(line);
+    if (root) {
+        const cJSON* jDev = cJSON_GetObjectItemCaseSensitive(root, "deviceId");
+        const cJSON* jLv = cJSON_GetObjectItemCaseSensitive(root, "level");
+
+        if (cJSON_IsString(jDev) && jDev->valuestring) {
+            snprintf(r->deviceId, sizeof(r->deviceId), "%s", jDev->valuestring);
+        }
+        if (cJSON_IsNumber(jLv)) {
+            r->level = (int)jLv->valuedouble;
+        } else if (cJSON_IsString(jLv) && jLv->valuestring) {
+            snprintf(r->level_name, sizeof(r->level_name), "%s", jLv->valuestring);
+            r->level = hub_result_level_parse(jLv->valuestring);
+        }
+        cJSON_Delete(root);
+    }
+    if (b->has_arena) {
+        mem_arena_reset(&b->arena);
+        mem_arena_bind(prev);
+    }
+    r->dev_hash = shard_hash(r->deviceId, strlen(r->deviceId));
+    return r;
+}
+
+static int _match(const HubSub* s, const HubResult* r) {
+    // NORMAL이 가장 낮은 level → 그 이하는 필터 없음 (0으로 초기화한 옵션도 전체)
+    if (s->min_level > HUB_LEVEL_NORMAL && r->level < s->min_level) return 0;
+    if (s->ndev == 0) return 1;
+
+    for (int i = 0; i < s->ndev; i++) {
+        if (s->dev_hash[i] == r->dev_hash && strcmp(s->dev[i], r->deviceId) == 0) return 1;
+    }
+    return 0;
+}
+
+static void* _worker(void* arg) {
+    HubSub* s = (HubSub*)arg;
+
+    pthread_mutex_lock(&s->mtx);
+    for (;;) {
+        while (s->count == 0 && !s->stop) pthread_cond_wait(&s->cv, &s->mtx);
+        if (s->stop) break;
+
+        const HubResult* r = s->q[s->head];
+        s->head = (s->head + 1) % s->cap;
+        s->count--;
+        if (s->block_when_full) pthread_cond_signal(&s->space);
+        pthread_mutex_unlock(&s->mtx);
+
+        s->h(r, s->ctx);
+        hub_result_release(r);
+
+        pthread_mutex_lock(&s->mtx);
+        s->delivered++;
+    }
+    pthread_mutex_unlock(&s->mtx);
+    return NULL;
+}
+
+static void _sub_free(HubSub* s) {
+    pthread_mutex_lock(&s->mtx);
+    s->stop = 1;
+    pthread_cond_broadcast(&s->cv);
+    pthread_cond_broadcast(&s->space);
+    pthread_mutex_unlock(&s->mtx);
+    pthread_join(s->th, NULL);
+
+    // 못 보낸 건 참조만 내려놓음
+    while (s->count > 0) {
+        hub_result_release(s->q[s->head]);
+        s->head = (s->head + 1) % s->cap;
+        s->count--;
+    }
+    pthread_cond_destroy(&s->cv);
+    pthread_cond_destroy(&s->space);
+    pthread_mutex_destroy(&s->mtx);
+    free(s->q);
+    free(s);
+}
+
+// ================================
+// 외부 API
+// ================================
+HubResultBus* hub_result_bus_create(void) {
+    HubResultBus* b = (HubResultBus*)calloc(1, sizeof(HubResultBus));
+    if (!b) return NULL;
+    pthread_rwlock_init(&b->lock, NULL);
+    atomic_init(&b->nsubs, 0);
+    b->next_id = 1;
+    b->pool = _pool_create(); // 실패하면 heap만
+    if (!b->pool) fprintf(stderr, "⚠️ [HUB][RESULT] slab init failed, using heap\n");
+    mem_pool_install_cjson_hooks();
+    b->has_arena = mem_arena_init(&b->arena, HUB_RESULT_ARENA_BYTES) == 0;
+    return b;
+}
+
+void hub_result_bus_destroy(HubResultBus* b) {
+    if (!b) return;
+
+    pthread_rwlock_wrlock(&b->lock);
+    HubSub* s = b->subs;
+    b->subs = NULL;
+    atomic_store(&b->nsubs, 0);
+    pthread_rwlock_unlock(&b->lock);
+
+    while (s) {
+        HubSub* next = s->next;
+        _sub_free(s);
+        s = next;
+    }
+    pthread_rwlock_destroy(&b->lock);
+    if (b->has_arena) mem_arena_destroy(&b->arena);
+    _pool_unref(b->pool); // 밖에서 retain한 HubResult가 남아 있으면 그게 release될 때 해제
+    free(b);
+}
+
+int hub_result_subscribe(HubResultBus* b, HubResultHandler h, void* ctx, const HubSubscribeOptions* opt) {
+    if (!b || !h) return -1;
+    if (opt && opt->n_device_ids > HUB_RESULT_MAX_DEVICES) {
+        fprintf(stderr, "❌ [HUB][RESULT] too many deviceId filters (%d > %d)\n",
+                opt->n_device_ids, HUB_RESULT_MAX_DEVICES);
+        return -1;
+    }
+
+    HubSub* s = (HubSub*)calloc(1, sizeof(HubSub));
+    if (!s) return -1;
+
+    s->h = h;
+    s->ctx = ctx;
+    s->min_level = opt ? opt->min_level : HUB_LEVEL_UNKNOWN;
+    s->drop_oldest = opt ? opt->drop_oldest : 0;
+    s->block_when_full = opt ? opt->block_when_full : 0;
+    s->cap = (opt && opt->queue_len > 0) ? opt->queue_len : HUB_RESULT_DEFAULT_QUEUE;
+
+    if (opt && opt->device_ids) {
+        for (int i = 0; i < opt->n_device_ids; i++) {
+            if (!opt->device_ids[i]) continue;
+            snprintf(s->dev[s->ndev], sizeof(s->dev[0]), "%s", opt->device_ids[i]);
+            s->dev_hash[s->ndev] = shard_hash(s->dev[s->ndev], strlen(s->dev[s->ndev]));
+            s->ndev++;
+        }
+    }
+
+    s->q = (const HubResult**)calloc((size_t)s->cap, sizeof(HubResult*));
+    if (!s->q) {
+        free(s);
+        return -1;
+    }
+    pthread_mutex_init(&s->mtx, NULL);
+    pthread_cond_init(&s->cv, NULL);
+    pthread_cond_init(&s->space, NULL);
+
+    pthread_rwlock_wrlock(&b->lock);
+    s->id = b->next_id++;
+    if (opt && opt->name) snprintf(s->name, sizeof(s->name), "%s", opt->name);
+    else snprintf(s->name, sizeof(s->name), "sub%d", s->id);
+
+    if (pthread_create(&s->th, NULL, _worker, s) != 0) {
+        pthread_rwlock_unlock(&b->lock);
+        pthread_cond_destroy(&s->cv);
+        pthread_cond_destroy(&s->space);
+        pthread_mutex_destroy(&s->mtx);
+        free(s->q);
+        free(s);
+        return -1;
+    }
+
+    // 뒤에 붙여서 publish 순서 = 구독 순서
+    HubSub** pp = &b->subs;
+    while (*pp) pp = &(*pp)->next;
+    *pp = s;
+    atomic_fetch_add(&b->nsubs, 1);
+    int id = s->id;
+    pthread_rwlock_unlock(&b->lock);
+    return id;
+}
+
+int hub_result_unsubscribe(HubResultBus* b, int id) {
+    if (!b) return -1;
+
+    pthread_rwlock_wrlock(&b->lock);
+    HubSub** pp = &b->subs;
+    while (*pp && (*pp)->id != id) pp = &(*pp)->next;
+    HubSub* s = *pp;
+    if (s) {
+        *pp = s->next;
+        atomic_fetch_sub(&b->nsubs, 1);
+    }
+    pthread_rwlock_unlock(&b->lock);
+
+    if (!s) return -1;
+    _sub_free(s); // 목록에서 빠졌으니 더 안 들어옴
+    return 0;
+}
+
+int hub_result_publish_line(HubResultBus* b, const char* line) {
+    if (!b || !line || atomic_load(&b->nsubs) == 0) return 0;
+
+    HubResult* r = _parse(b, line);
+    if (!r) return 0;
+
+    int n = 0;
+    pthread_rwlock_rdlock(&b->lock);
+    for (HubSub* s = b->subs; s; s = s->next) {
+        int match = _match(s, r);
+
+        pthread_mutex_lock(&s->mtx);
+        if (!match) {
+            s->filtered++;
+            pthread_mutex_unlock(&s->mtx);
+            continue;
+        }
+        // 유실 없는 구독: 워커가 자리를 낼 때까지 (unsubscribe/destroy는 publish가 끝나야 들어오니 stop은 안전장치)
+        while (s->block_when_full && s->count == s->cap && !s->stop) pthread_cond_wait(&s->space, &s->mtx);
+        if (s->count == s->cap) {
+            s->dropped++;
+            if (!s->drop_oldest) {
+                pthread_mutex_unlock(&s->mtx);
+                continue;
+            }
+            hub_result_release(s->q[s->head]);
+            s->head = (s->head + 1) % s->cap;
+            s->count--;
+        }
+        hub_result_retain(r);
+        s->q[(s->head + s->count) % s->cap] = r;
+        s->count++;
+        if (s->count > s->high) s->high = s->count;
+        pthread_cond_signal(&s->cv);
+        pthread_mutex_unlock(&s->mtx);
+        n++;
+    }
+    pthread_rwlock_unlock(&b->lock);
+
+    hub_result_release(r); // 리더 몫
+    return n;
+}
+
+void hub_result_retain(const HubResult* r) {
+    if (r) atomic_fetch_add_explicit(&((HubResult*)r)->refs, 1, memory_order_relaxed);
+}
+
+void hub_result_release(const HubResult* r) {
+    if (!r) return;
+    if (atomic_fetch_sub_explicit(&((HubResult*)r)->refs, 1, memory_order_acq_rel) != 1) return;
+
+    ResultPool* p = (ResultPool*)r->pool;
+    if (!p) {
+        free((void*)r);
+        return;
+    }
+    pthread_mutex_lock(&p->mtx);
+    mem_slab_free(&p->slab, (void*)r);
+    pthread_mutex_unlock(&p->mtx);
+    _pool_unref(p);
+}
+
+int hub_result_bus_stats(HubResultBus* b, HubSubscriberStats* out, int max) {
+    if (!b || !out || max <= 0) return 0;
+
+    int n = 0;
+    pthread_rwlock_rdlock(&b->lock);
+    for (HubSub* s = b->subs; s && n < max; s = s->next, n++) {
+        pthread_mutex_lock(&s->mtx);
+        out[n].id = s->id;
+        out[n].name = s->name;
+        out[n].delivered = s->delivered;
+        out[n].filtered = s->filtered;
+        out[n].dropped = s->dropped;
+        out[n].queued = s->count;
+        out[n].queue_high = s->high;
+        out[n].queue_len = s->cap;
+        pthread_mutex_unlock(&s->mtx);
+    }
+    pthread_rwlock_unlock(&b->lock);
+    return n;
+}
+
+void hub_result_bus_print(HubResultBus* b, const char* tag) {
+    if (!b) return;
+
+    pthread_rwlock_rdlock(&b->lock);
+    for (HubSub* s = b->subs; s; s = s->next) {
+        pthread_mutex_lock(&s->mtx);
+        printf("📊 %s %s delivered=%llu filtered=%llu dropped=%llu queue=%d high=%d/%d\n",
+               tag ? tag : "[RESULT]", s->name,
+               (unsigned long long)s->delivered, (unsigned long long)s->filtered,
+               (unsigned long long)s->dropped, s->count, s->high, s->cap);
+        pthread_mutex_unlock(&s->mtx);
+    }
+    pthread_rwlock_unlock(&b->lock);
+
+    int in_use = 0;
+    uint64_t heap = 0;
+    hub_result_bus_pool_stats(b, &in_use, &heap);
+    printf("📊 %s pool slab=%d/%d heap=%llu\n", tag ? tag : "[RESULT]", in_use, HUB_RESULT_SLAB_COUNT,
+           (unsigned long long)heap);
+}
+
+void hub_result_bus_pool_stats(HubResultBus* b, int* in_use, uint64_t* heap_allocs) {
+    int n = 0;
+    uint64_t h = 0;
+    if (b && b->pool) {
+        pthread_mutex_lock(&b->pool->mtx);
+        n = mem_slab_in_use(&b->pool->slab);
+        pthread_mutex_unlock(&b->pool->mtx);
+        h = atomic_load(&b->pool->heap_allocs);
+    }
+    if (in_use) *in_use = n;
+    if (heap_allocs) *heap_allocs = h;
+}
+
+int hub_result_level_parse(const char* s) {
+    if (!s) return HUB_LEVEL_UNKNOWN;
+    for (size_t i = 0; i < sizeof(g_levels) / sizeof(g_levels[0]); i++) {
+        if (strcasecmp(s, g_levels[i].name) == 0) return g_levels[i].level;
+    }
+    return HUB_LEVEL_UNKNOWN;
+}
@@ -0,0 +1,101 @@
+#ifndef HUB_RESULT_H
+#define HUB_RESULT_H
+
+/*
+RESULT fan-out (rulebase_out → 구독자 여러 개)
+- 리더 스레드는 라인을 한 번만 파싱해서 HubResult(참조 카운트)로 만들고 구독자 큐에 넣기만 함
+- 구독자마다 bounded 큐 + 워커 스레드 1개 → 느린 콜백(DB, 알림)이 rulebase 출력을 막지 않음
+- 필터(deviceId 목록, 최소 level)는 미리 파싱된 필드로 리더 스레드에서 평가 (안 맞으면 큐에 안 넣음)
+- 큐가 꽉 차면 버림 (drop_oldest면 가장 오래된 것, 아니면 새 것) → 구독자별 dropped 통계
+  block_when_full이면 안 버리고 자리가 날 때까지 리더가 기다림 (예전 동기 콜백처럼 유실 없음, 대신 느리면 rulebase 출력도 밀림)
+- 파싱(cJSON)은 버스 arena에서 → publish는 리더 스레드 1개에서만
+- HubResult 버퍼는 버스 slab(HUB_RESULT_SLAB_COUNT개, 라인 HUB_RESULT_SLAB_LINE까지)에서
+  라인이 더 길거나 slab을 다 쓰면 heap (heap_allocs 통계), slab은 마지막 HubResult가 release될 때까지 살아 있음
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_RESULT_DEFAULT_QUEUE 256
+#define HUB_RESULT_MAX_DEVICES   32   // 구독 1개가 걸 수 있는 deviceId 필터 수
+#define HUB_RESULT_SLAB_COUNT    1024 // 동시에 살아 있는 RESULT 수 (구독자 큐 합 정도)
+#define HUB_RESULT_SLAB_LINE     1024 // slab 한 칸에 들어가는 라인 길이 ('\0' 포함)
+#define HUB_RESULT_ARENA_BYTES   (64 * 1024) // 라인 1개 파싱용 cJSON arena (라인마다 reset)
+
+// level: 숫자면 그대로, 문자열이면 아래 순위 (대소문자 무시), 없거나 모르면 HUB_LEVEL_UNKNOWN
+enum {
+    HUB_LEVEL_UNKNOWN = -1,
+    HUB_LEVEL_NORMAL = 0,   // "NORMAL" / "SAFE" / "OK"
+    HUB_LEVEL_CAUTION,      // "CAUTION" / "ATTENTION" / "INFO"
+    HUB_LEVEL_WARNING,      // "WARNING" / "WARN"
+    HUB_LEVEL_DANGER,       // "DANGER" / "ALERT"
+    HUB_LEVEL_CRITICAL      // "CRITICAL" / "EMERGENCY"
+};
+
+// 구독자 전원이 같이 보는 읽기 전용 RESULT (마지막 release에서 해제)
+typedef struct {
+    atomic_int refs;
+    void* pool;              // 내부용: 나온 slab (NULL이면 heap)
+    int64_t rx_ms;           // 허브 수신 시각 (epoch ms)
+    char deviceId[64];       // 없으면 ""
+    uint64_t dev_hash;       // shard_hash(deviceId)
+    int level;               // HUB_LEVEL_*
+    char level_name[16];     // 원문 (문자열이었을 때), 숫자면 ""
+    size_t len;
+    char line[];             // 받은 그대로 ('\n' 포함일 수 있음)
+} HubResult;
+
+typedef void (*HubResultHandler)(const HubResult* r, void* ctx);
+
+typedef struct {
+    const char* const* device_ids; // NULL이면 전체
+    int n_device_ids;
+    int min_level;                 // 이 level 이상만 (CAUTION부터 필터, 0 / NORMAL / UNKNOWN이면 level 없는 RESULT 포함 전체)
+    int queue_len;                 // 0이면 HUB_RESULT_DEFAULT_QUEUE
+    int drop_oldest;               // 1: 꽉 차면 가장 오래된 것 버림, 0: 새 것 버림
+    int block_when_full;           // 1: 꽉 차면 버리지 않고 리더가 기다림 (drop_oldest 무시)
+    const char* name;              // 로그/통계용 (NULL이면 "sub<id>")
+} HubSubscribeOptions;
+
+typedef struct {
+    int id;
+    const char* name;
+    uint64_t delivered;
+    uint64_t filtered;
+    uint64_t dropped;
+    int queued;
+    int queue_high;
+    int queue_len;
+} HubSubscriberStats;
+
+typedef struct HubResultBus HubResultBus;
+
+HubResultBus* hub_result_bus_create(void);
+void hub_result_bus_destroy(HubResultBus* b); // 워커 전부 정지 (큐에 남은 건 버림)
+
+// return: 구독 id (>0), 실패 -1. opt NULL이면 전체 구독 + 기본 큐
+int hub_result_subscribe(HubResultBus* b, HubResultHandler h, void* ctx, const HubSubscribeOptions* opt);
+int hub_result_unsubscribe(HubResultBus* b, int id); // 워커 join까지 (핸들러 안에서 부르면 안 됨)
+
+// 라인 1개 파싱 → 맞는 구독자 큐에 넣음 (return: 넣은 구독자 수, 구독자 없으면 파싱도 안 함)
+int hub_result_publish_line(HubResultBus* b, const char* line);
+
+void hub_result_retain(const HubResult* r);  // 핸들러 밖에서 더 쓰려면 retain → 다 쓰고 release
+void hub_result_release(const HubResult* r);
+
+int  hub_result_bus_stats(HubResultBus* b, HubSubscriberStats* out, int max); // return: 채운 개수
+void hub_result_bus_print(HubResultBus* b, const char* tag);
+void hub_result_bus_pool_stats(HubResultBus* b, int* in_use, uint64_t* heap_allocs); // slab 사용 중 / heap으로 넘어간 수
+
+int hub_result_level_parse(const char* s); // 문자열 → HUB_LEVEL_*
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
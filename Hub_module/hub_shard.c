@@ -0,0 +1,490 @@
+#include "hub_shard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "shard_ring.h"
+#include "mem_pool.h"
+#include "io_engine.h"
+#include "mq_batch.h"
+#include "dev_intern.h"
+
+#define SHARD_PATH_LEN 256
+#define ROUTER_WAIT_MS 500   // 라우터 대기 (종료는 eventfd로 바로)
+
+typedef struct {
+    char rule_in[SHARD_PATH_LEN];
+    char rule_out[SHARD_PATH_LEN];
+    char watch_mq[SHARD_PATH_LEN];
+    char state_file[SHARD_PATH_LEN];
+    char archive_dir[SHARD_PATH_LEN];
+    char query_socket[SHARD_PATH_LEN];
+} ShardPaths;
+
+struct CollectorHubGroup {
+    CollectorHubConfig base;
+    int shards;
+
+    ShardRing* ring;
+    CollectorHub** hubs;
+    ShardPaths* paths;
+    unsigned long long* routed;   // 라우터 스레드만 씀
+
+    // RESULT 합치기
+    CollectorHubResultCallback cb;
+    void* cb_ctx;
+    pthread_mutex_t cb_mtx;
+
+    // FIFO 라우터 (정지 / 준비 상태는 life, endpoint = watch FIFO)
+    int running;
+    int has_router;
+    pthread_t t_router;
+    HubLife life;
+    int ep_router;
+    int router_eof;               // 라우터 스레드만 씀 (엔진 콜백 → 루프)
+    MemArena router_arena;
+    int has_arena;
+};
+
+// ============================
+// 내부 유틸
+// ============================
+static void _on_shard_result(const char* json_line, void* ctx) {
+    CollectorHubGroup* g = (CollectorHubGroup*)ctx;
+    if (!g->cb) return;
+
+    // shard마다 rule_out 스레드가 따로라서 사용자 콜백은 한 번에 하나씩
+    pthread_mutex_lock(&g->cb_mtx);
+    g->cb(json_line, g->cb_ctx);
+    pthread_mutex_unlock(&g->cb_mtx);
+}
+
+static int _hex4(const char* p) {
+    int v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    return v;
+}
+
+// out에 UTF-8로 (자리 없으면 안 씀), return: 쓴 바이트 수
+static size_t _put_utf8(char* out, size_t n, size_t cap, unsigned cp) {
+    unsigned char b[4];
+    size_t k;
+    if (cp < 0x80) { b[0] = (unsigned char)cp; k = 1; }
+    else if (cp < 0x800) { b[0] = (unsigned char)(0xC0 | (cp >> 6)); b[1] = (unsigned char)(0x80 | (cp & 0x3F)); k = 2; }
+    else if (cp < 0x10000) {
+        b[0] = (unsigned char)(0xE0 | (cp >> 12));
+        b[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        b[2] = (unsigned char)(0x80 | (cp & 0x3F));
+        k = 3;
+    } else {
+        b[0] = (unsigned char)(0xF0 | (cp >> 18));
+        b[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+        b[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        b[3] = (unsigned char)(0x80 | (cp & 0x3F));
+        k = 4;
+    }
+    for (size_t i = 0; i < k && n + i < cap; i++) out[n + i] = (char)b[i];
+    return k;
+}
+
+// 라인에서 "deviceId":"..." 값만 찾아서 out에 (라우팅용, JSON 전체 파싱은 shard에서 한 번만)
+// escape를 풀고 63자로 자름 → 워치 모듈이 해시하는 dev_intern 이름과 같은 바이트
+// return: 길이, -1 없음/깨짐
+static int _scan_device_id(const char* line, char out[DEV_INTERN_ID_LEN]) {
+    const char* p = strstr(line, "\"deviceId\"");
+    if (!p) return -1;
+    p += 10;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != ':') return -1;
+    p++;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p != '"') return -1;
+    p++;
+
+    const size_t cap = DEV_INTERN_ID_LEN - 1;
+    size_t n = 0;
+    for (; *p && *p != '"'; p++) {
+        if (*p != '\\') {
+            if (n < cap) out[n] = *p;
+            n++;
+            continue;
+        }
+        p++;
+        unsigned cp;
+        switch (*p) {
+        case '"': case '\\': case '/': cp = (unsigned char)*p; break;
+        case 'b': cp = '\b'; break;
+        case 'f': cp = '\f'; break;
+        case 'n': cp = '\n'; break;
+        case 'r': cp = '\r'; break;
+        case 't': cp = '\t'; break;
+        case 'u': {
+            int hi = _hex4(p + 1);
+            if (hi < 0) return -1;
+            p += 4;
+            cp = (unsigned)hi;
+            // surrogate pair (cJSON과 같은 규칙)
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                int lo = (p[1] == '\\' && p[2] == 'u') ? _hex4(p + 3) : -1;
+                if (lo < 0xDC00 || lo > 0xDFFF) return -1;
+                cp = 0x10000 + (((cp & 0x3FF) << 10) | ((unsigned)lo & 0x3FF));
+                p += 6;
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                return -1;
+            }
+            break;
+        }
+        default: return -1;
+        }
+        n += _put_utf8(out, n, cap, cp);
+    }
+    if (*p != '"') return -1;
+    if (n > cap) n = cap;
+    out[n] = '\0';
+    return (int)n;
+}
+
+static void _ensure_fifo(const char* path) {
+    struct stat st;
+    if (stat(path, &st) == 0) return;
+    if (mkfifo(path, 0666) != 0 && errno != EEXIST) perror("mkfifo");
+}
+
+// base 설정 → shard k 설정 (경로는 g->paths[k]에 만들어서 가리킴)
+static void _shard_cfg(CollectorHubGroup* g, int k, CollectorHubConfig* c) {
+    ShardPaths* sp = &g->paths[k];
+    *c = g->base;
+
+    snprintf(sp->rule_in, sizeof(sp->rule_in), "%s.%d", g->base.rulebase_in_fifo_path, k);
+    snprintf(sp->rule_out, sizeof(sp->rule_out), "%s.%d", g->base.rulebase_out_fifo_path, k);
+    c->rulebase_in_fifo_path = sp->rule_in;
+    c->rulebase_out_fifo_path = sp->rule_out;
+
+    if (g->base.state_file_path) {
+        snprintf(sp->state_file, sizeof(sp->state_file), "%s.%d", g->base.state_file_path, k);
+        c->state_file_path = sp->state_file;
+    }
+
+    if (g->base.archive_dir) {
+        snprintf(sp->archive_dir, sizeof(sp->archive_dir), "%s.%d", g->base.archive_dir, k);
+        c->archive_dir = sp->archive_dir;
+    }
+
+    if (g->base.query_socket_path) {
+        snprintf(sp->query_socket, sizeof(sp->query_socket), "%s.%d", g->base.query_socket_path, k);
+        c->query_socket_path = sp->query_socket;
+    }
+
+    if (g->base.watch_mq_name) {
+        snprintf(sp->watch_mq, sizeof(sp->watch_mq), "%s.%d", g->base.watch_mq_name, k);
+        c->watch_mq_name = sp->watch_mq;
+        c->watch_ingest_external = 0;
+    } else {
+        c->watch_ingest_external = 1; // 라우터 스레드가 넣어줌
+    }
+    c->th_disabled = g->base.th_disabled || k != 0;
+
+    // 설정 파일 reload는 그룹 단위로만 (shard마다 읽으면 경로 suffix가 빠짐)
+    c->reload_file_path = NULL;
+}
+
+// ============================
+// 라우터 스레드 (FIFO 모드)
+// ============================
+static void _router_on_line(void* ctx, char* line, size_t len) {
+    (void)len;
+    CollectorHubGroup* g = (CollectorHubGroup*)ctx;
+    char id[DEV_INTERN_ID_LEN];
+    int n = _scan_device_id(line, id);
+    int k = n >= 0 ? shard_ring_lookup_n(g->ring, id, (size_t)n) : 0;
+
+    if (g->has_arena) mem_arena_reset(&g->router_arena);
+    collector_hub_ingest_line(g->hubs[k], line);
+    g->routed[k]++;
+}
+
+// 상대 writer가 다 닫음 → 라우터 루프가 엔진에서 내리고 재시도 timer로 다시 확인
+static void _router_on_eof(void* ctx, int fd) {
+    (void)fd;
+    ((CollectorHubGroup*)ctx)->router_eof = 1;
+}
+
+// watch FIFO 열기: non-blocking (writer 없어도 안 멈춤), 상대 writer는 hub_life_fifo_writer로 따로 확인
+static int _router_open(const char* path) {
+    _ensure_fifo(path);
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int fl = fcntl(fd, F_GETFL);
+    if (fl >= 0) fcntl(fd, F_SETFL, fl & ~O_NONBLOCK);
+    return fd;
+}
+
+static void* router_thread(void* arg) {
+    CollectorHubGroup* g = (CollectorHubGroup*)arg;
+
+    IoEngine* io = io_engine_create((IoBackend)g->base.io_backend, 0);
+    if (!io || io_engine_set_wakeup(io, hub_life_fd(&g->life)) != 0) {
+        fprintf(stderr, "❌ [HUB][SHARD] router io_engine_create failed\n");
+        hub_life_fail(&g->life, g->ep_router, ENOMEM, mq_batch_now_ms(), "[HUB][SHARD]");
+        io_engine_destroy(io);
+        return NULL;
+    }
+
+    // 라우터 스레드의 cJSON(shard의 ingest 파싱) 할당도 arena로
+    g->has_arena = mem_arena_init(&g->router_arena, 64 * 1024) == 0;
+    if (g->has_arena) mem_arena_bind(&g->router_arena);
+
+    // fd는 상대가 없어도 열어둠, 엔진에는 상대 writer가 있을 때만 (없으면 endpoint RETRY)
+    int fd = -1, attached = 0;
+    g->router_eof = 0;
+    while (!hub_life_stopping(&g->life)) {
+        if (attached && g->router_eof) {
+            io_engine_remove(io, fd);
+            attached = 0;
+            g->router_eof = 0;
+            hub_life_fail(&g->life, g->ep_router, EPIPE, mq_batch_now_ms(), "[HUB][SHARD]");
+        }
+        if (!attached) {
+            uint64_t now = mq_batch_now_ms();
+            if (!hub_life_due(&g->life, g->ep_router, now)) {
+                hub_life_wait_ms(&g->life, hub_life_retry_in_ms(&g->life, g->ep_router, now));
+                continue;
+            }
+            if (fd < 0) fd = _router_open(g->base.watch_fifo_path);
+            int peer = fd >= 0 ? hub_life_fifo_writer(fd) : -1;
+            if (peer == 0) errno = ENXIO;
+            if (peer > 0 && io_engine_add_lines(io, fd, 4096, _router_on_line, _router_on_eof, g) != 0) {
+                peer = -1;
+                errno = EIO;
+            }
+            if (peer <= 0) {
+                hub_life_fail(&g->life, g->ep_router, errno, now, "[HUB][SHARD]");
+                continue;
+            }
+            attached = 1;
+            hub_life_up(&g->life, g->ep_router, now);
+        }
+        io_engine_run_once(io, ROUTER_WAIT_MS);
+    }
+
+    io_engine_print_stats(io, "[HUB][SHARD] router");
+    if (fd >= 0) {
+        if (attached) io_engine_remove(io, fd);
+        close(fd);
+    }
+    io_engine_destroy(io);
+    if (g->has_arena) {
+        mem_arena_bind(NULL);
+        mem_arena_destroy(&g->router_arena);
+        g->has_arena = 0;
+    }
+    return NULL;
+}
+
+// ============================
+// 외부 API
+// ============================
+CollectorHubGroup* collector_hub_group_create(const CollectorHubConfig* base_cfg,
+                                              int shards, int vnodes,
+                                              CollectorHubResultCallback cb,
+                                              void* cb_ctx) {
+    if (!base_cfg) return NULL;
+    if (shards < 1) shards = 1;
+
+    CollectorHubGroup* g = (CollectorHubGroup*)calloc(1, sizeof(CollectorHubGroup));
+    if (!g) return NULL;
+
+    g->base = *base_cfg;
+    g->shards = shards;
+    g->cb = cb;
+    g->cb_ctx = cb_ctx;
+    pthread_mutex_init(&g->cb_mtx, NULL);
+    int life_ok = hub_life_init(&g->life) == 0;
+    g->ep_router = -1;
+
+    if (!g->base.watch_fifo_path) g->base.watch_fifo_path = "/tmp/th_fifo";
+    if (!g->base.rulebase_in_fifo_path) g->base.rulebase_in_fifo_path = "/tmp/rulebase_in.fifo";
+    if (!g->base.rulebase_out_fifo_path) g->base.rulebase_out_fifo_path = "/tmp/rulebase_out.fifo";
+
+    g->ring = shard_ring_create(shards, vnodes);
+    g->hubs = (CollectorHub**)calloc((size_t)shards, sizeof(CollectorHub*));
+    g->paths = (ShardPaths*)calloc((size_t)shards, sizeof(ShardPaths));
+    g->routed = (unsigned long long*)calloc((size_t)shards, sizeof(unsigned long long));
+    if (!life_ok || !g->ring || !g->hubs || !g->paths || !g->routed) {
+        collector_hub_group_destroy(g);
+        return NULL;
+    }
+
+    for (int k = 0; k < shards; k++) {
+        CollectorHubConfig c;
+        _shard_cfg(g, k, &c);
+
+        g->hubs[k] = collector_hub_create(&c, _on_shard_result, g);
+        if (!g->hubs[k]) {
+            collector_hub_group_destroy(g);
+            return NULL;
+        }
+        if (k != 0) collector_hub_set_env_source(g->hubs[k], g->hubs[0]);
+    }
+    if (!g->base.watch_mq_name && !g->base.watch_ingest_external) g->ep_router = hub_life_add(&g->life, "router");
+
+    return g;
+}
+
+// 시작 실패: 이미 시작한 shard 0 ~ n-1 되돌리기 (전부 먼저 정지 요청 → join)
+static void _stop_started(CollectorHubGroup* g, int n) {
+    for (int k = 0; k < n; k++) collector_hub_request_stop(g->hubs[k]);
+    for (int k = 0; k < n; k++) collector_hub_stop(g->hubs[k]);
+}
+
+int collector_hub_group_start(CollectorHubGroup* g) {
+    if (!g) return -1;
+    if (g->running) return 0;
+
+    for (int k = 0; k < g->shards; k++) {
+        int rc = collector_hub_start(g->hubs[k]);
+        if (rc != 0) {
+            fprintf(stderr, "❌ [HUB][SHARD] shard %d start failed (%d)\n", k, rc);
+            _stop_started(g, k);
+            return rc;
+        }
+    }
+
+    hub_life_arm(&g->life);
+    if (!g->base.watch_mq_name && !g->base.watch_ingest_external) {
+        if (pthread_create(&g->t_router, NULL, router_thread, g) != 0) {
+            fprintf(stderr, "❌ [HUB][SHARD] router thread create failed\n");
+            hub_life_disarm(&g->life);
+            _stop_started(g, g->shards);
+            return -6;
+        }
+        g->has_router = 1;
+    }
+    g->running = 1;
+
+    printf("🧩 [HUB][SHARD] %d shard started (watch: %s)\n", g->shards,
+           g->base.watch_mq_name ? g->base.watch_mq_name : g->base.watch_fifo_path);
+    return 0;
+}
+
+void collector_hub_group_stop(CollectorHubGroup* g) {
+    if (!g) return;
+
+    // 라우터 / shard 전부 먼저 정지 요청 → 각자 동시에 빠져나옴 (shard마다 차례로 기다리지 않게)
+    hub_life_request_stop(&g->life);
+    for (int k = 0; k < g->shards; k++) {
+        if (g->hubs && g->hubs[k]) collector_hub_request_stop(g->hubs[k]);
+    }
+
+    if (g->running) {
+        g->running = 0;
+        if (g->has_router) {
+            pthread_join(g->t_router, NULL);
+            g->has_router = 0;
+            for (int k = 0; k < g->shards; k++) {
+                printf("📊 [HUB][SHARD] shard %d routed=%llu\n", k, g->routed[k]);
+            }
+        }
+    }
+    for (int k = 0; k < g->shards; k++) {
+        if (g->hubs && g->hubs[k]) collector_hub_stop(g->hubs[k]);
+    }
+    hub_life_disarm(&g->life);
+}
+
+void collector_hub_group_destroy(CollectorHubGroup* g) {
+    if (!g) return;
+    collector_hub_group_stop(g);
+
+    if (g->hubs) {
+        for (int k = 0; k < g->shards; k++) collector_hub_destroy(g->hubs[k]);
+    }
+    free(g->hubs);
+    free(g->paths);
+    free(g->routed);
+    shard_ring_destroy(g->ring);
+    hub_life_destroy(&g->life);
+    pthread_mutex_destroy(&g->cb_mtx);
+    free(g);
+}
+
+int collector_hub_group_reconfigure(CollectorHubGroup* g, const CollectorHubConfig* cfg) {
+    if (!g || !cfg) return -1;
+
+    // watch 입력 구성(라우터 FIFO / MQ 이름)은 시작할 때 것 그대로
+    CollectorHubConfig prev = g->base;
+    g->base = *cfg;
+    g->base.watch_fifo_path = prev.watch_fifo_path;
+    g->base.watch_mq_name = prev.watch_mq_name;
+    g->base.watch_ingest_external = prev.watch_ingest_external;
+    if (!g->base.rulebase_in_fifo_path) g->base.rulebase_in_fifo_path = "/tmp/rulebase_in.fifo";
+    if (!g->base.rulebase_out_fifo_path) g->base.rulebase_out_fifo_path = "/tmp/rulebase_out.fifo";
+
+    int rc = 0;
+    for (int k = 0; k < g->shards; k++) {
+        CollectorHubConfig c;
+        _shard_cfg(g, k, &c);
+        int r = collector_hub_reconfigure(g->hubs[k], &c); // 문자열은 허브가 복사해감
+        if (r != 0) rc = r;
+    }
+    return rc;
+}
+
+HubLifeState collector_hub_group_state(CollectorHubGroup* g) {
+    if (!g) return HUB_LIFE_STOPPED;
+    HubLifeState s = hub_life_state(&g->life);
+    for (int k = 0; k < g->shards; k++) {
+        HubLifeState hs = collector_hub_state(g->hubs[k]);
+        if (hs < s) s = hs;
+    }
+    return s;
+}
+
+HubLifeState collector_hub_group_wait_ready(CollectorHubGroup* g, int timeout_ms) {
+    if (!g) return HUB_LIFE_STOPPED;
+    uint64_t dl = mq_batch_now_ms() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0);
+
+    // 하나씩 차례로 기다림 (남은 시간만큼)
+    hub_life_wait_state(&g->life, HUB_LIFE_READY, timeout_ms);
+    for (int k = 0; k < g->shards; k++) {
+        uint64_t now = mq_batch_now_ms();
+        collector_hub_wait_ready(g->hubs[k], now < dl ? (int)(dl - now) : 0);
+    }
+    return collector_hub_group_state(g);
+}
+
+int collector_hub_group_shards(const CollectorHubGroup* g) {
+    return g ? g->shards : 0;
+}
+
+CollectorHub* collector_hub_group_shard(CollectorHubGroup* g, int k) {
+    if (!g || k < 0 || k >= g->shards) return NULL;
+    return g->hubs[k];
+}
+
+int collector_hub_group_route(const CollectorHubGroup* g, const char* deviceId) {
+    if (!g) return -1;
+    return shard_ring_lookup(g->ring, deviceId);
+}
+
+int collector_hub_group_query(CollectorHubGroup* g, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                              HubArchiveVisit visit, void* ctx) {
+    if (!g || !deviceId) return -1;
+
+    // env는 TH 폴링하는 shard 0에만 있음
+    int k = strcmp(deviceId, HUB_ARCHIVE_ENV_ID) == 0 ? 0 : shard_ring_lookup(g->ring, deviceId);
+    return collector_hub_query(g->hubs[k], deviceId, t0_ms, t1_ms, visit, ctx);
+}
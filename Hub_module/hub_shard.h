@@ -0,0 +1,58 @@
+#ifndef HUB_SHARD_H
+#define HUB_SHARD_H
+
+/*
+허브 샤드 그룹 (deviceId consistent hash로 CollectorHub N개에 분산)
+- shard k는 자기 캐시/타이머/rule_in emitter를 따로 가짐
+  rulebase FIFO 경로는 "<경로>.k" (RuleBase도 shard마다 하나씩)
+- watch 입력
+  - FIFO 모드: 라우터 스레드가 base watch FIFO를 읽어서 deviceId로 shard 선택
+  - MQ 모드 (watch_mq_name 지정): shard k가 "<mq>.k" 를 직접 읽음
+    워치 모듈은 같은 (shards, vnodes)로 WatchUdpConfig.shard_count를 맞춰야 함
+- TH 폴링은 shard 0만, 나머지는 shard 0의 env를 tick마다 복사
+- 상태 파일 / 아카이브 디렉터리도 shard마다 "<경로>.k"
+- 모든 shard의 RESULT는 그룹 락으로 직렬화해서 콜백 하나로 합침
+*/
+
+#include "collector_hub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CollectorHubGroup CollectorHubGroup;
+
+// shards <= 1 이어도 동작 (shard 1개), vnodes <= 0 이면 SHARD_RING_DEFAULT_VNODES
+CollectorHubGroup* collector_hub_group_create(const CollectorHubConfig* base_cfg,
+                                              int shards, int vnodes,
+                                              CollectorHubResultCallback cb,
+                                              void* cb_ctx);
+
+int  collector_hub_group_start(CollectorHubGroup* g);   // 0 성공, 음수 실패
+void collector_hub_group_stop(CollectorHubGroup* g);
+void collector_hub_group_destroy(CollectorHubGroup* g);
+
+// 준비 상태: 라우터와 shard 중 가장 낮은 것 (hub_life.h)
+HubLifeState collector_hub_group_state(CollectorHubGroup* g);
+// READY가 될 때까지 최대 timeout_ms, return: 그때 상태
+HubLifeState collector_hub_group_wait_ready(CollectorHubGroup* g, int timeout_ms);
+
+// 모든 shard에 설정 변경 적용 (shard별 경로 suffix는 그룹이 붙임, watch FIFO 경로는 안 바뀜)
+// cfg의 문자열은 호출 후 해제해도 됨
+int collector_hub_group_reconfigure(CollectorHubGroup* g, const CollectorHubConfig* cfg);
+
+int collector_hub_group_shards(const CollectorHubGroup* g);
+CollectorHub* collector_hub_group_shard(CollectorHubGroup* g, int k);
+
+// deviceId가 갈 shard 번호 (워치 모듈과 같은 링)
+int collector_hub_group_route(const CollectorHubGroup* g, const char* deviceId);
+
+// 아카이브 조회 (deviceId가 속한 shard의 "<archive_dir>.k", env는 shard 0)
+int collector_hub_group_query(CollectorHubGroup* g, const char* deviceId, int64_t t0_ms, int64_t t1_ms,
+                              HubArchiveVisit visit, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,259 @@
+/*
+샤드 그룹 스케일링 벤치 (한 머신에서, rulebase / 워치 프로세스 없이)
+
+빌드 (저장소 루트에서)
+gcc -O2 -o hub_shard_bench Hub_module/hub_shard_bench.c \
+    Hub_module/collector_hub.c Hub_module/hub_shard.c Hub_module/hub_snapshot.c Hub_module/hub_config.c \
+    Hub_module/hub_result.c Hub_module/hub_archive.c Hub_module/hub_emit.c Hub_module/hub_query.c \
+    Hub_module/hub_life.c \
+    TH_Module/th_module.c TH_Module/th_health.c TH_Module/th_filter.c TH_Module/th_sched.c \
+    mq_batch.c timer_wheel.c ts_parse.c shard_ring.c mem_pool.c thread_place.c flow_ctl.c io_engine.c \
+    dev_intern.c channel_reg.c rt_pool.c \
+    -I. -IHub_module -ITH_Module $(pkg-config --cflags --libs libmodbus) -lcjson -lpthread -lrt -lm
+
+실행
+./hub_shard_bench [-s 최대 shard] [-d 디바이스 수] [-n 라인 수] [-t tick 관찰 초]
+- shard 1, 2, 4, ... 최대까지 차례로 그룹을 새로 만들어서
+  rulebase_in.k 리더(SENSOR 라인 수만 셈) / rulebase_out.k writer는 이 프로세스가 열어줌 → READY 확인
+- 입력: shard마다 producer 스레드 1개가 자기 shard 디바이스 라인만 collector_hub_ingest_line
+  (MQ 모드처럼 shard별로 따로 들어오는 경우, 라우팅은 collector_hub_group_route)
+- 출력: ingest lines/s, 라인당 CPU(user+sys), shard별 디바이스 수, tick 동안 받은 SENSOR 라인/s
+  shard가 늘 때 lines/s가 코어 수까지 같이 늘면 OK (shard 1개짜리는 허브 락 하나에 다 몰림)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "hub_shard.h"
+#include "ts_parse.h"
+
+#define BENCH_DIR      "/tmp/hub_shard_bench"
+#define BENCH_LINE_LEN 160
+
+typedef struct {
+    CollectorHubGroup* g;
+    int k;
+    char** lines;     // 이 shard 디바이스 라인
+    int n_lines;
+    long long total;  // 넣을 라인 수
+    long long bad;
+} Producer;
+
+typedef struct {
+    int fd;
+    atomic_llong lines;
+    atomic_int stop;
+} Drain;
+
+static double _mono_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double _cpu_s(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+           (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+}
+
+static void* _produce(void* arg) {
+    Producer* p = (Producer*)arg;
+    CollectorHub* hub = collector_hub_group_shard(p->g, p->k);
+    for (long long i = 0; i < p->total; i++) {
+        if (collector_hub_ingest_line(hub, p->lines[i % p->n_lines]) != 0) p->bad++;
+    }
+    return NULL;
+}
+
+// rulebase_in.k 리더: 줄 수만 셈 (허브 쪽 writer가 막히지 않게 계속 읽음)
+static void* _drain(void* arg) {
+    Drain* d = (Drain*)arg;
+    char buf[65536];
+    while (!atomic_load(&d->stop)) {
+        ssize_t n = read(d->fd, buf, sizeof(buf));
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+            usleep(1000);
+            continue;
+        }
+        long long c = 0;
+        for (ssize_t i = 0; i < n; i++) c += buf[i] == '\n';
+        atomic_fetch_add(&d->lines, c);
+    }
+    return NULL;
+}
+
+// 허브 리더가 열릴 때까지 (ENXIO) 잠깐씩 다시
+static int _open_writer(const char* path) {
+    for (int i = 0; i < 300; i++) {
+        int fd = open(path, O_WRONLY | O_NONBLOCK);
+        if (fd >= 0 || errno != ENXIO) return fd;
+        usleep(10000);
+    }
+    return -1;
+}
+
+static int _run(int shards, int devices, long long total, int tick_sec) {
+    char watch_fifo[128], rin[128], rout[128], intern[64];
+    snprintf(watch_fifo, sizeof(watch_fifo), "%s/watch.fifo", BENCH_DIR);
+    snprintf(rin, sizeof(rin), "%s/rule_in.fifo", BENCH_DIR);
+    snprintf(rout, sizeof(rout), "%s/rule_out.fifo", BENCH_DIR);
+    snprintf(intern, sizeof(intern), "/hub_shard_bench.%d", (int)getpid());
+    shm_unlink(intern);
+
+    CollectorHubConfig c;
+    memset(&c, 0, sizeof(c));
+    c.watch_fifo_path = watch_fifo;
+    c.watch_ingest_external = 1;     // 입력은 producer 스레드가 직접
+    c.rulebase_in_fifo_path = rin;
+    c.rulebase_out_fifo_path = rout;
+    c.th_disabled = 1;
+    c.collect_interval_sec = 1;
+    c.max_devices = devices;
+    c.device_stale_sec = 600;
+    c.dev_intern_name = intern;
+    c.dev_intern_capacity = devices + 16;
+
+    CollectorHubGroup* g = collector_hub_group_create(&c, shards, 0, NULL, NULL);
+    if (!g || collector_hub_group_start(g) != 0) {
+        fprintf(stderr, "❌ [BENCH] group (%d shards) start failed\n", shards);
+        collector_hub_group_destroy(g);
+        shm_unlink(intern);
+        return -1;
+    }
+
+    // 상대 프로세스 역할: rule_in 리더 / rule_out writer
+    Drain* dr = (Drain*)calloc((size_t)shards, sizeof(Drain));
+    pthread_t* dt = (pthread_t*)calloc((size_t)shards, sizeof(pthread_t));
+    int* out_fd = (int*)calloc((size_t)shards, sizeof(int));
+    for (int k = 0; k < shards; k++) {
+        char p[160];
+        snprintf(p, sizeof(p), "%s.%d", rin, k);
+        mkfifo(p, 0666);
+        dr[k].fd = open(p, O_RDONLY | O_NONBLOCK);
+        pthread_create(&dt[k], NULL, _drain, &dr[k]);
+        snprintf(p, sizeof(p), "%s.%d", rout, k);
+        out_fd[k] = _open_writer(p);
+    }
+    HubLifeState st = collector_hub_group_wait_ready(g, 3000);
+
+    // shard별 디바이스 라인 (라우팅은 워치 모듈과 같은 링)
+    Producer* pr = (Producer*)calloc((size_t)shards, sizeof(Producer));
+    int* per = (int*)calloc((size_t)shards, sizeof(int));
+    for (int i = 0; i < devices; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "W%06d", i);
+        per[collector_hub_group_route(g, id)]++;
+    }
+    for (int k = 0; k < shards; k++) {
+        pr[k].g = g;
+        pr[k].k = k;
+        pr[k].lines = (char**)calloc((size_t)(per[k] ? per[k] : 1), sizeof(char*));
+    }
+    int64_t now = ts_now_ms();
+    for (int i = 0; i < devices; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "W%06d", i);
+        Producer* p = &pr[collector_hub_group_route(g, id)];
+        char* line = (char*)malloc(BENCH_LINE_LEN);
+        snprintf(line, BENCH_LINE_LEN, "{\"deviceId\":\"%s\",\"ts\":%lld,\"heartRate\":%d,\"skin_temperature\":%.1f}",
+                 id, (long long)now, 60 + i % 40, 36.0 + (double)(i % 10) / 10.0);
+        p->lines[p->n_lines++] = line;
+    }
+
+    // 입력 (라인 수는 shard 디바이스 비율대로 나눔)
+    double t0 = _mono_s(), c0 = _cpu_s();
+    pthread_t* pt = (pthread_t*)calloc((size_t)shards, sizeof(pthread_t));
+    for (int k = 0; k < shards; k++) {
+        pr[k].total = pr[k].n_lines ? total * pr[k].n_lines / devices : 0;
+        pthread_create(&pt[k], NULL, _produce, &pr[k]);
+    }
+    long long done = 0, bad = 0;
+    for (int k = 0; k < shards; k++) {
+        pthread_join(pt[k], NULL);
+        done += pr[k].total;
+        bad += pr[k].bad;
+    }
+    double wall = _mono_s() - t0, cpu = _cpu_s() - c0;
+
+    // tick 관찰: 디바이스가 다 들어간 상태에서 SENSOR 출력
+    long long s0 = 0, s1 = 0;
+    for (int k = 0; k < shards; k++) s0 += atomic_load(&dr[k].lines);
+    double tt0 = _mono_s();
+    sleep((unsigned)tick_sec);
+    for (int k = 0; k < shards; k++) s1 += atomic_load(&dr[k].lines);
+    double tw = _mono_s() - tt0;
+
+    printf("📊 [BENCH] shards=%d ready=%s devices=%d lines=%lld bad=%lld wall=%.3fs → %.0f lines/s, cpu %.2f us/line (%.0f%% of 1 core)\n",
+           shards, hub_life_state_name(st), devices, done, bad, wall, (double)done / wall,
+           cpu * 1e6 / (double)(done ? done : 1), cpu * 100.0 / wall);
+    printf("📊 [BENCH] shards=%d sensor lines/s=%.0f per-shard devices:", shards, (double)(s1 - s0) / tw);
+    for (int k = 0; k < shards; k++) printf(" %d", per[k]);
+    printf("\n");
+
+    collector_hub_group_stop(g);
+    collector_hub_group_destroy(g);
+    for (int k = 0; k < shards; k++) {
+        atomic_store(&dr[k].stop, 1);
+        pthread_join(dt[k], NULL);
+        if (dr[k].fd >= 0) close(dr[k].fd);
+        if (out_fd[k] >= 0) close(out_fd[k]);
+        for (int i = 0; i < pr[k].n_lines; i++) free(pr[k].lines[i]);
+        free(pr[k].lines);
+    }
+    free(dr);
+    free(dt);
+    free(out_fd);
+    free(pr);
+    free(per);
+    free(pt);
+    shm_unlink(intern);
+    return bad ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    int max_shards = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int devices = 20000;
+    long long total = 2000000;
+    int tick_sec = 2;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:d:n:t:")) != -1) {
+        switch (opt) {
+        case 's': max_shards = atoi(optarg); break;
+        case 'd': devices = atoi(optarg); break;
+        case 'n': total = atoll(optarg); break;
+        case 't': tick_sec = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-s max_shards] [-d devices] [-n lines] [-t tick_sec]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max_shards < 1) max_shards = 1;
+    if (devices < 1) devices = 1;
+    if (tick_sec < 1) tick_sec = 1;
+
+    mkdir(BENCH_DIR, 0777);
+    printf("▶ [BENCH] cores=%ld devices=%d lines=%lld (shard 1 → %d)\n", sysconf(_SC_NPROCESSORS_ONLN), devices,
+           total, max_shards);
+
+    int rc = 0;
+    for (int s = 1;; s *= 2) {
+        if (s > max_shards) s = max_shards;
+        if (_run(s, devices, total, tick_sec) != 0) rc = 1;
+        if (s == max_shards) break;
+    }
+    return rc;
+}
@@ -0,0 +1,231 @@
+#include "hub_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct HubSnapshot {
+    int fd;
+    size_t map_len;
+    HubSnapHdr* hdr;
+    HubSnapRec* recs;
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static uint32_t _fnv1a(const void* p, size_t n) {
+    const unsigned char* b = (const unsigned char*)p;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t _rec_checksum(const HubSnapRec* r) {
+    return _fnv1a(r, offsetof(HubSnapRec, checksum));
+}
+
+static uint32_t _env_checksum(const HubSnapHdr* h) {
+    return _fnv1a(&h->has_env, sizeof(HubSnapHdr) - offsetof(HubSnapHdr, has_env));
+}
+
+static size_t _file_len(int capacity) {
+    return sizeof(HubSnapHdr) + (size_t)capacity * sizeof(HubSnapRec);
+}
+
+static int _header_ok(const HubSnapHdr* h, size_t file_len) {
+    return h->magic == HUB_SNAP_MAGIC &&
+           h->version == HUB_SNAP_VERSION &&
+           h->rec_size == sizeof(HubSnapRec) &&
+           _file_len((int)h->capacity) <= file_len;
+}
+
+static int _map(HubSnapshot* s, int capacity) {
+    s->map_len = _file_len(capacity);
+    void* p = mmap(NULL, s->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+    if (p == MAP_FAILED) {
+        perror("mmap state_file");
+        return -1;
+    }
+    s->hdr = (HubSnapHdr*)p;
+    s->recs = (HubSnapRec*)((unsigned char*)p + sizeof(HubSnapHdr));
+    return 0;
+}
+
+// ================================
+// 외부 API
+// ================================
+HubSnapshot* hub_snapshot_open(const char* path, int capacity) {
+    if (!path || capacity <= 0) return NULL;
+
+    HubSnapshot* s = (HubSnapshot*)calloc(1, sizeof(HubSnapshot));
+    if (!s) return NULL;
+
+    s->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (s->fd < 0) {
+        perror("open state_file");
+        free(s);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(s->fd, &st) != 0) {
+        perror("fstat state_file");
+        close(s->fd);
+        free(s);
+        return NULL;
+    }
+
+    // 기존 파일 헤더 확인 (capacity가 다르면 유효한 레코드만 꺼내둠)
+    HubSnapHdr old;
+    memset(&old, 0, sizeof(old));
+    HubSnapRec* keep = NULL;
+    int nkeep = 0;
+    int reuse = 0;
+
+    if ((size_t)st.st_size >= sizeof(HubSnapHdr) &&
+        pread(s->fd, &old, sizeof(old), 0) == (ssize_t)sizeof(old) &&
+        _header_ok(&old, (size_t)st.st_size)) {
+        if ((int)old.capacity == capacity) {
+            reuse = 1;
+        } else {
+            keep = (HubSnapRec*)calloc((size_t)capacity, sizeof(HubSnapRec));
+            for (uint32_t i = 0; keep && i < old.capacity && nkeep < capacity; i++) {
+                HubSnapRec r;
+                off_t off = (off_t)(sizeof(HubSnapHdr) + (size_t)i * sizeof(HubSnapRec));
+                if (pread(s->fd, &r, sizeof(r), off) != (ssize_t)sizeof(r)) break;
+                if (r.used && r.checksum == _rec_checksum(&r)) keep[nkeep++] = r;
+            }
+        }
+    }
+
+    if (!reuse) {
+        // 새로 만들거나 크기 변경: 0으로 채운 뒤 헤더/옮긴 레코드 기록
+        if (ftruncate(s->fd, 0) != 0 || ftruncate(s->fd, (off_t)_file_len(capacity)) != 0) {
+            perror("ftruncate state_file");
+            free(keep);
+            close(s->fd);
+            free(s);
+            return NULL;
+        }
+    }
+
+    if (_map(s, capacity) != 0) {
+        free(keep);
+        close(s->fd);
+        free(s);
+        return NULL;
+    }
+
+    if (!reuse) {
+        HubSnapHdr* h = s->hdr;
+        h->magic = HUB_SNAP_MAGIC;
+        h->version = HUB_SNAP_VERSION;
+        h->rec_size = sizeof(HubSnapRec);
+        h->capacity = (uint32_t)capacity;
+        h->generation = old.magic == HUB_SNAP_MAGIC ? old.generation : 0;
+        h->saved_ms = old.magic == HUB_SNAP_MAGIC ? old.saved_ms : 0;
+
+        // env는 이전 파일 것이 온전하면 그대로 가져감
+        if (old.magic == HUB_SNAP_MAGIC && old.env_checksum == _env_checksum(&old)) {
+            h->has_env = old.has_env;
+            h->temp = old.temp;
+            h->humi = old.humi;
+            h->env_ts_ms = old.env_ts_ms;
+        }
+        h->env_checksum = _env_checksum(h);
+
+        for (int i = 0; i < nkeep; i++) s->recs[i] = keep[i];
+        if (nkeep > 0) {
+            printf("🗂️ [HUB][STATE] capacity %u → %d, %d records kept\n", old.capacity, capacity, nkeep);
+        }
+    }
+    free(keep);
+    return s;
+}
+
+void hub_snapshot_close(HubSnapshot* s) {
+    if (!s) return;
+    if (s->hdr) {
+        msync(s->hdr, s->map_len, MS_SYNC);
+        munmap(s->hdr, s->map_len);
+    }
+    if (s->fd >= 0) close(s->fd);
+    free(s);
+}
+
+int hub_snapshot_capacity(const HubSnapshot* s) {
+    return s ? (int)s->hdr->capacity : 0;
+}
+
+const HubSnapHdr* hub_snapshot_header(const HubSnapshot* s) {
+    return s ? s->hdr : NULL;
+}
+
+int hub_snapshot_get(const HubSnapshot* s, int slot, HubSnapRec* out) {
+    if (!s || !out || slot < 0 || slot >= (int)s->hdr->capacity) return -1;
+
+    *out = s->recs[slot];
+    if (!out->used || out->checksum != _rec_checksum(out)) return -1;
+    out->deviceId[sizeof(out->deviceId) - 1] = '\0';
+    return 0;
+}
+
+void hub_snapshot_put(HubSnapshot* s, int slot, const HubSnapRec* rec) {
+    if (!s || !rec || slot < 0 || slot >= (int)s->hdr->capacity) return;
+
+    HubSnapRec r = *rec;
+    r.used = 1;
+    r._pad = 0;
+    r.checksum = _rec_checksum(&r);
+    s->recs[slot] = r;
+}
+
+void hub_snapshot_clear(HubSnapshot* s, int slot) {
+    if (!s || slot < 0 || slot >= (int)s->hdr->capacity) return;
+    memset(&s->recs[slot], 0, sizeof(HubSnapRec));
+}
+
+int hub_snapshot_get_env(const HubSnapshot* s, double* temp, double* humi, int64_t* ts_ms) {
+    if (!s) return -1;
+    const HubSnapHdr* h = s->hdr;
+    if (!h->has_env || h->env_checksum != _env_checksum(h)) return -1;
+
+    if (temp) *temp = h->temp;
+    if (humi) *humi = h->humi;
+    if (ts_ms) *ts_ms = h->env_ts_ms;
+    return 0;
+}
+
+void hub_snapshot_put_env(HubSnapshot* s, int has_env, double temp, double humi, int64_t ts_ms) {
+    if (!s) return;
+    HubSnapHdr* h = s->hdr;
+    h->has_env = has_env;
+    h->_pad = 0;
+    h->temp = temp;
+    h->humi = humi;
+    h->env_ts_ms = ts_ms;
+    h->env_checksum = _env_checksum(h);
+}
+
+int hub_snapshot_commit(HubSnapshot* s, int64_t now_ms) {
+    if (!s) return -1;
+    s->hdr->generation++;
+    s->hdr->saved_ms = now_ms;
+
+    // MAP_SHARED라 프로세스가 죽어도 페이지 캐시에 남음, 여기서는 writeback만 앞당김
+    if (msync(s->hdr, s->map_len, MS_ASYNC) != 0) {
+        perror("msync state_file");
+        return -1;
+    }
+    return 0;
+}
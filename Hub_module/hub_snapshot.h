@@ -0,0 +1,78 @@
+#ifndef HUB_SNAPSHOT_H
+#define HUB_SNAPSHOT_H
+
+/*
+허브 상태 스냅샷 파일 (mmap, warm restart용)
+- 파일 = [HubSnapHdr][HubSnapRec * capacity], 레코드 번호 = 허브 캐시 슬롯 번호
+- 허브는 바뀐 슬롯만 레코드에 덮어씀 (증분 checkpoint)
+- 레코드마다 checksum → 쓰다가 죽어서 찢어진 레코드는 로드할 때 버림
+- magic/version/rec_size가 다르면 빈 파일로 새로 시작
+- capacity가 바뀌면 유효한 레코드만 앞에서부터 옮겨 담음
+- 스레드 안전하지 않음: 허브가 hub->mtx로 보호
+*/
+
+#include <stdint.h>
+
+#include "channel_reg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HUB_SNAP_MAGIC   0x504E5348u // "HSNP"
+#define HUB_SNAP_VERSION 2
+
+typedef struct {
+    uint32_t used;
+    char deviceId[64];
+    uint32_t present;    // 채널 bitmask (channel_reg 번호, channels 설정을 바꾸면 번호가 달라짐)
+    double val[CHAN_MAX];
+    int64_t dev_ts_ms;   // 워치 측정 시각 (epoch ms)
+    int64_t rx_ts_ms;    // 마지막 수신 시각 (epoch ms), 로드할 때 stale 판정 기준
+    int64_t skew_ms;
+    uint32_t checksum;   // 위 필드들의 FNV-1a
+    uint32_t _pad;
+} HubSnapRec;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_size;   // sizeof(HubSnapRec)
+    uint32_t capacity;
+    uint32_t env_checksum;
+    uint64_t generation; // checkpoint 횟수
+    int64_t saved_ms;    // 마지막 checkpoint 시각 (epoch ms)
+
+    // env(TH)
+    int32_t has_env;
+    int32_t _pad;
+    double temp;
+    double humi;
+    int64_t env_ts_ms;   // env 갱신 시각 (epoch ms)
+} HubSnapHdr;
+
+typedef struct HubSnapshot HubSnapshot;
+
+HubSnapshot* hub_snapshot_open(const char* path, int capacity); // 실패하면 NULL
+void hub_snapshot_close(HubSnapshot* s);                        // msync 후 unmap
+
+int hub_snapshot_capacity(const HubSnapshot* s);
+const HubSnapHdr* hub_snapshot_header(const HubSnapshot* s);
+
+// 0: 유효한 레코드, -1: 빈 슬롯/찢어진 레코드
+int  hub_snapshot_get(const HubSnapshot* s, int slot, HubSnapRec* out);
+void hub_snapshot_put(HubSnapshot* s, int slot, const HubSnapRec* rec); // checksum은 여기서 채움
+void hub_snapshot_clear(HubSnapshot* s, int slot);
+
+// env: 0 유효, -1 없음/손상
+int  hub_snapshot_get_env(const HubSnapshot* s, double* temp, double* humi, int64_t* ts_ms);
+void hub_snapshot_put_env(HubSnapshot* s, int has_env, double temp, double humi, int64_t ts_ms);
+
+// checkpoint 마무리: generation/saved_ms 갱신 + msync(MS_ASYNC)
+int hub_snapshot_commit(HubSnapshot* s, int64_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+#include "th_filter.h"
+
+#include <string.h>
+
+// ================================
+// 내부 유틸
+// ================================
+// 작은 배열이라 삽입 정렬로 충분
+static float _median(const float* ring, int n) {
+    float tmp[TH_FILTER_RING];
+    for (int i = 0; i < n; i++) {
+        float v = ring[i];
+        int j = i - 1;
+        while (j >= 0 && tmp[j] > v) {
+            tmp[j + 1] = tmp[j];
+            j--;
+        }
+        tmp[j + 1] = v;
+    }
+    if (n & 1) return tmp[n / 2];
+    return (tmp[n / 2 - 1] + tmp[n / 2]) * 0.5f;
+}
+
+static float _clamp_delta(float prev, float cur, float max_delta, int* hit) {
+    if (cur > prev + max_delta) { *hit = 1; return prev + max_delta; }
+    if (cur < prev - max_delta) { *hit = 1; return prev - max_delta; }
+    return cur;
+}
+
+static void _stage_rate_clamp(THFilter* f, THFilterStage* s, float* t, float* h, uint64_t now_ms) {
+    if (s->primed && now_ms > s->last_ms) {
+        float dt = (float)(now_ms - s->last_ms) / 1000.0f;
+        int hit = 0;
+        if (s->cfg.max_temp_rate > 0) *t = _clamp_delta(s->last_t, *t, s->cfg.max_temp_rate * dt, &hit);
+        if (s->cfg.max_humi_rate > 0) *h = _clamp_delta(s->last_h, *h, s->cfg.max_humi_rate * dt, &hit);
+        if (hit) f->stats.clamped++;
+    }
+    s->primed = 1;
+    s->last_t = *t;
+    s->last_h = *h;
+    s->last_ms = now_ms;
+}
+
+static void _stage_median(THFilterStage* s, float* t, float* h) {
+    int n = s->cfg.median_n;
+
+    s->ring_t[s->head] = *t;
+    s->ring_h[s->head] = *h;
+    s->head = (s->head + 1) % n;
+    if (s->count < n) s->count++;
+
+    // 창이 덜 찼으면 있는 것만으로 중앙값
+    *t = _median(s->ring_t, s->count);
+    *h = _median(s->ring_h, s->count);
+}
+
+static void _stage_ewma(THFilterStage* s, float* t, float* h) {
+    if (s->primed) {
+        float a = s->cfg.alpha;
+        *t = a * *t + (1.0f - a) * s->last_t;
+        *h = a * *h + (1.0f - a) * s->last_h;
+    }
+    s->primed = 1;
+    s->last_t = *t;
+    s->last_h = *h;
+}
+
+// ================================
+// 외부 API
+// ================================
+void th_filter_default_config(THFilterConfig* cfg) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+
+    cfg->stages[0].kind = TH_FILTER_RATE_CLAMP;
+    cfg->stages[0].max_temp_rate = 1.0f;
+    cfg->stages[0].max_humi_rate = 5.0f;
+
+    cfg->stages[1].kind = TH_FILTER_MEDIAN;
+    cfg->stages[1].median_n = 3;
+
+    cfg->stages[2].kind = TH_FILTER_EWMA;
+    cfg->stages[2].alpha = 0.5f;
+}
+
+void th_filter_init(THFilter* f, const THFilterConfig* cfg) {
+    memset(f, 0, sizeof(*f));
+    if (!cfg) return;
+
+    for (int i = 0; i < TH_FILTER_MAX_STAGES; i++) {
+        THFilterStageConfig sc = cfg->stages[i];
+        if (sc.kind == TH_FILTER_NONE) break;
+
+        // 잘못된 파라미터의 단계는 건너뜀
+        if (sc.kind == TH_FILTER_MEDIAN && (sc.median_n < 2 || sc.median_n > TH_FILTER_RING)) continue;
+        if (sc.kind == TH_FILTER_EWMA && (sc.alpha <= 0.0f || sc.alpha > 1.0f)) continue;
+        if (sc.kind == TH_FILTER_RATE_CLAMP && sc.max_temp_rate <= 0 && sc.max_humi_rate <= 0) continue;
+
+        f->st[f->n++].cfg = sc;
+    }
+}
+
+void th_filter_reset(THFilter* f) {
+    for (int i = 0; i < f->n; i++) {
+        THFilterStageConfig sc = f->st[i].cfg;
+        memset(&f->st[i], 0, sizeof(f->st[i]));
+        f->st[i].cfg = sc;
+    }
+}
+
+void th_filter_apply(THFilter* f, float* t, float* h, uint64_t now_ms) {
+    for (int i = 0; i < f->n; i++) {
+        THFilterStage* s = &f->st[i];
+        switch (s->cfg.kind) {
+        case TH_FILTER_RATE_CLAMP: _stage_rate_clamp(f, s, t, h, now_ms); break;
+        case TH_FILTER_MEDIAN:     _stage_median(s, t, h); break;
+        case TH_FILTER_EWMA:       _stage_ewma(s, t, h); break;
+        default: break;
+        }
+    }
+    f->stats.samples++;
+}
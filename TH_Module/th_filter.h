@@ -0,0 +1,78 @@
+#ifndef TH_FILTER_H
+#define TH_FILTER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+센서별 필터 파이프라인 (동적 할당 없음, 핸들 안에 그대로 들어감)
+- stages[]에 적은 순서대로 적용, kind가 TH_FILTER_NONE인 곳에서 끝
+- 범위 밖 값은 파이프라인에 넣지 않고 th_module_read에서 바로 BAD_VALUE 처리
+*/
+#define TH_FILTER_MAX_STAGES 4
+#define TH_FILTER_RING       9  // median 창 최대 크기
+
+typedef enum {
+    TH_FILTER_NONE = 0,
+    TH_FILTER_RATE_CLAMP,  // 직전 출력 대비 변화율 제한 (범위 안의 튐 억제)
+    TH_FILTER_MEDIAN,      // 최근 N개 중앙값
+    TH_FILTER_EWMA,        // 지수 이동 평균
+} THFilterKind;
+
+typedef struct {
+    THFilterKind kind;
+    int   median_n;        // MEDIAN: 창 크기 (2 ~ TH_FILTER_RING)
+    float alpha;           // EWMA: 새 값 가중치 (0,1]
+    float max_temp_rate;   // RATE_CLAMP: °C/s
+    float max_humi_rate;   // RATE_CLAMP: %/s
+} THFilterStageConfig;
+
+typedef struct {
+    THFilterStageConfig stages[TH_FILTER_MAX_STAGES];
+} THFilterConfig;
+
+typedef struct {
+    THFilterStageConfig cfg;
+
+    // MEDIAN: 최근 샘플 ring
+    float ring_t[TH_FILTER_RING];
+    float ring_h[TH_FILTER_RING];
+    int head;
+    int count;
+
+    // EWMA / RATE_CLAMP: 직전 출력
+    int primed;
+    float last_t;
+    float last_h;
+    uint64_t last_ms;
+} THFilterStage;
+
+typedef struct {
+    uint64_t samples;      // 파이프라인 통과한 샘플 수
+    uint64_t clamped;      // 변화율 제한에 걸린 수
+    uint64_t rejected;     // 범위 밖이라 버린 수
+} THFilterStats;
+
+typedef struct {
+    THFilterStage st[TH_FILTER_MAX_STAGES];
+    int n;
+    THFilterStats stats;
+} THFilter;
+
+// 기본 파이프라인: RATE_CLAMP(1°C/s, 5%/s) → MEDIAN(3) → EWMA(0.5)
+void th_filter_default_config(THFilterConfig* cfg);
+
+void th_filter_init(THFilter* f, const THFilterConfig* cfg);
+void th_filter_reset(THFilter* f); // 상태만 비움 (설정 유지)
+
+// t/h를 제자리에서 필터링 (now_ms: CLOCK_MONOTONIC)
+void th_filter_apply(THFilter* f, float* t, float* h, uint64_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
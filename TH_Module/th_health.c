@@ -0,0 +1,78 @@
+#include "th_health.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+uint64_t th_health_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000ULL);
+}
+
+void th_health_init(THHealth* h, const THHealthConfig* cfg) {
+    memset(h, 0, sizeof(*h));
+    if (cfg) h->cfg = *cfg;
+
+    // defaults
+    if (h->cfg.fail_threshold <= 0) h->cfg.fail_threshold = 1;
+    if (h->cfg.backoff_base_ms <= 0) h->cfg.backoff_base_ms = 2000;
+    if (h->cfg.backoff_max_ms <= 0) h->cfg.backoff_max_ms = 60000;
+    if (h->cfg.backoff_max_ms < h->cfg.backoff_base_ms) h->cfg.backoff_max_ms = h->cfg.backoff_base_ms;
+
+    h->state = TH_HEALTH_CLOSED;
+    h->backoff_ms = h->cfg.backoff_base_ms;
+
+    // 여러 센서가 동시에 죽어도 재시도 시각이 겹치지 않게 seed를 다르게
+    h->rng = (unsigned int)th_health_now_ms() ^ (unsigned int)getpid() ^ (unsigned int)(uintptr_t)h;
+}
+
+int th_health_allow(THHealth* h, uint64_t now_ms) {
+    if (h->state != TH_HEALTH_OPEN) return 1;
+
+    if (now_ms >= h->open_until_ms) {
+        h->state = TH_HEALTH_HALF_OPEN;
+        return 1;
+    }
+
+    h->st.fast_fails++;
+    return 0;
+}
+
+void th_health_on_success(THHealth* h, uint64_t now_ms) {
+    (void)now_ms;
+    h->st.reads_ok++;
+    h->state = TH_HEALTH_CLOSED;
+    h->consecutive_fail = 0;
+    h->backoff_ms = h->cfg.backoff_base_ms;
+}
+
+void th_health_on_failure(THHealth* h, uint64_t now_ms) {
+    h->st.reads_fail++;
+    h->consecutive_fail++;
+
+    if (h->state == TH_HEALTH_HALF_OPEN) {
+        // 시험 연결 실패 → backoff 2배
+        h->backoff_ms *= 2;
+        if (h->backoff_ms > h->cfg.backoff_max_ms) h->backoff_ms = h->cfg.backoff_max_ms;
+    } else if (h->consecutive_fail < h->cfg.fail_threshold) {
+        return;
+    }
+
+    // equal jitter: backoff/2 + [0, backoff/2)
+    int half = h->backoff_ms / 2;
+    int jitter = (half > 0) ? (int)(rand_r(&h->rng) % (unsigned int)half) : 0;
+
+    h->state = TH_HEALTH_OPEN;
+    h->open_until_ms = now_ms + (uint64_t)(half + jitter);
+    h->st.trips++;
+}
+
+void th_health_get_stats(const THHealth* h, THHealthStats* out) {
+    if (!h || !out) return;
+    *out = h->st;
+    out->state = (int)h->state;
+    out->consecutive_fail = h->consecutive_fail;
+    out->backoff_ms = h->backoff_ms;
+}
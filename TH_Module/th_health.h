@@ -0,0 +1,72 @@
+#ifndef TH_HEALTH_H
+#define TH_HEALTH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Modbus 연결 상태 머신 (circuit breaker)
+- CLOSED    : 정상, 실패하면 soft/hard 복구까지 시도
+- OPEN      : 복구까지 실패한 상태, backoff 동안은 통신 없이 바로 실패 리턴
+- HALF_OPEN : backoff가 끝나면 1번만 시험 연결 → 성공하면 CLOSED, 실패하면 backoff 2배로 OPEN
+*/
+typedef enum {
+    TH_HEALTH_CLOSED = 0,
+    TH_HEALTH_OPEN,
+    TH_HEALTH_HALF_OPEN,
+} THHealthState;
+
+// 0 이하 값은 기본값 사용
+typedef struct {
+    int fail_threshold;    // 연속 실패 몇 번이면 OPEN (기본 1: 복구 단계까지 전부 실패한 경우)
+    int backoff_base_ms;   // 첫 OPEN 유지 시간 (기본 2000)
+    int backoff_max_ms;    // 최대 OPEN 유지 시간 (기본 60000)
+} THHealthConfig;
+
+// 외부로 내보내는 통계
+typedef struct {
+    int state;                  // THHealthState
+    int consecutive_fail;
+    int backoff_ms;             // 현재 backoff
+
+    uint64_t reads_ok;
+    uint64_t reads_fail;
+    uint64_t soft_reconnects;   // _soft_reconnect 시도 횟수
+    uint64_t hard_recreates;    // _hard_recreate 시도 횟수
+    uint64_t trips;             // OPEN으로 전환된 횟수
+    uint64_t fast_fails;        // OPEN 상태라 통신 없이 실패 리턴한 횟수
+    uint64_t recover_ms_total;  // 복구(재연결+재시도)에 쓴 누적 시간
+} THHealthStats;
+
+typedef struct {
+    THHealthConfig cfg;
+    THHealthState state;
+    int consecutive_fail;
+    int backoff_ms;
+    uint64_t open_until_ms;     // CLOCK_MONOTONIC
+    unsigned int rng;           // jitter용 rand_r seed
+    THHealthStats st;
+} THHealth;
+
+void th_health_init(THHealth* h, const THHealthConfig* cfg);
+
+// 지금 통신을 시도해도 되는지 (1: 시도, 0: fail fast)
+// OPEN에서 backoff가 끝났으면 HALF_OPEN으로 바꾸고 1 리턴
+int  th_health_allow(THHealth* h, uint64_t now_ms);
+
+void th_health_on_success(THHealth* h, uint64_t now_ms);
+void th_health_on_failure(THHealth* h, uint64_t now_ms);
+
+// 통계 스냅샷
+void th_health_get_stats(const THHealth* h, THHealthStats* out);
+
+uint64_t th_health_now_ms(void); // CLOCK_MONOTONIC ms
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
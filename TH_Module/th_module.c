@@ -1,197 +1,297 @@
 #include <modbus/modbus.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <unistd.h>
 
 #include "th_module.h"
 
 // ================================
-// 내부 상태(전역)
+// 센서 핸들 (센서마다 1개, 전역 상태 없음)
 // ================================
-static modbus_t *g_ctx = NULL;
+struct THSensor {
+    THSensorConfig cfg;
+    char ip[64];          // cfg.ip는 이 버퍼를 가리킴 (호출자 문자열 수명과 무관하게)
+    int reg_cnt;          // 레지스터 맵에서 계산한 읽기 개수
 
-static char g_ip[64] = {0};
-static int  g_port = 0;
+    modbus_t *ctx;
+    pthread_mutex_t ctx_mtx;   // ctx 교체 ↔ th_module_abort (다른 스레드)만, 통신 중엔 안 잡음
+    atomic_int aborted;        // th_module_abort 뒤로는 연결 / 재연결 안 함
 
-// 센서/네트워크 환경에 맞게 조절 가능
-static const int   SLAVE_ID = 1; //TODO 이 부분은 BT-NB114의 온습도계 번호와 맞아야 함 확인 필요
-// 그 BT-NB114 보면 버튼 있는데 그거 8번 버튼 켜져 있으면 1번 맞을거야, 내가 8번 켜두고 써서 아마 안바꿨으면 1 맞아
-static const int   REG_ADDR = 0;
-static const int   REG_CNT  = 2;
+    // 연결 상태 머신 (죽은 게이트웨이에 매 주기 3초 이상 묶이지 않도록)
+    THHealth health;
 
-// 무결성 체크 범위(필요하면 센서 스펙에 맞춰 조정)
-// 예: 산업용 온습도 센서 흔한 범위
-static const float TEMP_MIN = -40.0f;
-static const float TEMP_MAX =  85.0f;
-static const float HUMI_MIN =   0.0f;
-static const float HUMI_MAX = 100.0f;
-
-// 타임아웃(무선 환경 고려)
-static const int TIMEOUT_SEC = 1;
-static const int TIMEOUT_USEC = 0;
+    // 범위 안의 튐을 거르는 필터 (최근 샘플 ring 포함)
+    THFilter filter;
+};
 
 // ================================
 // 내부 유틸
 // ================================
-static int _validate_range(float t, float h) {
-    if (t < TEMP_MIN || t > TEMP_MAX) return 0;
-    if (h < HUMI_MIN || h > HUMI_MAX) return 0;
+static int _validate_range(const THSensor* s, float t, float h) {
+    if (t < s->cfg.temp_min || t > s->cfg.temp_max) return 0;
+    if (h < s->cfg.humi_min || h > s->cfg.humi_max) return 0;
     return 1;
 }
 
-static void _apply_common_options(modbus_t *c) { 
+static float _scale(const THSensor* s, uint16_t raw, float scale) {
+    float v = s->cfg.signed_regs ? (float)(int16_t)raw : (float)raw;
+    return v / scale;
+}
+
+static void _apply_common_options(const THSensor* s, modbus_t *c) {
     // Slave ID 설정
-    modbus_set_slave(c, SLAVE_ID);
+    modbus_set_slave(c, s->cfg.slave_id);
 
     // 응답 타임아웃 설정
     struct timeval tv;
-    tv.tv_sec = TIMEOUT_SEC;
-    tv.tv_usec = TIMEOUT_USEC;
+    tv.tv_sec = s->cfg.timeout_sec;
+    tv.tv_usec = s->cfg.timeout_usec;
     modbus_set_response_timeout(c, tv.tv_sec, tv.tv_usec);
 }
 
-// ctx를 유지한 채로 재연결(가벼운 복구)
-static int _soft_reconnect(void) {
-    if (!g_ctx) return -1;
+static int _aborted(THSensor* s) {
+    if (!atomic_load(&s->aborted)) return 0;
+    errno = ECANCELED;
+    return 1;
+}
 
-    // 기존 연결 닫고 다시 연결
-    modbus_close(g_ctx); 
-    if (modbus_connect(g_ctx) == -1) {
+// ctx 떼어내서 정리 (abort가 닫힌 소켓 번호를 shutdown하지 않게 떼는 건 락 안에서)
+static void _drop_ctx(THSensor* s) {
+    pthread_mutex_lock(&s->ctx_mtx);
+    modbus_t* c = s->ctx;
+    s->ctx = NULL;
+    pthread_mutex_unlock(&s->ctx_mtx);
+    if (c) {
+        modbus_close(c);
+        modbus_free(c);
+    }
+}
+
+// ctx를 유지한 채로 재연결(가벼운 복구)
+static int _soft_reconnect(THSensor* s) {
+    if (!s->ctx) return -1;
+
+    // 기존 연결 닫고 다시 연결 (닫기는 락 안에서: 닫힌 fd 번호가 abort에 보이지 않게)
+    pthread_mutex_lock(&s->ctx_mtx);
+    modbus_close(s->ctx);
+    pthread_mutex_unlock(&s->ctx_mtx);
+    if (_aborted(s) || modbus_connect(s->ctx) == -1) {
         return -1;
     }
 
     // 재연결 후 옵션 재적용(안전)
-    _apply_common_options(g_ctx);
+    _apply_common_options(s, s->ctx);
     return 0;
 }
 
 // ctx 자체를 새로 만드는 복구(무거운 복구)
-static int _hard_recreate(void) {
-    if (g_ip[0] == '\0' || g_port <= 0) return -1;
+static int _hard_recreate(THSensor* s) {
+    if (s->ip[0] == '\0' || s->cfg.port <= 0) return -1;
 
-    if (g_ctx) {
-        modbus_close(g_ctx);
-        modbus_free(g_ctx);
-        g_ctx = NULL;
-    }
+    _drop_ctx(s);
+    if (_aborted(s)) return -1;
+
+    modbus_t* c = modbus_new_tcp(s->ip, s->cfg.port);
+    if (!c) return -1;
 
-    g_ctx = modbus_new_tcp(g_ip, g_port);
-    if (!g_ctx) return -1;
+    _apply_common_options(s, c);
 
-    _apply_common_options(g_ctx);
+    // connect 전에 걸어둠 → connect 대기 중에도 abort가 소켓을 shutdown할 수 있음
+    pthread_mutex_lock(&s->ctx_mtx);
+    s->ctx = c;
+    pthread_mutex_unlock(&s->ctx_mtx);
 
-    if (modbus_connect(g_ctx) == -1) {
-        modbus_free(g_ctx);
-        g_ctx = NULL;
+    if (modbus_connect(c) == -1 || _aborted(s)) {
+        int err = errno;
+        _drop_ctx(s);
+        errno = err;
         return -1;
     }
     return 0;
 }
 
+static int _read_regs(THSensor* s, uint16_t* reg) {
+    if (!s->ctx) return -1;
+    return modbus_read_input_registers(s->ctx, s->cfg.reg_addr, s->reg_cnt, reg);
+}
+
 // ================================
 // 외부 API
 // ================================
-int th_module_init(const char* ip, int port) {
-    if (!ip || port <= 0) return -1;
+void th_module_default_config(THSensorConfig* cfg) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
 
-    // ip/port 저장(하드 재생성용)
-    snprintf(g_ip, sizeof(g_ip), "%s", ip);
-    g_port = port;
+    cfg->slave_id = 1; //TODO 이 부분은 BT-NB114의 온습도계 번호와 맞아야 함 확인 필요
+    // 그 BT-NB114 보면 버튼 있는데 그거 8번 버튼 켜져 있으면 1번 맞을거야, 내가 8번 켜두고 써서 아마 안바꿨으면 1 맞아
+    cfg->reg_addr = 0;
+    cfg->temp_reg = 0;
+    cfg->humi_reg = 1;
 
-    // 이미 ctx가 있다면 정리 후 재생성
-    if (g_ctx) {
-        th_module_close();
-    }
+    cfg->temp_scale = 10.0f;
+    cfg->humi_scale = 10.0f;
 
-    g_ctx = modbus_new_tcp(g_ip, g_port);
-    if (!g_ctx) {
-        return -1;
-    }
+    // 예: 산업용 온습도 센서 흔한 범위
+    cfg->temp_min = -40.0f;
+    cfg->temp_max =  85.0f;
+    cfg->humi_min =   0.0f;
+    cfg->humi_max = 100.0f;
 
-    _apply_common_options(g_ctx);
+    cfg->timeout_sec = 1;
+    cfg->timeout_usec = 0;
 
-    if (modbus_connect(g_ctx) == -1) {
-        modbus_free(g_ctx);
-        g_ctx = NULL;
-        return -1;
+    th_filter_default_config(&cfg->filter);
+}
+
+THSensor* th_module_create(const THSensorConfig* cfg) {
+    if (!cfg || !cfg->ip || cfg->port <= 0) return NULL;
+    if (cfg->temp_reg < 0 || cfg->temp_reg >= TH_MAX_REGS) return NULL;
+    if (cfg->humi_reg < 0 || cfg->humi_reg >= TH_MAX_REGS) return NULL;
+    if (cfg->temp_scale == 0.0f || cfg->humi_scale == 0.0f) return NULL;
+
+    THSensor* s = (THSensor*)calloc(1, sizeof(THSensor));
+    if (!s) return NULL;
+
+    s->cfg = *cfg;
+
+    // ip 저장(하드 재생성용)
+    snprintf(s->ip, sizeof(s->ip), "%s", cfg->ip);
+    s->cfg.ip = s->ip;
+
+    if (s->cfg.timeout_sec <= 0 && s->cfg.timeout_usec <= 0) s->cfg.timeout_sec = 1;
+    s->reg_cnt = (s->cfg.temp_reg > s->cfg.humi_reg ? s->cfg.temp_reg : s->cfg.humi_reg) + 1;
+
+    th_health_init(&s->health, &s->cfg.health);
+    th_filter_init(&s->filter, &s->cfg.filter);
+    pthread_mutex_init(&s->ctx_mtx, NULL);
+    atomic_init(&s->aborted, 0);
+    return s;
+}
+
+THSensor* th_module_open(const THSensorConfig* cfg) {
+    THSensor* s = th_module_create(cfg);
+    if (!s) return NULL;
+
+    // 첫 연결 실패는 상태 머신에 반영 (read에서 backoff 후 재시도)
+    if (_hard_recreate(s) != 0) {
+        th_health_on_failure(&s->health, th_health_now_ms());
     }
+    return s;
+}
 
-    return 0;
+void th_module_abort(THSensor* s) {
+    if (!s) return;
+    atomic_store(&s->aborted, 1);
+    pthread_mutex_lock(&s->ctx_mtx);
+    if (s->ctx) {
+        int fd = modbus_get_socket(s->ctx);
+        if (fd >= 0) shutdown(fd, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&s->ctx_mtx);
 }
 
-THData th_module_read_once(void) { 
+int th_module_is_connected(const THSensor* s) {
+    return (s && s->ctx) ? 1 : 0;
+}
+
+THData th_module_read(THSensor* s) {
     THData data;
     data.temperature = 0.0f;
     data.humidity = 0.0f;
     data.error_code = TH_OK;
     data.sys_errno = 0;
 
-    if (!g_ctx) {
+    if (!s) {
         data.error_code = TH_ERR_NOT_INIT;
         data.sys_errno = 0; // TODO 이 부분 왜 0인지? 설계대로라면 에러 코드마다 넘버가 따로 있는게 좋을듯
         // ㄴㄴ 이거 0이 통신 성공이라 오류면 에러코드 errno 출력함, 미초기화 상태래
         return data;
     }
 
-    uint16_t reg[REG_CNT];
-
-    // 1) 1차 read
-    int rc = modbus_read_input_registers(g_ctx, REG_ADDR, REG_CNT, reg);
-
-    // 2) 실패하면 soft reconnect 1회 + 재시도
-    //TODO 복구 로직이 꼭 필요한지? 무결성 검증 후에 다시 반복을 한다던지 시간을 측정해봐야할 듯
-    // 이거 우리 랩실은 문제될거 없어보이는데 좀 더 큰 환경(작업장)에서 통신 장애나 변수에 도움되라고 넣어둔거 지금 당장 테스트엔 필요없음 복구 로직
-    if (rc != REG_CNT) {
-        data.sys_errno = errno;
+    uint64_t now = th_health_now_ms();
 
-        if (_soft_reconnect() == 0) {
-            rc = modbus_read_input_registers(g_ctx, REG_ADDR, REG_CNT, reg);
-        }
+    // 0) OPEN(backoff 중)이면 통신 없이 바로 실패
+    if (!th_health_allow(&s->health, now)) {
+        data.error_code = TH_ERR_CIRCUIT_OPEN;
+        return data;
     }
 
-    // 3) 그래도 실패하면 hard recreate 1회 + 재시도
-    if (rc != REG_CNT) {
-        data.sys_errno = errno;
+    uint16_t reg[TH_MAX_REGS];
+    int rc = -1;
 
-        if (_hard_recreate() == 0) {
-            rc = modbus_read_input_registers(g_ctx, REG_ADDR, REG_CNT, reg);
+    if (s->health.state == TH_HEALTH_HALF_OPEN) {
+        // 시험 연결: ctx 새로 만들고 딱 1번만 읽음 (단계별 복구 안 함)
+        s->health.st.hard_recreates++;
+        if (_hard_recreate(s) == 0) {
+            rc = _read_regs(s, reg);
+        }
+        if (rc != s->reg_cnt) data.sys_errno = errno;
+        s->health.st.recover_ms_total += th_health_now_ms() - now;
+    } else {
+        // 1) 1차 read
+        rc = _read_regs(s, reg);
+
+        // 2) 실패하면 soft reconnect 1회 + 재시도
+        //TODO 복구 로직이 꼭 필요한지? 무결성 검증 후에 다시 반복을 한다던지 시간을 측정해봐야할 듯
+        // 이거 우리 랩실은 문제될거 없어보이는데 좀 더 큰 환경(작업장)에서 통신 장애나 변수에 도움되라고 넣어둔거 지금 당장 테스트엔 필요없음 복구 로직
+        if (rc != s->reg_cnt) {
+            uint64_t t0 = th_health_now_ms();
+            data.sys_errno = errno;
+
+            if (s->ctx) {
+                s->health.st.soft_reconnects++;
+                if (_soft_reconnect(s) == 0) {
+                    rc = _read_regs(s, reg);
+                }
+            }
+
+            // 3) 그래도 실패하면 hard recreate 1회 + 재시도
+            if (rc != s->reg_cnt) {
+                data.sys_errno = errno;
+
+                s->health.st.hard_recreates++;
+                if (_hard_recreate(s) == 0) {
+                    rc = _read_regs(s, reg);
+                }
+            }
+            s->health.st.recover_ms_total += th_health_now_ms() - t0;
         }
     }
 
-    // 4) 최종 실패 처리
-    if (rc != REG_CNT) {
+    // 4) 최종 실패 처리 → 상태 머신에 반영 (임계치 넘으면 OPEN)
+    if (rc != s->reg_cnt) {
         data.error_code = TH_ERR_READ_FAIL;
         // errno 갱신(최신 실패 기준)
         data.sys_errno = errno;
+        th_health_on_failure(&s->health, th_health_now_ms());
         return data;
     }
+    th_health_on_success(&s->health, th_health_now_ms());
 
     // 5) 스케일링
-    float t = reg[0] / 10.0f;
-    float h = reg[1] / 10.0f;
-
-    // 7) 무결성 체크 및 일시적 노이즈 재시도
-    if (!_validate_range(t, h)) {
-        // 일시적인 튐 현상일 수 있으므로 0.05초 대기 후 딱 한 번만 더 읽어봄
-        usleep(50000); 
-        if (modbus_read_input_registers(g_ctx, REG_ADDR, REG_CNT, reg) == REG_CNT) {
-            t = reg[0] / 10.0f;
-            h = reg[1] / 10.0f;
-        }
-
-        // 재시도 후에도 범위를 벗어나면 최종 에러 처리
-        if (!_validate_range(t, h)) {
-            data.error_code = TH_ERR_BAD_VALUE;
-            data.temperature = t;
-            data.humidity = h;
-            data.sys_errno = 0; // 통신 자체는 성공했으므로 OS 에러는 없음
-            return data;
-        }
+    float t = _scale(s, reg[s->cfg.temp_reg], s->cfg.temp_scale);
+    float h = _scale(s, reg[s->cfg.humi_reg], s->cfg.humi_scale);
+
+    // 6) 무결성 체크: 범위 밖이면 다시 읽지 않고 바로 버림 (필터 상태에도 안 넣음)
+    if (!_validate_range(s, t, h)) {
+        s->filter.stats.rejected++;
+        data.error_code = TH_ERR_BAD_VALUE;
+        data.temperature = t;
+        data.humidity = h;
+        data.sys_errno = 0; // 통신 자체는 성공했으므로 OS 에러는 없음
+        return data;
     }
 
+    // 7) 범위 안의 튐은 필터 파이프라인으로 (변화율 제한 → median → EWMA)
+    th_filter_apply(&s->filter, &t, &h, th_health_now_ms());
+
     // 모든 검증 통과 시 데이터 확정
     data.temperature = t;
     data.humidity = h;
@@ -200,10 +300,19 @@ THData th_module_read_once(void) {
     return data;
 }
 
-void th_module_close(void) { //TODO 이 부분 MQ를 정리하는 코드 추가 필요
-    if (g_ctx) {
-        modbus_close(g_ctx);
-        modbus_free(g_ctx);
-        g_ctx = NULL;
-    }
+void th_module_get_stats(const THSensor* s, THHealthStats* out) {
+    if (!s) return;
+    th_health_get_stats(&s->health, out);
+}
+
+void th_module_get_filter_stats(const THSensor* s, THFilterStats* out) {
+    if (!s || !out) return;
+    *out = s->filter.stats;
+}
+
+void th_module_close(THSensor* s) { //TODO 이 부분 MQ를 정리하는 코드 추가 필요
+    if (!s) return;
+    _drop_ctx(s);
+    pthread_mutex_destroy(&s->ctx_mtx);
+    free(s);
 }
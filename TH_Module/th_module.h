@@ -4,6 +4,10 @@
 #define TH_ERR_NOT_INIT     TH_MODULE_ERR_NOT_INIT
 #define TH_ERR_READ_FAIL    TH_MODULE_ERR_READ_FAIL
 #define TH_ERR_BAD_VALUE    TH_MODULE_ERR_BAD_VALUE
+#define TH_ERR_CIRCUIT_OPEN TH_MODULE_ERR_CIRCUIT_OPEN
+
+#include "th_health.h"
+#include "th_filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,6 +19,7 @@ enum {
     TH_MODULE_ERR_NOT_INIT   = -1,  // 초기화/연결 안 됨
     TH_MODULE_ERR_READ_FAIL  = -2,  // Modbus read 실패(통신/타임아웃/센서응답 등)
     TH_MODULE_ERR_BAD_VALUE  = -3,  // 값 무결성 실패(범위 밖/쓰레기값)
+    TH_MODULE_ERR_CIRCUIT_OPEN = -4, // 연결 장애로 backoff 중, 통신 없이 바로 실패
 };
 
 
@@ -29,10 +34,53 @@ typedef struct {
 } THData;
 
 
-// th_module 내부 함수
-int th_module_init(const char* ip, int port); // 초기화 및 네트워크 연결(0은 성공, -1은 실패)
-THData th_module_read_once(void);             // 단일 데이터 읽기 (스레드 루프 내에서 호출용)
-void th_module_close(void);                   // 자원 해제
+#define TH_MAX_REGS 8 // 한 번에 읽는 input register 최대 개수
+
+// 센서별 설정 (th_module_default_config로 기본값 채운 뒤 필요한 것만 바꿔서 사용)
+typedef struct {
+    const char* ip;          // 예: "192.168.0.20"
+    int port;                // 예: 8887
+    int slave_id;            // BT-NB114 온습도계 번호 (기본 1)
+
+    // 레지스터 맵: reg_addr부터 읽고 temp_reg/humi_reg는 reg_addr 기준 offset
+    int reg_addr;            // 기본 0
+    int temp_reg;            // 기본 0
+    int humi_reg;            // 기본 1
+    int signed_regs;         // 1이면 int16으로 해석 (영하 온도 센서용, 기본 0)
+
+    // 스케일링: 값 = raw / scale
+    float temp_scale;        // 기본 10
+    float humi_scale;        // 기본 10
+
+    // 무결성 체크 범위(필요하면 센서 스펙에 맞춰 조정)
+    float temp_min, temp_max; // 기본 -40 ~ 85
+    float humi_min, humi_max; // 기본 0 ~ 100
+
+    // 타임아웃(무선 환경 고려)
+    int timeout_sec;          // 기본 1
+    int timeout_usec;         // 기본 0
+
+    THHealthConfig health;    // circuit breaker 설정
+    THFilterConfig filter;    // 스무딩/이상치 필터 (전부 NONE이면 필터 없음)
+} THSensorConfig;
+
+// 센서 1개 = 핸들 1개 (modbus ctx, 설정, 연결 상태를 모두 핸들이 가짐)
+// 전역 상태가 없으므로 스레드마다 자기 핸들을 가지면 락 없이 동시에 사용 가능
+// 단, 같은 핸들을 여러 스레드에서 동시에 쓰면 안 됨
+typedef struct THSensor THSensor;
+
+// th_module 함수
+void th_module_default_config(THSensorConfig* cfg);
+THSensor* th_module_open(const THSensorConfig* cfg);   // 설정 복사 후 연결 시도, 잘못된 설정/메모리 부족이면 NULL
+                                                     // 연결 실패해도 핸들은 리턴 (read에서 breaker 따라 재시도)
+THSensor* th_module_create(const THSensorConfig* cfg); // open과 같지만 연결은 안 함 (첫 read가 연결)
+void th_module_abort(THSensor* s);                   // 다른 스레드에서: 소켓 shutdown → 진행 중인 connect / 응답 대기가 바로 실패
+                                                     // 이후 read는 연결 없이 바로 실패 (close만 남음)
+int th_module_is_connected(const THSensor* s);       // 1 연결됨, 0 아님
+THData th_module_read(THSensor* s);                  // 단일 데이터 읽기 (스레드 루프 내에서 호출용)
+void th_module_close(THSensor* s);                   // 자원 해제
+void th_module_get_stats(const THSensor* s, THHealthStats* out); // 연결 상태/재연결 통계
+void th_module_get_filter_stats(const THSensor* s, THFilterStats* out); // 필터 통계
 
 #ifdef __cplusplus
 }
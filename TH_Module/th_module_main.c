@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <mqueue.h>
 #include <time.h>
 #include <unistd.h>
@@ -7,11 +8,20 @@
 
 #include "common.h"
 #include "th_module.h"
+#include "th_sched.h"
+#include "mq_batch.h"
 
 int main(void) {
 
-    if (th_module_init("192.168.0.20", 8887) != 0) {
+    THSensorConfig tc;
+    th_module_default_config(&tc);
+    tc.ip = "192.168.0.20";
+    tc.port = 8887;
+
+    THSensor* sensor = th_module_open(&tc);
+    if (!sensor || !th_module_is_connected(sensor)) {
         printf("초기화 실패\n");
+        th_module_close(sensor);
         return 1;
     }
 
@@ -19,11 +29,28 @@ int main(void) {
     mqd_t mq = mq_open(TH_QUEUE_NAME, O_WRONLY);
     if (mq == (mqd_t)-1) {
         perror("MQ 열기 실패");
+        th_module_close(sensor);
+        return 1;
+    }
+
+    // 큐 msgsize가 배치 크기면 여러 레코드를 묶어서 전송 (mq_tool init -b)
+    MQBatcher batch;
+    if (mq_batch_init(&batch, mq, sizeof(THMsg), 0, MQ_BATCH_DEFAULT_MS) != 0) {
+        mq_close(mq);
+        th_module_close(sensor);
         return 1;
     }
 
+    // 변화율/열지수에 따라 1초~60초 사이에서 폴링 간격 조절
+    THSchedConfig sc;
+    memset(&sc, 0, sizeof(sc));
+    sc.min_interval_ms = 1000;
+    sc.max_interval_ms = 60000;
+    THSched sched;
+    th_sched_init(&sched, &sc);
+
     while (1) {
-        THData d = th_module_read_once();
+        THData d = th_module_read(sensor);
 
         THMsg msg;
         msg.temperature = d.temperature;
@@ -36,14 +63,17 @@ int main(void) {
         msg.ts_ms = (uint64_t)ts.tv_sec * 1000ULL +
                     (uint64_t)(ts.tv_nsec / 1000000ULL);
 
-        if (mq_send(mq, (char*)&msg, sizeof(msg), 0) == -1) {
-            perror("mq_send 실패");
-        }
+        mq_batch_push(&batch, &msg);
 
-        sleep(5);
+        // 다음 수집 시각까지 대기, 그 사이 배치 deadline이 오면 flush
+        th_sched_update(&sched, &d);
+        while (th_sched_sleep(&sched, mq_batch_timeout_ms(&batch)) == 0) {
+            mq_batch_poll(&batch);
+        }
     }
 
+    mq_batch_destroy(&batch);
     mq_close(mq);
-    th_module_close();
+    th_module_close(sensor);
     return 0;
 }
@@ -0,0 +1,129 @@
+#include "th_sched.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+// ================================
+// 내부 유틸
+// ================================
+static uint64_t _ts_to_ms(const struct timespec* ts) {
+    return (uint64_t)ts->tv_sec * 1000ULL + (uint64_t)(ts->tv_nsec / 1000000L);
+}
+
+static uint64_t _now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return _ts_to_ms(&ts);
+}
+
+static void _ts_add_ms(struct timespec* ts, int ms) {
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec += 1;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// collector_hub.c calc_heat_index와 같은 공식 (반올림 없음)
+static float _heat_index(float T, float RH) {
+    return (float)(
+        -8.784695 +
+        1.61139411 * T +
+        2.338549 * RH -
+        0.14611605 * T * RH -
+        0.012308094 * T * T -
+        0.016424828 * RH * RH +
+        0.002211732 * T * T * RH +
+        0.00072546 * T * RH * RH -
+        0.000003582 * T * T * RH * RH);
+}
+
+// ================================
+// 외부 API
+// ================================
+void th_sched_init(THSched* s, const THSchedConfig* cfg) {
+    memset(s, 0, sizeof(*s));
+    if (cfg) s->cfg = *cfg;
+
+    // defaults
+    if (s->cfg.min_interval_ms <= 0) s->cfg.min_interval_ms = 1000;
+    if (s->cfg.max_interval_ms <= 0) s->cfg.max_interval_ms = 60000;
+    if (s->cfg.max_interval_ms < s->cfg.min_interval_ms) s->cfg.max_interval_ms = s->cfg.min_interval_ms;
+    if (s->cfg.fast_temp_rate <= 0) s->cfg.fast_temp_rate = 0.5f;
+    if (s->cfg.stable_temp_rate <= 0) s->cfg.stable_temp_rate = 0.1f;
+    if (s->cfg.fast_humi_rate <= 0) s->cfg.fast_humi_rate = 3.0f;
+    if (s->cfg.stable_humi_rate <= 0) s->cfg.stable_humi_rate = 0.5f;
+    if (s->cfg.hi_warn <= 0) s->cfg.hi_warn = 27.0f;
+
+    // 처음에는 빠르게 시작해서 안정되면 늘어나도록
+    s->interval_ms = s->cfg.min_interval_ms;
+    clock_gettime(CLOCK_MONOTONIC, &s->deadline);
+}
+
+int th_sched_update(THSched* s, const THData* d) {
+    uint64_t now = _now_ms();
+    int next = s->interval_ms;
+
+    // 실패한 읽기는 변화율 계산에 안 씀 (간격 유지)
+    if (d && d->error_code == TH_OK) {
+        float t = d->temperature;
+        float h = d->humidity;
+
+        if (s->have_last && now > s->last_ms) {
+            float dt_min = (float)(now - s->last_ms) / 60000.0f;
+            float rate_t = fabsf(t - s->last_t) / dt_min;
+            float rate_h = fabsf(h - s->last_h) / dt_min;
+
+            if (_heat_index(t, h) >= s->cfg.hi_warn - 1.0f) {
+                // 열 스트레스 기준 근처: 가장 빠르게
+                next = s->cfg.min_interval_ms;
+            } else if (rate_t >= s->cfg.fast_temp_rate || rate_h >= s->cfg.fast_humi_rate) {
+                next = s->interval_ms / 2;
+            } else if (rate_t <= s->cfg.stable_temp_rate && rate_h <= s->cfg.stable_humi_rate) {
+                next = s->interval_ms + s->interval_ms / 2;
+            }
+        }
+
+        s->have_last = 1;
+        s->last_t = t;
+        s->last_h = h;
+        s->last_ms = now;
+    }
+
+    if (next < s->cfg.min_interval_ms) next = s->cfg.min_interval_ms;
+    if (next > s->cfg.max_interval_ms) next = s->cfg.max_interval_ms;
+    s->interval_ms = next;
+
+    // 이전 deadline 기준으로 더해서 drift 없음
+    // 읽기가 오래 걸려서 이미 지나버렸으면 지금부터 다시 잡음 (몰아서 폴링 방지)
+    _ts_add_ms(&s->deadline, next);
+    if (_ts_to_ms(&s->deadline) <= now) {
+        clock_gettime(CLOCK_MONOTONIC, &s->deadline);
+        _ts_add_ms(&s->deadline, next);
+    }
+    return next;
+}
+
+int th_sched_sleep(THSched* s, int max_slice_ms) {
+    struct timespec until = s->deadline;
+    int partial = 0;
+
+    if (max_slice_ms >= 0) {
+        struct timespec slice;
+        clock_gettime(CLOCK_MONOTONIC, &slice);
+        _ts_add_ms(&slice, max_slice_ms);
+        if (_ts_to_ms(&slice) < _ts_to_ms(&until)) {
+            until = slice;
+            partial = 1;
+        }
+    }
+
+    int rc;
+    do {
+        rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL);
+    } while (rc == EINTR);
+
+    return partial ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#ifndef TH_SCHED_H
+#define TH_SCHED_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "th_module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 적응형 폴링 설정 (0 이하 값은 기본값 사용)
+typedef struct {
+    int   min_interval_ms;   // 최소 폴링 간격 (기본 1000)
+    int   max_interval_ms;   // 최대 폴링 간격 (기본 60000)
+    float fast_temp_rate;    // 이 이상 변하면 간격 줄임 (°C/min, 기본 0.5)
+    float stable_temp_rate;  // 이 이하로 변하면 간격 늘림 (°C/min, 기본 0.1)
+    float fast_humi_rate;    // (%/min, 기본 3.0)
+    float stable_humi_rate;  // (%/min, 기본 0.5)
+    float hi_warn;           // heat index가 이 값에 가까우면 최소 간격 (기본 27.0 = 주의 단계)
+} THSchedConfig;
+
+typedef struct {
+    THSchedConfig cfg;
+    int interval_ms;          // 현재 폴링 간격
+
+    int have_last;
+    float last_t;
+    float last_h;
+    uint64_t last_ms;
+
+    struct timespec deadline; // 다음 폴링 시각 (CLOCK_MONOTONIC, 절대시간)
+} THSched;
+
+void th_sched_init(THSched* s, const THSchedConfig* cfg);
+
+// 읽은 값으로 다음 간격을 정하고 deadline을 갱신 (return: 새 간격 ms)
+int th_sched_update(THSched* s, const THData* d);
+
+// deadline까지 대기
+// max_slice_ms >= 0 이면 그 시간까지만 자고 리턴 (종료 플래그/배치 flush 확인용)
+// return: 1 deadline 도달, 0 slice만큼만 잠
+int th_sched_sleep(THSched* s, int max_slice_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <time.h>
 #include "common.h"
+#include "mq_batch.h"
 
 int main(void) {
     // 1. 큐 열기
@@ -42,23 +43,28 @@ int main(void) {
             break; // 에러 발생 시 루프 탈출
         }
 
-        if (n != (ssize_t)sizeof(THMsg)) {
+        // 배치 메시지면 레코드 여러 개, 예전 크기면 1개
+        const unsigned char* rec = NULL;
+        int cnt = mq_batch_unpack(buf, (size_t)n, sizeof(THMsg), &rec);
+        if (cnt < 0) {
             fprintf(stderr, "unexpected message size: %zd\n", n);
             continue; // 다음 메시지 기다리기
         }
 
-        THMsg msg;
-        memcpy(&msg, buf, sizeof(msg));
+        for (int i = 0; i < cnt; i++) {
+            THMsg msg;
+            memcpy(&msg, rec + (size_t)i * sizeof(THMsg), sizeof(msg));
 
-        // 시간 형식 yy-MM-dd HH:mm:ss 형식 맞췄음 (워치에서 이렇게 보냄 TS)
-        time_t raw_time = (time_t)(msg.ts_ms / 1000);
-        struct tm *lt = localtime(&raw_time);
-        char formatted_time[20];
-        strftime(formatted_time, sizeof(formatted_time), "%y-%m-%d %H:%M:%S", lt);
+            // 시간 형식 yy-MM-dd HH:mm:ss 형식 맞췄음 (워치에서 이렇게 보냄 TS)
+            time_t raw_time = (time_t)(msg.ts_ms / 1000);
+            struct tm *lt = localtime(&raw_time);
+            char formatted_time[20];
+            strftime(formatted_time, sizeof(formatted_time), "%y-%m-%d %H:%M:%S", lt);
 
-        printf("[RECV] prio=%u | t=%.1f h=%.1f err=%d errno=%d | 시간:%s \n",
-                prio, msg.temperature, msg.humidity, msg.error_code, msg.sys_errno,
-                formatted_time);
+            printf("[RECV] prio=%u | batch=%d/%d | t=%.1f h=%.1f err=%d errno=%d | 시간:%s \n",
+                    prio, i + 1, cnt, msg.temperature, msg.humidity, msg.error_code, msg.sys_errno,
+                    formatted_time);
+        }
     }
 
     mq_close(q);
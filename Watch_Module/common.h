@@ -2,14 +2,18 @@
 #include <stdint.h>
 
 // 큐 이름 정의
-#define WQTCH_QUEUE_NAME "/mq_vital"
+#define WATCH_QUEUE_NAME "/mq_vital"
+#define WATCH_QUEUE_SHARD_FMT WATCH_QUEUE_NAME ".%d" // 샤딩 모드: /mq_vital.0, /mq_vital.1, ...
+
+#define DEV_ID_LEN 64 // deviceId 최대 길이 (DEV_INTERN_ID_LEN과 같아야 함)
+
+#define WATCH_MSG_VALS 4 // 레코드 하나에 싣는 채널 값 수 (MQ msgsize 고정)
 
 // 워치 데이터 구조체 (사용자님의 캐시 로직 반영)
 typedef struct {
-    char deviceId[64];
-    double heartRate;
-    double skin_temperature;
-    int has_hr; // 심박수 포함 여부
-    int has_st; // 체온 포함 여부
-    uint64_t ts_ms;
+    uint32_t dev;      // deviceId 핸들 (dev_intern, 문자열은 양쪽이 같은 shm에서 찾음)
+    uint32_t present;  // 이 레코드에 실린 채널 bitmask (channel_reg 번호)
+    int64_t dev_ts_ms; // 워치 ts(디바이스 측정 시각) epoch ms, ts 없거나 형식 오류면 rx_ts_ms와 같음
+    int64_t rx_ts_ms;  // 워치 모듈 수신 시각 epoch ms (skew = rx_ts_ms - dev_ts_ms)
+    double vals[WATCH_MSG_VALS]; // present 비트 순서(낮은 채널부터)로 채움, 채널이 더 많으면 레코드 여러 개
 } WatchMsg;
@@ -0,0 +1,99 @@
+#include "seq_win.h"
+
+#include <string.h>
+
+void seq_win_reset(SeqWin* w) {
+    memset(w, 0, sizeof(*w));
+}
+
+// 창을 seq에서 다시 시작 (counter는 유지)
+static void _restart(SeqWin* w, uint64_t seq) {
+    w->top = seq;
+    w->bits = 1;
+    w->started = 1;
+}
+
+SeqWinVerdict seq_win_check(SeqWin* w, uint64_t seq) {
+    if (!w->started) {
+        _restart(w, seq);
+        w->accepted++;
+        return SEQ_WIN_NEW;
+    }
+
+    if (seq > w->top) {
+        uint64_t d = seq - w->top;
+        if (d > SEQ_WIN_RESET_GAP) {
+            // 한참 앞으로 뜀 = 재시작으로 봄 (그 사이를 전부 손실로 세지 않음)
+            _restart(w, seq);
+            w->resets++;
+        } else {
+            w->lost += d - 1;
+            w->bits = d >= SEQ_WIN_BITS ? 1 : (w->bits << d) | 1;
+            w->top = seq;
+        }
+        w->accepted++;
+        return SEQ_WIN_NEW;
+    }
+
+    uint64_t back = w->top - seq;
+    if (back >= SEQ_WIN_BITS) {
+        if (back > SEQ_WIN_RESET_GAP) {
+            _restart(w, seq);
+            w->resets++;
+            w->accepted++;
+            return SEQ_WIN_NEW;
+        }
+        w->stale++;
+        return SEQ_WIN_STALE;
+    }
+
+    uint64_t bit = 1ull << back;
+    if (w->bits & bit) {
+        w->dup++;
+        return SEQ_WIN_DUP;
+    }
+
+    // 늦게 왔지만 처음 보는 seq: 손실 아님, 값은 이미 더 새 것이 있어서 반영 안 함
+    w->bits |= bit;
+    w->late++;
+    if (w->lost > 0) w->lost--;
+    return SEQ_WIN_LATE;
+}
+
+SeqWinVerdict seq_win_check_ts(SeqWin* w, int64_t* last_ts, int64_t ts_ms, int same_value) {
+    int64_t last = *last_ts;
+    if (last != 0 && ts_ms <= last) {
+        if (ts_ms == last) {
+            // 초 단위 ts라 같은 초에 값이 바뀐 건 새 측정값 (같은 값이면 재전송으로 봄)
+            if (!same_value) {
+                w->accepted++;
+                return SEQ_WIN_NEW;
+            }
+            w->dup++;
+            return SEQ_WIN_DUP;
+        }
+        if (last - ts_ms <= SEQ_WIN_TS_RESET_MS) {
+            w->late++;
+            return SEQ_WIN_LATE;
+        }
+        w->resets++;
+    }
+    *last_ts = ts_ms;
+    w->accepted++;
+    return SEQ_WIN_NEW;
+}
+
+double seq_win_loss_pct(const SeqWin* w) {
+    uint64_t total = w->accepted + w->lost;
+    return total ? 100.0 * (double)w->lost / (double)total : 0.0;
+}
+
+const char* seq_win_verdict_name(SeqWinVerdict v) {
+    switch (v) {
+    case SEQ_WIN_NEW:   return "new";
+    case SEQ_WIN_DUP:   return "dup";
+    case SEQ_WIN_LATE:  return "late";
+    case SEQ_WIN_STALE: return "stale";
+    }
+    return "?";
+}
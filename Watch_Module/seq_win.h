@@ -0,0 +1,67 @@
+#ifndef SEQ_WIN_H
+#define SEQ_WIN_H
+
+/*
+디바이스별 수신 순서 창 (UDP 중복 / 순서 뒤바뀜 / 손실)
+- seq 모드: 패킷 "seq" (디바이스마다 1씩 증가) 기준 64칸 sliding bitmap
+    top = 지금까지 본 가장 큰 seq, bit i = (top - i) 받음
+    같은 seq → DUP, 창 안의 늦게 온 seq → LATE (손실에서 빼고 reorder로 셈), 창 밖 → STALE
+    top보다 큰 seq → 사이 빈칸은 일단 손실 (늦게 오면 LATE에서 되돌림)
+- ts 모드 (seq 없는 패킷): 채널별 마지막 워치 ts 기준
+    같은 ts + 같은 값 → DUP, 더 이전 ts → LATE (늦게 온 측정값은 최신 값을 덮지 않음), 손실은 모름
+    워치 ts는 초 단위라 같은 ts + 다른 값은 같은 초 안의 다음 측정값 → NEW
+- NEW가 아닌 패킷은 캐시/MQ에 반영하지 않음 (counter만)
+- seq / ts가 크게 뒤로 가면 워치 재시작/시계 보정으로 보고 창을 다시 시작 (resets)
+- 스레드 안전하지 않음 (수신 루프 전용)
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEQ_WIN_BITS        64
+#define SEQ_WIN_RESET_GAP   1024     // seq가 이만큼 넘게 뒤로(또는 앞으로) 뛰면 재시작
+#define SEQ_WIN_TS_RESET_MS 600000   // 워치 ts가 10분 넘게 뒤로 가면 재시작
+
+typedef enum {
+    SEQ_WIN_NEW = 0,   // 반영
+    SEQ_WIN_DUP,       // 이미 받은 것
+    SEQ_WIN_LATE,      // 창 안에서 늦게 옴 (순서 뒤바뀜)
+    SEQ_WIN_STALE      // 창보다 오래됨
+} SeqWinVerdict;
+
+typedef struct {
+    uint64_t top;
+    uint64_t bits;
+    int started;
+
+    // link 품질 counter (디바이스 슬롯이 살아있는 동안 누적)
+    uint64_t accepted;
+    uint64_t dup;
+    uint64_t late;
+    uint64_t stale;
+    uint64_t lost;     // seq 모드만 (빈칸 - 늦게 채워진 것)
+    uint64_t resets;
+} SeqWin;
+
+void seq_win_reset(SeqWin* w);
+
+// seq 모드
+SeqWinVerdict seq_win_check(SeqWin* w, uint64_t seq);
+
+// ts 모드: last_ts = 이 디바이스/채널의 마지막 반영 ts (0이면 처음, NEW면 갱신)
+// same_value = 마지막으로 반영한 값과 같음 (값이 없는 샘플도 1) → ts가 같을 때만 봄
+SeqWinVerdict seq_win_check_ts(SeqWin* w, int64_t* last_ts, int64_t ts_ms, int same_value);
+
+// 손실률 (%): lost / (accepted + lost), seq 모드가 아니면 0
+double seq_win_loss_pct(const SeqWin* w);
+
+const char* seq_win_verdict_name(SeqWinVerdict v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
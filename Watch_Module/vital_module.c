@@ -4,37 +4,151 @@
 #include <errno.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
 #include <mqueue.h>
 #include <signal.h>
 #include <time.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #include <cjson/cJSON.h>
 
 #include "vital_module.h"
 #include "common.h"
+#include "mq_batch.h"
+#include "timer_wheel.h"
+#include "ts_parse.h"
+#include "shard_ring.h"
+#include "mem_pool.h"
+#include "flow_ctl.h"
+#include "io_engine.h"
+#include "dev_intern.h"
+#include "channel_reg.h"
+#include "seq_win.h"
+#include "spsc_ring.h"
 
 #define DEFAULT_PORT 5005
 #define MAX_DEVICES 64
-
-// 전역: 시그널 종료 제어 + MQ 핸들
-static volatile sig_atomic_t g_keep_running = 1;
-static mqd_t g_watch_mq = (mqd_t)-1;
+#define DEFAULT_STALE_MS 300000
+#define WHEEL_TICK_MS 100     // 만료 정밀도 (staleness라 거칠어도 됨)
+#define IDLE_POLL_MS 1000     // 패킷 없을 때도 만료 처리하러 깨어나는 주기
+#define WATCH_ARENA_BYTES (64 * 1024) // 패킷 1개 cJSON 트리용 (패킷마다 reset)
+#define WARM_PACKETS 100               // 이 패킷 수 이후를 steady-state로 봄 (MEM_POOL_DEBUG 카운터)
+#define FLOW_SAMPLE_MS 100    // MQ 깊이 측정 주기 (degrade 중에는 이 주기로 깨어나서 복구 판단)
+#define MAX_DGRAM 4095        // 패킷 1개 최대 크기 (max_dgram 기본값)
+#define MAX_DGRAM_LIMIT 65507 // UDP payload 최대
+#define ARENA_PER_DGRAM 8     // 배치 패킷은 cJSON 트리가 원문의 몇 배 (arena = max_dgram * 이것, 최소 WATCH_ARENA_BYTES)
+
+// SIGINT가 멈출 실행 (no_signal이 아닌 run이 도는 동안만)
+static WatchUdpStop* volatile g_sig_stop = NULL;
+
+// MQ 출력 (shard_count > 1 이면 deviceId consistent hash로 /mq_vital.<k>에 나눠 보냄)
+typedef struct {
+    int shards;
+    ShardRing* ring;
+    mqd_t* mqs;
+    MQBatcher* batches;
+    FlowStage* flow;       // shard별 흐름 제어 (큐 깊이 = 허브가 밀린 정도)
+    uint64_t flow_next_ms;
+
+    // 통합 실행 (out_rings): MQ/배치 대신 shard별 lock-free 링으로 허브에 바로
+    SpscRing** inproc;
+    uint64_t* inproc_sent;
+    uint64_t* inproc_full;
+} WatchOut;
 
 typedef struct {
     int used;
-    char deviceId[DEV_ID_LEN];
-    char last_ts[TS_LEN];
-    double heartRate;
-    double skin_temperature;
-    int has_hr;
-    int has_st;    
+    DevHandle dev;         // dev_intern 핸들 (MQ 레코드에는 이것만)
+    const char* deviceId;  // dev_intern shm 안 문자열 (로그용)
+    int shard;             // 보낼 MQ shard (슬롯 만들 때 한 번 계산)
+    int64_t dev_ts_ms;     // 마지막 패킷의 워치 ts (epoch ms)
+    int64_t rx_ts_ms;      // 마지막 패킷 수신 시각 (epoch ms)
+    int64_t skew_ms;       // rx - dev (네트워크 지연 + 워치 시계 오차)
+    int64_t skew_max_ms;   // |skew| 최대값
+    uint64_t last_seen_ms; // CLOCK_MONOTONIC, 마지막 패킷 수신 시각
+    SeqWin win;            // 중복 / 순서 뒤바뀜 / 손실 (seq 없으면 채널별 ts로)
+    int sent_any;          // MQ에 한 번이라도 넘겼는지 (채널 값은 WatchLoop vals/sent 저장소)
 } DeviceCache;
 
+// 만료 콜백 컨텍스트
+typedef struct {
+    DeviceCache* cache;
+    int* slot_of;
+    DevIntern* ids;
+    ChanStore* vals;
+    ChanStore* sent;
+    int log;
+} ExpireCtx;
+
+// 수신 소스별 카운터 (UDP / Unix datagram)
+typedef struct {
+    const char* name;
+    uint64_t packets;
+    uint64_t batched;      // "samples" 배열이나 최상위 배열로 온 패킷
+    uint64_t samples;
+    uint64_t groups;       // 디바이스 묶음 수 (= 캐시 반영 후 MQ로 넘긴 횟수)
+    uint64_t bad;          // JSON 오류 / 형식 오류
+    uint64_t bytes;
+    uint64_t busy_ns;      // 콜백 안에서 쓴 시간 (처리량 비교용)
+} WatchSrcStats;
+
+// 수신 루프 상태 (io_engine 데이터그램 콜백에서 사용)
+typedef struct {
+    const WatchUdpConfig* cfg;
+    int max_dev;
+    int stale_ms;
+    DeviceCache* cache;
+    DevIntern* ids;
+    int* slot_of;          // 핸들 → 슬롯 (-1 없음), dev_intern capacity + 1개
+    ChanReg* chans;        // 패킷 "type" → 채널 번호
+    ChanStore* vals;       // 슬롯별 최신 채널 값
+    ChanStore* sent;       // 마지막으로 실제 전달된 값 (mq_send 성공 / 링 push 성공, 흐름 제어 우선순위 판단용)
+    int64_t* ch_ts;        // 채널별 캐시 값의 워치 ts [ch * max_dev + slot] (seq 없는 패킷은 중복/늦음 판단도)
+    TimerWheel* wheel;
+    WatchOut* out;
+    MemArena* arena;
+    uint64_t packets;
+    uint64_t rejected[SEQ_WIN_STALE + 1]; // verdict별 버린 샘플 수 (NEW 칸은 안 씀)
+    uint64_t superseded;   // seq로는 새 것인데 ts가 캐시 값보다 옛날이라 값을 안 바꾼 샘플 (묶음 안 / 패킷 사이 순서 뒤바뀜)
+} WatchLoop;
+
+// io_engine 소스 1개 (콜백 ctx)
+typedef struct {
+    WatchLoop* L;
+    WatchSrcStats st;
+} WatchSrc;
+
+int watch_udp_stop_init(WatchUdpStop* s) {
+    atomic_init(&s->stop, 0);
+    s->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s->efd < 0) {
+        perror("eventfd watch stop");
+        return -1;
+    }
+    return 0;
+}
+
+void watch_udp_stop_destroy(WatchUdpStop* s) {
+    if (s->efd < 0) return;
+    close(s->efd);
+    s->efd = -1;
+}
+
+void watch_udp_request_stop(WatchUdpStop* s) {
+    if (!s) return;
+    atomic_store_explicit(&s->stop, 1, memory_order_release);
+    uint64_t one = 1;
+    ssize_t w = write(s->efd, &one, sizeof(one)); // 시그널 핸들러에서도 되는 것만
+    (void)w;
+}
+
 // 컨트롤 C로 루프 종료
 void handle_sigint(int sig) {
     (void)sig;
-    g_keep_running = 0;
+    watch_udp_request_stop(g_sig_stop);
 }
 
 // JSON 유틸 함수
@@ -55,57 +169,546 @@ static int json_get_number(cJSON* obj, const char* key, double* out) {
     return 0;
 }
 
-// 디바이스 아이디 슬롯 찾기/생성
-static int find_or_create_slot(DeviceCache* cache, int max_dev, const char* deviceId) {
-    // 64대 규모면 선형 탐색으로도 충분 (병목 거의 없음)
-    for (int i = 0; i < max_dev; i++) {
-        if (cache[i].used && strncmp(cache[i].deviceId, deviceId, DEV_ID_LEN) == 0) return i;
-    }
+// 디바이스 핸들 슬롯 찾기/생성 (있는 디바이스는 slot_of로 바로, 새 디바이스만 빈 슬롯 탐색)
+// 슬롯을 잡는 동안 핸들 ref (만료로 놓을 때 unref)
+static int find_or_create_slot(WatchLoop* L, DevHandle dev) {
+    int s = L->slot_of[dev];
+    if (s >= 0) return s;
 
-    for (int i = 0; i < max_dev; i++) {
+    DeviceCache* cache = L->cache;
+    for (int i = 0; i < L->max_dev; i++) {
         if (!cache[i].used) {
+            if (dev_intern_ref(L->ids, dev) != 0) return -1; // 그 사이에 놓인 핸들
             // 새 슬롯 명시 초기화 (A 개선)
             cache[i].used = 1;
-            strncpy(cache[i].deviceId, deviceId, DEV_ID_LEN - 1);
-            cache[i].deviceId[DEV_ID_LEN - 1] = '\0';
-
-            cache[i].last_ts[0] = '\0';
-            cache[i].has_hr = 0;
-            cache[i].has_st = 0;
-            cache[i].heartRate = 0.0;
-            cache[i].skin_temperature = 0.0;
+            cache[i].dev = dev;
+            cache[i].deviceId = dev_intern_name(L->ids, dev);
+            cache[i].shard = shard_ring_lookup(L->out->ring, cache[i].deviceId);
+            L->slot_of[dev] = i;
+
+            cache[i].dev_ts_ms = 0;
+            cache[i].rx_ts_ms = 0;
+            cache[i].skew_ms = 0;
+            cache[i].skew_max_ms = 0;
+            cache[i].sent_any = 0;
+            seq_win_reset(&cache[i].win);
+            for (int c = 0; c < L->vals->n_ch; c++) L->ch_ts[(size_t)c * (size_t)L->max_dev + (size_t)i] = 0;
+            chan_store_clear(L->vals, i);
+            chan_store_clear(L->sent, i);
             return i;
         }
     }
     return -1;
 }
 
-// 현재 시간
-static uint64_t now_ms_realtime(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000ULL);
+// 오래 조용한 디바이스 슬롯 해제 (timer_wheel_advance 콜백)
+static void on_device_stale(void* ctx, int slot, uint64_t now_ms) {
+    ExpireCtx* ec = (ExpireCtx*)ctx;
+    DeviceCache* dc = &ec->cache[slot];
+    if (!dc->used) return;
+
+    if (ec->log) {
+        printf("⌛ [watch_udp] %s stale (%llu ms) → slot %d freed (dup=%llu late=%llu lost=%llu)\n", dc->deviceId,
+               (unsigned long long)(now_ms - dc->last_seen_ms), slot, (unsigned long long)dc->win.dup,
+               (unsigned long long)dc->win.late, (unsigned long long)dc->win.lost);
+    }
+    ec->slot_of[dc->dev] = -1;
+    dev_intern_unref(ec->ids, dc->dev);
+    chan_store_clear(ec->vals, slot);
+    chan_store_clear(ec->sent, slot);
+    memset(dc, 0, sizeof(*dc));
+}
+
+// 워치 ts → epoch ms (return: 1 워치 ts, 0 없거나 형식 오류라 수신 시각으로 대체)
+static int parse_dev_time(const cJSON* jts, int64_t rx_ms, int64_t* dev_ms) {
+    *dev_ms = rx_ms;
+    if (!cJSON_IsString(jts) || !jts->valuestring) return 0;
+    if (ts_parse_local(jts->valuestring, 0, rx_ms, dev_ms) != 0) {
+        *dev_ms = rx_ms;
+        return 0;
+    }
+    return 1;
+}
+
+// 워치 ts 반영 + 디바이스별 시계 차이 기록
+static void update_device_time(DeviceCache* dc, int64_t dev_ms, int64_t rx_ms) {
+    dc->dev_ts_ms = dev_ms;
+    dc->rx_ts_ms = rx_ms;
+    dc->skew_ms = rx_ms - dev_ms;
+
+    int64_t abs_skew = dc->skew_ms < 0 ? -dc->skew_ms : dc->skew_ms;
+    if (abs_skew > dc->skew_max_ms) dc->skew_max_ms = abs_skew;
+}
+
+static void watch_out_close(WatchOut* o) {
+    for (int k = 0; k < o->shards; k++) {
+        if (o->batches) mq_batch_destroy(&o->batches[k]); // 남은 레코드 flush
+        if (o->mqs && o->mqs[k] != (mqd_t)-1) mq_close(o->mqs[k]);
+    }
+    free(o->batches);
+    free(o->mqs);
+    free(o->flow);
+    free(o->inproc_sent);
+    free(o->inproc_full);
+    shard_ring_destroy(o->ring);
+    memset(o, 0, sizeof(*o));
+}
+
+static int watch_out_open(WatchOut* o, const WatchUdpConfig* cfg) {
+    memset(o, 0, sizeof(*o));
+    o->shards = (cfg->shard_count > 1 ? cfg->shard_count : 1);
+
+    o->flow = (FlowStage*)calloc((size_t)o->shards, sizeof(FlowStage));
+    o->ring = shard_ring_create(o->shards, cfg->shard_vnodes);
+    if (!o->flow || !o->ring) {
+        fprintf(stderr, "❌ calloc failed\n");
+        watch_out_close(o);
+        return -6;
+    }
+
+    if (cfg->out_rings) {
+        o->inproc = cfg->out_rings;
+        o->inproc_sent = (uint64_t*)calloc((size_t)o->shards, sizeof(uint64_t));
+        o->inproc_full = (uint64_t*)calloc((size_t)o->shards, sizeof(uint64_t));
+        if (!o->inproc_sent || !o->inproc_full) {
+            fprintf(stderr, "❌ calloc failed\n");
+            watch_out_close(o);
+            return -6;
+        }
+        for (int k = 0; k < o->shards; k++) {
+            char fname[24];
+            snprintf(fname, sizeof(fname), "watch.%d", k);
+            flow_stage_init(&o->flow[k], fname, &cfg->flow);
+        }
+        return 0;
+    }
+
+    o->mqs = (mqd_t*)calloc((size_t)o->shards, sizeof(mqd_t));
+    o->batches = (MQBatcher*)calloc((size_t)o->shards, sizeof(MQBatcher));
+    if (!o->mqs || !o->batches) {
+        fprintf(stderr, "❌ calloc failed\n");
+        watch_out_close(o);
+        return -6;
+    }
+    for (int k = 0; k < o->shards; k++) o->mqs[k] = (mqd_t)-1;
+
+    for (int k = 0; k < o->shards; k++) {
+        char name[64];
+        if (o->shards == 1) snprintf(name, sizeof(name), "%s", WATCH_QUEUE_NAME);
+        else snprintf(name, sizeof(name), WATCH_QUEUE_SHARD_FMT, k);
+
+        // Hub가 먼저 MQ를 생성/오픈해둬야 함
+        // non-blocking: 허브가 밀려도 수신 루프는 안 멈추고, 꽉 찬 건 흐름 제어가 처리
+        o->mqs[k] = mq_open(name, O_WRONLY | O_NONBLOCK);
+        if (o->mqs[k] == (mqd_t)-1) {
+            fprintf(stderr, "❌ mq_open %s failed (run hub first / create MQ first): %s\n",
+                    name, strerror(errno));
+            watch_out_close(o);
+            return -2;
+        }
+        if (mq_batch_init(&o->batches[k], o->mqs[k], sizeof(WatchMsg),
+                          cfg->batch_max, cfg->batch_flush_ms) != 0) {
+            fprintf(stderr, "❌ mq_batch_init failed (%s)\n", name);
+            watch_out_close(o);
+            return -7;
+        }
+
+        char fname[24];
+        snprintf(fname, sizeof(fname), "watch.%d", k);
+        flow_stage_init(&o->flow[k], fname, &cfg->flow);
+    }
+    return 0;
+}
+
+// 큐가 꽉 차서 배치를 못 보냈으면 (배치는 남아서 재시도) 깊이 측정 주기를 기다리지 않고 바로 degrade
+static void watch_out_after_send(WatchOut* o, int k, uint64_t full_before) {
+    if (o->batches[k].send_full == full_before) return;
+    flow_stage_on_full(&o->flow[k], mq_batch_now_ms());
+}
+
+// 통합 실행: 링에 바로 (꽉 차면 MQ 꽉 참과 같이 바로 degrade)
+// 링이 꽉 차서 못 넣으면 -1 (그 레코드는 sent에 안 남아서 다음 샘플 때 다시 보냄)
+static int watch_out_push_inproc(WatchOut* o, int k, const WatchMsg* m) {
+    if (spsc_ring_push(o->inproc[k], m) == 0) {
+        o->inproc_sent[k]++;
+        return 0;
+    }
+    o->inproc_full[k]++;
+    flow_stage_count_dropped(&o->flow[k], 1);
+    flow_stage_on_full(&o->flow[k], mq_batch_now_ms());
+    return -1;
+}
+
+// 값이 바뀌었으면 NORMAL, 그대로면 LOW(다음 것이 대신함), 처음 보는 디바이스는 HIGH
+static FlowPrio device_prio(const WatchLoop* L, int slot) {
+    if (!L->cache[slot].sent_any) return FLOW_PRIO_HIGH;
+    uint32_t p = L->vals->present[slot];
+    if (p != L->sent->present[slot]) return FLOW_PRIO_NORMAL;
+    for (; p; p &= p - 1) {
+        int c = __builtin_ctz(p);
+        if (chan_store_get(L->vals, slot, c) != chan_store_get(L->sent, slot, c)) return FLOW_PRIO_NORMAL;
+    }
+    return FLOW_PRIO_LOW;
+}
+
+// 실제로 넘어간 레코드 값만 sent에 (MQ는 mq_send 성공 콜백에서 → 큐에 못 넣은 값은 다음에 다시 보냄)
+static void mark_sent_rec(WatchLoop* L, const WatchMsg* m) {
+    if (m->dev == DEV_HANDLE_NONE || m->dev > (DevHandle)dev_intern_capacity(L->ids)) return;
+    int slot = L->slot_of[m->dev];
+    if (slot < 0 || L->cache[slot].dev != m->dev) return; // 보내는 사이 만료된 디바이스
+
+    L->cache[slot].sent_any = 1;
+    int i = 0;
+    for (uint32_t p = m->present; p; p &= p - 1, i++) {
+        chan_store_set(L->sent, slot, __builtin_ctz(p), m->vals[i]);
+    }
+}
+
+static void on_mq_sent(void* ctx, const unsigned char* recs, int n) {
+    WatchLoop* L = (WatchLoop*)ctx;
+    for (int i = 0; i < n; i++) {
+        WatchMsg m;
+        memcpy(&m, recs + (size_t)i * sizeof(WatchMsg), sizeof(m));
+        mark_sent_rec(L, &m);
+    }
+}
+
+// mask에서 낮은 비트부터 최대 n개
+static uint32_t low_bits(uint32_t mask, int n) {
+    uint32_t out = 0;
+    for (; mask && n > 0; n--) {
+        out |= mask & (~mask + 1u);
+        mask &= mask - 1;
+    }
+    return out;
+}
+
+static void send_to_mq(WatchLoop* L, int slot) {
+    WatchOut* o = L->out;
+    DeviceCache* dc = &L->cache[slot];
+
+    // 같은 디바이스는 항상 같은 shard로
+    int k = dc->shard;
+    MQBatcher* b = &o->batches[k];
+    FlowStage* fs = &o->flow[k];
+    int coalesce = flow_stage_level(fs) >= FLOW_COALESCE;
+    int admitted = -1; // 디바이스 단위로 한 번만 판단 (레코드가 여러 개여도)
+
+    // 채널이 WATCH_MSG_VALS개보다 많으면 레코드 여러 개 (채널이 없어도 ts 갱신용으로 1개)
+    uint32_t rest = L->vals->present[slot];
+    do {
+        WatchMsg msg;
+        memset(&msg, 0, sizeof(msg));
+
+        msg.dev = dc->dev;
+        msg.present = low_bits(rest, WATCH_MSG_VALS);
+        msg.dev_ts_ms = dc->dev_ts_ms;
+        msg.rx_ts_ms = dc->rx_ts_ms;
+        chan_store_pack(L->vals, slot, msg.present, msg.vals, WATCH_MSG_VALS);
+        rest &= ~msg.present;
+
+        // COALESCE 이상: 같은 디바이스 + 같은 채널 묶음 레코드가 아직 배치에 있으면 최신 값으로 덮어씀
+        // (링은 넣자마자 소비자 것이라 덮어쓸 배치가 없음, sent는 배치가 실제로 나갈 때 on_mq_sent가)
+        if (coalesce && !o->inproc) {
+            int idx = mq_batch_find(b, offsetof(WatchMsg, dev), &msg.dev,
+                                    offsetof(WatchMsg, present) + sizeof(msg.present) - offsetof(WatchMsg, dev));
+            if (idx >= 0) {
+                mq_batch_replace(b, idx, &msg);
+                flow_stage_count_coalesced(fs);
+                continue;
+            }
+        }
+
+        // SAMPLE / DROP_LOW: 버린 값은 캐시에 남아 다음 전송에 실림
+        if (admitted < 0) admitted = flow_stage_admit(fs, device_prio(L, slot));
+        if (!admitted) break;
+
+        if (o->inproc) {
+            // 링에 들어간 레코드만 sent에 (꽉 차서 버린 채널 묶음은 다음 샘플 때 다시)
+            if (watch_out_push_inproc(o, k, &msg) == 0) mark_sent_rec(L, &msg);
+            continue;
+        }
+
+        // 배치가 꽉 차면 여기서 mq_send, 아니면 deadline에 flush
+        // 못 받은 레코드(큐도 배치도 꽉 참)는 sent에 안 남아서 다음 샘플 때 다시 보냄
+        uint64_t full_before = b->send_full;
+        if (mq_batch_push(b, &msg) != 0) flow_stage_count_dropped(fs, 1);
+        watch_out_after_send(o, k, full_before);
+    } while (rest);
+}
+
+// 가장 가까운 배치 deadline (없으면 -1)
+static int watch_out_timeout(const WatchOut* o) {
+    if (o->inproc) return -1;
+    int best = -1;
+    for (int k = 0; k < o->shards; k++) {
+        int t = mq_batch_timeout_ms(&o->batches[k]);
+        if (t >= 0 && (best < 0 || t < best)) best = t;
+    }
+    return best;
+}
+
+static void watch_out_poll(WatchOut* o) {
+    if (o->inproc) return;
+    for (int k = 0; k < o->shards; k++) {
+        uint64_t full_before = o->batches[k].send_full;
+        mq_batch_poll(&o->batches[k]); // EAGAIN으로 남은 배치도 여기서 재시도
+        watch_out_after_send(o, k, full_before);
+    }
+}
+
+// shard 큐 깊이 publish + degrade 단계 재계산 (FLOW_SAMPLE_MS마다)
+static void watch_out_flow(WatchOut* o) {
+    uint64_t now = mq_batch_now_ms();
+    if (now < o->flow_next_ms) return;
+    o->flow_next_ms = now + FLOW_SAMPLE_MS;
+
+    for (int k = 0; k < o->shards; k++) {
+        int cap = 0;
+        int depth;
+        if (o->inproc) {
+            depth = spsc_ring_count(o->inproc[k]);
+            cap = spsc_ring_capacity(o->inproc[k]);
+        } else {
+            depth = mq_batch_depth(&o->batches[k], &cap);
+        }
+        if (depth < 0) continue;
+        flow_stage_update(&o->flow[k], depth, cap, 0, now);
+    }
+}
+
+// degrade 중이면 복구 판단을 위해 자주 깨어남
+static int watch_out_degraded(const WatchOut* o) {
+    for (int k = 0; k < o->shards; k++) {
+        if (flow_stage_level(&o->flow[k]) != FLOW_NORMAL) return 1;
+    }
+    return 0;
+}
+
+// 중복 / 순서 판단: "seq"가 있으면 디바이스 seq 창, 없으면 채널별 워치 ts (ts가 같으면 값까지 같아야 중복)
+// (ts도 없거나 모르는 type이면 판단할 key가 없어서 그대로 받음)
+static SeqWinVerdict admit_sample(WatchLoop* L, int slot, const cJSON* jseq, int ch, int has_ts, int64_t dev_ms,
+                                  int has_value, double value) {
+    SeqWin* w = &L->cache[slot].win;
+    if (cJSON_IsNumber(jseq) && jseq->valuedouble >= 0) {
+        return seq_win_check(w, (uint64_t)jseq->valuedouble);
+    }
+    if (!has_ts || ch < 0) {
+        w->accepted++;
+        return SEQ_WIN_NEW;
+    }
+    int same = !has_value || (chan_store_has(L->vals, slot, ch) && chan_store_get(L->vals, slot, ch) == value);
+    return seq_win_check_ts(w, &L->ch_ts[(size_t)ch * (size_t)L->max_dev + (size_t)slot], dev_ms, same);
 }
 
-static void send_to_mq(mqd_t q, const DeviceCache* dc) {
-    if (q == (mqd_t)-1 || !dc) return;
+// 샘플 1개 ({type, ts, value, seq}): 중복/순서 확인 → 채널 값 캐시 (MQ는 디바이스 묶음 끝에 한 번)
+// jts_def: 샘플에 "ts"가 없을 때 쓸 묶음 "ts", check = 0이면 묶음 "seq"로 이미 확인함
+// 채널 값은 ts가 가장 새 샘플만: 묶음 안에서 순서가 뒤바뀌었거나 seq 창이 받아준 늦은 패킷이
+// 옛날 값으로 덮고 묶음 ts_max가 찍혀서 값 / ts 짝이 어긋나는 것 막음
+// return: 1 반영, 0 버림
+static int apply_sample(WatchLoop* L, int slot, const cJSON* js, const cJSON* jts_def, int check, int64_t rx_ms,
+                        int64_t* ts_max) {
+    char type[32] = "";
+    json_get_string((cJSON*)js, "type", type, sizeof(type));
+    const cJSON* jts = cJSON_GetObjectItemCaseSensitive(js, "ts");
+    if (!jts) jts = jts_def;
+
+    int64_t dev_ms;
+    int has_ts = parse_dev_time(jts, rx_ms, &dev_ms);
+    int ch = chan_reg_lookup(L->chans, type);
+    double value = 0.0;
+    int has_value = ch >= 0 && json_get_number((cJSON*)js, "value", &value);
+
+    // 캐시에 넣기 전에 중복 / 늦게 온 샘플 거름 (캐시 ts도 안 건드리고 MQ에도 안 보냄)
+    if (check) {
+        SeqWinVerdict v = admit_sample(L, slot, cJSON_GetObjectItemCaseSensitive(js, "seq"), ch, has_ts, dev_ms,
+                                       has_value, value);
+        if (v != SEQ_WIN_NEW) {
+            L->rejected[v]++;
+            if (L->cfg->log_raw) printf("🔁 %s %s %s → dropped\n", L->cache[slot].deviceId, type, seq_win_verdict_name(v));
+            return 0;
+        }
+    }
 
-    WatchMsg msg;
-    memset(&msg, 0, sizeof(msg));
+    // ts 창을 거친 샘플은 여기서 last == dev_ms (그대로 통과), seq로 받은 샘플만 걸릴 수 있음
+    // (워치 시계가 SEQ_WIN_TS_RESET_MS 넘게 뒤로 가면 재시작으로 보고 받음)
+    if (has_value && has_ts) {
+        int64_t* last = &L->ch_ts[(size_t)ch * (size_t)L->max_dev + (size_t)slot];
+        if (*last != 0 && dev_ms < *last && *last - dev_ms <= SEQ_WIN_TS_RESET_MS) {
+            L->superseded++;
+            if (L->cfg->log_raw) printf("🔁 %s %s older than cached → value kept\n", L->cache[slot].deviceId, type);
+            return 0;
+        }
+        *last = dev_ms;
+    }
 
-    strncpy(msg.deviceId, dc->deviceId, DEV_ID_LEN - 1);
-    msg.deviceId[DEV_ID_LEN - 1] = '\0';
+    if (dev_ms > *ts_max) *ts_max = dev_ms;
+    if (has_value) chan_store_set(L->vals, slot, ch, value);
+    return 1;
+}
 
-    msg.heartRate = dc->heartRate;
-    msg.skin_temperature = dc->skin_temperature;
-    msg.has_hr = dc->has_hr;
-    msg.has_st = dc->has_st;
-    msg.ts_ms = now_ms_realtime();
+// 디바이스 묶음 1개: 샘플 객체 하나, 또는 {"deviceId", "seq"?, "ts"?, "samples": [{type, ts, value, seq}, ...]}
+// 묶음에 "seq"가 있으면 묶음 단위로 한 번만 확인 (중복 패킷이면 통째로 버림), 없으면 샘플마다 seq / 채널별 ts
+// return: 반영한 샘플이 있으면 슬롯 (MQ는 호출한 쪽이), 없으면 -1
+static int apply_device(WatchLoop* L, const cJSON* obj, int64_t rx_ms, WatchSrcStats* st) {
+    char deviceId[DEV_ID_LEN] = "unknown";
+    if (!cJSON_IsObject(obj)) {
+        st->bad++;
+        return -1;
+    }
+    json_get_string((cJSON*)obj, "deviceId", deviceId, sizeof(deviceId));
+    const cJSON* samples = cJSON_GetObjectItemCaseSensitive(obj, "samples");
+
+    // 문자열은 여기서 한 번만 (이후 캐시/MQ는 핸들)
+    DevHandle dev = dev_intern_get(L->ids, deviceId);
+    int slot = dev != DEV_HANDLE_NONE ? find_or_create_slot(L, dev) : -1;
+    if (slot < 0) return -1;
+    DeviceCache* dc = &L->cache[slot];
+
+    // 마지막 수신 시각 갱신 + 만료 타이머 다시 걸기 (중복이어도 살아있는 디바이스)
+    dc->last_seen_ms = mq_batch_now_ms();
+    timer_wheel_schedule(L->wheel, slot, dc->last_seen_ms + (uint64_t)L->stale_ms);
+
+    int64_t ts_max = INT64_MIN;
+    int applied = 0;
+    if (!samples) {
+        st->samples++;
+        applied = apply_sample(L, slot, obj, NULL, 1, rx_ms, &ts_max);
+    } else if (cJSON_IsArray(samples)) {
+        const cJSON* jseq = cJSON_GetObjectItemCaseSensitive(obj, "seq");
+        const cJSON* jts = cJSON_GetObjectItemCaseSensitive(obj, "ts");
+        int check = 1;
+        if (cJSON_IsNumber(jseq) && jseq->valuedouble >= 0) {
+            SeqWinVerdict v = seq_win_check(&dc->win, (uint64_t)jseq->valuedouble);
+            if (v != SEQ_WIN_NEW) {
+                L->rejected[v]++;
+                if (L->cfg->log_raw) printf("🔁 %s batch %s → dropped\n", dc->deviceId, seq_win_verdict_name(v));
+                return -1;
+            }
+            check = 0;
+        }
+        const cJSON* js;
+        cJSON_ArrayForEach(js, samples) {
+            st->samples++;
+            if (!cJSON_IsObject(js)) {
+                st->bad++;
+                continue;
+            }
+            applied += apply_sample(L, slot, js, jts, check, rx_ms, &ts_max);
+        }
+    } else {
+        st->bad++;
+    }
+    if (!applied) return -1;
 
-    if (mq_send(q, (const char*)&msg, sizeof(msg), 0) == -1) {
-        // Hub가 느려서 큐가 찼거나, 기타 오류
-        perror("⚠️ mq_send failed");
+    update_device_time(dc, ts_max, rx_ms);
+    if (L->cfg->log_raw) {
+        printf("🕒 %s skew=%lld ms\n", dc->deviceId, (long long)dc->skew_ms);
     }
+    return slot;
+}
+
+// 패킷 1개 처리: JSON 파싱 → 디바이스 묶음별 캐시 갱신 → MQ 배치
+// 패킷 = 샘플 객체 / 디바이스 묶음 객체 / 그 둘의 배열 (여러 디바이스)
+// 배열에서 같은 디바이스가 연달아 나오면 MQ는 마지막에 한 번
+static void handle_packet(WatchSrc* src, const unsigned char* buf, size_t len) {
+    WatchLoop* L = src->L;
+    WatchSrcStats* st = &src->st;
+    const WatchUdpConfig* cfg = L->cfg;
+    int64_t rx_ms = ts_now_ms();
+
+    if (cfg->log_raw) {
+        printf("📥 RAW(%s): %s\n", st->name, (const char*)buf);
+    }
+
+    mem_arena_reset(L->arena);
+    if (++L->packets == WARM_PACKETS) mem_pool_mark_warm();
+    st->packets++;
+    st->bytes += len;
+
+    cJSON* root = cJSON_Parse((const char*)buf);
+    if (!root) {
+        st->bad++;
+        if (cfg->log_raw) fprintf(stderr, "⚠️ JSON Parse Error: %s\n", buf);
+        return;
+    }
+
+    if (!cJSON_IsArray(root)) {
+        if (cJSON_GetObjectItemCaseSensitive(root, "samples")) st->batched++;
+        int slot = apply_device(L, root, rx_ms, st);
+        if (slot >= 0) {
+            send_to_mq(L, slot);
+            st->groups++;
+        }
+        cJSON_Delete(root);
+        return;
+    }
+
+    st->batched++;
+    int pending = -1;
+    const cJSON* it;
+    cJSON_ArrayForEach(it, root) {
+        int slot = apply_device(L, it, rx_ms, st);
+        if (slot < 0 || slot == pending) continue;
+        if (pending >= 0) {
+            send_to_mq(L, pending);
+            st->groups++;
+        }
+        pending = slot;
+    }
+    if (pending >= 0) {
+        send_to_mq(L, pending);
+        st->groups++;
+    }
+    cJSON_Delete(root);
+}
+
+// io_engine 콜백: 한 번에 받은 데이터그램들 (epoll: recvmmsg 1번, io_uring: 완료된 recv 슬롯들)
+static void on_datagrams(void* ctx, IoDatagram* dg, int n) {
+    WatchSrc* src = (WatchSrc*)ctx;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < n; i++) {
+        if (dg[i].len == 0) continue;
+        handle_packet(src, dg[i].data, dg[i].len);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    src->st.busy_ns += (uint64_t)((t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec));
+}
+
+static void print_src_stats(const WatchSrcStats* st) {
+    if (!st->packets) return;
+    printf("📊 [watch_udp] %s packets=%llu batched=%llu samples=%llu (%.2f/packet) groups=%llu bad=%llu bytes=%llu "
+           "busy=%llums (%llu ns/sample)\n",
+           st->name, (unsigned long long)st->packets, (unsigned long long)st->batched,
+           (unsigned long long)st->samples, (double)st->samples / (double)st->packets,
+           (unsigned long long)st->groups, (unsigned long long)st->bad, (unsigned long long)st->bytes,
+           (unsigned long long)(st->busy_ns / 1000000ULL),
+           (unsigned long long)(st->samples ? st->busy_ns / st->samples : 0));
+}
+
+// 같은 호스트 브리지용 AF_UNIX SOCK_DGRAM (예전 socket 파일은 지우고 새로)
+static int open_unix_dgram(const char* path) {
+    struct sockaddr_un ua;
+    if (strlen(path) >= sizeof(ua.sun_path)) {
+        fprintf(stderr, "❌ unix_path too long: %s\n", path);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket(AF_UNIX)");
+        return -1;
+    }
+    memset(&ua, 0, sizeof(ua));
+    ua.sun_family = AF_UNIX;
+    strcpy(ua.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&ua, sizeof(ua)) != 0) {
+        perror("bind(AF_UNIX)");
+        close(fd);
+        return -1;
+    }
+    return fd;
 }
 
 int watch_udp_run(const WatchUdpConfig* cfg) {
@@ -113,21 +716,25 @@ int watch_udp_run(const WatchUdpConfig* cfg) {
 
     const int port    = (cfg->port > 0 ? cfg->port : DEFAULT_PORT);
     const int max_dev = (cfg->max_devices > 0 ? cfg->max_devices : MAX_DEVICES);
+    const int stale_ms = (cfg->stale_timeout_ms > 0 ? cfg->stale_timeout_ms : DEFAULT_STALE_MS);
+    int max_dgram = (cfg->max_dgram > 0 ? cfg->max_dgram : MAX_DGRAM);
+    if (max_dgram > MAX_DGRAM_LIMIT) max_dgram = MAX_DGRAM_LIMIT;
+    size_t arena_bytes = (size_t)max_dgram * ARENA_PER_DGRAM;
+    if (arena_bytes < WATCH_ARENA_BYTES) arena_bytes = WATCH_ARENA_BYTES;
 
-    signal(SIGINT, handle_sigint);
+    // 버퍼 할당 전에 배치 (NUMA 로컬이면 이후 calloc이 고정한 CPU의 노드로)
+    thread_place_apply(&cfg->place, "watch-udp");
+    TickJitter jitter;
+    memset(&jitter, 0, sizeof(jitter));
 
-    // Hub가 먼저 MQ를 생성/오픈해둬야 함
-    g_watch_mq = mq_open(WATCH_QUEUE_NAME, O_WRONLY);
-    if (g_watch_mq == (mqd_t)-1) {
-        perror("❌ mq_open failed (run hub first / create MQ first)");
-        return -2;
-    }
+    WatchOut out;
+    int orc = watch_out_open(&out, cfg);
+    if (orc != 0) return orc;
 
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
     if (sock < 0) {
         perror("socket");
-        mq_close(g_watch_mq);
-        g_watch_mq = (mqd_t)-1;
+        watch_out_close(&out);
         return -4;
     }
 
@@ -143,87 +750,239 @@ int watch_udp_run(const WatchUdpConfig* cfg) {
     if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
         perror("bind failed (Address already in use?)");
         close(sock);
-        mq_close(g_watch_mq);
-        g_watch_mq = (mqd_t)-1;
+        watch_out_close(&out);
         return -5;
     }
 
+    // deviceId → 핸들 (허브와 같은 shm), 캐시는 핸들로 바로 찾음
+    DevIntern* ids = dev_intern_open(cfg->dev_intern_name, cfg->dev_intern_capacity);
+    if (!ids) {
+        close(sock);
+        watch_out_close(&out);
+        return -8;
+    }
+
+    // 패킷 "type" → 채널 번호 (허브와 같은 spec, 다르면 shm에 걸린 hash가 달라서 시작 안 함)
+    ChanReg* chans = chan_reg_create(cfg->channels);
+    if (!chans || dev_intern_bind_spec(ids, chan_reg_spec_hash(chans)) != 0) {
+        chan_reg_destroy(chans);
+        dev_intern_close(ids);
+        close(sock);
+        watch_out_close(&out);
+        return -9;
+    }
+
     DeviceCache* cache = (DeviceCache*)calloc((size_t)max_dev, sizeof(DeviceCache));
-    if (!cache) {
+    int* slot_of = (int*)malloc(((size_t)dev_intern_capacity(ids) + 1) * sizeof(int));
+    ChanStore vals, sent;
+    int src = chan_store_init(&vals, chan_reg_count(chans), max_dev);
+    src |= chan_store_init(&sent, chan_reg_count(chans), max_dev);
+    int64_t* ch_ts = (int64_t*)calloc((size_t)chan_reg_count(chans) * (size_t)max_dev, sizeof(int64_t));
+    if (!cache || !slot_of || src != 0 || !ch_ts) {
         fprintf(stderr, "❌ calloc failed\n");
+        free(cache);
+        free(slot_of);
+        free(ch_ts);
+        chan_store_free(&vals);
+        chan_store_free(&sent);
+        chan_reg_destroy(chans);
+        dev_intern_close(ids);
         close(sock);
-        mq_close(g_watch_mq);
-        g_watch_mq = (mqd_t)-1;
+        watch_out_close(&out);
         return -6;
     }
-
-    printf("📡 [watch_udp] Listening %s:%d → MQ %s\n", cfg->bind_ip, port, WATCH_QUEUE_NAME);
-
-    unsigned char buf[4096];
-
-    while (g_keep_running) {
-        struct sockaddr_in from;
-        socklen_t fromlen = sizeof(from);
-
-        ssize_t n = recvfrom(sock, buf, sizeof(buf) - 1, 0,
-                             (struct sockaddr*)&from, &fromlen);
-
-        if (n < 0) {
-            if (errno == EINTR) break; // SIGINT로 종료
-            continue;
+    memset(slot_of, 0xff, ((size_t)dev_intern_capacity(ids) + 1) * sizeof(int));
+
+    // 디바이스별 staleness 타이머 (id = 슬롯 번호)
+    TimerWheel* wheel = timer_wheel_create(max_dev, WHEEL_TICK_MS, mq_batch_now_ms());
+    if (!wheel) {
+        fprintf(stderr, "❌ timer_wheel_create failed\n");
+        free(cache);
+        free(slot_of);
+        free(ch_ts);
+        chan_store_free(&vals);
+        chan_store_free(&sent);
+        chan_reg_destroy(chans);
+        dev_intern_close(ids);
+        close(sock);
+        watch_out_close(&out);
+        return -6;
+    }
+    ExpireCtx ectx = { cache, slot_of, ids, &vals, &sent, cfg->log_raw };
+
+    // cJSON 파싱은 arena에서 (패킷마다 reset, steady-state에서 malloc 없음, 배치 패킷 크기에 맞춤)
+    mem_pool_install_cjson_hooks();
+    MemArena arena;
+    if (mem_arena_init(&arena, arena_bytes) != 0) {
+        fprintf(stderr, "❌ arena init failed\n");
+        timer_wheel_destroy(wheel);
+        free(cache);
+        free(slot_of);
+        free(ch_ts);
+        chan_store_free(&vals);
+        chan_store_free(&sent);
+        chan_reg_destroy(chans);
+        dev_intern_close(ids);
+        close(sock);
+        watch_out_close(&out);
+        return -6;
+    }
+    mem_arena_bind(&arena);
+
+    WatchLoop loop = { cfg, max_dev, stale_ms, cache, ids, slot_of, chans, &vals, &sent, ch_ts, wheel, &out, &arena, 0, { 0 }, 0 };
+    for (int k = 0; !out.inproc && k < out.shards; k++) mq_batch_set_sent_cb(&out.batches[k], on_mq_sent, &loop);
+    WatchSrc udp_src = { &loop, { "udp", 0, 0, 0, 0, 0, 0, 0 } };
+    WatchSrc unix_src = { &loop, { "unix", 0, 0, 0, 0, 0, 0, 0 } };
+
+    // 정지: 호출자가 준 것 (다른 스레드에서 request_stop) 또는 이 실행 전용 (SIGINT로만)
+    WatchUdpStop own_stop = { 0, -1 };
+    WatchUdpStop* stop = cfg->stop;
+    if (!stop && watch_udp_stop_init(&own_stop) == 0) stop = &own_stop;
+
+    // 수신: io_uring(가능하면) / epoll + recvmmsg, 한 번 깨어날 때 최대 recv_batch개
+    // unix_path가 있으면 같은 엔진에 AF_UNIX datagram 소스도 (같은 패킷 형식, 같은 캐시 반영 경로)
+    // 정지 eventfd를 wakeup으로 → 대기 중에 request_stop이 오면 바로 돌아옴
+    IoEngine* io = io_engine_create((IoBackend)cfg->io_backend, cfg->recv_batch);
+    int usock = -1;
+    int io_rc = (!stop || !io || io_engine_set_wakeup(io, stop->efd) != 0 ||
+                 io_engine_add_udp(io, sock, (size_t)max_dgram, on_datagrams, &udp_src) != 0) ? -1 : 0;
+    if (io_rc == 0 && cfg->unix_path) {
+        usock = open_unix_dgram(cfg->unix_path);
+        if (usock < 0 || io_engine_add_udp(io, usock, (size_t)max_dgram, on_datagrams, &unix_src) != 0) io_rc = -1;
+    }
+    if (io_rc != 0) {
+        fprintf(stderr, "❌ io_engine init failed\n");
+        io_engine_destroy(io);
+        watch_udp_stop_destroy(&own_stop);
+        if (usock >= 0) {
+            close(usock);
+            unlink(cfg->unix_path);
         }
-        if (n == 0) continue;
+        mem_arena_bind(NULL);
+        mem_arena_destroy(&arena);
+        timer_wheel_destroy(wheel);
+        free(cache);
+        free(slot_of);
+        free(ch_ts);
+        chan_store_free(&vals);
+        chan_store_free(&sent);
+        chan_reg_destroy(chans);
+        dev_intern_close(ids);
+        close(sock);
+        watch_out_close(&out);
+        return -6;
+    }
+
+    if (out.inproc) {
+        printf("📡 [watch_udp] Listening %s:%d (%s) → in-process ring x%d shard (cap %d)\n",
+               cfg->bind_ip, port, io_engine_backend_name(io), out.shards, spsc_ring_capacity(out.inproc[0]));
+    } else {
+        printf("📡 [watch_udp] Listening %s:%d (%s) → MQ %s x%d shard (batch %d, %d ms)\n",
+               cfg->bind_ip, port, io_engine_backend_name(io), WATCH_QUEUE_NAME, out.shards,
+               out.batches[0].max_records, out.batches[0].flush_ms);
+    }
+    if (usock >= 0) printf("📡 [watch_udp] Listening unix:%s (max dgram %d)\n", cfg->unix_path, max_dgram);
 
-        buf[n] = '\0';
+    if (!cfg->no_signal) {
+        g_sig_stop = stop;
+        signal(SIGINT, handle_sigint);
+    }
 
-        if (cfg->log_raw) {
-            printf("📥 RAW: %s\n", (char*)buf);
+    while (!atomic_load_explicit(&stop->stop, memory_order_acquire)) {
+        // 배치 deadline까지만 대기, 비어있어도 만료 처리를 위해 주기적으로 깨어남
+        int timeout = watch_out_timeout(&out);
+        if (timeout < 0 || timeout > IDLE_POLL_MS) timeout = IDLE_POLL_MS;
+        if (timeout > FLOW_SAMPLE_MS && watch_out_degraded(&out)) timeout = FLOW_SAMPLE_MS;
+
+        // timeout으로 깨어날 때 deadline 대비 지연 측정 (배치 flush / 만료 처리 지연)
+        struct timespec wake;
+        clock_gettime(CLOCK_MONOTONIC, &wake);
+        wake.tv_sec += timeout / 1000;
+        wake.tv_nsec += (long)(timeout % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L) {
+            wake.tv_sec += 1;
+            wake.tv_nsec -= 1000000000L;
         }
 
-        cJSON* root = cJSON_Parse((const char*)buf);
-        if (!root) {
-            if (cfg->log_raw) fprintf(stderr, "⚠️ JSON Parse Error: %s\n", buf);
+        // 받은 패킷은 on_datagrams에서 처리 (여러 개 한 번에)
+        int got = io_engine_run_once(io, timeout);
+        if (got < 0) {
+            if (errno == EINTR) break; // SIGINT로 종료
             continue;
         }
+        if (got == 0) tick_jitter_record(&jitter, &wake);
 
-        char deviceId[DEV_ID_LEN] = "unknown";
-        char type[32] = "";
-        char ts[TS_LEN] = "";
-
-        json_get_string(root, "deviceId", deviceId, sizeof(deviceId));
-        json_get_string(root, "type", type, sizeof(type));
-        json_get_string(root, "ts", ts, sizeof(ts));
-
-        double value = 0.0;
-        int has_value = json_get_number(root, "value", &value);
-
-        int slot = find_or_create_slot(cache, max_dev, deviceId);
-        if (slot >= 0) {
-            DeviceCache* dc = &cache[slot];
-
-            if (ts[0]) {
-                strncpy(dc->last_ts, ts, TS_LEN - 1);
-                dc->last_ts[TS_LEN - 1] = '\0';
-            }
-
-            if (strcmp(type, "HEART_RATE") == 0) {
-                if (has_value) { dc->heartRate = value; dc->has_hr = 1; }
-            } else if (strcmp(type, "SKIN_TEMP") == 0) {
-                if (has_value) { dc->skin_temperature = value; dc->has_st = 1; }
-            }
-
-            send_to_mq(g_watch_mq, dc);
-        }
+        watch_out_poll(&out);
+        watch_out_flow(&out);
+        timer_wheel_advance(wheel, mq_batch_now_ms(), on_device_stale, &ectx);
+    }
 
-        cJSON_Delete(root);
+    if (!cfg->no_signal) {
+        signal(SIGINT, SIG_DFL);
+        g_sig_stop = NULL;
     }
 
     printf("\n🧹 Cleaning up watch module...\n");
+    tick_jitter_print(&jitter, "[watch_udp]");
+    io_engine_print_stats(io, "[watch_udp]");
+    printf("🧮 [watch_udp] arena high=%zu/%zu overflow=%llu\n", arena.high_water, arena.cap,
+           (unsigned long long)arena.overflow);
+#ifdef MEM_POOL_DEBUG
+    if (loop.packets >= WARM_PACKETS) {
+        printf("🧮 [watch_udp] mallocs after warm-up (%d packets): %llu\n", WARM_PACKETS,
+               (unsigned long long)mem_pool_mallocs_since_warm());
+    }
+#endif
+    for (int k = 0; k < out.shards; k++) {
+        if (out.inproc) {
+            printf("📊 [watch_udp] shard %d records=%llu ring_full=%llu\n", k,
+                   (unsigned long long)out.inproc_sent[k], (unsigned long long)out.inproc_full[k]);
+        } else {
+            printf("📊 [watch_udp] shard %d records=%llu mq_send=%llu fail=%llu full=%llu rejected=%llu dropped=%llu\n", k,
+                   (unsigned long long)out.batches[k].sent_records,
+                   (unsigned long long)out.batches[k].sent_msgs,
+                   (unsigned long long)out.batches[k].send_fail,
+                   (unsigned long long)out.batches[k].send_full,
+                   (unsigned long long)out.batches[k].rejected,
+                   (unsigned long long)out.batches[k].dropped);
+        }
+        flow_stage_print(&out.flow[k]);
+    }
+    print_src_stats(&udp_src.st);
+    print_src_stats(&unix_src.st);
+    printf("🔁 [watch_udp] dropped dup=%llu late=%llu stale=%llu, superseded=%llu\n",
+           (unsigned long long)loop.rejected[SEQ_WIN_DUP], (unsigned long long)loop.rejected[SEQ_WIN_LATE],
+           (unsigned long long)loop.rejected[SEQ_WIN_STALE], (unsigned long long)loop.superseded);
+    for (int i = 0; i < max_dev; i++) {
+        if (!cache[i].used) continue;
+        const SeqWin* w = &cache[i].win;
+        printf("🕒 [watch_udp] %s skew last=%lld ms max=%lld ms\n", cache[i].deviceId,
+               (long long)cache[i].skew_ms, (long long)cache[i].skew_max_ms);
+        printf("📶 [watch_udp] %s ok=%llu dup=%llu late=%llu stale=%llu lost=%llu (%.2f%%) resets=%llu\n",
+               cache[i].deviceId, (unsigned long long)w->accepted, (unsigned long long)w->dup,
+               (unsigned long long)w->late, (unsigned long long)w->stale, (unsigned long long)w->lost,
+               seq_win_loss_pct(w), (unsigned long long)w->resets);
+    }
+    watch_out_close(&out);
+    for (int i = 0; i < max_dev; i++) {
+        if (cache[i].used) dev_intern_unref(ids, cache[i].dev); // 잡고 있던 핸들 놓음
+    }
+    io_engine_destroy(io);
+    watch_udp_stop_destroy(&own_stop);
+    timer_wheel_destroy(wheel);
     free(cache);
+    free(slot_of);
+    free(ch_ts);
+    chan_store_free(&vals);
+    chan_store_free(&sent);
+    chan_reg_destroy(chans);
+    dev_intern_close(ids);
     close(sock);
-    if (g_watch_mq != (mqd_t)-1) {
-        mq_close(g_watch_mq);
-        g_watch_mq = (mqd_t)-1;
+    if (usock >= 0) {
+        close(usock);
+        unlink(cfg->unix_path);
     }
+    mem_arena_bind(NULL);
+    mem_arena_destroy(&arena);
     return 0;
 }
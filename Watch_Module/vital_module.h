@@ -2,27 +2,77 @@
 #define VITAL_MODULE_H
 
 #include <stdio.h>
+#include <stdatomic.h>
+
+#include "thread_place.h"
+#include "flow_ctl.h"
+#include "io_engine.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// 수신 루프 정지 (실행마다 하나): atomic 플래그 + eventfd
+// 루프가 eventfd를 io_engine wakeup으로 걸어서 request_stop 하면 대기 중이어도 바로 깨어남
+typedef struct {
+    atomic_int stop;
+    int efd;                  // 정지 eventfd (EFD_NONBLOCK, 루프는 읽지 않음)
+} WatchUdpStop;
+
 typedef struct {
     int port;                 // UDP listen port (default 5005)
     const char* bind_ip;      // "0.0.0.0"
     int max_devices;          // e.g. 64
     int log_raw;              // 1이면 RAW 수신 로그 출력
+    int batch_max;            // MQ 메시지당 최대 WatchMsg 수 (0이면 큐 msgsize에 맞춤)
+    int batch_flush_ms;       // 배치 flush deadline (0이면 매 패킷 즉시 전송)
+    int stale_timeout_ms;     // 이 시간 동안 패킷 없는 디바이스는 슬롯 해제 (기본 300000)
+    int shard_count;          // >1 이면 deviceId consistent hash로 /mq_vital.<k> 에 분배 (허브 shard별 큐)
+    int shard_vnodes;         // shard당 가상 노드 수 (0이면 기본값, 허브와 같아야 함)
+    ThreadPlace place;        // 수신 루프 스레드 CPU 고정 / SCHED_FIFO·nice / NUMA 로컬 할당 (0이면 기본)
+    FlowConfig flow;          // MQ 깊이 기반 degrade 임계값 (0이면 기본값)
+    int io_backend;           // IoBackend: 0 자동(io_uring → 안 되면 epoll), 1 epoll, 2 io_uring
+    int recv_batch;           // 한 번 깨어날 때 받는 최대 패킷 수 (0이면 기본 16)
+    const char* dev_intern_name; // deviceId 핸들 shm 이름 (NULL이면 "/dev_intern", 허브와 같아야 함)
+    int dev_intern_capacity;  // 처음 만드는 쪽일 때 최대 디바이스 수 (0이면 65536)
+    const char* channels;     // HR/SKIN_TEMP 뒤에 붙일 채널 "TYPE=key,..." (NULL이면 기본 2개, 허브와 같아야 함, 다르면 -9)
+    const char* unix_path;    // 같은 호스트 브리지용 AF_UNIX SOCK_DGRAM 경로 (NULL이면 UDP만)
+    int max_dgram;            // 패킷 1개 최대 크기 (0이면 4095, 배치 패킷이면 키움, 최대 65507)
+
+    // 통합 실행 (runtime_main): 같은 프로세스 안의 허브로 바로
+    struct SpscRing** out_rings; // 지정하면 MQ 대신 shard별 링에 WatchMsg (shard_count개, 소비자 = 허브 drain)
+    int no_signal;            // 1이면 SIGINT 핸들러 안 걸음 (런타임이 시그널 처리 → watch_udp_request_stop)
+    WatchUdpStop* stop;       // 다른 스레드에서 멈출 때 (실행마다 init, NULL이면 run 안에서 만들고 SIGINT로만 멈춤)
 } WatchUdpConfig;
 
 /**
  * 워치 UDP(JSON) 수신 루프.
- * - deviceId별로 HR/SKIN_TEMP 캐시 유지
- * - 매 패킷마다 WatchMsg(구조체)로 MQ(/mq_watch)에 전송
+ * - 패킷 형식 (UDP / unix_path 공통)
+ *     샘플 1개      {"deviceId", "type", "ts", "value", "seq"?}
+ *     디바이스 묶음 {"deviceId", "seq"?, "ts"?, "samples": [{"type", "ts"?, "value", "seq"?}, ...]}
+ *                   묶음 "seq"는 패킷 단위 중복 확인 (샘플 "seq"와 섞지 말 것), 샘플 "ts" 없으면 묶음 "ts"
+ *     배열          [샘플 1개 또는 디바이스 묶음, ...] (여러 디바이스)
+ *   디바이스 묶음마다 캐시 반영 후 MQ 전송 1번 (샘플마다가 아니라)
+ * - deviceId별로 채널(HR/SKIN_TEMP + channels) 값 캐시 유지, 패킷 "type"은 channel_reg로 채널 번호로
+ * - stale_timeout_ms 동안 조용한 디바이스는 타이머 휠로 만료시켜 슬롯 재사용
+ * - 디바이스별 seq 창(seq_win)으로 중복 / 늦게 온 패킷은 값 읽기 전에 버림 ("seq" 없으면 채널별 워치 ts로)
+ * - 채널 값은 ts가 가장 새 샘플만 (묶음 안에서 순서가 뒤바뀌거나 seq 창이 받은 늦은 패킷도 옛날 값으로 안 덮음)
+ * - deviceId는 dev_intern 핸들로 바꿔서 캐시/MQ에 (WatchMsg에는 문자열 없음)
+ * - 매 패킷마다 WatchMsg(구조체)를 배치에 쌓고, 배치가 차거나 deadline이 지나면 MQ(/mq_vital)에 전송
+ * - MQ는 non-blocking, 허브가 밀려 큐가 차면 COALESCE → SAMPLE → DROP_LOW 순으로 degrade (flow_ctl)
  *
- * return: 0 정상 종료(보통 SIGINT로 빠져나옴), <0 에러
+ * return: 0 정상 종료(SIGINT 또는 cfg->stop에 request_stop), <0 에러
  */
 int watch_udp_run(const WatchUdpConfig* cfg);
 
+// return: 0 성공, -1 eventfd 실패
+int watch_udp_stop_init(WatchUdpStop* s);
+void watch_udp_stop_destroy(WatchUdpStop* s);
+
+// 수신 루프 종료 요청 (아무 스레드에서나, 시그널 핸들러에서도 됨, eventfd로 바로 빠져나옴)
+// run 시작 전에 불러도 그 실행은 바로 끝남 (플래그는 init에서만 비움)
+void watch_udp_request_stop(WatchUdpStop* s);
+
 #ifdef __cplusplus
 }
 #endif
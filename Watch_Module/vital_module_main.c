@@ -1,14 +1,32 @@
 #include <stdio.h>
+#include <string.h>
 #include "vital_module.h"
 
 int main(int argc, char** argv) {
     (void)argc; (void)argv;
 
     WatchUdpConfig cfg;
+    memset(&cfg, 0, sizeof(cfg)); // 안 적은 항목은 0 = 기본값
     cfg.port = 5005;
     cfg.bind_ip = "0.0.0.0";
     cfg.max_devices = 64;
     cfg.log_raw = 0;
+    cfg.batch_max = 0;        // 큐 msgsize 기준
+    cfg.batch_flush_ms = 200;
+    cfg.stale_timeout_ms = 300000; // 5분
+    cfg.shard_count = 1;           // 샤딩 안 함 (/mq_vital 하나)
+    cfg.shard_vnodes = 0;
+    cfg.io_backend = IO_BACKEND_AUTO; // io_uring 안 되는 커널이면 epoll
+    cfg.recv_batch = 0;               // 기본 16
+    cfg.unix_path = NULL;             // 예) "/tmp/watch.sock" (같은 호스트 BLE 브리지가 배치 패킷을 바로)
+    cfg.max_dgram = 0;                // 기본 4095, 배치 패킷을 크게 보내면 키움
+
+    // 스레드 배치: 기본은 스케줄러에 맡김
+    // 예) cfg.place.cpu_mask = thread_place_parse_cpus("2"); cfg.place.rt_priority = 10; cfg.place.numa_local = 1;
+    memset(&cfg.place, 0, sizeof(cfg.place));
+
+    // 흐름 제어: 기본 임계값 (큐 75% 이상이면 degrade, 25% 이하면 복구)
+    memset(&cfg.flow, 0, sizeof(cfg.flow));
 
     printf("▶ watch_udp_main start\n");
     return watch_udp_run(&cfg);
@@ -0,0 +1,266 @@
+/*
+워치 수신 처리량 벤치: 샘플 1개 UDP / 묶음 UDP / 묶음 AF_UNIX datagram (한 프로세스, MQ / 허브 없이)
+
+빌드 (저장소 루트에서)
+gcc -O2 -o watch_ingest_bench Watch_Module/watch_ingest_bench.c Watch_Module/vital_module.c Watch_Module/seq_win.c \
+    mq_batch.c timer_wheel.c ts_parse.c shard_ring.c mem_pool.c thread_place.c flow_ctl.c io_engine.c \
+    dev_intern.c channel_reg.c spsc_ring.c \
+    -I. -IWatch_Module -lcjson -lpthread -lrt -lm
+
+실행
+./watch_ingest_bench [-d 디바이스 수] [-s 단계당 샘플 수] [-b 묶음당 샘플] [-w 앞서 보낼 최대 패킷] [-p port]
+- watch_udp_run을 스레드로 (MQ 대신 링 1개, 소비자 스레드가 WatchMsg 수만 셈)
+- 단계 3개를 같은 샘플 수로: udp/1 ({deviceId,type,ts,value,seq} 1개 / 패킷)
+                             udp/N ({deviceId,seq,samples:[N개]} / 패킷)
+                             unix/N (같은 묶음을 AF_UNIX SOCK_DGRAM으로)
+- 보내는 쪽은 링에서 나온 레코드보다 -w 패킷 넘게 앞서지 않음 (loopback 소켓 버퍼가 넘쳐 버려지는 걸 재는 게 아니라서)
+- 출력: 단계별 samples/s, packets/s, 레코드 수, 못 받은 패킷, 프로세스 CPU ns/sample (보내는 쪽 포함)
+  끝나면 watch_udp_run이 소스별 busy ns/sample (수신 루프만)을 찍음
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "vital_module.h"
+#include "common.h"
+#include "spsc_ring.h"
+#include "ts_parse.h"
+
+#define BENCH_UNIX_PATH "/tmp/watch_ingest_bench.sock"
+#define BENCH_PKT_MAX   65507
+#define BENCH_STALL_MS  200     // 레코드가 이만큼 안 늘면 나머지는 못 받은 걸로
+
+typedef struct {
+    SpscRing* ring;
+    atomic_llong records;
+    atomic_int stop;
+} Consumer;
+
+typedef struct {
+    int rc;
+    const WatchUdpConfig* cfg;
+} Runner;
+
+typedef struct {
+    int devices;
+    long long samples;      // 단계당
+    int per_pkt;
+    int window;
+    int port;
+    uint64_t* seq;          // 디바이스별 (단계가 바뀌어도 이어서 → 중복으로 안 걸림)
+    char ts[32];            // 워치 ts 문자열 (로컬 시간, 초 단위), 패킷 256개마다 갱신
+} Bench;
+
+static double _mono_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double _cpu_s(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+           (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+}
+
+static void* _consume(void* arg) {
+    Consumer* c = (Consumer*)arg;
+    WatchMsg m[64];
+    while (!atomic_load(&c->stop)) {
+        int n = spsc_ring_pop_n(c->ring, m, 64);
+        if (n > 0) {
+            atomic_fetch_add(&c->records, n);
+            continue;
+        }
+        spsc_ring_wait(c->ring, 100);
+    }
+    return NULL;
+}
+
+static void* _watch(void* arg) {
+    Runner* r = (Runner*)arg;
+    r->rc = watch_udp_run(r->cfg);
+    return NULL;
+}
+
+// 디바이스 d의 다음 패킷 (seq는 디바이스별로 계속 늘어남, 묶음 샘플은 묶음 "ts" 하나)
+static int _build(Bench* b, char* buf, size_t cap, int d, int per_pkt) {
+    uint64_t seq = ++b->seq[d];
+    int n;
+    if (per_pkt <= 1) {
+        n = snprintf(buf, cap, "{\"deviceId\":\"I%06d\",\"type\":\"%s\",\"ts\":\"%s\",\"value\":%d,\"seq\":%llu}", d,
+                     seq % 2 ? "HEART_RATE" : "SKIN_TEMP", b->ts, 60 + (int)(seq % 40), (unsigned long long)seq);
+        return n > 0 && (size_t)n < cap ? n : -1;
+    }
+    n = snprintf(buf, cap, "{\"deviceId\":\"I%06d\",\"seq\":%llu,\"ts\":\"%s\",\"samples\":[", d,
+                 (unsigned long long)seq, b->ts);
+    for (int i = 0; i < per_pkt && n > 0 && (size_t)n < cap; i++) {
+        n += snprintf(buf + n, cap - (size_t)n, "%s{\"type\":\"%s\",\"value\":%d}", i ? "," : "",
+                      i % 2 ? "SKIN_TEMP" : "HEART_RATE", 60 + (int)((seq + (uint64_t)i) % 40));
+    }
+    if (n > 0 && (size_t)n < cap) n += snprintf(buf + n, cap - (size_t)n, "]}");
+    return n > 0 && (size_t)n < cap ? n : -1;
+}
+
+// 단계 1개: fd로 to에
+static void _phase(Bench* b, Consumer* c, const char* name, int fd, const struct sockaddr* to, socklen_t to_len,
+                   int per_pkt) {
+    char* buf = (char*)malloc(BENCH_PKT_MAX);
+    if (!buf) return;
+    long long pkts = (b->samples + per_pkt - 1) / per_pkt;
+    long long r0 = atomic_load(&c->records), sent = 0, fail = 0;
+
+    double t0 = _mono_s(), c0 = _cpu_s();
+    int d = 0;
+    while (sent + fail < pkts) {
+        // 링에서 나온 만큼만 앞서 보냄
+        if (sent - (atomic_load(&c->records) - r0) >= b->window) {
+            sched_yield();
+            continue;
+        }
+        if (((sent + fail) & 255) == 0) ts_format_local_iso(ts_now_ms(), b->ts, sizeof(b->ts));
+        int n = _build(b, buf, BENCH_PKT_MAX, d, per_pkt);
+        if (n < 0 || sendto(fd, buf, (size_t)n, 0, to, to_len) != n) {
+            fail++;
+        } else {
+            sent++;
+        }
+        if (++d >= b->devices) d = 0;
+    }
+    // 남은 것: 레코드가 BENCH_STALL_MS 동안 안 늘면 그만
+    long long last = -1;
+    double t_last = _mono_s();
+    for (;;) {
+        long long got = atomic_load(&c->records) - r0;
+        if (got >= sent) break;
+        if (got != last) {
+            last = got;
+            t_last = _mono_s();
+        } else if (_mono_s() - t_last > BENCH_STALL_MS / 1000.0) {
+            break;
+        }
+        usleep(1000);
+    }
+    double wall = _mono_s() - t0, cpu = _cpu_s() - c0;
+    long long recs = atomic_load(&c->records) - r0;
+    long long samples = sent * per_pkt;
+
+    printf("📊 [BENCH] %-7s samples/pkt=%d packets=%lld fail=%lld records=%lld lost=%lld wall=%.3fs → %.0f samples/s "
+           "%.0f pkt/s, cpu %.0f ns/sample\n",
+           name, per_pkt, sent, fail, recs, sent > recs ? sent - recs : 0, wall, (double)samples / wall,
+           (double)sent / wall, cpu * 1e9 / (double)(samples ? samples : 1));
+    free(buf);
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    memset(&b, 0, sizeof(b));
+    b.devices = 1000;
+    b.samples = 1000000;
+    b.per_pkt = 16;
+    b.window = 64;
+    b.port = 5995;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:s:b:w:p:")) != -1) {
+        switch (opt) {
+        case 'd': b.devices = atoi(optarg); break;
+        case 's': b.samples = atoll(optarg); break;
+        case 'b': b.per_pkt = atoi(optarg); break;
+        case 'w': b.window = atoi(optarg); break;
+        case 'p': b.port = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-d devices] [-s samples] [-b samples/pkt] [-w window] [-p port]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (b.devices < 1) b.devices = 1;
+    if (b.samples < 1) b.samples = 1;
+    if (b.per_pkt < 2) b.per_pkt = 2;
+    if (b.window < 1) b.window = 1;
+    b.seq = (uint64_t*)calloc((size_t)b.devices, sizeof(uint64_t));
+
+    char intern[64];
+    snprintf(intern, sizeof(intern), "/watch_ingest_bench.%d", (int)getpid());
+    shm_unlink(intern);
+
+    Consumer c;
+    memset(&c, 0, sizeof(c));
+    c.ring = spsc_ring_create(sizeof(WatchMsg), 1 << 16, 1);
+    if (!b.seq || !c.ring) {
+        fprintf(stderr, "❌ [BENCH] alloc failed\n");
+        return 1;
+    }
+
+    WatchUdpConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.port = b.port;
+    cfg.bind_ip = "127.0.0.1";
+    cfg.max_devices = b.devices;
+    cfg.stale_timeout_ms = 600000;
+    cfg.shard_count = 1;
+    cfg.recv_batch = 64;
+    cfg.dev_intern_name = intern;
+    cfg.dev_intern_capacity = b.devices + 16;
+    cfg.unix_path = BENCH_UNIX_PATH;
+    cfg.max_dgram = BENCH_PKT_MAX;
+    cfg.out_rings = &c.ring;
+    cfg.no_signal = 1;
+    WatchUdpStop stop;
+    if (watch_udp_stop_init(&stop) != 0) return 1;
+    cfg.stop = &stop;
+
+    Runner run = { 0, &cfg };
+    pthread_t tw, tc;
+    pthread_create(&tc, NULL, _consume, &c);
+    pthread_create(&tw, NULL, _watch, &run);
+    usleep(300000); // 소켓 bind까지
+
+    int ufd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in ua;
+    memset(&ua, 0, sizeof(ua));
+    ua.sin_family = AF_INET;
+    ua.sin_port = htons((uint16_t)b.port);
+    ua.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int xfd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    struct sockaddr_un xa;
+    memset(&xa, 0, sizeof(xa));
+    xa.sun_family = AF_UNIX;
+    snprintf(xa.sun_path, sizeof(xa.sun_path), "%s", BENCH_UNIX_PATH);
+
+    printf("▶ [BENCH] devices=%d samples/phase=%lld batch=%d window=%d\n", b.devices, b.samples, b.per_pkt, b.window);
+    char name[16];
+    _phase(&b, &c, "udp/1", ufd, (struct sockaddr*)&ua, sizeof(ua), 1);
+    snprintf(name, sizeof(name), "udp/%d", b.per_pkt);
+    _phase(&b, &c, name, ufd, (struct sockaddr*)&ua, sizeof(ua), b.per_pkt);
+    snprintf(name, sizeof(name), "unix/%d", b.per_pkt);
+    _phase(&b, &c, name, xfd, (struct sockaddr*)&xa, sizeof(xa), b.per_pkt);
+
+    watch_udp_request_stop(&stop);
+    pthread_join(tw, NULL);
+    watch_udp_stop_destroy(&stop);
+    atomic_store(&c.stop, 1);
+    spsc_ring_kick(c.ring);
+    pthread_join(tc, NULL);
+
+    close(ufd);
+    close(xfd);
+    spsc_ring_destroy(c.ring);
+    free(b.seq);
+    shm_unlink(intern);
+    return run.rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+#include "channel_reg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#define CHAN_NAME_LEN 32
+#define PH_MAX_SEEDS  4096   // 이 안에 충돌 없는 seed 못 찾으면 테이블 2배
+
+typedef struct {
+    char type[CHAN_NAME_LEN];
+    char key[CHAN_NAME_LEN];
+    char field[CHAN_NAME_LEN];
+    size_t type_len;
+} ChanDef;
+
+struct ChanReg {
+    int n;
+    ChanDef ch[CHAN_MAX];
+
+    // perfect hash: table[_ph(type) & mask] = 채널 번호 (-1 빈 칸)
+    uint32_t seed;
+    uint32_t mask;
+    int8_t* table;
+};
+
+// ================================
+// 내부: perfect hash
+// ================================
+static uint32_t _ph(const char* s, size_t n, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+// 충돌 없는 (seed, 크기) 찾기
+static int _build(ChanReg* r) {
+    uint32_t size = 8;
+    while (size < (uint32_t)r->n * 2) size <<= 1;
+
+    for (; size <= 4096; size <<= 1) {
+        int8_t* t = (int8_t*)malloc(size);
+        if (!t) return -1;
+
+        for (uint32_t seed = 1; seed <= PH_MAX_SEEDS; seed++) {
+            memset(t, -1, size);
+            int ok = 1;
+            for (int c = 0; c < r->n && ok; c++) {
+                uint32_t i = _ph(r->ch[c].type, r->ch[c].type_len, seed) & (size - 1);
+                if (t[i] >= 0) ok = 0;
+                else t[i] = (int8_t)c;
+            }
+            if (ok) {
+                free(r->table);
+                r->table = t;
+                r->seed = seed;
+                r->mask = size - 1;
+                return 0;
+            }
+        }
+        free(t);
+    }
+    return -1;
+}
+
+static int _add(ChanReg* r, const char* type, size_t tlen, const char* key, size_t klen, const char* field) {
+    if (r->n >= CHAN_MAX || tlen == 0 || tlen >= CHAN_NAME_LEN || klen >= CHAN_NAME_LEN) return -1;
+    for (int c = 0; c < r->n; c++) {
+        if (r->ch[c].type_len == tlen && memcmp(r->ch[c].type, type, tlen) == 0) return -1;
+    }
+
+    ChanDef* d = &r->ch[r->n];
+    memcpy(d->type, type, tlen);
+    d->type[tlen] = '\0';
+    d->type_len = tlen;
+
+    if (klen > 0) {
+        memcpy(d->key, key, klen);
+        d->key[klen] = '\0';
+    } else {
+        for (size_t i = 0; i < tlen; i++) d->key[i] = (char)tolower((unsigned char)type[i]);
+        d->key[tlen] = '\0';
+    }
+    if (field) snprintf(d->field, sizeof(d->field), "%s", field);
+    else memcpy(d->field, d->key, sizeof(d->field));
+    r->n++;
+    return 0;
+}
+
+static const char* _skip_ws(const char* p, const char* end) {
+    while (p < end && isspace((unsigned char)*p)) p++;
+    return p;
+}
+
+static const char* _trim_end(const char* b, const char* e) {
+    while (e > b && isspace((unsigned char)e[-1])) e--;
+    return e;
+}
+
+// ================================
+// 외부 API
+// ================================
+ChanReg* chan_reg_create(const char* spec) {
+    ChanReg* r = (ChanReg*)calloc(1, sizeof(ChanReg));
+    if (!r) return NULL;
+
+    // 기본 채널 (번호 고정)
+    _add(r, "HEART_RATE", 10, "hr", 2, "heartRate");
+    _add(r, "SKIN_TEMP", 9, "st", 2, "skin_temperature");
+
+    // "TYPE=key,TYPE2,TYPE3=key3"
+    const char* p = spec ? spec : "";
+    while (*p) {
+        const char* end = strchr(p, ',');
+        if (!end) end = p + strlen(p);
+
+        const char* b = _skip_ws(p, end);
+        const char* e = _trim_end(b, end);
+        if (b < e) {
+            const char* eq = memchr(b, '=', (size_t)(e - b));
+            const char* tend = _trim_end(b, eq ? eq : e);
+            const char* kb = eq ? _skip_ws(eq + 1, e) : e;
+            if (_add(r, b, (size_t)(tend - b), kb, (size_t)(e - kb), NULL) != 0) {
+                fprintf(stderr, "❌ [CHAN] bad channel spec near \"%.*s\" (max %d, no duplicates)\n",
+                        (int)(e - b), b, CHAN_MAX);
+                chan_reg_destroy(r);
+                return NULL;
+            }
+        }
+        p = *end ? end + 1 : end;
+    }
+
+    if (_build(r) != 0) {
+        fprintf(stderr, "❌ [CHAN] perfect hash build failed (%d channels)\n", r->n);
+        chan_reg_destroy(r);
+        return NULL;
+    }
+    return r;
+}
+
+void chan_reg_destroy(ChanReg* r) {
+    if (!r) return;
+    free(r->table);
+    free(r);
+}
+
+int chan_reg_count(const ChanReg* r) {
+    return r ? r->n : 0;
+}
+
+int chan_reg_lookup_n(const ChanReg* r, const char* type, size_t len) {
+    if (!r || !type) return -1;
+    int c = r->table[_ph(type, len, r->seed) & r->mask];
+    if (c < 0 || r->ch[c].type_len != len || memcmp(r->ch[c].type, type, len) != 0) return -1;
+    return c;
+}
+
+int chan_reg_lookup(const ChanReg* r, const char* type) {
+    return type ? chan_reg_lookup_n(r, type, strlen(type)) : -1;
+}
+
+const char* chan_reg_type(const ChanReg* r, int ch) {
+    return (r && ch >= 0 && ch < r->n) ? r->ch[ch].type : NULL;
+}
+
+const char* chan_reg_key(const ChanReg* r, int ch) {
+    return (r && ch >= 0 && ch < r->n) ? r->ch[ch].key : NULL;
+}
+
+const char* chan_reg_field(const ChanReg* r, int ch) {
+    return (r && ch >= 0 && ch < r->n) ? r->ch[ch].field : NULL;
+}
+
+// FNV-1a (채널 순서대로 type / key / field, 구분자 포함)
+static uint64_t _fnv(uint64_t h, const char* s) {
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= 0xffu; // 필드 경계
+    return h * 0x100000001b3ULL;
+}
+
+uint64_t chan_reg_spec_hash(const ChanReg* r) {
+    if (!r) return 0;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int c = 0; c < r->n; c++) {
+        h = _fnv(h, r->ch[c].type);
+        h = _fnv(h, r->ch[c].key);
+        h = _fnv(h, r->ch[c].field);
+    }
+    return h ? h : 1;
+}
+
+// ================================
+// 채널 값 저장소
+// ================================
+int chan_store_init(ChanStore* s, int n_ch, int cap) {
+    memset(s, 0, sizeof(*s));
+    if (n_ch <= 0 || n_ch > CHAN_MAX || cap <= 0) return -1;
+
+    s->present = (uint32_t*)calloc((size_t)cap, sizeof(uint32_t));
+    s->val = (double*)calloc((size_t)n_ch * (size_t)cap, sizeof(double));
+    if (!s->present || !s->val) {
+        chan_store_free(s);
+        return -1;
+    }
+    s->cap = cap;
+    s->n_ch = n_ch;
+    return 0;
+}
+
+void chan_store_free(ChanStore* s) {
+    if (!s) return;
+    free(s->present);
+    free(s->val);
+    memset(s, 0, sizeof(*s));
+}
+
+int chan_store_resize(ChanStore* s, int cap) {
+    if (cap <= 0) return -1;
+    if (cap == s->cap) return 0;
+
+    // 채널마다 cap 간격이라 새 배열로 옮겨 담음
+    uint32_t* p = (uint32_t*)calloc((size_t)cap, sizeof(uint32_t));
+    double* v = (double*)calloc((size_t)s->n_ch * (size_t)cap, sizeof(double));
+    if (!p || !v) {
+        free(p);
+        free(v);
+        return -1;
+    }
+
+    int keep = s->cap < cap ? s->cap : cap;
+    memcpy(p, s->present, (size_t)keep * sizeof(uint32_t));
+    for (int c = 0; c < s->n_ch; c++) {
+        memcpy(v + (size_t)c * (size_t)cap, s->val + (size_t)c * (size_t)s->cap, (size_t)keep * sizeof(double));
+    }
+
+    free(s->present);
+    free(s->val);
+    s->present = p;
+    s->val = v;
+    s->cap = cap;
+    return 0;
+}
+
+void chan_store_move(ChanStore* s, int from, int to) {
+    for (int c = 0; c < s->n_ch; c++) {
+        s->val[(size_t)c * (size_t)s->cap + (size_t)to] = s->val[(size_t)c * (size_t)s->cap + (size_t)from];
+    }
+    s->present[to] = s->present[from];
+    s->present[from] = 0;
+}
+
+int chan_store_pack(const ChanStore* s, int slot, uint32_t mask, double* out, int max) {
+    int n = 0;
+    mask &= s->present[slot];
+    while (mask && n < max) {
+        int c = __builtin_ctz(mask);
+        out[n++] = chan_store_get(s, slot, c);
+        mask &= mask - 1;
+    }
+    return n;
+}
@@ -0,0 +1,84 @@
+#ifndef CHANNEL_REG_H
+#define CHANNEL_REG_H
+
+/*
+센서 채널 레지스트리 + 디바이스별 채널 값 저장소 (워치 모듈 / 허브 공용)
+- 채널 = 워치 패킷 "type" 문자열 (HEART_RATE, SKIN_TEMP, ...) → 채널 번호 (0 ~ CHAN_MAX-1)
+  기본 2개 (HR = 0, ST = 1) + 설정 문자열로 추가 ("SPO2=spo2,STEPS=steps")
+  번호는 설정 순서대로라서 워치 모듈과 허브는 같은 설정을 써야 함
+  → chan_reg_spec_hash를 dev_intern shm에 걸어두고 (dev_intern_bind_spec) 다르면 시작 안 함
+- type → 번호: 만들 때 충돌 없는 seed를 찾아둔 perfect hash (hash 1번 + 문자열 비교 1번)
+- 값 저장소: 채널별 배열(SoA) + 슬롯별 presence bitmask
+- 생성 후에는 읽기 전용 (여러 스레드에서 락 없이 lookup)
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHAN_MAX 32   // presence bitmask가 uint32
+
+enum {
+    CHAN_HR = 0,      // "HEART_RATE" → SENSOR "hr", watch 라인 "heartRate"
+    CHAN_ST = 1       // "SKIN_TEMP"  → SENSOR "st", watch 라인 "skin_temperature"
+};
+
+typedef struct ChanReg ChanReg;
+
+// spec: 기본 채널 뒤에 붙일 "TYPE=key" 목록 (',' 구분, key 생략하면 type 소문자)
+//       NULL / ""이면 기본 채널만. 형식 오류 / CHAN_MAX 초과 / 중복이면 NULL
+ChanReg* chan_reg_create(const char* spec);
+void chan_reg_destroy(ChanReg* r);
+
+int chan_reg_count(const ChanReg* r);
+int chan_reg_lookup(const ChanReg* r, const char* type);                // 모르는 type이면 -1
+int chan_reg_lookup_n(const ChanReg* r, const char* type, size_t len);
+const char* chan_reg_type(const ChanReg* r, int ch);   // "HEART_RATE"
+const char* chan_reg_key(const ChanReg* r, int ch);    // SENSOR 필드 이름 ("hr")
+const char* chan_reg_field(const ChanReg* r, int ch);  // watch JSON 라인 필드 이름 ("heartRate")
+uint64_t chan_reg_spec_hash(const ChanReg* r);         // 채널 번호 / type / key / field 전체 (0은 안 나옴)
+
+// ============================
+// 채널 값 저장소 (SoA): val[ch * cap + slot], present[slot] bit ch
+// ============================
+typedef struct {
+    int cap;          // 슬롯 수
+    int n_ch;
+    uint32_t* present;
+    double* val;
+} ChanStore;
+
+int  chan_store_init(ChanStore* s, int n_ch, int cap); // 0 성공, -1 실패
+void chan_store_free(ChanStore* s);
+int  chan_store_resize(ChanStore* s, int cap);         // 앞쪽 min(old, cap) 슬롯 유지
+void chan_store_move(ChanStore* s, int from, int to);  // to에 덮어쓰고 from은 비움
+
+static inline void chan_store_set(ChanStore* s, int slot, int ch, double v) {
+    s->val[(size_t)ch * (size_t)s->cap + (size_t)slot] = v;
+    s->present[slot] |= 1u << ch;
+}
+
+static inline double chan_store_get(const ChanStore* s, int slot, int ch) {
+    return s->val[(size_t)ch * (size_t)s->cap + (size_t)slot];
+}
+
+static inline int chan_store_has(const ChanStore* s, int slot, int ch) {
+    return (s->present[slot] >> ch) & 1u;
+}
+
+static inline void chan_store_clear(ChanStore* s, int slot) {
+    s->present[slot] = 0;
+}
+
+// present 비트 순서(낮은 채널부터)로 값 꺼내기 (return: 꺼낸 개수, max까지만)
+int chan_store_pack(const ChanStore* s, int slot, uint32_t mask, double* out, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,465 @@
+#include "dev_intern.h"
+#include "shard_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define DEV_INTERN_MAGIC   0x4E544944u // "DITN"
+#define DEV_INTERN_VERSION 3
+#define ATTACH_WAIT_MS     1000        // 다른 프로세스가 초기화 중이면 이만큼 기다림
+#define INDEX_TOMB         0xFFFFFFFFu // index 삭제 표시 (탐색은 계속 지나감)
+
+enum { ENTRY_LIVE = 1, ENTRY_FREE = 2 };
+
+typedef struct {
+    _Atomic uint32_t magic;    // 초기화 끝나면 마지막에 씀
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t index_mask;
+    _Atomic uint32_t count;    // 만든 핸들 수 (= 가장 큰 핸들)
+    _Atomic uint32_t index_seq; // index 재구성 중이면 홀수 (락 없는 조회가 보고 다시)
+
+    // 아래는 lock 잡고만
+    uint32_t live;
+    uint32_t tombs;
+    uint32_t free_head;        // 놓인 핸들 FIFO (놓인 순서 = 재사용 가능해지는 순서), 0 = 없음
+    uint32_t free_tail;
+    uint32_t n_free;
+    uint32_t _pad;
+    uint64_t reused;
+    uint64_t full;
+    uint64_t spec_hash;        // 채널 spec (0 = 아직 안 걸림)
+    pthread_mutex_t lock;      // 등록 / ref / unref (PTHREAD_PROCESS_SHARED + robust)
+} DevInternHdr;
+
+typedef struct {
+    uint64_t hash;
+    char id[DEV_INTERN_ID_LEN];
+    // 아래는 lock 잡고만
+    uint32_t state;            // ENTRY_LIVE / ENTRY_FREE
+    uint32_t refs;             // 슬롯에 붙인 프로세스 수 (프로세스 안에서 여러 허브면 허브마다)
+    uint32_t slot;             // index 위치 (놓을 때 지울 칸)
+    uint32_t next_free;
+    uint64_t touch_ms;         // 등록 / 마지막 unref 시각 (CLOCK_MONOTONIC)
+} DevInternEntry;
+
+struct DevIntern {
+    size_t map_len;
+    DevInternHdr* hdr;
+    DevInternEntry* names;     // 핸들 h → names[h - 1]
+    _Atomic uint32_t* index;   // 0 = 빈 칸, 아니면 핸들
+    int full_warned;           // 꽉 참 경고는 프로세스마다 한 번
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static uint32_t _index_size(uint32_t capacity) {
+    uint32_t n = 1;
+    while (n < capacity * 2) n <<= 1;
+    return n;
+}
+
+static size_t _map_len(uint32_t capacity) {
+    return sizeof(DevInternHdr) + (size_t)capacity * sizeof(DevInternEntry) +
+           (size_t)_index_size(capacity) * sizeof(uint32_t);
+}
+
+static void _bind(DevIntern* d, void* p) {
+    d->hdr = (DevInternHdr*)p;
+    d->names = (DevInternEntry*)((unsigned char*)p + sizeof(DevInternHdr));
+    d->index = (_Atomic uint32_t*)((unsigned char*)d->names + (size_t)d->hdr->capacity * sizeof(DevInternEntry));
+}
+
+static int _init_lock(pthread_mutex_t* m) {
+    pthread_mutexattr_t a;
+    pthread_mutexattr_init(&a);
+    pthread_mutexattr_setpshared(&a, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&a, PTHREAD_MUTEX_ROBUST);
+    int rc = pthread_mutex_init(m, &a);
+    pthread_mutexattr_destroy(&a);
+    return rc;
+}
+
+static void _lock(DevInternHdr* h) {
+    // 등록하다 죽은 프로세스가 있으면 넘겨받음 (count는 마지막에 올리므로 반쯤 쓴 항목은 안 보임)
+    if (pthread_mutex_lock(&h->lock) == EOWNERDEAD) pthread_mutex_consistent(&h->lock);
+}
+
+static uint64_t _now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+// hash/id로 index 탐색, slot_out에 넣을 칸 (지나온 첫 삭제 표시, 없으면 멈춘 빈 칸)
+// index는 항상 절반 이상 빈 칸 (live <= capacity, tombs <= capacity/2, 크기 >= capacity*2) → 탐색이 끝남
+static DevHandle _probe(const DevIntern* d, const char* id, uint64_t hash, uint32_t* slot_out) {
+    uint32_t mask = d->hdr->index_mask;
+    uint32_t tomb = INDEX_TOMB;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask) {
+        DevHandle h = atomic_load_explicit(&d->index[i], memory_order_acquire);
+        if (h == DEV_HANDLE_NONE) {
+            if (slot_out) *slot_out = tomb != INDEX_TOMB ? tomb : i;
+            return DEV_HANDLE_NONE;
+        }
+        if (h == INDEX_TOMB) {
+            if (tomb == INDEX_TOMB) tomb = i;
+            continue;
+        }
+        const DevInternEntry* e = &d->names[h - 1];
+        if (e->hash == hash && strcmp(e->id, id) == 0) return h;
+    }
+}
+
+// 락 없는 조회: 재구성 중(홀수)이거나 도중에 바뀌었으면 다시
+// (놓인 핸들은 DEV_INTERN_REUSE_MS 뒤에야 이름이 바뀌므로 탐색 도중 이름이 바뀌는 경우는 없다고 봄)
+static DevHandle _lookup(const DevIntern* d, const char* id, uint64_t hash) {
+    for (;;) {
+        uint32_t seq = atomic_load_explicit(&d->hdr->index_seq, memory_order_acquire);
+        if (seq & 1u) {
+            sched_yield();
+            continue;
+        }
+        DevHandle h = _probe(d, id, hash, NULL);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&d->hdr->index_seq, memory_order_relaxed) == seq) return h;
+    }
+}
+
+// 삭제 표시가 많아지면 live 핸들만 다시 넣음 (lock 잡고 호출)
+static void _rebuild(DevIntern* d) {
+    DevInternHdr* hdr = d->hdr;
+    atomic_fetch_add_explicit(&hdr->index_seq, 1, memory_order_acq_rel);
+
+    uint32_t mask = hdr->index_mask;
+    for (uint32_t i = 0; i <= mask; i++) atomic_store_explicit(&d->index[i], DEV_HANDLE_NONE, memory_order_relaxed);
+    uint32_t n = atomic_load(&hdr->count);
+    for (uint32_t h = 1; h <= n; h++) {
+        DevInternEntry* e = &d->names[h - 1];
+        if (e->state != ENTRY_LIVE) continue;
+        uint32_t i = (uint32_t)e->hash & mask;
+        while (atomic_load_explicit(&d->index[i], memory_order_relaxed) != DEV_HANDLE_NONE) i = (i + 1) & mask;
+        e->slot = i;
+        atomic_store_explicit(&d->index[i], h, memory_order_relaxed);
+    }
+    hdr->tombs = 0;
+
+    atomic_fetch_add_explicit(&hdr->index_seq, 1, memory_order_acq_rel);
+}
+
+// live → free 줄 (lock 잡고 호출), touch_ms부터 DEV_INTERN_REUSE_MS 뒤에 재사용
+// front: 이미 재사용 가능한 핸들은 줄 앞에 (뒤에 두면 아직 이른 핸들에 막힘)
+static void _retire(DevIntern* d, DevHandle h, uint64_t touch_ms, int front) {
+    DevInternHdr* hdr = d->hdr;
+    DevInternEntry* e = &d->names[h - 1];
+
+    atomic_store_explicit(&d->index[e->slot], INDEX_TOMB, memory_order_release);
+    hdr->tombs++;
+    hdr->live--;
+    e->state = ENTRY_FREE;
+    e->refs = 0;
+    e->touch_ms = touch_ms;
+    if (front) {
+        e->next_free = hdr->free_head;
+        hdr->free_head = h;
+        if (!hdr->free_tail) hdr->free_tail = h;
+    } else {
+        e->next_free = 0;
+        if (hdr->free_tail) d->names[hdr->free_tail - 1].next_free = h;
+        else hdr->free_head = h;
+        hdr->free_tail = h;
+    }
+    hdr->n_free++;
+
+    if (hdr->tombs > hdr->capacity / 2) _rebuild(d);
+}
+
+// 재사용할 핸들 (맨 앞이 아직 이르면 0)
+static DevHandle _pop_free(DevIntern* d, uint64_t now) {
+    DevInternHdr* hdr = d->hdr;
+    DevHandle h = hdr->free_head;
+    if (!h || d->names[h - 1].touch_ms + DEV_INTERN_REUSE_MS > now) return DEV_HANDLE_NONE;
+
+    hdr->free_head = d->names[h - 1].next_free;
+    if (!hdr->free_head) hdr->free_tail = 0;
+    hdr->n_free--;
+    return h;
+}
+
+// 꽉 찼을 때만: 등록만 되고 아무도 안 잡은 채 오래된 핸들 (슬롯을 못 얻은 디바이스 등) 회수
+static void _sweep_unheld(DevIntern* d, uint64_t now) {
+    uint32_t n = atomic_load(&d->hdr->count);
+    for (uint32_t h = 1; h <= n; h++) {
+        DevInternEntry* e = &d->names[h - 1];
+        if (e->state == ENTRY_LIVE && e->refs == 0 && e->touch_ms + DEV_INTERN_REUSE_MS <= now) {
+            _retire(d, h, e->touch_ms, 1); // 이미 충분히 지났으니 바로 재사용 가능
+        }
+    }
+}
+
+// 63자로 자른 ID (WatchMsg 예전 deviceId와 같은 규칙)
+static const char* _clip(const char* id, char* tmp) {
+    size_t n = strnlen(id, DEV_INTERN_ID_LEN);
+    if (n < DEV_INTERN_ID_LEN) return id;
+    memcpy(tmp, id, DEV_INTERN_ID_LEN - 1);
+    tmp[DEV_INTERN_ID_LEN - 1] = '\0';
+    return tmp;
+}
+
+// ================================
+// 외부 API
+// ================================
+DevIntern* dev_intern_open(const char* shm_name, int capacity) {
+    if (!shm_name) shm_name = DEV_INTERN_SHM_NAME;
+    if (capacity <= 0) capacity = DEV_INTERN_DEFAULT_CAP;
+
+    DevIntern* d = (DevIntern*)calloc(1, sizeof(DevIntern));
+    if (!d) return NULL;
+
+    // 먼저 만드는 쪽이 크기 정하고 초기화, 나머지는 magic이 보일 때까지 기다렸다가 붙음
+    int created = 1;
+    int fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0 && errno == EEXIST) {
+        created = 0;
+        fd = shm_open(shm_name, O_RDWR, 0666);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "❌ [DEV_INTERN] shm_open %s failed: %s\n", shm_name, strerror(errno));
+        free(d);
+        return NULL;
+    }
+
+    if (created) {
+        d->map_len = _map_len((uint32_t)capacity);
+        if (ftruncate(fd, (off_t)d->map_len) != 0) {
+            perror("ftruncate dev_intern");
+            close(fd);
+            shm_unlink(shm_name);
+            free(d);
+            return NULL;
+        }
+    } else {
+        struct stat st;
+        int waited = 0;
+        while (fstat(fd, &st) == 0 && (size_t)st.st_size < sizeof(DevInternHdr) && waited < ATTACH_WAIT_MS) {
+            usleep(1000);
+            waited++;
+        }
+        if ((size_t)st.st_size < sizeof(DevInternHdr)) {
+            fprintf(stderr, "❌ [DEV_INTERN] %s not initialized\n", shm_name);
+            close(fd);
+            free(d);
+            return NULL;
+        }
+        d->map_len = (size_t)st.st_size;
+    }
+
+    void* p = mmap(NULL, d->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap dev_intern");
+        if (created) shm_unlink(shm_name);
+        free(d);
+        return NULL;
+    }
+    DevInternHdr* h = (DevInternHdr*)p;
+
+    if (created) {
+        // ftruncate로 0이 채워져 있음 → index는 전부 빈 칸
+        h->version = DEV_INTERN_VERSION;
+        h->capacity = (uint32_t)capacity;
+        h->index_mask = _index_size((uint32_t)capacity) - 1;
+        atomic_store(&h->count, 0);
+        _init_lock(&h->lock);
+        atomic_store_explicit(&h->magic, DEV_INTERN_MAGIC, memory_order_release);
+    } else {
+        int waited = 0;
+        while (atomic_load_explicit(&h->magic, memory_order_acquire) != DEV_INTERN_MAGIC &&
+               waited < ATTACH_WAIT_MS) {
+            usleep(1000);
+            waited++;
+        }
+        if (atomic_load(&h->magic) != DEV_INTERN_MAGIC || h->version != DEV_INTERN_VERSION ||
+            _map_len(h->capacity) > d->map_len) {
+            fprintf(stderr, "❌ [DEV_INTERN] %s: bad header (magic/version/size)\n", shm_name);
+            munmap(p, d->map_len);
+            free(d);
+            return NULL;
+        }
+    }
+
+    _bind(d, p);
+    return d;
+}
+
+void dev_intern_close(DevIntern* d) {
+    if (!d) return;
+    munmap(d->hdr, d->map_len);
+    free(d);
+}
+
+int dev_intern_unlink(const char* shm_name) {
+    if (!shm_name) shm_name = DEV_INTERN_SHM_NAME;
+    if (shm_unlink(shm_name) != 0 && errno != ENOENT) {
+        fprintf(stderr, "❌ [DEV_INTERN] shm_unlink %s failed: %s\n", shm_name, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+DevHandle dev_intern_find(const DevIntern* d, const char* id) {
+    if (!d || !id) return DEV_HANDLE_NONE;
+    char tmp[DEV_INTERN_ID_LEN];
+    id = _clip(id, tmp);
+    return _lookup(d, id, shard_hash(id, strlen(id)));
+}
+
+DevHandle dev_intern_get(DevIntern* d, const char* id) {
+    if (!d || !id) return DEV_HANDLE_NONE;
+    char tmp[DEV_INTERN_ID_LEN];
+    id = _clip(id, tmp);
+    uint64_t hash = shard_hash(id, strlen(id));
+
+    // 이미 있으면 락 없이 끝 (대부분 여기)
+    DevHandle h = _lookup(d, id, hash);
+    if (h != DEV_HANDLE_NONE) return h;
+
+    DevInternHdr* hdr = d->hdr;
+    _lock(hdr);
+
+    uint32_t slot;
+    h = _probe(d, id, hash, &slot); // 그 사이에 다른 쪽이 등록했을 수 있음
+    if (h == DEV_HANDLE_NONE) {
+        // 새 핸들 먼저, 다 썼으면 놓인 지 오래된 핸들
+        uint64_t now = _now_ms();
+        uint32_t n = atomic_load(&hdr->count);
+        int fresh = n < hdr->capacity;
+        if (fresh) {
+            h = n + 1;
+        } else {
+            h = _pop_free(d, now);
+            if (h == DEV_HANDLE_NONE) {
+                uint32_t seq = atomic_load(&hdr->index_seq);
+                _sweep_unheld(d, now);
+                h = _pop_free(d, now);
+                if (atomic_load(&hdr->index_seq) != seq) _probe(d, id, hash, &slot); // 재구성됐으면 넣을 칸 다시
+            }
+        }
+
+        if (h != DEV_HANDLE_NONE) {
+            DevInternEntry* e = &d->names[h - 1];
+            e->hash = hash;
+            snprintf(e->id, sizeof(e->id), "%s", id);
+            e->state = ENTRY_LIVE;
+            e->refs = 0;
+            e->slot = slot;
+            e->next_free = 0;
+            e->touch_ms = now;
+            if (atomic_load_explicit(&d->index[slot], memory_order_relaxed) == INDEX_TOMB) hdr->tombs--;
+            hdr->live++;
+            // 항목을 다 쓴 뒤에 index에 publish (락 없는 reader가 반쯤 쓴 이름을 안 보게)
+            atomic_store_explicit(&d->index[slot], h, memory_order_release);
+            if (fresh) atomic_store_explicit(&hdr->count, h, memory_order_release);
+            else hdr->reused++;
+        } else {
+            hdr->full++;
+            if (!d->full_warned) {
+                fprintf(stderr, "⚠️ [DEV_INTERN] full (%u live, %u waiting reuse) → new deviceId not registered (%s)\n",
+                        hdr->live, hdr->n_free, id);
+                d->full_warned = 1;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&hdr->lock);
+    return h;
+}
+
+int dev_intern_ref(DevIntern* d, DevHandle h) {
+    if (!d || h == DEV_HANDLE_NONE || h > atomic_load(&d->hdr->count)) return -1;
+
+    DevInternHdr* hdr = d->hdr;
+    _lock(hdr);
+    DevInternEntry* e = &d->names[h - 1];
+    int rc = -1;
+    if (e->state == ENTRY_LIVE) { // get 이후 그 사이에 놓였으면 -1 (이름으로 다시 get하면 새 핸들)
+        e->refs++;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&hdr->lock);
+    return rc;
+}
+
+void dev_intern_unref(DevIntern* d, DevHandle h) {
+    if (!d || h == DEV_HANDLE_NONE || h > atomic_load(&d->hdr->count)) return;
+
+    DevInternHdr* hdr = d->hdr;
+    _lock(hdr);
+    DevInternEntry* e = &d->names[h - 1];
+    if (e->state == ENTRY_LIVE && e->refs > 0 && --e->refs == 0) _retire(d, h, _now_ms(), 0);
+    pthread_mutex_unlock(&hdr->lock);
+}
+
+int dev_intern_bind_spec(DevIntern* d, uint64_t spec_hash) {
+    if (!d || spec_hash == 0) return -1;
+
+    DevInternHdr* hdr = d->hdr;
+    _lock(hdr);
+    if (hdr->spec_hash == 0) hdr->spec_hash = spec_hash;
+    uint64_t have = hdr->spec_hash;
+    pthread_mutex_unlock(&hdr->lock);
+
+    if (have != spec_hash) {
+        fprintf(stderr, "❌ [DEV_INTERN] channel spec mismatch (shm %016llx, mine %016llx) → same channels on watch/hub, "
+                        "or stop all modules and reset (mq_tool clean)\n",
+                (unsigned long long)have, (unsigned long long)spec_hash);
+        return -1;
+    }
+    return 0;
+}
+
+const char* dev_intern_name(const DevIntern* d, DevHandle h) {
+    if (!d || h == DEV_HANDLE_NONE) return NULL;
+    if (h > atomic_load_explicit(&d->hdr->count, memory_order_acquire)) return NULL;
+    return d->names[h - 1].id;
+}
+
+int dev_intern_count(const DevIntern* d) {
+    if (!d) return 0;
+    _lock(d->hdr);
+    int n = (int)d->hdr->live;
+    pthread_mutex_unlock(&d->hdr->lock);
+    return n;
+}
+
+int dev_intern_capacity(const DevIntern* d) {
+    return d ? (int)d->hdr->capacity : 0;
+}
+
+void dev_intern_stats(const DevIntern* d, DevInternStats* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!d) return;
+
+    DevInternHdr* hdr = d->hdr;
+    _lock(hdr);
+    out->capacity = (int)hdr->capacity;
+    out->issued = (int)atomic_load(&hdr->count);
+    out->live = (int)hdr->live;
+    out->free = (int)hdr->n_free;
+    out->tombs = (int)hdr->tombs;
+    out->reused = hdr->reused;
+    out->full = hdr->full;
+    pthread_mutex_unlock(&hdr->lock);
+}
@@ -0,0 +1,76 @@
+#ifndef DEV_INTERN_H
+#define DEV_INTERN_H
+
+/*
+deviceId 문자열 → 32bit 핸들 (워치 모듈 / 허브 공용, POSIX shm으로 프로세스끼리 공유)
+- 핸들은 1부터 촘촘하게 (0 = 없음)
+- 회수: 디바이스 슬롯을 잡는 쪽(워치 모듈 / 허브)이 ref, 슬롯을 놓을 때 unref
+  참조가 0이 되면 index에서 빠지고 free 줄로 → DEV_INTERN_REUSE_MS 지난 뒤에만 새 deviceId에 재사용
+  (MQ에 남아 있던 옛 핸들 레코드가 다른 디바이스로 붙지 않게), 새 핸들을 다 쓴 뒤에만 재사용
+- 잡고 있는 동안 핸들 ↔ 이름은 안 바뀜 (name 포인터도 unref 전까지 유효)
+- MQ 레코드(WatchMsg)는 문자열 대신 핸들, 캐시는 핸들 → 슬롯 배열로 O(1)
+  문자열은 경계에서만: 워치 JSON 파싱(get) / SENSOR 라인·로그·상태 파일(name)
+- 조회(find/name)는 락 없음 (index 재구성 중이면 seq 보고 다시), 등록(get) / ref / unref만 프로세스 공유 mutex
+- shm 레이아웃 = [헤더][이름 capacity개][hash index (2의 거듭제곱, capacity*2 이상)]
+  먼저 만든 쪽의 capacity를 따름, 잡혀 있는 핸들이 capacity개면 get이 0
+- ref를 잡은 채 죽은 프로세스의 핸들은 회수 안 됨 → 모듈을 다 내리고 dev_intern_unlink (mq_tool clean)
+- 채널 spec hash도 헤더에 (먼저 건 쪽 기준, 다르면 bind_spec 실패 → 워치 모듈 / 허브가 시작 안 함)
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEV_INTERN_SHM_NAME    "/dev_intern"
+#define DEV_INTERN_DEFAULT_CAP 65536
+#define DEV_INTERN_ID_LEN      64    // WatchMsg 예전 deviceId 크기와 같음
+#define DEV_HANDLE_NONE        0u
+#ifndef DEV_INTERN_REUSE_MS
+#define DEV_INTERN_REUSE_MS    60000 // 놓은 핸들을 다른 deviceId에 다시 주기까지 (MQ / FIFO에 남은 레코드 수명보다 길게)
+#endif
+
+typedef uint32_t DevHandle;
+
+typedef struct DevIntern DevIntern;
+
+typedef struct {
+    int capacity;
+    int issued;     // 지금까지 만든 핸들 (= 가장 큰 핸들)
+    int live;       // index에 있는 핸들 (잡힌 것 + 등록만 되고 아직 안 잡힌 것)
+    int free;       // 놓여서 재사용 기다리는 핸들
+    int tombs;      // index 삭제 표시 (많아지면 재구성)
+    uint64_t reused;
+    uint64_t full;  // 꽉 차서 get이 0을 준 횟수
+} DevInternStats;
+
+// shm_name NULL이면 DEV_INTERN_SHM_NAME, capacity <= 0 이면 기본값 (이미 있으면 무시)
+DevIntern* dev_intern_open(const char* shm_name, int capacity);
+void dev_intern_close(DevIntern* d); // unmap만 (shm은 남음)
+int  dev_intern_unlink(const char* shm_name); // 초기화: shm 삭제 (NULL이면 기본 이름, 붙어 있는 프로세스가 없을 때)
+
+// 없으면 등록 (꽉 찼거나 실패하면 DEV_HANDLE_NONE), 63자 넘는 ID는 잘라서 씀
+DevHandle dev_intern_get(DevIntern* d, const char* id);
+DevHandle dev_intern_find(const DevIntern* d, const char* id); // 등록 안 됐으면 DEV_HANDLE_NONE
+
+// 슬롯에 핸들을 붙일 때 ref, 슬롯을 놓을 때 unref (return: 0 성공, -1 이미 놓인 핸들 → 다시 get)
+int  dev_intern_ref(DevIntern* d, DevHandle h);
+void dev_intern_unref(DevIntern* d, DevHandle h);
+
+// 채널 spec hash (chan_reg_spec_hash) 확인: 처음이면 걸어두고 0, 이미 다른 값이면 -1
+// (spec을 바꾸려면 모듈을 다 내리고 dev_intern_unlink)
+int dev_intern_bind_spec(DevIntern* d, uint64_t spec_hash);
+
+// 핸들 → 문자열 (shm 안, close 전까지 유효), 모르는 핸들이면 NULL
+const char* dev_intern_name(const DevIntern* d, DevHandle h);
+
+int dev_intern_count(const DevIntern* d);    // live 핸들 수
+int dev_intern_capacity(const DevIntern* d); // 핸들 최대값 (핸들 → 슬롯 배열 크기 - 1)
+void dev_intern_stats(const DevIntern* d, DevInternStats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,146 @@
+#include "flow_ctl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char* g_level_names[FLOW_LEVELS] = { "NORMAL", "COALESCE", "SAMPLE", "DROP_LOW" };
+
+// ================================
+// 내부 유틸
+// ================================
+static void _set_level(FlowStage* s, int to, uint64_t now_ms, const char* why) {
+    int from = atomic_load_explicit(&s->level, memory_order_relaxed);
+    if (to == from) return;
+
+    atomic_store_explicit(&s->level, to, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->level_changes, 1, memory_order_relaxed);
+    s->changed_ms = now_ms;
+
+    int cap = atomic_load_explicit(&s->capacity, memory_order_relaxed);
+    int depth = atomic_load_explicit(&s->depth, memory_order_relaxed);
+    printf("🚦 [FLOW][%s] %s → %s (%s, depth %d/%d lag %lld ms)\n", s->name,
+           g_level_names[from], g_level_names[to], why, depth, cap,
+           (long long)atomic_load_explicit(&s->lag_ms, memory_order_relaxed));
+}
+
+// ================================
+// 외부 API
+// ================================
+void flow_config_default(FlowConfig* c) {
+    if (!c) return;
+    c->high_pct = 75;
+    c->low_pct = 25;
+    c->lag_high_ms = 0;
+    c->hold_ms = 1000;
+    c->sample_keep = 4;
+}
+
+void flow_stage_init(FlowStage* s, const char* name, const FlowConfig* cfg) {
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    snprintf(s->name, sizeof(s->name), "%s", name ? name : "stage");
+
+    flow_config_default(&s->cfg);
+    if (cfg) {
+        if (cfg->high_pct > 0) s->cfg.high_pct = cfg->high_pct;
+        if (cfg->low_pct > 0) s->cfg.low_pct = cfg->low_pct;
+        if (cfg->lag_high_ms > 0) s->cfg.lag_high_ms = cfg->lag_high_ms;
+        if (cfg->hold_ms > 0) s->cfg.hold_ms = cfg->hold_ms;
+        if (cfg->sample_keep > 0) s->cfg.sample_keep = cfg->sample_keep;
+    }
+    if (s->cfg.low_pct >= s->cfg.high_pct) s->cfg.low_pct = s->cfg.high_pct / 2;
+
+    atomic_init(&s->level, FLOW_NORMAL);
+}
+
+FlowLevel flow_stage_update(FlowStage* s, int depth, int capacity, int64_t lag_ms, uint64_t now_ms) {
+    if (!s) return FLOW_NORMAL;
+
+    atomic_store_explicit(&s->depth, depth, memory_order_relaxed);
+    atomic_store_explicit(&s->capacity, capacity, memory_order_relaxed);
+    atomic_store_explicit(&s->lag_ms, (long long)lag_ms, memory_order_relaxed);
+
+    int level = atomic_load_explicit(&s->level, memory_order_relaxed);
+    int pct = capacity > 0 ? (int)((int64_t)depth * 100 / capacity) : 0;
+    int lag_hot = s->cfg.lag_high_ms > 0 && lag_ms >= s->cfg.lag_high_ms;
+    int lag_ok = s->cfg.lag_high_ms <= 0 || lag_ms < s->cfg.lag_high_ms / 2;
+
+    // 한 번에 한 단계씩, 바꾼 뒤 hold_ms 동안은 유지 (출렁임 방지)
+    if (now_ms - s->changed_ms < (uint64_t)s->cfg.hold_ms && s->changed_ms != 0) return (FlowLevel)level;
+
+    if ((pct >= s->cfg.high_pct || lag_hot) && level < FLOW_DROP_LOW) {
+        _set_level(s, level + 1, now_ms, lag_hot ? "lag" : "depth");
+    } else if (pct <= s->cfg.low_pct && lag_ok && level > FLOW_NORMAL) {
+        _set_level(s, level - 1, now_ms, "recovered");
+    }
+    return flow_stage_level(s);
+}
+
+void flow_stage_on_full(FlowStage* s, uint64_t now_ms) {
+    if (!s) return;
+    int level = atomic_load_explicit(&s->level, memory_order_relaxed);
+    int cap = atomic_load_explicit(&s->capacity, memory_order_relaxed);
+    atomic_store_explicit(&s->depth, cap, memory_order_relaxed);
+
+    if (level < FLOW_DROP_LOW &&
+        (s->changed_ms == 0 || now_ms - s->changed_ms >= (uint64_t)s->cfg.hold_ms)) {
+        _set_level(s, level + 1, now_ms, "full");
+    }
+}
+
+int flow_stage_admit(FlowStage* s, FlowPrio prio) {
+    if (!s) return 1;
+    int level = atomic_load_explicit(&s->level, memory_order_relaxed);
+
+    if (prio == FLOW_PRIO_HIGH || level <= FLOW_COALESCE) {
+        atomic_fetch_add_explicit(&s->passed, 1, memory_order_relaxed);
+        return 1;
+    }
+    if (level == FLOW_DROP_LOW && prio == FLOW_PRIO_LOW) {
+        atomic_fetch_add_explicit(&s->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+    if ((s->sample_seq++ % (uint64_t)s->cfg.sample_keep) != 0) {
+        atomic_fetch_add_explicit(&s->sampled_out, 1, memory_order_relaxed);
+        return 0;
+    }
+    atomic_fetch_add_explicit(&s->passed, 1, memory_order_relaxed);
+    return 1;
+}
+
+void flow_stage_count_coalesced(FlowStage* s) {
+    if (s) atomic_fetch_add_explicit(&s->coalesced, 1, memory_order_relaxed);
+}
+
+void flow_stage_count_dropped(FlowStage* s, uint64_t n) {
+    if (s) atomic_fetch_add_explicit(&s->dropped, n, memory_order_relaxed);
+}
+
+void flow_stage_snapshot(const FlowStage* s, FlowSnapshot* out) {
+    if (!s || !out) return;
+    out->name = s->name;
+    out->level = flow_stage_level(s);
+    out->depth = atomic_load_explicit(&s->depth, memory_order_relaxed);
+    out->capacity = atomic_load_explicit(&s->capacity, memory_order_relaxed);
+    out->lag_ms = atomic_load_explicit(&s->lag_ms, memory_order_relaxed);
+    out->passed = atomic_load_explicit(&s->passed, memory_order_relaxed);
+    out->coalesced = atomic_load_explicit(&s->coalesced, memory_order_relaxed);
+    out->sampled_out = atomic_load_explicit(&s->sampled_out, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&s->dropped, memory_order_relaxed);
+    out->level_changes = atomic_load_explicit(&s->level_changes, memory_order_relaxed);
+}
+
+void flow_stage_print(const FlowStage* s) {
+    FlowSnapshot f;
+    if (!s) return;
+    flow_stage_snapshot(s, &f);
+    printf("📊 [FLOW][%s] level=%s depth=%d/%d lag=%lldms passed=%llu coalesced=%llu sampled_out=%llu dropped=%llu changes=%llu\n",
+           f.name, flow_level_name(f.level), f.depth, f.capacity, (long long)f.lag_ms,
+           (unsigned long long)f.passed, (unsigned long long)f.coalesced,
+           (unsigned long long)f.sampled_out, (unsigned long long)f.dropped,
+           (unsigned long long)f.level_changes);
+}
+
+const char* flow_level_name(FlowLevel l) {
+    return (l >= 0 && l < FLOW_LEVELS) ? g_level_names[l] : "?";
+}
@@ -0,0 +1,101 @@
+#ifndef FLOW_CTL_H
+#define FLOW_CTL_H
+
+/*
+흐름 제어 (워치 모듈 / 허브 공용)
+- 단계(stage)마다 큐 깊이/용량/lag를 주기적으로 publish → 과부하 단계(level) 결정
+- 과부하가 커지면 정해진 순서로 한 단계씩 degrade, 줄어들면 한 단계씩 복구 (hysteresis + 최소 유지 시간)
+    NORMAL   : 전부 통과
+    COALESCE : 같은 key(디바이스)는 최신 것 하나로 합침 (합치는 방법은 호출하는 쪽이 앎)
+    SAMPLE   : HIGH 빼고 sample_keep개 중 1개만 통과
+    DROP_LOW : LOW는 버리고, NORMAL은 샘플링, HIGH만 전부 통과
+- 하류가 느리면 그 앞 큐가 차고 → 상류 stage가 그 깊이를 보고 degrade (rulebase → 허브 → 워치 모듈)
+- update는 stage 주인 스레드 하나만, level/통계 읽기는 아무 스레드나 (atomic)
+*/
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FLOW_NORMAL = 0,
+    FLOW_COALESCE,
+    FLOW_SAMPLE,
+    FLOW_DROP_LOW,
+    FLOW_LEVELS
+} FlowLevel;
+
+typedef enum {
+    FLOW_PRIO_LOW = 0,   // 값이 안 바뀐 갱신 등 (없어져도 다음 것이 대신함)
+    FLOW_PRIO_NORMAL,
+    FLOW_PRIO_HIGH       // 새 디바이스 등 (항상 통과)
+} FlowPrio;
+
+typedef struct {
+    int high_pct;        // 깊이가 용량의 이 % 이상이면 한 단계 올림 (기본 75)
+    int low_pct;         // 이 % 이하 + lag도 정상이면 한 단계 내림 (기본 25)
+    int lag_high_ms;     // lag가 이 값 이상이어도 올림 (0이면 lag 안 봄)
+    int hold_ms;         // 단계 바꾼 뒤 최소 유지 시간 (기본 1000)
+    int sample_keep;     // SAMPLE/DROP_LOW에서 N개 중 1개 통과 (기본 4)
+} FlowConfig;
+
+typedef struct {
+    char name[24];
+    FlowConfig cfg;
+
+    atomic_int level;
+    atomic_int depth;
+    atomic_int capacity;
+    atomic_llong lag_ms;
+
+    uint64_t changed_ms;   // 마지막 단계 변경 시각 (주인 스레드만)
+    uint64_t sample_seq;
+
+    // 통계
+    atomic_ullong passed;
+    atomic_ullong coalesced;
+    atomic_ullong sampled_out;
+    atomic_ullong dropped;       // DROP_LOW로 버림 + 하류가 꽉 차서 버림
+    atomic_ullong level_changes;
+} FlowStage;
+
+typedef struct {
+    const char* name;
+    FlowLevel level;
+    int depth;
+    int capacity;
+    int64_t lag_ms;
+    uint64_t passed, coalesced, sampled_out, dropped, level_changes;
+} FlowSnapshot;
+
+void flow_config_default(FlowConfig* c);
+void flow_stage_init(FlowStage* s, const char* name, const FlowConfig* cfg); // cfg NULL이면 기본값
+
+// 깊이/lag publish + 단계 재계산 (return: 새 단계)
+FlowLevel flow_stage_update(FlowStage* s, int depth, int capacity, int64_t lag_ms, uint64_t now_ms);
+
+// 하류가 꽉 차서 못 보냈을 때 (깊이 측정 주기를 기다리지 않고 바로 한 단계 올림)
+void flow_stage_on_full(FlowStage* s, uint64_t now_ms);
+
+static inline FlowLevel flow_stage_level(const FlowStage* s) {
+    return (FlowLevel)atomic_load_explicit(&s->level, memory_order_relaxed);
+}
+
+// 아이템 하나 통과 여부 (1 통과, 0 버림 → 통계에 반영). COALESCE는 호출하는 쪽이 처리 후 flow_stage_count_coalesced
+int  flow_stage_admit(FlowStage* s, FlowPrio prio);
+void flow_stage_count_coalesced(FlowStage* s);
+void flow_stage_count_dropped(FlowStage* s, uint64_t n);
+
+void flow_stage_snapshot(const FlowStage* s, FlowSnapshot* out);
+void flow_stage_print(const FlowStage* s);
+
+const char* flow_level_name(FlowLevel l);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
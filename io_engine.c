@@ -0,0 +1,761 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "io_engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifndef IO_ENGINE_NO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+typedef enum { SRC_UDP = 1, SRC_LINES } SrcKind;
+
+typedef struct {
+    int used;
+    int removing;          // URING: cancel 보냈고 남은 완료 기다리는 중 (끝나면 해제)
+    int fd;
+    SrcKind kind;
+    void* ctx;
+    IoDgramCb on_dgram;
+    IoLineCb on_line;
+    IoEofCb on_eof;
+    int inflight;          // URING: 커널에 걸려 있는 요청 수
+
+    // UDP: 슬롯 nslots개 (슬롯마다 데이터그램 1개)
+    int nslots;
+    size_t slot_sz;
+    unsigned char* slot_buf;
+    struct sockaddr_in* addr;
+    struct iovec* iov;
+    struct mmsghdr* mm;    // EPOLL: recvmmsg, URING: mm[i].msg_hdr을 RECVMSG에 사용
+    IoDatagram* dg;
+    int ndone;             // URING: 이번 run_once에서 완료된 슬롯 (dg에 모임)
+    int* done_slot;
+
+    // 라인: '\n' 나올 때까지 모으는 버퍼 (rcap + 1, 끝에 '\0' 자리)
+    char* rbuf;
+    size_t rcap;
+    size_t rlen;
+    int eof;
+} IoSource;
+
+#ifndef IO_ENGINE_NO_URING
+typedef struct {
+    int fd;
+    unsigned entries;
+    void* sq_ptr;
+    size_t sq_sz;
+    void* cq_ptr;
+    size_t cq_sz;
+    struct io_uring_sqe* sqes;
+    size_t sqes_sz;
+
+    _Atomic unsigned* sq_head;
+    _Atomic unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    _Atomic unsigned* cq_head;
+    _Atomic unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    unsigned tail;          // 다음 SQE 위치 (우리만 씀)
+    unsigned to_submit;     // 아직 io_uring_enter 안 한 SQE 수
+} Uring;
+#endif
+
+struct IoEngine {
+    IoBackend backend;
+    int batch;
+    int epfd;
+#ifndef IO_ENGINE_NO_URING
+    Uring ring;
+#endif
+    IoSource src[IO_ENGINE_MAX_SOURCES];
+    IoEngineStats st;
+
+    int wake_fd;            // -1 없음
+    int woken;
+};
+
+// epoll data / io_uring user_data에서 wakeup fd 표시
+#define WAKE_IDX IO_ENGINE_MAX_SOURCES
+#define UD_WAKE  (~0ULL)
+
+// user_data: [상위 32bit: 소스 번호+1][하위 32bit: 슬롯], cancel 요청은 0
+#define UD_MAKE(si, slot) (((uint64_t)((si) + 1) << 32) | (uint32_t)(slot))
+#define UD_SRC(ud)        ((int)((ud) >> 32) - 1)
+#define UD_SLOT(ud)       ((int)((ud) & 0xffffffffu))
+
+// ================================
+// 내부 유틸 (공용)
+// ================================
+static void _src_free(IoSource* s) {
+    free(s->slot_buf);
+    free(s->addr);
+    free(s->iov);
+    free(s->mm);
+    free(s->dg);
+    free(s->done_slot);
+    free(s->rbuf);
+    memset(s, 0, sizeof(*s));
+}
+
+static IoSource* _src_alloc(IoEngine* e, int fd, int* idx) {
+    for (int i = 0; i < IO_ENGINE_MAX_SOURCES; i++) {
+        if (e->src[i].used && !e->src[i].removing && e->src[i].fd == fd) return NULL; // 중복 등록
+    }
+    for (int i = 0; i < IO_ENGINE_MAX_SOURCES; i++) {
+        if (!e->src[i].used) {
+            *idx = i;
+            return &e->src[i];
+        }
+    }
+    return NULL;
+}
+
+static int _src_find(IoEngine* e, int fd) {
+    for (int i = 0; i < IO_ENGINE_MAX_SOURCES; i++) {
+        if (e->src[i].used && !e->src[i].removing && e->src[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+// 읽은 n바이트를 붙이고 완성된 줄마다 콜백
+static void _lines_feed(IoEngine* e, IoSource* s, size_t n) {
+    size_t scan = s->rlen;
+    s->rlen += n;
+
+    size_t start = 0;
+    for (size_t i = scan; i < s->rlen; i++) {
+        if (s->rbuf[i] != '\n') continue;
+        char save = s->rbuf[i + 1];
+        s->rbuf[i + 1] = '\0';
+        s->on_line(s->ctx, s->rbuf + start, i + 1 - start);
+        s->rbuf[i + 1] = save;
+        start = i + 1;
+        e->st.lines++;
+    }
+
+    if (start == 0 && s->rlen == s->rcap) {
+        // '\n' 없이 버퍼가 참: fgets처럼 잘라서 넘김
+        s->rbuf[s->rlen] = '\0';
+        s->on_line(s->ctx, s->rbuf, s->rlen);
+        e->st.lines++;
+        s->rlen = 0;
+    } else if (start > 0) {
+        memmove(s->rbuf, s->rbuf + start, s->rlen - start);
+        s->rlen -= start;
+    }
+}
+
+// writer가 닫힘: '\n' 없이 남은 마지막 줄도 넘기고 (fgets와 같게) eof 콜백
+static void _lines_eof(IoEngine* e, IoSource* s) {
+    s->eof = 1;
+    if (s->rlen > 0) {
+        s->rbuf[s->rlen] = '\0';
+        s->on_line(s->ctx, s->rbuf, s->rlen);
+        e->st.lines++;
+        s->rlen = 0;
+    }
+    if (s->on_eof) s->on_eof(s->ctx, s->fd);
+}
+
+static void _udp_deliver(IoEngine* e, IoSource* s, int n) {
+    if (n <= 0) return;
+    e->st.datagrams += (uint64_t)n;
+    if (n > e->st.max_batch) e->st.max_batch = n;
+    s->on_dgram(s->ctx, s->dg, n);
+}
+
+// ================================
+// 내부: epoll 백엔드
+// ================================
+static int _epoll_add(IoEngine* e, int idx) {
+    IoSource* s = &e->src[idx];
+
+    // 한 번에 다 읽고 EAGAIN에서 멈추도록 non-blocking
+    int fl = fcntl(s->fd, F_GETFL);
+    if (fl >= 0) fcntl(s->fd, F_SETFL, fl | O_NONBLOCK);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)idx;
+    if (epoll_ctl(e->epfd, EPOLL_CTL_ADD, s->fd, &ev) != 0) {
+        perror("epoll_ctl(ADD)");
+        return -1;
+    }
+    return 0;
+}
+
+static int _epoll_udp(IoEngine* e, IoSource* s) {
+    int total = 0;
+    for (;;) {
+        for (int i = 0; i < s->nslots; i++) s->mm[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+
+        int r = recvmmsg(s->fd, s->mm, (unsigned)s->nslots, MSG_DONTWAIT, NULL);
+        e->st.syscalls++;
+        if (r <= 0) break;
+
+        for (int i = 0; i < r; i++) {
+            s->dg[i].data = s->slot_buf + (size_t)i * s->slot_sz;
+            s->dg[i].len = s->mm[i].msg_len;
+            s->dg[i].data[s->dg[i].len] = '\0';
+            s->dg[i].from = s->addr[i];
+        }
+        e->st.completions += (uint64_t)r;
+        total += r;
+        _udp_deliver(e, s, r);
+        if (r < s->nslots) break; // 다 비웠음
+    }
+    return total;
+}
+
+static int _epoll_lines(IoEngine* e, IoSource* s) {
+    int total = 0;
+    while (!s->eof) {
+        ssize_t r = read(s->fd, s->rbuf + s->rlen, s->rcap - s->rlen);
+        e->st.syscalls++;
+        if (r > 0) {
+            e->st.completions++;
+            total++;
+            _lines_feed(e, s, (size_t)r);
+            continue;
+        }
+        if (r == 0) {
+            _lines_eof(e, s);
+            total++;
+        }
+        break; // EAGAIN 등
+    }
+    return total;
+}
+
+static int _epoll_run(IoEngine* e, int timeout_ms) {
+    struct epoll_event ev[IO_ENGINE_MAX_SOURCES];
+    int n = epoll_wait(e->epfd, ev, IO_ENGINE_MAX_SOURCES, timeout_ms);
+    e->st.waits++;
+    e->st.syscalls++;
+    if (n < 0) return -1;
+
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        if (ev[i].data.u32 == WAKE_IDX) {
+            e->woken = 1; // 안 읽음 (level-triggered라 계속 readable)
+            continue;
+        }
+        IoSource* s = &e->src[ev[i].data.u32];
+        if (!s->used) continue;
+        if (s->kind == SRC_UDP) total += _epoll_udp(e, s);
+        else total += _epoll_lines(e, s);
+    }
+    return total;
+}
+
+// ================================
+// 내부: io_uring 백엔드 (liburing 없이)
+// ================================
+#ifndef IO_ENGINE_NO_URING
+static void _uring_close(Uring* r) {
+    if (r->sqes) munmap(r->sqes, r->sqes_sz);
+    if (r->cq_ptr && r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_sz);
+    if (r->sq_ptr) munmap(r->sq_ptr, r->sq_sz);
+    if (r->fd >= 0) close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+static int _uring_open(Uring* r, unsigned entries) {
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (fd < 0) return -1;
+    r->fd = fd;
+
+    // 대기 timeout을 io_uring_enter 인자로 넘기려면 EXT_ARG 필요 (5.11+)
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        _uring_close(r);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    r->entries = p.sq_entries;
+    r->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_sz > r->sq_sz) r->sq_sz = r->cq_sz;
+        r->cq_sz = r->sq_sz;
+    }
+
+    r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) {
+        r->sq_ptr = NULL;
+        _uring_close(r);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) {
+            r->cq_ptr = NULL;
+            _uring_close(r);
+            return -1;
+        }
+    }
+    r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = (struct io_uring_sqe*)mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                         fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        r->sqes = NULL;
+        _uring_close(r);
+        return -1;
+    }
+
+    unsigned char* sq = (unsigned char*)r->sq_ptr;
+    unsigned char* cq = (unsigned char*)r->cq_ptr;
+    r->sq_head = (_Atomic unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (_Atomic unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->cq_head = (_Atomic unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (_Atomic unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+    return 0;
+}
+
+// 빈 SQE 하나 (링이 꽉 찼으면 NULL → 호출하는 쪽이 먼저 제출)
+static struct io_uring_sqe* _uring_sqe(Uring* r) {
+    unsigned head = atomic_load_explicit(r->sq_head, memory_order_acquire);
+    if (r->tail - head >= r->entries) return NULL;
+
+    unsigned idx = r->tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    r->tail++;
+    r->to_submit++;
+    atomic_store_explicit(r->sq_tail, r->tail, memory_order_release);
+    return sqe;
+}
+
+// 쌓인 SQE 제출 + (wait면) 완료 1개 이상 또는 timeout까지 대기
+static int _uring_enter(IoEngine* e, int wait, int timeout_ms) {
+    Uring* r = &e->ring;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+
+    unsigned flags = wait ? (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG) : 0;
+    int rc = (int)syscall(__NR_io_uring_enter, r->fd, r->to_submit, wait ? 1u : 0u, flags,
+                          wait ? (void*)&arg : NULL, wait ? sizeof(arg) : 0);
+    e->st.syscalls++;
+    if (wait) e->st.waits++;
+
+    // 제출된 만큼은 timeout/시그널이어도 커널이 가져감
+    unsigned head = atomic_load_explicit(r->sq_head, memory_order_acquire);
+    r->to_submit = r->tail - head;
+    return rc;
+}
+
+static int _uring_arm_udp(IoEngine* e, int si, int slot) {
+    IoSource* s = &e->src[si];
+    struct io_uring_sqe* sqe = _uring_sqe(&e->ring);
+    if (!sqe) {
+        _uring_enter(e, 0, 0);
+        sqe = _uring_sqe(&e->ring);
+        if (!sqe) return -1;
+    }
+
+    struct msghdr* mh = &s->mm[slot].msg_hdr;
+    mh->msg_namelen = sizeof(struct sockaddr_in);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = s->fd;
+    sqe->addr = (uint64_t)(uintptr_t)mh;
+    sqe->len = 1;
+    sqe->user_data = UD_MAKE(si, slot);
+    s->inflight++;
+    return 0;
+}
+
+static int _uring_arm_read(IoEngine* e, int si) {
+    IoSource* s = &e->src[si];
+    struct io_uring_sqe* sqe = _uring_sqe(&e->ring);
+    if (!sqe) {
+        _uring_enter(e, 0, 0);
+        sqe = _uring_sqe(&e->ring);
+        if (!sqe) return -1;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = s->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(s->rbuf + s->rlen);
+    sqe->len = (uint32_t)(s->rcap - s->rlen);
+    sqe->off = (uint64_t)-1; // pipe: 현재 위치
+    sqe->user_data = UD_MAKE(si, 0);
+    s->inflight++;
+    return 0;
+}
+
+static void _uring_cancel(IoEngine* e, int si) {
+    IoSource* s = &e->src[si];
+    for (int slot = 0; slot < (s->kind == SRC_UDP ? s->nslots : 1); slot++) {
+        struct io_uring_sqe* sqe = _uring_sqe(&e->ring);
+        if (!sqe) {
+            _uring_enter(e, 0, 0);
+            sqe = _uring_sqe(&e->ring);
+            if (!sqe) return;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = UD_MAKE(si, slot);
+        sqe->user_data = 0;
+    }
+    _uring_enter(e, 0, 0);
+}
+
+// 다시 걸어봐야 계속 실패하는 오류 (fd가 잘못됨 등)
+static int _uring_fatal(int res) {
+    return res == -EBADF || res == -ENOTSOCK || res == -EINVAL || res == -EFAULT ||
+           res == -ECANCELED || res == -EOPNOTSUPP;
+}
+
+static int _uring_run(IoEngine* e, int timeout_ms) {
+    Uring* r = &e->ring;
+
+    // 지난 완료의 재요청 + 새 소스 요청을 여기서 한 번에 제출
+    int rc = _uring_enter(e, 1, timeout_ms);
+    int intr = (rc < 0 && errno == EINTR);
+    if (rc < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) return -1;
+
+    int total = 0;
+    unsigned head = atomic_load_explicit(r->cq_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(r->cq_tail, memory_order_acquire);
+
+    for (; head != tail; head++) {
+        struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+        if (cqe->user_data == 0) continue; // cancel 요청 자체의 완료
+        if (cqe->user_data == UD_WAKE) {
+            e->woken = 1; // 1회성 poll, 다시 안 걸음
+            continue;
+        }
+
+        int si = UD_SRC(cqe->user_data);
+        int slot = UD_SLOT(cqe->user_data);
+        if (si < 0 || si >= IO_ENGINE_MAX_SOURCES) continue;
+        IoSource* s = &e->src[si];
+        if (!s->used) continue;
+        s->inflight--;
+
+        if (s->removing) {
+            if (s->inflight == 0) _src_free(s);
+            continue;
+        }
+
+        int res = cqe->res;
+        if (s->kind == SRC_UDP) {
+            if (res >= 0) {
+                IoDatagram* d = &s->dg[s->ndone];
+                d->data = s->slot_buf + (size_t)slot * s->slot_sz;
+                d->len = (size_t)res;
+                d->data[res] = '\0';
+                d->from = s->addr[slot];
+                e->st.completions++;
+            }
+            if (res < 0 && _uring_fatal(res)) {
+                fprintf(stderr, "❌ [IO] recvmsg fd=%d: %s (slot %d stopped)\n", s->fd, strerror(-res), slot);
+                continue;
+            }
+            s->done_slot[s->ndone++] = res >= 0 ? slot : -1 - slot; // 일시적 실패는 다시 걸기
+        } else if (res > 0) {
+            e->st.completions++;
+            total++;
+            _lines_feed(e, s, (size_t)res);
+            _uring_arm_read(e, si);
+        } else if (res == 0) {
+            _lines_eof(e, s);
+            total++;
+        } else if (!_uring_fatal(res)) {
+            _uring_arm_read(e, si); // -EAGAIN / -EINTR
+        } else {
+            fprintf(stderr, "❌ [IO] read fd=%d: %s\n", s->fd, strerror(-res));
+        }
+    }
+    atomic_store_explicit(r->cq_head, head, memory_order_release);
+
+    // UDP: 완료된 것 모아서 콜백 1번 → 슬롯 다시 걸기 (제출은 다음 run_once의 enter에서 같이)
+    for (int si = 0; si < IO_ENGINE_MAX_SOURCES; si++) {
+        IoSource* s = &e->src[si];
+        if (!s->used || s->kind != SRC_UDP || s->ndone == 0) continue;
+
+        int ok = 0;
+        for (int i = 0; i < s->ndone; i++) {
+            if (s->done_slot[i] >= 0) s->dg[ok++] = s->dg[i];
+        }
+        total += ok;
+        _udp_deliver(e, s, ok);
+
+        for (int i = 0; i < s->ndone; i++) {
+            int slot = s->done_slot[i] >= 0 ? s->done_slot[i] : -1 - s->done_slot[i];
+            _uring_arm_udp(e, si, slot);
+        }
+        s->ndone = 0;
+    }
+
+    if (total == 0 && intr) {
+        errno = EINTR;
+        return -1;
+    }
+    return total;
+}
+#endif
+
+// ================================
+// 외부 API
+// ================================
+IoEngine* io_engine_create(IoBackend want, int batch) {
+    IoEngine* e = (IoEngine*)calloc(1, sizeof(IoEngine));
+    if (!e) return NULL;
+    e->batch = batch > 0 ? batch : IO_ENGINE_DEFAULT_BATCH;
+    e->epfd = -1;
+    e->wake_fd = -1;
+
+#ifndef IO_ENGINE_NO_URING
+    e->ring.fd = -1;
+    if (want != IO_BACKEND_EPOLL) {
+        // 소스 전부가 슬롯을 다 걸어도 + cancel 여유
+        unsigned entries = (unsigned)(e->batch * IO_ENGINE_MAX_SOURCES * 2);
+        if (_uring_open(&e->ring, entries) == 0) {
+            e->backend = IO_BACKEND_URING;
+            return e;
+        }
+        if (want == IO_BACKEND_URING) {
+            fprintf(stderr, "⚠️ [IO] io_uring unavailable (%s) → epoll\n", strerror(errno));
+        }
+    }
+#else
+    if (want == IO_BACKEND_URING) fprintf(stderr, "⚠️ [IO] built without io_uring → epoll\n");
+#endif
+
+    e->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (e->epfd < 0) {
+        perror("epoll_create1");
+        free(e);
+        return NULL;
+    }
+    e->backend = IO_BACKEND_EPOLL;
+    return e;
+}
+
+void io_engine_destroy(IoEngine* e) {
+    if (!e) return;
+#ifndef IO_ENGINE_NO_URING
+    // ring fd를 닫으면 걸려 있던 요청은 커널이 전부 취소 (버퍼는 그 뒤에 해제)
+    if (e->ring.fd >= 0) _uring_close(&e->ring);
+#endif
+    if (e->epfd >= 0) close(e->epfd);
+    for (int i = 0; i < IO_ENGINE_MAX_SOURCES; i++) {
+        if (e->src[i].used) _src_free(&e->src[i]);
+    }
+    free(e);
+}
+
+IoBackend io_engine_backend(const IoEngine* e) {
+    return e ? e->backend : IO_BACKEND_AUTO;
+}
+
+const char* io_engine_backend_name(const IoEngine* e) {
+    if (!e) return "?";
+    return e->backend == IO_BACKEND_URING ? "io_uring" : "epoll";
+}
+
+int io_engine_add_udp(IoEngine* e, int fd, size_t max_dgram, IoDgramCb cb, void* ctx) {
+    if (!e || fd < 0 || !cb || max_dgram == 0) return -1;
+
+    int idx = -1;
+    IoSource* s = _src_alloc(e, fd, &idx);
+    if (!s) return -1;
+
+    s->used = 1;
+    s->fd = fd;
+    s->kind = SRC_UDP;
+    s->ctx = ctx;
+    s->on_dgram = cb;
+    s->nslots = e->batch;
+    s->slot_sz = max_dgram + 1; // 끝에 '\0'
+
+    s->slot_buf = (unsigned char*)malloc(s->slot_sz * (size_t)s->nslots);
+    s->addr = (struct sockaddr_in*)calloc((size_t)s->nslots, sizeof(struct sockaddr_in));
+    s->iov = (struct iovec*)calloc((size_t)s->nslots, sizeof(struct iovec));
+    s->mm = (struct mmsghdr*)calloc((size_t)s->nslots, sizeof(struct mmsghdr));
+    s->dg = (IoDatagram*)calloc((size_t)s->nslots, sizeof(IoDatagram));
+    s->done_slot = (int*)calloc((size_t)s->nslots, sizeof(int));
+    if (!s->slot_buf || !s->addr || !s->iov || !s->mm || !s->dg || !s->done_slot) {
+        _src_free(s);
+        return -1;
+    }
+
+    for (int i = 0; i < s->nslots; i++) {
+        s->iov[i].iov_base = s->slot_buf + (size_t)i * s->slot_sz;
+        s->iov[i].iov_len = max_dgram;
+        s->mm[i].msg_hdr.msg_name = &s->addr[i];
+        s->mm[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        s->mm[i].msg_hdr.msg_iov = &s->iov[i];
+        s->mm[i].msg_hdr.msg_iovlen = 1;
+    }
+
+#ifndef IO_ENGINE_NO_URING
+    if (e->backend == IO_BACKEND_URING) {
+        for (int i = 0; i < s->nslots; i++) _uring_arm_udp(e, idx, i);
+        return 0;
+    }
+#endif
+    if (_epoll_add(e, idx) != 0) {
+        _src_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+int io_engine_add_lines(IoEngine* e, int fd, size_t max_line, IoLineCb cb, IoEofCb eof, void* ctx) {
+    if (!e || fd < 0 || !cb || max_line < 2) return -1;
+
+    int idx = -1;
+    IoSource* s = _src_alloc(e, fd, &idx);
+    if (!s) return -1;
+
+    s->used = 1;
+    s->fd = fd;
+    s->kind = SRC_LINES;
+    s->ctx = ctx;
+    s->on_line = cb;
+    s->on_eof = eof;
+    s->rcap = max_line - 1;
+    s->rbuf = (char*)malloc(max_line);
+    if (!s->rbuf) {
+        _src_free(s);
+        return -1;
+    }
+
+#ifndef IO_ENGINE_NO_URING
+    if (e->backend == IO_BACKEND_URING) {
+        if (_uring_arm_read(e, idx) != 0) {
+            _src_free(s);
+            return -1;
+        }
+        return 0;
+    }
+#endif
+    if (_epoll_add(e, idx) != 0) {
+        _src_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+int io_engine_remove(IoEngine* e, int fd) {
+    if (!e) return -1;
+    int idx = _src_find(e, fd);
+    if (idx < 0) return -1;
+    IoSource* s = &e->src[idx];
+
+#ifndef IO_ENGINE_NO_URING
+    if (e->backend == IO_BACKEND_URING) {
+        // 걸려 있는 요청은 취소 보내고, 완료가 다 돌아오면 run_once에서 해제
+        if (s->inflight > 0) {
+            s->removing = 1;
+            _uring_cancel(e, idx);
+            return 0;
+        }
+        _src_free(s);
+        return 0;
+    }
+#endif
+    epoll_ctl(e->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    _src_free(s);
+    return 0;
+}
+
+int io_engine_set_wakeup(IoEngine* e, int fd) {
+    if (!e || fd < 0 || e->wake_fd >= 0) return -1;
+    e->wake_fd = fd;
+    e->woken = 0;
+
+#ifndef IO_ENGINE_NO_URING
+    if (e->backend == IO_BACKEND_URING) {
+        struct io_uring_sqe* sqe = _uring_sqe(&e->ring);
+        if (!sqe) {
+            _uring_enter(e, 0, 0);
+            sqe = _uring_sqe(&e->ring);
+            if (!sqe) return -1;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = UD_WAKE;
+        return 0;
+    }
+#endif
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = WAKE_IDX;
+    if (epoll_ctl(e->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("epoll_ctl(ADD wakeup)");
+        e->wake_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int io_engine_woken(const IoEngine* e) {
+    return e ? e->woken : 0;
+}
+
+int io_engine_run_once(IoEngine* e, int timeout_ms) {
+    if (!e) return -1;
+#ifndef IO_ENGINE_NO_URING
+    if (e->backend == IO_BACKEND_URING) return _uring_run(e, timeout_ms);
+#endif
+    return _epoll_run(e, timeout_ms);
+}
+
+void io_engine_get_stats(const IoEngine* e, IoEngineStats* out) {
+    if (!e || !out) return;
+    *out = e->st;
+}
+
+void io_engine_print_stats(const IoEngine* e, const char* tag) {
+    if (!e) return;
+    const IoEngineStats* s = &e->st;
+    double per = s->completions ? (double)s->syscalls / (double)s->completions : 0.0;
+    printf("📊 %s io=%s waits=%llu syscalls=%llu completions=%llu (%.2f syscall/op) dgrams=%llu lines=%llu max_batch=%d\n",
+           tag ? tag : "[IO]", io_engine_backend_name(e),
+           (unsigned long long)s->waits, (unsigned long long)s->syscalls,
+           (unsigned long long)s->completions, per,
+           (unsigned long long)s->datagrams, (unsigned long long)s->lines, s->max_batch);
+}
@@ -0,0 +1,85 @@
+#ifndef IO_ENGINE_H
+#define IO_ENGINE_H
+
+/*
+I/O 엔진 (워치 모듈 UDP 수신 / 허브 FIFO 라인 리더 공용)
+- 스레드 하나가 엔진 하나를 소유, fd 여러 개를 한 루프에서 처리
+- 백엔드
+    URING : io_uring (liburing 없이 syscall 직접), UDP는 recv 슬롯 batch개를 미리 걸어두고
+            완료된 것 모아서 콜백 1번 + 다시 걸기는 다음 io_uring_enter 1번에 같이 제출
+    EPOLL : epoll_wait + recvmmsg(batch개) / read, io_uring이 없거나 막혀 있으면 자동으로 이걸로
+- UDP: 데이터그램 여러 개를 한 번에 콜백 (IoDatagram 배열), AF_UNIX SOCK_DGRAM fd도 같은 방식 (from은 의미 없음)
+- 라인: FIFO에서 읽은 바이트를 '\n' 단위로 잘라서 콜백 (fgets처럼 '\n' 포함, '\0'으로 끝남)
+       writer가 닫으면 eof 콜백 (다시 여는 건 호출하는 쪽)
+- wakeup fd (허브 정지 eventfd 등): readable이 되면 run_once가 timeout 전에 돌아옴 (엔진은 읽지 않음)
+- FIFO 쓰기는 허브가 tick마다 한 번에 모아서 non-blocking write (collector_hub out_flush) → 엔진에 안 넣음
+- -DIO_ENGINE_NO_URING 이면 io_uring 코드 빼고 빌드
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IO_ENGINE_DEFAULT_BATCH 16
+#define IO_ENGINE_MAX_SOURCES   8
+
+typedef enum {
+    IO_BACKEND_AUTO = 0,  // io_uring 되면 io_uring, 아니면 epoll
+    IO_BACKEND_EPOLL,
+    IO_BACKEND_URING
+} IoBackend;
+
+typedef struct {
+    unsigned char* data;      // 엔진 버퍼 (콜백 안에서만 유효, data[len] = '\0')
+    size_t len;
+    struct sockaddr_in from;
+} IoDatagram;
+
+typedef void (*IoDgramCb)(void* ctx, IoDatagram* dg, int n);
+typedef void (*IoLineCb)(void* ctx, char* line, size_t len);
+typedef void (*IoEofCb)(void* ctx, int fd);
+
+typedef struct {
+    uint64_t waits;        // epoll_wait / io_uring_enter 횟수
+    uint64_t syscalls;     // 전체 I/O syscall 수 (wait 포함)
+    uint64_t completions;  // 처리한 recv/read 완료 수
+    uint64_t datagrams;
+    uint64_t lines;
+    int max_batch;         // 콜백 1번에 넘긴 최대 데이터그램 수
+} IoEngineStats;
+
+typedef struct IoEngine IoEngine;
+
+// batch: UDP 소스 하나에 걸어둘 recv 슬롯 수 (<= 0 이면 기본값)
+// return: NULL 실패, want가 URING인데 안 되면 EPOLL로 만들어짐 (io_engine_backend로 확인)
+IoEngine* io_engine_create(IoBackend want, int batch);
+void io_engine_destroy(IoEngine* e);
+
+IoBackend io_engine_backend(const IoEngine* e);
+const char* io_engine_backend_name(const IoEngine* e);
+
+// 소스 등록 (0 성공, -1 실패). fd는 호출하는 쪽 소유 (remove 후 close)
+int io_engine_add_udp(IoEngine* e, int fd, size_t max_dgram, IoDgramCb cb, void* ctx);
+int io_engine_add_lines(IoEngine* e, int fd, size_t max_line, IoLineCb cb, IoEofCb eof, void* ctx);
+int io_engine_remove(IoEngine* e, int fd);
+
+// fd가 readable이면 run_once를 바로 깨움 (엔진당 1개, fd는 호출하는 쪽 소유, 0 성공 / -1 실패)
+int io_engine_set_wakeup(IoEngine* e, int fd);
+int io_engine_woken(const IoEngine* e);      // wakeup fd가 readable인 걸 봤는지
+
+// 한 번 대기 + 완료된 것 콜백
+// return: 처리한 완료 수 (0이면 timeout), -1 오류 (시그널이면 errno == EINTR)
+int io_engine_run_once(IoEngine* e, int timeout_ms);
+
+void io_engine_get_stats(const IoEngine* e, IoEngineStats* out);
+void io_engine_print_stats(const IoEngine* e, const char* tag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+#include "mem_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifndef MEM_POOL_NO_CJSON
+#include <cjson/cJSON.h>
+#endif
+
+#define ARENA_ALIGN 16
+
+// cJSON 훅 할당마다 앞에 붙는 헤더 (free할 때 arena/heap 구분)
+#define HOOK_MAGIC_ARENA 0xA7E4A7E4u
+#define HOOK_MAGIC_HEAP  0x4EA94EA9u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t _pad[3];   // 16바이트 → 뒤에 오는 메모리 정렬 유지
+} HookHdr;
+
+static __thread MemArena* t_arena = NULL;
+
+// ================================
+// 할당 카운터 (MEM_POOL_DEBUG)
+// ================================
+static atomic_uint_fast64_t g_mallocs = 0;
+static atomic_uint_fast64_t g_warm_mark = 0;
+
+#ifdef MEM_POOL_DEBUG
+// glibc malloc 가로채서 횟수만 셈
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t n) {
+    atomic_fetch_add_explicit(&g_mallocs, 1, memory_order_relaxed);
+    return __libc_malloc(n);
+}
+
+void* calloc(size_t n, size_t sz) {
+    atomic_fetch_add_explicit(&g_mallocs, 1, memory_order_relaxed);
+    return __libc_calloc(n, sz);
+}
+
+void* realloc(void* p, size_t n) {
+    atomic_fetch_add_explicit(&g_mallocs, 1, memory_order_relaxed);
+    return __libc_realloc(p, n);
+}
+#endif
+
+uint64_t mem_pool_malloc_count(void) {
+    return (uint64_t)atomic_load(&g_mallocs);
+}
+
+void mem_pool_mark_warm(void) {
+    atomic_store(&g_warm_mark, atomic_load(&g_mallocs));
+}
+
+uint64_t mem_pool_mallocs_since_warm(void) {
+    return (uint64_t)(atomic_load(&g_mallocs) - atomic_load(&g_warm_mark));
+}
+
+// ================================
+// arena
+// ================================
+int mem_arena_init(MemArena* a, size_t cap) {
+    if (!a || cap == 0) return -1;
+    memset(a, 0, sizeof(*a));
+    a->base = (unsigned char*)malloc(cap);
+    if (!a->base) return -1;
+    a->cap = cap;
+    return 0;
+}
+
+void mem_arena_destroy(MemArena* a) {
+    if (!a) return;
+    if (t_arena == a) t_arena = NULL;
+    free(a->base);
+    memset(a, 0, sizeof(*a));
+}
+
+void* mem_arena_alloc(MemArena* a, size_t n) {
+    if (!a || !a->base) return NULL;
+
+    size_t off = (a->used + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+    if (off > a->cap || n > a->cap - off) return NULL;
+
+    a->used = off + n;
+    if (a->used > a->high_water) a->high_water = a->used;
+    return a->base + off;
+}
+
+void mem_arena_reset(MemArena* a) {
+    if (a) a->used = 0;
+}
+
+#ifndef MEM_POOL_NO_CJSON
+// ================================
+// cJSON 훅
+// ================================
+static void* _hook_malloc(size_t n) {
+    MemArena* a = t_arena;
+    HookHdr* h = NULL;
+
+    if (a) {
+        h = (HookHdr*)mem_arena_alloc(a, sizeof(HookHdr) + n);
+        if (h) {
+            h->magic = HOOK_MAGIC_ARENA;
+            return h + 1;
+        }
+        a->overflow++;
+    }
+
+    h = (HookHdr*)malloc(sizeof(HookHdr) + n);
+    if (!h) return NULL;
+    h->magic = HOOK_MAGIC_HEAP;
+    return h + 1;
+}
+
+static void _hook_free(void* p) {
+    if (!p) return;
+    HookHdr* h = (HookHdr*)p - 1;
+    if (h->magic == HOOK_MAGIC_HEAP) {
+        h->magic = 0;
+        free(h);
+    }
+    // arena 메모리는 reset 때 한꺼번에
+}
+
+static pthread_once_t g_hooks_once = PTHREAD_ONCE_INIT;
+
+static void _install_hooks(void) {
+    cJSON_Hooks hooks;
+    hooks.malloc_fn = _hook_malloc;
+    hooks.free_fn = _hook_free;
+    cJSON_InitHooks(&hooks);
+}
+
+void mem_pool_install_cjson_hooks(void) {
+    pthread_once(&g_hooks_once, _install_hooks);
+}
+#endif
+
+void mem_arena_bind(MemArena* a) {
+    t_arena = a;
+}
+
+MemArena* mem_arena_bound(void) {
+    return t_arena;
+}
+
+// ================================
+// slab
+// ================================
+int mem_slab_init(MemSlab* s, size_t obj_size, int count) {
+    if (!s || obj_size == 0 || count <= 0) return -1;
+    memset(s, 0, sizeof(*s));
+
+    s->obj_size = (obj_size + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+    s->count = count;
+    s->mem = (unsigned char*)calloc((size_t)count, s->obj_size);
+    s->free_stack = (int*)malloc((size_t)count * sizeof(int));
+    if (!s->mem || !s->free_stack) {
+        mem_slab_destroy(s);
+        return -1;
+    }
+
+    // 낮은 번호부터 나가도록 역순으로 쌓음
+    for (int i = 0; i < count; i++) s->free_stack[i] = count - 1 - i;
+    s->free_top = count;
+    return 0;
+}
+
+void mem_slab_destroy(MemSlab* s) {
+    if (!s) return;
+    free(s->mem);
+    free(s->free_stack);
+    memset(s, 0, sizeof(*s));
+}
+
+void* mem_slab_alloc(MemSlab* s) {
+    if (!s || s->free_top == 0) {
+        if (s) s->alloc_fail++;
+        return NULL;
+    }
+    int i = s->free_stack[--s->free_top];
+    return s->mem + (size_t)i * s->obj_size;
+}
+
+void mem_slab_free(MemSlab* s, void* p) {
+    if (!s || !p) return;
+
+    size_t off = (size_t)((unsigned char*)p - s->mem);
+    if ((unsigned char*)p < s->mem || off % s->obj_size != 0 || off / s->obj_size >= (size_t)s->count) {
+        fprintf(stderr, "❌ [MEM] slab free of foreign pointer %p\n", p);
+        return;
+    }
+    s->free_stack[s->free_top++] = (int)(off / s->obj_size);
+}
+
+int mem_slab_in_use(const MemSlab* s) {
+    return s ? s->count - s->free_top : 0;
+}
@@ -0,0 +1,78 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+/*
+메모리 풀 (워치 모듈 / 허브 공용)
+- MemArena: bump 할당 + 한 번에 reset (메시지/tick 단위 임시 메모리)
+  용량이 모자라면 heap으로 넘어가고 overflow 카운트 (high_water 보고 크기 조정)
+- cJSON 훅: mem_pool_install_cjson_hooks() 한 번 호출하면
+  mem_arena_bind()로 arena를 건 스레드의 cJSON 할당은 그 arena에서, 안 건 스레드는 heap에서
+  arena에서 나온 메모리의 cJSON_Delete/cJSON_free는 아무것도 안 함 → 메시지/tick 끝에 mem_arena_reset
+- MemSlab: 고정 크기 객체 풀 (시작할 때 count개 미리 할당, 이후 malloc 없음)
+  MQ 배치 메시지 버퍼 (mq_batch), RESULT 라인 버퍼 (hub_result)
+- cJSON 없이 쓰는 곳 (TH 모듈)은 -DMEM_POOL_NO_CJSON → 훅 함수 없이 arena / slab만
+- MemArena / MemSlab 자체는 스레드 안전하지 않음 (스레드마다 따로 두거나 호출하는 쪽에서 락)
+- MEM_POOL_DEBUG로 빌드하면 프로세스 전체 malloc/calloc/realloc 호출 수를 셈 (glibc)
+  mem_pool_mark_warm() 이후 카운트가 0이면 steady-state에서 malloc 없음
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================
+// arena
+// ============================
+typedef struct {
+    unsigned char* base;
+    size_t cap;
+    size_t used;
+    size_t high_water;   // reset 사이 최대 사용량
+    uint64_t overflow;   // 용량 초과로 heap에서 할당한 횟수
+} MemArena;
+
+int   mem_arena_init(MemArena* a, size_t cap);   // 0 성공, -1 실패
+void  mem_arena_destroy(MemArena* a);
+void* mem_arena_alloc(MemArena* a, size_t n);    // 16바이트 정렬, 모자라면 NULL
+void  mem_arena_reset(MemArena* a);
+
+// ============================
+// cJSON 훅 (스레드별 arena)
+// ============================
+void mem_pool_install_cjson_hooks(void);         // 여러 번 불러도 한 번만 설치 (cJSON 쓰는 스레드 만들기 전에)
+void mem_arena_bind(MemArena* a);                // 호출한 스레드의 cJSON 할당 대상 (NULL이면 heap)
+MemArena* mem_arena_bound(void);
+
+// ============================
+// slab (고정 크기 객체)
+// ============================
+typedef struct {
+    size_t obj_size;
+    int count;
+    unsigned char* mem;
+    int* free_stack;     // 비어있는 객체 번호
+    int free_top;
+    uint64_t alloc_fail; // 다 써서 NULL 돌려준 횟수
+} MemSlab;
+
+int   mem_slab_init(MemSlab* s, size_t obj_size, int count); // 0 성공, -1 실패
+void  mem_slab_destroy(MemSlab* s);
+void* mem_slab_alloc(MemSlab* s);                           // 다 썼으면 NULL
+void  mem_slab_free(MemSlab* s, void* p);
+int   mem_slab_in_use(const MemSlab* s);
+
+// ============================
+// 할당 카운터 (MEM_POOL_DEBUG 빌드에서만 셈, 아니면 0)
+// ============================
+uint64_t mem_pool_malloc_count(void);
+void     mem_pool_mark_warm(void);               // 지금까지 카운트를 기준점으로
+uint64_t mem_pool_mallocs_since_warm(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,279 @@
+#include "mq_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+uint64_t mq_batch_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000ULL);
+}
+
+int mq_batch_init(MQBatcher* b, mqd_t q, size_t rec_size, int max_records, int flush_ms) {
+    if (!b || q == (mqd_t)-1 || rec_size == 0 || rec_size > UINT16_MAX) return -1;
+
+    memset(b, 0, sizeof(*b));
+    b->q = q;
+    b->rec_size = rec_size;
+    b->flush_ms = (flush_ms >= 0 ? flush_ms : MQ_BATCH_DEFAULT_MS);
+
+    // 큐 msgsize 기준으로 한 메시지에 들어가는 레코드 수 결정
+    struct mq_attr attr;
+    if (mq_getattr(q, &attr) == -1) {
+        perror("mq_getattr");
+        return -1;
+    }
+    if ((size_t)attr.mq_msgsize < rec_size) {
+        fprintf(stderr, "❌ MQ msgsize(%ld) < record size(%zu)\n", attr.mq_msgsize, rec_size);
+        return -1;
+    }
+
+    int fit = 0;
+    if ((size_t)attr.mq_msgsize >= MQ_BATCH_MSGSIZE(rec_size, 1)) {
+        fit = (int)(((size_t)attr.mq_msgsize - sizeof(MQBatchHdr)) / rec_size);
+    }
+    if (max_records > 0 && max_records < fit) fit = max_records;
+    b->max_records = fit; // 0이면 예전 크기의 큐 → 1개씩 전송
+
+    // 쌓는 중 1개 + 대기 줄 MQ_BATCH_PENDING개
+    if (b->max_records > 0) {
+        if (mem_slab_init(&b->pool, MQ_BATCH_MSGSIZE(rec_size, b->max_records), MQ_BATCH_PENDING + 1) != 0) return -1;
+        b->buf = (unsigned char*)mem_slab_alloc(&b->pool);
+    }
+    return 0;
+}
+
+void mq_batch_set_sent_cb(MQBatcher* b, MQBatchSentCb cb, void* ctx) {
+    if (!b) return;
+    b->on_sent = cb;
+    b->on_sent_ctx = ctx;
+}
+
+static int _retry_ms(const MQBatcher* b) {
+    return (b->flush_ms > 0 && b->flush_ms < MQ_BATCH_RETRY_MS) ? b->flush_ms : MQ_BATCH_RETRY_MS;
+}
+
+static void _seal(MQBatcher* b) {
+    MQBatchHdr* hdr = (MQBatchHdr*)b->buf;
+    hdr->magic = MQ_BATCH_MAGIC;
+    hdr->rec_size = (uint16_t)b->rec_size;
+    hdr->count = (uint32_t)b->count;
+}
+
+// 메시지 1개 전송, return: 0 보냄, 1 큐 꽉 참(EAGAIN, 그대로 들고 있어야 함), -1 다른 오류(버림)
+static int _send_msg(MQBatcher* b, const unsigned char* msg) {
+    MQBatchHdr hdr;
+    memcpy(&hdr, msg, sizeof(hdr));
+    int n = (int)hdr.count;
+
+    if (mq_send(b->q, (const char*)msg, MQ_BATCH_MSGSIZE(b->rec_size, n), 0) == -1) {
+        b->send_fail++;
+        // 소비자가 느려서 큐가 참 (O_NONBLOCK): 잠시 뒤 다시 (흐름 제어가 degrade)
+        if (errno == EAGAIN) {
+            b->send_full++;
+            return 1;
+        }
+        // 다시 보내도 안 될 오류 → 버림 (on_sent가 안 불렸으니 호출하는 쪽은 안 보낸 것으로 앎)
+        perror("⚠️ mq_send(batch) failed");
+        b->dropped += (uint64_t)n;
+        return -1;
+    }
+    b->sent_msgs++;
+    b->sent_records += (uint64_t)n;
+    if (b->on_sent) b->on_sent(b->on_sent_ctx, msg + sizeof(MQBatchHdr), n);
+    return 0;
+}
+
+// 대기 줄을 앞에서부터 보냄 (EAGAIN이면 거기서 멈춤), return: 남은 메시지 수
+static int _drain_pending(MQBatcher* b) {
+    while (b->pend_n > 0) {
+        unsigned char* m = b->pend[b->pend_head];
+        if (_send_msg(b, m) == 1) {
+            b->retry_ms = mq_batch_now_ms() + (uint64_t)_retry_ms(b);
+            return b->pend_n;
+        }
+        mem_slab_free(&b->pool, m);
+        b->pend_head = (b->pend_head + 1) % MQ_BATCH_PENDING;
+        b->pend_n--;
+    }
+    b->retry_ms = 0;
+    return 0;
+}
+
+// 쌓는 중인 배치를 대기 줄 뒤에 세우고 새 버퍼로 (버퍼가 없으면 그대로 들고 재시도 시각에 다시)
+static void _park(MQBatcher* b) {
+    if (!b->retry_ms) b->retry_ms = mq_batch_now_ms() + (uint64_t)_retry_ms(b);
+
+    unsigned char* nb = b->pend_n < MQ_BATCH_PENDING ? (unsigned char*)mem_slab_alloc(&b->pool) : NULL;
+    if (!nb) {
+        b->deadline_ms = b->retry_ms;
+        return;
+    }
+    _seal(b);
+    b->pend[(b->pend_head + b->pend_n) % MQ_BATCH_PENDING] = b->buf;
+    b->pend_n++;
+    b->buf = nb;
+    b->count = 0;
+    b->deadline_ms = 0;
+}
+
+int mq_batch_flush(MQBatcher* b) {
+    if (!b || b->max_records == 0) return 0;
+
+    // 순서 유지: 대기 줄이 남아 있으면 지금 배치는 그 뒤로
+    if (b->pend_n > 0 && _drain_pending(b) > 0) {
+        if (b->count > 0) _park(b);
+        return -1;
+    }
+    if (b->count == 0) return 0;
+
+    _seal(b);
+    int rc = _send_msg(b, b->buf);
+    if (rc == 1) {
+        _park(b);
+        return -1;
+    }
+    b->count = 0;
+    b->deadline_ms = 0;
+    return rc;
+}
+
+int mq_batch_push(MQBatcher* b, const void* rec) {
+    if (!b || !rec) return -1;
+
+    // 예전 크기의 큐: 헤더 없이 바로 전송 (들고 있을 배치가 없어서 못 보내면 버림)
+    if (b->max_records == 0) {
+        if (mq_send(b->q, (const char*)rec, b->rec_size, 0) == -1) {
+            b->send_fail++;
+            if (errno == EAGAIN) b->send_full++;
+            else perror("⚠️ mq_send failed");
+            b->rejected++;
+            return -1;
+        }
+        b->sent_msgs++;
+        b->sent_records++;
+        if (b->on_sent) b->on_sent(b->on_sent_ctx, (const unsigned char*)rec, 1);
+        return 0;
+    }
+
+    // 버퍼가 다 찬 채로 못 보내고 있으면 재시도 시각이 됐을 때만 다시 (syscall 폭주 방지), 안 되면 이 레코드는 안 받음
+    if (b->count >= b->max_records) {
+        mq_batch_poll(b);
+        if (b->count >= b->max_records) {
+            b->rejected++;
+            return -1;
+        }
+    }
+
+    if (b->count == 0) {
+        b->deadline_ms = mq_batch_now_ms() + (uint64_t)b->flush_ms;
+    }
+
+    memcpy(b->buf + sizeof(MQBatchHdr) + b->rec_size * (size_t)b->count, rec, b->rec_size);
+    b->count++;
+
+    // 대기 줄이 있으면 (flush_ms == 0이어도) 재시도 시각까지 쌓기만
+    if (b->count >= b->max_records || (b->flush_ms == 0 && b->pend_n == 0)) {
+        // EAGAIN이면 대기 줄에 남아서 재시도 (레코드는 받은 것), 다른 오류로 버렸으면 -1
+        uint64_t dropped = b->dropped;
+        mq_batch_flush(b);
+        return b->dropped == dropped ? 0 : -1;
+    }
+    return 0;
+}
+
+int mq_batch_find(const MQBatcher* b, size_t key_off, const void* key, size_t key_len) {
+    if (!b || !key || key_off + key_len > b->rec_size) return -1;
+
+    // 배치는 수십 개 수준이라 선형 탐색
+    const unsigned char* p = b->buf + sizeof(MQBatchHdr) + key_off;
+    for (int i = 0; i < b->count; i++, p += b->rec_size) {
+        if (memcmp(p, key, key_len) == 0) return i;
+    }
+    return -1;
+}
+
+int mq_batch_replace(MQBatcher* b, int idx, const void* rec) {
+    if (!b || !rec || idx < 0 || idx >= b->count) return -1;
+    memcpy(b->buf + sizeof(MQBatchHdr) + b->rec_size * (size_t)idx, rec, b->rec_size);
+    return 0;
+}
+
+int mq_batch_depth(const MQBatcher* b, int* capacity) {
+    if (!b) return -1;
+
+    struct mq_attr attr;
+    if (mq_getattr(b->q, &attr) == -1) return -1;
+    if (capacity) *capacity = (int)attr.mq_maxmsg;
+    return (int)attr.mq_curmsgs;
+}
+
+int mq_batch_poll(MQBatcher* b) {
+    if (!b || b->max_records == 0) return 0;
+
+    uint64_t now = mq_batch_now_ms();
+    int rc = 0;
+    if (b->pend_n > 0 && now >= b->retry_ms && _drain_pending(b) > 0) rc = -1;
+    if (b->count > 0 && now >= b->deadline_ms && mq_batch_flush(b) != 0) rc = -1;
+    return rc;
+}
+
+int mq_batch_timeout_ms(const MQBatcher* b) {
+    if (!b) return -1;
+
+    uint64_t at = 0;
+    if (b->count > 0) at = b->deadline_ms;
+    if (b->pend_n > 0 && (at == 0 || b->retry_ms < at)) at = b->retry_ms;
+    if (at == 0) return -1;
+
+    uint64_t now = mq_batch_now_ms();
+    if (now >= at) return 0;
+    return (int)(at - now);
+}
+
+int mq_batch_pending(const MQBatcher* b) {
+    if (!b) return 0;
+    int n = b->count;
+    for (int i = 0; i < b->pend_n; i++) {
+        MQBatchHdr hdr;
+        memcpy(&hdr, b->pend[(b->pend_head + i) % MQ_BATCH_PENDING], sizeof(hdr));
+        n += (int)hdr.count;
+    }
+    return n;
+}
+
+void mq_batch_destroy(MQBatcher* b) {
+    if (!b) return;
+    mq_batch_flush(b);
+
+    int left = mq_batch_pending(b);
+    if (left > 0) fprintf(stderr, "⚠️ mq_batch: %d record(s) not sent at close (queue full)\n", left);
+    mem_slab_destroy(&b->pool); // 대기 줄 버퍼도 전부 여기서
+    b->buf = NULL;
+    b->count = 0;
+    b->pend_n = 0;
+    b->max_records = 0;
+}
+
+int mq_batch_unpack(const void* msg, size_t len, size_t rec_size, const unsigned char** first) {
+    if (!msg || !first || rec_size == 0) return -1;
+
+    // 예전 방식: 헤더 없는 레코드 1개
+    if (len == rec_size) {
+        *first = (const unsigned char*)msg;
+        return 1;
+    }
+
+    if (len < MQ_BATCH_MSGSIZE(rec_size, 1)) return -1;
+
+    MQBatchHdr hdr;
+    memcpy(&hdr, msg, sizeof(hdr));
+    if (hdr.magic != MQ_BATCH_MAGIC || hdr.rec_size != rec_size) return -1;
+    if (hdr.count == 0 || len != MQ_BATCH_MSGSIZE(rec_size, hdr.count)) return -1;
+
+    *first = (const unsigned char*)msg + sizeof(MQBatchHdr);
+    return (int)hdr.count;
+}
@@ -0,0 +1,98 @@
+#ifndef MQ_BATCH_H
+#define MQ_BATCH_H
+
+/*
+MQ 배치 레이어
+- 메시지 1개 = [MQBatchHdr][레코드 * count]
+- 생산자: 레코드를 모아서 배치가 꽉 차거나 deadline이 지나면 mq_send 1번
+- 소비자: mq_batch_unpack으로 레코드 시작 주소/개수를 꺼냄
+- 큐 msgsize가 레코드 1개 크기면(예전 방식으로 만든 큐) 헤더 없이 1개씩 보냄
+- 메시지 버퍼는 init 때 만든 slab(MemSlab, MQ_BATCH_PENDING + 1개)에서만 → 이후 malloc 없음
+- O_NONBLOCK 큐가 꽉 차면(EAGAIN) 배치를 버리지 않고 대기 줄에 세우고 (최대 MQ_BATCH_PENDING개, 보낸 순서 유지)
+  MQ_BATCH_RETRY_MS 뒤 poll에서 다시 보냄, 그동안 push는 새 버퍼에 계속 쌓음
+  버퍼가 다 찼으면 레코드를 안 받음(-1) → 호출하는 쪽은 안 보낸 것으로 취급
+- 실제로 보낸 레코드는 on_sent 콜백으로 알려줌 (큐에 넣은 것과 전달된 것을 구분해야 하는 쪽용)
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mqueue.h>
+
+#include "mem_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQ_BATCH_MAGIC        0xB7C4
+#define MQ_BATCH_DEFAULT_RECS 32   // mq_tool 기본 배치 크기
+#define MQ_BATCH_DEFAULT_MS   200  // 기본 flush deadline
+#define MQ_BATCH_RETRY_MS     20   // 큐가 꽉 차서 못 보낸 배치를 다시 보내기까지 (flush_ms가 더 짧으면 그것)
+#define MQ_BATCH_PENDING      4    // 큐가 꽉 찼을 때 들고 있을 수 있는 메시지 수
+
+typedef struct {
+    uint16_t magic;     // MQ_BATCH_MAGIC
+    uint16_t rec_size;  // 레코드 1개 크기 (sizeof(THMsg) / sizeof(WatchMsg))
+    uint32_t count;     // 뒤에 붙은 레코드 수
+} MQBatchHdr;
+
+// 레코드 n개를 담는 배치 메시지 크기 (mq_tool에서 mq_msgsize로 사용)
+#define MQ_BATCH_MSGSIZE(rec_size, n) (sizeof(MQBatchHdr) + (size_t)(rec_size) * (size_t)(n))
+
+// mq_send 성공한 레코드 n개 (배치 안 주소, 콜백 안에서만 유효)
+typedef void (*MQBatchSentCb)(void* ctx, const unsigned char* recs, int n);
+
+typedef struct {
+    mqd_t q;
+    size_t rec_size;
+    int max_records;       // 0이면 예전 방식(헤더 없이 레코드 1개씩 전송)
+    int flush_ms;          // 첫 레코드가 쌓인 뒤 flush까지 최대 대기
+    uint64_t deadline_ms;  // CLOCK_MONOTONIC 기준, 0이면 비어있음
+
+    int count;             // 지금 쌓는 배치의 레코드 수
+    unsigned char* buf;    // 지금 쌓는 배치 (pool)
+
+    // 못 보낸 메시지 대기 줄 (헤더까지 채워진 채로, 앞에서부터 보냄)
+    MemSlab pool;
+    unsigned char* pend[MQ_BATCH_PENDING];
+    int pend_head;
+    int pend_n;
+    uint64_t retry_ms;     // 대기 줄 다시 보낼 시각 (CLOCK_MONOTONIC)
+
+    MQBatchSentCb on_sent;
+    void* on_sent_ctx;
+
+    // 통계
+    uint64_t sent_msgs;
+    uint64_t sent_records;
+    uint64_t send_fail;
+    uint64_t send_full;    // 큐가 O_NONBLOCK으로 열려 있고 꽉 차서 못 보낸 시도 수 (send_fail에도 포함, 배치는 남음)
+    uint64_t rejected;     // 대기 줄 / 버퍼까지 꽉 차서 push가 안 받은 레코드 수
+    uint64_t dropped;      // EAGAIN 말고 다른 mq_send 오류로 버린 레코드 수
+} MQBatcher;
+
+// 생산자 API (0 성공, -1 실패)
+// max_records <= 0 이면 큐의 mq_msgsize에 들어가는 만큼 사용
+int  mq_batch_init(MQBatcher* b, mqd_t q, size_t rec_size, int max_records, int flush_ms);
+void mq_batch_set_sent_cb(MQBatcher* b, MQBatchSentCb cb, void* ctx);
+int  mq_batch_push(MQBatcher* b, const void* rec); // 꽉 차면 바로 flush, -1이면 레코드를 안 받음 (버려짐)
+int  mq_batch_poll(MQBatcher* b);                  // deadline 지났으면 flush, 재시도 시각이면 대기 줄 다시 보냄
+int  mq_batch_flush(MQBatcher* b);                 // -1: 못 보냄 (EAGAIN이면 대기 줄에 남아 있음)
+int  mq_batch_pending(const MQBatcher* b);         // 못 보내고 들고 있는 레코드 수 (대기 줄 + 쌓는 중)
+int  mq_batch_find(const MQBatcher* b, size_t key_off, const void* key, size_t key_len); // 대기 중 레코드 index, 없으면 -1
+int  mq_batch_replace(MQBatcher* b, int idx, const void* rec); // 대기 중 레코드를 최신 값으로 덮어씀 (coalesce)
+int  mq_batch_depth(const MQBatcher* b, int* capacity);        // 큐에 쌓인 메시지 수 (mq_curmsgs), 실패 시 -1
+int  mq_batch_timeout_ms(const MQBatcher* b);      // 다음 deadline / 재시도까지 남은 ms, 비어있으면 -1
+void mq_batch_destroy(MQBatcher* b);               // 남은 레코드 flush (한 번만 시도) 후 버퍼 해제
+
+uint64_t mq_batch_now_ms(void);                    // CLOCK_MONOTONIC ms
+
+// 소비자 API
+// return: 레코드 수(>=1), 형식이 안 맞으면 -1
+int mq_batch_unpack(const void* msg, size_t len, size_t rec_size, const unsigned char** first);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
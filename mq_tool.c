@@ -1,23 +1,45 @@
 /*
 빌드
-gcc -o mq_tool mq_tool.c -I../include -lrt
+gcc -o mq_tool mq_tool.c dev_intern.c shard_ring.c -I../include -lrt -lpthread
 
 테스트 시작 전에 큐 생성
 ./mq_tool init
+./mq_tool init -d 64 -b 32   (큐 깊이 64, 메시지 1개에 레코드 32개까지 배치)
+./mq_tool init -b 0          (예전 방식: 메시지 1개 = 레코드 1개)
+./mq_tool init -s 4          (샤딩 모드: /mq_vital.0 ~ /mq_vital.3 도 생성)
 
-테스트 끝나고 큐 삭제
+테스트 끝나고 큐 삭제 (deviceId 핸들 shm /dev_intern 도 같이 초기화)
 ./mq_tool clean
+./mq_tool clean -s 4
+
+deviceId 핸들 사용량 (live / 재사용 대기 / 꽉 차서 못 받은 횟수)
+./mq_tool intern
 */
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <mqueue.h>
+#include <sys/mman.h>
 #include "common.h" // 큐 이름과 구조체 크기를 땡겨옴
+#include "mq_batch.h"
+#include "dev_intern.h"
 
 void print_usage() {
-    printf("Usage: ./mq_tool [init|clean]\n");
+    printf("Usage: ./mq_tool [init [-d depth] [-b batch] [-s shards]|clean [-s shards]|intern]\n");
+    printf("  -d depth : mq_maxmsg (default 10)\n");
+    printf("  -b batch : 메시지당 최대 레코드 수, 0이면 레코드 1개 크기 (default %d)\n",
+           MQ_BATCH_DEFAULT_RECS);
+    printf("  -s shards: 워치 샤드 큐 %s.0 ~ .(shards-1) 도 생성/삭제 (default 0)\n",
+           WATCH_QUEUE_NAME);
+}
+
+static long queue_msgsize(size_t rec_size, int batch) {
+    if (batch <= 0) return (long)rec_size;
+    return (long)MQ_BATCH_MSGSIZE(rec_size, batch);
 }
 
 int main(int argc, char* argv[]) {
@@ -26,34 +48,95 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    int depth = 10;
+    int batch = MQ_BATCH_DEFAULT_RECS;
+    int shards = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            batch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            shards = atoi(argv[++i]);
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (depth <= 0 || shards < 0) {
+        print_usage();
+        return 1;
+    }
+
     struct mq_attr attr;
     attr.mq_flags = 0;
-    attr.mq_maxmsg = 10;
+    attr.mq_maxmsg = depth;
     attr.mq_curmsgs = 0;
 
     if (strcmp(argv[1], "init") == 0) {
         // 1. 온습도용 큐 생성
-        attr.mq_msgsize = sizeof(THMsg);
+        attr.mq_msgsize = queue_msgsize(sizeof(THMsg), batch);
         mqd_t q1 = mq_open(TH_QUEUE_NAME, O_RDWR | O_CREAT, 0666, &attr);
+        long th_size = attr.mq_msgsize;
         
         // 2. 워치용 큐 생성
-        attr.mq_msgsize = sizeof(WatchMsg);
+        attr.mq_msgsize = queue_msgsize(sizeof(WatchMsg), batch);
         mqd_t q2 = mq_open(WATCH_QUEUE_NAME, O_RDWR | O_CREAT, 0666, &attr);
 
         if (q1 != (mqd_t)-1 && q2 != (mqd_t)-1) {
-            printf("✅ MQ Created: %s (size: %ld)\n", TH_QUEUE_NAME, sizeof(THMsg));
-            printf("✅ MQ Created: %s (size: %ld)\n", WATCH_QUEUE_NAME, sizeof(WatchMsg));
+            printf("✅ MQ Created: %s (size: %ld, depth: %d)\n", TH_QUEUE_NAME, th_size, depth);
+            printf("✅ MQ Created: %s (size: %ld, depth: %d)\n", WATCH_QUEUE_NAME, attr.mq_msgsize, depth);
         } else {
             perror("❌ MQ Creation Failed");
+            // 일반 계정은 /proc/sys/fs/mqueue/msg_max, msgsize_max 한도를 넘으면 EINVAL
+            fprintf(stderr, "   (check /proc/sys/fs/mqueue/msg_max, msgsize_max)\n");
         }
         mq_close(q1);
         mq_close(q2);
 
+        // 3. 워치 샤드 큐 (허브 shard k가 WATCH_QUEUE_NAME.k 를 읽음)
+        for (int k = 0; k < shards; k++) {
+            char name[64];
+            snprintf(name, sizeof(name), WATCH_QUEUE_SHARD_FMT, k);
+            mqd_t qs = mq_open(name, O_RDWR | O_CREAT, 0666, &attr);
+            if (qs == (mqd_t)-1) {
+                perror("❌ MQ Creation Failed");
+                break;
+            }
+            printf("✅ MQ Created: %s (size: %ld, depth: %d)\n", name, attr.mq_msgsize, depth);
+            mq_close(qs);
+        }
+
     } else if (strcmp(argv[1], "clean") == 0) {
         // 기존 큐 삭제 (초기화용)
         mq_unlink(TH_QUEUE_NAME);
         mq_unlink(WATCH_QUEUE_NAME);
+        for (int k = 0; k < shards; k++) {
+            char name[64];
+            snprintf(name, sizeof(name), WATCH_QUEUE_SHARD_FMT, k);
+            mq_unlink(name);
+        }
         printf("🧹 All MQs unlinked (cleaned).\n");
+
+        // 핸들 shm도 초기화 (모듈을 다 내린 뒤에, 죽은 프로세스가 잡고 있던 핸들까지 정리)
+        if (dev_intern_unlink(NULL) == 0) printf("🧹 %s unlinked (deviceId handles reset).\n", DEV_INTERN_SHM_NAME);
+    } else if (strcmp(argv[1], "intern") == 0) {
+        // 없으면 새로 만들지 않음
+        int fd = shm_open(DEV_INTERN_SHM_NAME, O_RDONLY, 0);
+        if (fd < 0) {
+            printf("⚠️ %s not found (no module started yet)\n", DEV_INTERN_SHM_NAME);
+            return 1;
+        }
+        close(fd);
+        DevIntern* d = dev_intern_open(NULL, 0);
+        if (!d) return 1;
+        DevInternStats st;
+        dev_intern_stats(d, &st);
+        printf("📊 %s capacity=%d issued=%d live=%d free=%d tombs=%d reused=%llu full=%llu\n",
+               DEV_INTERN_SHM_NAME, st.capacity, st.issued, st.live, st.free, st.tombs,
+               (unsigned long long)st.reused, (unsigned long long)st.full);
+        dev_intern_close(d);
     } else {
         print_usage();
     }
@@ -0,0 +1,300 @@
+#include "rt_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+typedef struct {
+    RtTaskFn fn;
+    void* arg;
+} RtTask;
+
+// deque 칸: steal이 읽는 동안 주인이 덮어쓸 수 없지만(꽉 차면 push 거절) 타입상 atomic으로
+typedef struct {
+    _Atomic(RtTaskFn) fn;
+    _Atomic(void*) arg;
+} RtSlot;
+
+typedef struct {
+    _Alignas(64) _Atomic int64_t top;     // thief 쪽
+    _Alignas(64) _Atomic int64_t bottom;  // 주인 쪽
+    RtSlot slot[RT_POOL_DEQUE_CAP];
+} RtDeque;
+
+typedef struct {
+    RtPool* pool;
+    int id;
+    pthread_t th;
+    RtDeque dq;
+} RtWorker;
+
+struct RtPool {
+    int n;
+    char name[16];
+    ThreadPlace place;
+    RtWorker* w;
+
+    _Atomic int64_t pending;   // 어딘가에 들어 있는 작업 수 (꺼낼 때 감소)
+    _Atomic int sleepers;
+    _Atomic int stop;
+
+    // inject 큐 (워커 밖 submit / deque 꽉 참), mtx로 보호
+    pthread_mutex_t mtx;
+    pthread_cond_t cv;
+    RtTask* inj;
+    int inj_cap, inj_head, inj_len;
+    _Atomic int inj_count;
+
+    _Atomic uint64_t submitted, executed, stolen, injected, sleeps;
+};
+
+static _Thread_local RtWorker* tl_worker;
+
+// ================================
+// Chase-Lev deque (Lê et al. 2013, C11 버전)
+// ================================
+static int _dq_push(RtDeque* d, RtTask t) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - top >= RT_POOL_DEQUE_CAP) return -1;
+
+    RtSlot* s = &d->slot[b & (RT_POOL_DEQUE_CAP - 1)];
+    atomic_store_explicit(&s->fn, t.fn, memory_order_relaxed);
+    atomic_store_explicit(&s->arg, t.arg, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    return 0;
+}
+
+static int _dq_take(RtDeque* d, RtTask* out) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+
+    RtSlot* s = &d->slot[b & (RT_POOL_DEQUE_CAP - 1)];
+    out->fn = atomic_load_explicit(&s->fn, memory_order_relaxed);
+    out->arg = atomic_load_explicit(&s->arg, memory_order_relaxed);
+    if (t == b) {
+        // 마지막 1개: thief와 경쟁
+        int won = atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                          memory_order_relaxed);
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+static int _dq_steal(RtDeque* d, RtTask* out) {
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return 0;
+
+    RtSlot* s = &d->slot[t & (RT_POOL_DEQUE_CAP - 1)];
+    out->fn = atomic_load_explicit(&s->fn, memory_order_relaxed);
+    out->arg = atomic_load_explicit(&s->arg, memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                   memory_order_relaxed);
+}
+
+// ================================
+// inject 큐 (mtx 잡고 호출)
+// ================================
+static int _inj_push_locked(RtPool* p, RtTask t) {
+    if (p->inj_len == p->inj_cap) {
+        int cap = p->inj_cap ? p->inj_cap * 2 : 64;
+        RtTask* n = (RtTask*)malloc((size_t)cap * sizeof(RtTask));
+        if (!n) return -1;
+        for (int i = 0; i < p->inj_len; i++) n[i] = p->inj[(p->inj_head + i) % p->inj_cap];
+        free(p->inj);
+        p->inj = n;
+        p->inj_cap = cap;
+        p->inj_head = 0;
+    }
+    p->inj[(p->inj_head + p->inj_len) % p->inj_cap] = t;
+    p->inj_len++;
+    atomic_store(&p->inj_count, p->inj_len);
+    return 0;
+}
+
+static int _inj_pop(RtPool* p, RtTask* out) {
+    if (atomic_load_explicit(&p->inj_count, memory_order_relaxed) == 0) return 0;
+
+    int got = 0;
+    pthread_mutex_lock(&p->mtx);
+    if (p->inj_len > 0) {
+        *out = p->inj[p->inj_head];
+        p->inj_head = (p->inj_head + 1) % p->inj_cap;
+        p->inj_len--;
+        atomic_store(&p->inj_count, p->inj_len);
+        got = 1;
+    }
+    pthread_mutex_unlock(&p->mtx);
+    return got;
+}
+
+// ================================
+// 워커
+// ================================
+static int _find_task(RtWorker* w, RtTask* out) {
+    RtPool* p = w->pool;
+    if (_dq_take(&w->dq, out)) return 1;
+
+    for (int k = 1; k < p->n; k++) {
+        RtWorker* v = &p->w[(w->id + k) % p->n];
+        if (_dq_steal(&v->dq, out)) {
+            atomic_fetch_add_explicit(&p->stolen, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    return _inj_pop(p, out);
+}
+
+static void* _worker_main(void* arg) {
+    RtWorker* w = (RtWorker*)arg;
+    RtPool* p = w->pool;
+    tl_worker = w;
+
+    char tname[16];
+    snprintf(tname, sizeof(tname), "%.11s-%d", p->name, w->id);
+    thread_place_apply(&p->place, tname);
+
+    for (;;) {
+        RtTask t;
+        if (_find_task(w, &t)) {
+            atomic_fetch_sub(&p->pending, 1);
+            t.fn(t.arg);
+            atomic_fetch_add_explicit(&p->executed, 1, memory_order_relaxed);
+            continue;
+        }
+
+        // pending > 0 이면 다른 워커가 아직 publish 중이거나 steal 경쟁에서 짐 → 다시 찾음
+        pthread_mutex_lock(&p->mtx);
+        atomic_fetch_add(&p->sleepers, 1);
+        while (!atomic_load(&p->stop) && atomic_load(&p->pending) <= 0) {
+            atomic_fetch_add_explicit(&p->sleeps, 1, memory_order_relaxed);
+            pthread_cond_wait(&p->cv, &p->mtx);
+        }
+        atomic_fetch_sub(&p->sleepers, 1);
+        int done = atomic_load(&p->stop) && atomic_load(&p->pending) <= 0;
+        pthread_mutex_unlock(&p->mtx);
+        if (done) break;
+    }
+
+    tl_worker = NULL;
+    return NULL;
+}
+
+// ================================
+// 외부 API
+// ================================
+RtPool* rt_pool_create(int workers, const char* name, const ThreadPlace* place) {
+    if (workers <= 0) workers = 1;
+    if (workers > RT_POOL_MAX_WORKERS) workers = RT_POOL_MAX_WORKERS;
+
+    RtPool* p = (RtPool*)calloc(1, sizeof(RtPool));
+    if (!p) return NULL;
+    p->w = (RtWorker*)aligned_alloc(64, (size_t)workers * sizeof(RtWorker));
+    if (!p->w) {
+        free(p);
+        return NULL;
+    }
+    memset(p->w, 0, (size_t)workers * sizeof(RtWorker));
+    snprintf(p->name, sizeof(p->name), "%s", name ? name : "rt");
+    if (place) p->place = *place;
+    pthread_mutex_init(&p->mtx, NULL);
+    pthread_cond_init(&p->cv, NULL);
+
+    for (int i = 0; i < workers; i++) {
+        p->w[i].pool = p;
+        p->w[i].id = i;
+    }
+    p->n = workers;
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&p->w[i].th, NULL, _worker_main, &p->w[i]) != 0) {
+            perror("pthread_create rt_pool");
+            // 만든 것까지만 정리
+            p->n = i;
+            rt_pool_destroy(p);
+            return NULL;
+        }
+    }
+    return p;
+}
+
+void rt_pool_destroy(RtPool* p) {
+    if (!p) return;
+
+    pthread_mutex_lock(&p->mtx);
+    atomic_store(&p->stop, 1);
+    pthread_cond_broadcast(&p->cv);
+    pthread_mutex_unlock(&p->mtx);
+
+    for (int i = 0; i < p->n; i++) pthread_join(p->w[i].th, NULL);
+
+    pthread_cond_destroy(&p->cv);
+    pthread_mutex_destroy(&p->mtx);
+    free(p->inj);
+    free(p->w);
+    free(p);
+}
+
+int rt_pool_submit(RtPool* p, RtTaskFn fn, void* arg) {
+    if (!p || !fn || atomic_load(&p->stop)) return -1;
+
+    RtTask t = { fn, arg };
+    RtWorker* w = tl_worker;
+    if (!w || w->pool != p || _dq_push(&w->dq, t) != 0) {
+        pthread_mutex_lock(&p->mtx);
+        int rc = _inj_push_locked(p, t);
+        pthread_mutex_unlock(&p->mtx);
+        if (rc != 0) return -1;
+        atomic_fetch_add_explicit(&p->injected, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&p->submitted, 1, memory_order_relaxed);
+
+    // pending 증가 → sleepers 확인 (워커는 sleepers 증가 → pending 확인, 둘 다 seq_cst라 깨우기를 놓치지 않음)
+    atomic_fetch_add(&p->pending, 1);
+    if (atomic_load(&p->sleepers) > 0) {
+        pthread_mutex_lock(&p->mtx);
+        pthread_cond_signal(&p->cv);
+        pthread_mutex_unlock(&p->mtx);
+    }
+    return 0;
+}
+
+int rt_pool_workers(const RtPool* p) {
+    return p ? p->n : 0;
+}
+
+int rt_pool_current_worker(void) {
+    return tl_worker ? tl_worker->id : -1;
+}
+
+void rt_pool_get_stats(RtPool* p, RtPoolStats* out) {
+    memset(out, 0, sizeof(*out));
+    if (!p) return;
+    out->submitted = atomic_load_explicit(&p->submitted, memory_order_relaxed);
+    out->executed = atomic_load_explicit(&p->executed, memory_order_relaxed);
+    out->stolen = atomic_load_explicit(&p->stolen, memory_order_relaxed);
+    out->injected = atomic_load_explicit(&p->injected, memory_order_relaxed);
+    out->sleeps = atomic_load_explicit(&p->sleeps, memory_order_relaxed);
+}
+
+void rt_pool_print_stats(RtPool* p) {
+    RtPoolStats s;
+    rt_pool_get_stats(p, &s);
+    printf("🧵 [RT][%s] workers=%d submitted=%llu executed=%llu stolen=%llu injected=%llu sleeps=%llu\n",
+           p ? p->name : "?", rt_pool_workers(p), (unsigned long long)s.submitted,
+           (unsigned long long)s.executed, (unsigned long long)s.stolen, (unsigned long long)s.injected,
+           (unsigned long long)s.sleeps);
+}
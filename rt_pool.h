@@ -0,0 +1,54 @@
+#ifndef RT_POOL_H
+#define RT_POOL_H
+
+/*
+통합 실행용 work-stealing 스레드 풀
+- 워커마다 Chase-Lev deque (주인은 bottom에서 push/pop, 다른 워커는 top에서 steal, 락 없음)
+- 워커 밖(메인 / 허브 스레드)에서 넣은 작업은 inject 큐 (mutex), 워커가 자기 deque → steal → inject 순으로 찾음
+- 할 일이 없으면 condvar로 잠듦 (작업이 들어올 때 잠든 워커가 있을 때만 깨움)
+- 오래 도는 작업(워치 수신 루프, 링 drain)도 넣을 수 있음: 그 동안 워커 1개를 차지
+  → 워커 수 = 서비스 작업 수 + 짧은 작업용 여유
+- destroy: 새 작업 거절 → 남은 작업 다 실행 → join (오래 도는 작업은 미리 멈추게 해야 함)
+*/
+
+#include <stdint.h>
+
+#include "thread_place.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RT_POOL_MAX_WORKERS 64
+#define RT_POOL_DEQUE_CAP   1024   // 워커 deque 크기 (넘치면 inject 큐로)
+
+typedef void (*RtTaskFn)(void* arg);
+
+typedef struct RtPool RtPool;
+
+typedef struct {
+    uint64_t submitted;
+    uint64_t executed;
+    uint64_t stolen;      // 다른 워커 deque에서 가져온 것
+    uint64_t injected;    // inject 큐로 들어온 것 (워커 밖에서 submit / deque 꽉 참)
+    uint64_t sleeps;      // 할 일 없어서 잠든 횟수
+} RtPoolStats;
+
+// place: 모든 워커에 같은 배치 (NULL이면 기본)
+RtPool* rt_pool_create(int workers, const char* name, const ThreadPlace* place);
+void rt_pool_destroy(RtPool* p);
+
+// 0 성공, -1 종료 중 / 메모리 부족
+int rt_pool_submit(RtPool* p, RtTaskFn fn, void* arg);
+
+int rt_pool_workers(const RtPool* p);
+int rt_pool_current_worker(void);   // 지금 스레드의 워커 번호 (워커가 아니면 -1)
+
+void rt_pool_get_stats(RtPool* p, RtPoolStats* out);
+void rt_pool_print_stats(RtPool* p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,270 @@
+/*
+runtime_main 두 모드 (inproc / mp) 같은 UDP 부하로 비교
+
+빌드 (저장소 루트에서, runtime_main은 따로 먼저 빌드)
+gcc -O2 -o runtime_bench runtime_bench.c
+
+실행
+./runtime_bench [-x ./runtime_main] [-m inproc,mp] [-r 패킷/s] [-d 디바이스 수] [-b 패킷당 샘플] [-t 초] [-n shards] [-p port] [-c hub.conf]
+- 모드마다 runtime_main -m <mode> -n shards -p port -d devices (-c) 를 띄우고, 뜰 때까지 잠깐 기다린 뒤
+  디바이스를 돌아가며 UDP 패킷을 -r 속도로 -t초 동안 보냄 → SIGINT → 종료 대기 (안 끝나면 SIGKILL)
+- -b 1: 샘플 객체 1개 / 패킷 ({"deviceId","type","ts","value","seq"})
+  -b N: 디바이스 묶음 1개 / 패킷 ({"deviceId","seq","ts","samples":[N개]})
+  ts는 워치 형식 그대로 로컬 시간 "yyyy-MM-dd HH:mm:ss" (보내는 시각)
+- 이 프로세스: 보낸 패킷 / 샘플 수, 실제 송신 속도, sendto 실패 수
+  runtime_main (stdout 그대로): 종료할 때 CPU(user/sys), 수신 → 허브 반영 지연
+  (inproc: [RT] ring.k rx→hub, mp: 허브 stop에서 [HUB][WATCH] mq rx→hub)
+같은 -r / -d / -b로 두 모드를 돌려서 CPU / 지연 / dropped를 나란히 비교
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define BENCH_PKT_MAX    8192
+#define BENCH_START_MS   1500    // runtime_main이 UDP 소켓 / MQ / 링을 만들 때까지
+#define BENCH_STOP_MS    10000   // SIGINT 뒤 이만큼 안 끝나면 SIGKILL
+#define BENCH_TICK_US    1000    // 송신 속도 맞추는 단위
+
+typedef struct {
+    const char* runtime;
+    const char* conf_path;
+    int rate;        // 패킷/s
+    int devices;
+    int per_pkt;     // 패킷당 샘플
+    int sec;
+    int shards;
+    int port;
+} BenchOptions;
+
+typedef struct {
+    uint64_t pkts;
+    uint64_t samples;
+    uint64_t fail;
+    double wall;
+} BenchResult;
+
+static const char* BENCH_TYPES[] = { "HEART_RATE", "SKIN_TEMP" };
+
+static double _mono_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 워치 ts 문자열 (로컬 시간, 초 단위)
+static void _wall_ts(char* out, size_t cap) {
+    time_t t = time(NULL);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(out, cap, "%Y-%m-%d %H:%M:%S", &tm);
+}
+
+// 샘플 값: 디바이스 / seq / 채널마다 조금씩 달라서 워치 쪽에서 중복으로 안 걸림
+static double _value(int type, int dev, uint64_t seq) {
+    return type == 0 ? 60.0 + (double)((dev + seq) % 40) : 36.0 + (double)((dev + seq) % 10) / 10.0;
+}
+
+// 패킷 1개 만들기, return: 길이 (버퍼 넘치면 -1)
+static int _build(char* buf, size_t cap, const BenchOptions* o, int dev, uint64_t seq, const char* ts) {
+    int n;
+    if (o->per_pkt <= 1) {
+        int t = (int)(seq % 2);
+        n = snprintf(buf, cap, "{\"deviceId\":\"B%06d\",\"type\":\"%s\",\"ts\":\"%s\",\"value\":%.1f,\"seq\":%llu}",
+                     dev, BENCH_TYPES[t], ts, _value(t, dev, seq), (unsigned long long)seq);
+        return n > 0 && (size_t)n < cap ? n : -1;
+    }
+
+    n = snprintf(buf, cap, "{\"deviceId\":\"B%06d\",\"seq\":%llu,\"ts\":\"%s\",\"samples\":[", dev,
+                 (unsigned long long)seq, ts);
+    for (int i = 0; i < o->per_pkt && n > 0 && (size_t)n < cap; i++) {
+        int t = i % 2;
+        n += snprintf(buf + n, cap - (size_t)n, "%s{\"type\":\"%s\",\"value\":%.1f}", i ? "," : "", BENCH_TYPES[t],
+                      _value(t, dev, seq + (uint64_t)i));
+    }
+    if (n > 0 && (size_t)n < cap) n += snprintf(buf + n, cap - (size_t)n, "]}");
+    return n > 0 && (size_t)n < cap ? n : -1;
+}
+
+// -r 속도로 -t초 동안 (BENCH_TICK_US마다 밀린 만큼 보냄)
+static int _load(const BenchOptions* o, BenchResult* r) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    struct sockaddr_in to;
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons((uint16_t)o->port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    uint64_t* seq = (uint64_t*)calloc((size_t)o->devices, sizeof(uint64_t));
+    char* buf = (char*)malloc(BENCH_PKT_MAX);
+    if (!seq || !buf) {
+        free(seq);
+        free(buf);
+        close(fd);
+        return -1;
+    }
+
+    memset(r, 0, sizeof(*r));
+    int dev = 0;
+    double t0 = _mono_s(), now = t0;
+    while ((now = _mono_s()) - t0 < (double)o->sec) {
+        uint64_t due = (uint64_t)((now - t0) * (double)o->rate);
+        char ts[32];
+        _wall_ts(ts, sizeof(ts));
+        while (r->pkts + r->fail < due) {
+            int n = _build(buf, BENCH_PKT_MAX, o, dev, ++seq[dev], ts);
+            if (n < 0 || sendto(fd, buf, (size_t)n, 0, (struct sockaddr*)&to, sizeof(to)) != n) {
+                r->fail++;
+            } else {
+                r->pkts++;
+                r->samples += (uint64_t)(o->per_pkt > 1 ? o->per_pkt : 1);
+            }
+            if (++dev >= o->devices) dev = 0;
+        }
+        usleep(BENCH_TICK_US);
+    }
+    r->wall = _mono_s() - t0;
+
+    free(seq);
+    free(buf);
+    close(fd);
+    return 0;
+}
+
+static pid_t _spawn(const BenchOptions* o, const char* mode) {
+    char shards[16], port[16], devices[16];
+    snprintf(shards, sizeof(shards), "%d", o->shards);
+    snprintf(port, sizeof(port), "%d", o->port);
+    snprintf(devices, sizeof(devices), "%d", o->devices);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    const char* argv[16];
+    int a = 0;
+    argv[a++] = o->runtime;
+    argv[a++] = "-m";
+    argv[a++] = mode;
+    argv[a++] = "-n";
+    argv[a++] = shards;
+    argv[a++] = "-p";
+    argv[a++] = port;
+    argv[a++] = "-d";
+    argv[a++] = devices;
+    if (o->conf_path) {
+        argv[a++] = "-c";
+        argv[a++] = o->conf_path;
+    }
+    argv[a] = NULL;
+    execv(o->runtime, (char* const*)argv);
+    perror("execv");
+    _exit(127);
+}
+
+// SIGINT → BENCH_STOP_MS 안에 안 끝나면 SIGKILL, return: 종료 코드 (시그널로 죽었으면 128 + 번호)
+static int _stop(pid_t pid) {
+    kill(pid, SIGINT);
+    int st = 0;
+    for (int waited = 0; waited < BENCH_STOP_MS; waited += 10) {
+        pid_t w = waitpid(pid, &st, WNOHANG);
+        if (w == pid) return WIFEXITED(st) ? WEXITSTATUS(st) : 128 + WTERMSIG(st);
+        if (w < 0 && errno != EINTR) return -1;
+        usleep(10000);
+    }
+    fprintf(stderr, "⚠️ [BENCH] pid %d did not stop in %d ms → SIGKILL\n", (int)pid, BENCH_STOP_MS);
+    kill(pid, SIGKILL);
+    waitpid(pid, &st, 0);
+    return 128 + SIGKILL;
+}
+
+static int _run(const BenchOptions* o, const char* mode) {
+    printf("▶ [BENCH] mode=%s rate=%d pkt/s devices=%d samples/pkt=%d sec=%d shards=%d\n", mode, o->rate, o->devices,
+           o->per_pkt, o->sec, o->shards);
+    pid_t pid = _spawn(o, mode);
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    usleep(BENCH_START_MS * 1000);
+    if (waitpid(pid, NULL, WNOHANG) == pid) {
+        fprintf(stderr, "❌ [BENCH] %s exited during start\n", mode);
+        return -1;
+    }
+
+    BenchResult r;
+    int lrc = _load(o, &r);
+    usleep(200 * 1000); // 마지막 패킷이 허브까지 가도록
+    int rc = _stop(pid);
+    fflush(stdout);
+
+    if (lrc != 0) return -1;
+    printf("📊 [BENCH] mode=%s sent=%llu pkts (%llu samples) fail=%llu in %.2fs → %.0f pkt/s, %.0f samples/s, runtime exit=%d\n",
+           mode, (unsigned long long)r.pkts, (unsigned long long)r.samples, (unsigned long long)r.fail, r.wall,
+           (double)r.pkts / r.wall, (double)r.samples / r.wall, rc);
+    return rc == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions o;
+    memset(&o, 0, sizeof(o));
+    o.runtime = "./runtime_main";
+    o.rate = 20000;
+    o.devices = 1000;
+    o.per_pkt = 1;
+    o.sec = 5;
+    o.shards = 1;
+    o.port = 5005;
+    char modes_buf[64] = "inproc,mp";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "x:m:r:d:b:t:n:p:c:")) != -1) {
+        switch (opt) {
+        case 'x': o.runtime = optarg; break;
+        case 'm': snprintf(modes_buf, sizeof(modes_buf), "%s", optarg); break;
+        case 'r': o.rate = atoi(optarg); break;
+        case 'd': o.devices = atoi(optarg); break;
+        case 'b': o.per_pkt = atoi(optarg); break;
+        case 't': o.sec = atoi(optarg); break;
+        case 'n': o.shards = atoi(optarg); break;
+        case 'p': o.port = atoi(optarg); break;
+        case 'c': o.conf_path = optarg; break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-x runtime_main] [-m inproc,mp] [-r pkt/s] [-d devices] [-b samples/pkt] [-t sec] [-n shards] [-p port] [-c hub.conf]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (o.rate < 1) o.rate = 1;
+    if (o.devices < 1) o.devices = 1;
+    if (o.per_pkt < 1) o.per_pkt = 1;
+    if (o.sec < 1) o.sec = 1;
+    if (o.shards < 1) o.shards = 1;
+
+    int rc = 0;
+    char* save = NULL;
+    for (char* m = strtok_r(modes_buf, ",", &save); m; m = strtok_r(NULL, ",", &save)) {
+        if (strcmp(m, "inproc") != 0 && strcmp(m, "mp") != 0) {
+            fprintf(stderr, "❌ [BENCH] unknown mode %s\n", m);
+            rc = 1;
+            continue;
+        }
+        if (_run(&o, m) != 0) rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,630 @@
+/*
+통합 실행 (워치 UDP 수신 + 허브(TH 폴링 포함)를 한 바이너리로)
+
+빌드 (Hub_module / Watch_Module / TH_Module 소스를 같이)
+gcc -O2 -o runtime_main runtime_main.c rt_pool.c spsc_ring.c \
+    Watch_Module/vital_module.c Watch_Module/seq_win.c \
+    Hub_module/collector_hub.c Hub_module/hub_shard.c Hub_module/hub_snapshot.c Hub_module/hub_config.c \
+    Hub_module/hub_result.c Hub_module/hub_archive.c Hub_module/hub_emit.c Hub_module/hub_query.c \
+    Hub_module/hub_life.c \
+    TH_Module/th_module.c TH_Module/th_health.c TH_Module/th_filter.c TH_Module/th_sched.c \
+    mq_batch.c timer_wheel.c ts_parse.c shard_ring.c mem_pool.c thread_place.c flow_ctl.c io_engine.c \
+    dev_intern.c channel_reg.c \
+    -I. -IHub_module -IWatch_Module -ITH_Module $(pkg-config --cflags --libs libmodbus) -lcjson -lpthread -lrt -lm
+
+모드
+- inproc (기본): 워치 수신 루프 / shard별 링 drain을 work-stealing 풀(rt_pool)의 작업으로,
+                 WatchMsg는 MQ 대신 lock-free 링(spsc_ring)으로 허브에 바로
+- mp: 예전처럼 프로세스 분리 (허브 프로세스가 MQ 생성 → 워치 프로세스), 부모는 시그널 전달 + 회수만
+
+시그널 (두 모드 공통, 메인 스레드 하나가 sigtimedwait로 받음 → 다른 스레드는 전부 block)
+- SIGINT / SIGTERM: 워치 → 링 drain → 허브 순서로 정지
+- SIGHUP: -c 설정 파일 다시 읽기
+- SIGUSR1: 통계 출력
+
+종료할 때 CPU(user/sys)와 벽시계 시간, 수신 → 허브 반영 지연을 찍음 (두 모드를 같은 부하로 돌려 비교)
+- inproc: drain 작업이 레코드마다 ([RT] ring.k rx→hub)
+- mp: 허브 MQ 리더가 레코드마다, 허브 stop에서 shard별로 ([HUB][WATCH] mq rx→hub)
+같은 부하로 두 모드 돌리기: runtime_bench.c
+
+./runtime_main -m inproc -w 4 -n 1 -c hub.conf
+./runtime_main -m mp -n 2 -t 60
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "common.h"
+#include "rt_pool.h"
+#include "spsc_ring.h"
+#include "ts_parse.h"
+#include "thread_place.h"
+#include "vital_module.h"
+#include "collector_hub.h"
+#include "hub_shard.h"
+#include "hub_config.h"
+
+#define RT_DEFAULT_WORKERS  4
+#define RT_DEFAULT_RING     4096
+#define RT_DRAIN_BATCH      64
+#define RT_DRAIN_WAIT_MS    100
+#define RT_MQ_WAIT_MS       3000    // mp: 허브 프로세스가 MQ를 만들 때까지 기다리는 시간
+#define RT_READY_WAIT_MS    1000    // 시작 후 READY를 기다려 보는 시간 (안 돼도 계속)
+#define RT_WATCH_STOP_MS    100     // 워치 수신 루프 정지 한도 (정지 eventfd로 바로 깨어남, 넘으면 경고만)
+
+typedef struct {
+    int inproc;
+    int workers;
+    int shards;
+    int port;
+    int ring_cap;
+    int run_sec;        // 0이면 시그널이 올 때까지
+    int stats_sec;      // 0이면 주기 출력 안 함
+    int max_devices;    // 워치 캐시 / 허브 shard당 디바이스 수 (0이면 기본 64 / -c 설정 값)
+    const char* conf_path;
+    const char* unix_path;  // 워치 AF_UNIX datagram 수신 경로 (같은 호스트 브리지, NULL이면 UDP만)
+} RtOptions;
+
+// 허브 1개 (shards == 1, 경로 그대로) 또는 샤드 그룹
+typedef struct {
+    CollectorHub* one;
+    CollectorHubGroup* group;
+    int shards;
+} RtHubs;
+
+// inproc: shard별 링 drain 작업 상태
+typedef struct {
+    int k;
+    SpscRing* ring;
+    CollectorHub* hub;
+    atomic_int* stop;
+    uint64_t records;
+    uint64_t applied;
+    TickJitter lat;     // 워치 수신(rx_ts_ms) → 허브 반영 지연 (ms 단위 ts라 1ms 해상도)
+} RtDrain;
+
+typedef struct {
+    const WatchUdpConfig* cfg;
+    int rc;
+    atomic_int done;
+} RtWatchTask;
+
+typedef struct {
+    RtPool* pool;
+    RtHubs* hubs;
+    RtDrain* drains;
+    int shards;
+    atomic_int busy;    // 이전 통계 작업이 아직 안 끝났으면 건너뜀
+} RtStatsTask;
+
+// ============================
+// 설정
+// ============================
+static void usage(const char* prog) {
+    printf("Usage: %s [-m inproc|mp] [-w workers] [-n shards] [-p port] [-q ring_cap] [-u unix_path] [-c hub.conf] [-d max_devices] [-t sec] [-s stats_sec]\n",
+           prog);
+    printf("  -m : inproc = 한 프로세스 (풀 + 링, 기본), mp = 워치/허브 프로세스 분리 (MQ)\n");
+    printf("  -w : 풀 워커 수 (기본 %d, 최소 shards + 2)\n", RT_DEFAULT_WORKERS);
+    printf("  -n : 허브 shard 수 (기본 1)\n");
+    printf("  -q : shard별 링 크기 (기본 %d)\n", RT_DEFAULT_RING);
+    printf("  -u : 워치 AF_UNIX datagram 경로 (같은 호스트 브리지용, UDP와 같은 패킷 형식)\n");
+    printf("  -c : 허브 설정 파일 (key=value, SIGHUP에 다시 읽음)\n");
+    printf("  -d : 디바이스 수 상한 (워치 캐시 + 허브 shard당, 기본 64)\n");
+    printf("  -t : 이 시간 뒤 종료 (0이면 SIGINT까지)\n");
+}
+
+static int parse_options(int argc, char** argv, RtOptions* o) {
+    memset(o, 0, sizeof(*o));
+    o->inproc = 1;
+    o->workers = RT_DEFAULT_WORKERS;
+    o->shards = 1;
+    o->port = 5005;
+    o->ring_cap = RT_DEFAULT_RING;
+
+    int c;
+    while ((c = getopt(argc, argv, "m:w:n:p:q:u:c:d:t:s:h")) != -1) {
+        switch (c) {
+        case 'm':
+            if (strcmp(optarg, "inproc") == 0) o->inproc = 1;
+            else if (strcmp(optarg, "mp") == 0) o->inproc = 0;
+            else return -1;
+            break;
+        case 'w': o->workers = atoi(optarg); break;
+        case 'n': o->shards = atoi(optarg); break;
+        case 'p': o->port = atoi(optarg); break;
+        case 'q': o->ring_cap = atoi(optarg); break;
+        case 'u': o->unix_path = optarg; break;
+        case 'c': o->conf_path = optarg; break;
+        case 'd': o->max_devices = atoi(optarg); break;
+        case 't': o->run_sec = atoi(optarg); break;
+        case 's': o->stats_sec = atoi(optarg); break;
+        default: return -1;
+        }
+    }
+    if (o->shards < 1) o->shards = 1;
+    if (o->ring_cap <= 0) o->ring_cap = RT_DEFAULT_RING;
+    // 오래 도는 작업 (워치 루프 1 + drain shards개) + 통계 같은 짧은 작업용 1
+    if (o->workers < o->shards + 2) {
+        printf("⚠️ [RT] workers %d → %d (watch 1 + drain %d + spare 1)\n", o->workers, o->shards + 2, o->shards);
+        o->workers = o->shards + 2;
+    }
+    return 0;
+}
+
+static void hub_config_defaults(CollectorHubConfig* c) {
+    memset(c, 0, sizeof(*c));
+    c->watch_fifo_path = "/tmp/th_fifo";
+    c->rulebase_in_fifo_path = "/tmp/rulebase_in.fifo";
+    c->rulebase_out_fifo_path = "/tmp/rulebase_out.fifo";
+    c->th_ip = "192.168.0.20";
+    c->th_port = 8887;
+    c->th_slave_id = 1;
+    c->collect_interval_sec = 5;
+    c->max_devices = 64;
+    c->device_stale_sec = 300;
+}
+
+static void watch_config_defaults(WatchUdpConfig* w, const RtOptions* o) {
+    memset(w, 0, sizeof(*w));
+    w->port = o->port;
+    w->bind_ip = "0.0.0.0";
+    w->max_devices = o->max_devices > 0 ? o->max_devices : 64;
+    w->batch_flush_ms = 200;
+    w->stale_timeout_ms = 300000;
+    w->shard_count = o->shards;
+    w->unix_path = o->unix_path;
+    w->max_dgram = 65507;         // 배치 패킷
+}
+
+// ============================
+// 허브 (1개 / 그룹)
+// ============================
+static int hubs_create(RtHubs* h, const CollectorHubConfig* cfg, int shards) {
+    memset(h, 0, sizeof(*h));
+    h->shards = shards;
+    if (shards > 1) {
+        h->group = collector_hub_group_create(cfg, shards, 0, NULL, NULL);
+        return h->group ? 0 : -1;
+    }
+    h->one = collector_hub_create(cfg, NULL, NULL);
+    return h->one ? 0 : -1;
+}
+
+static HubLifeState hubs_state(RtHubs* h) {
+    return h->group ? collector_hub_group_state(h->group) : collector_hub_state(h->one);
+}
+
+// 시작은 상대 프로세스(rulebase 등)를 기다리지 않음 → 잠깐만 READY를 기다려 보고 상태만 알림
+static int hubs_start(RtHubs* h) {
+    int rc = h->group ? collector_hub_group_start(h->group) : collector_hub_start(h->one);
+    if (rc != 0) return rc;
+
+    HubLifeState st = h->group ? collector_hub_group_wait_ready(h->group, RT_READY_WAIT_MS)
+                               : collector_hub_wait_ready(h->one, RT_READY_WAIT_MS);
+    printf("🚦 [RT] hub %s (waited <= %dms)%s\n", hub_life_state_name(st), RT_READY_WAIT_MS,
+           st == HUB_LIFE_READY ? "" : " (endpoints retrying, continuing)");
+    return 0;
+}
+
+static void hubs_stop_destroy(RtHubs* h) {
+    if (h->group) {
+        collector_hub_group_stop(h->group);
+        collector_hub_group_destroy(h->group);
+    } else if (h->one) {
+        collector_hub_stop(h->one);
+        collector_hub_destroy(h->one);
+    }
+    memset(h, 0, sizeof(*h));
+}
+
+static CollectorHub* hubs_shard(RtHubs* h, int k) {
+    return h->group ? collector_hub_group_shard(h->group, k) : h->one;
+}
+
+static void hubs_reload(RtHubs* h, const char* path, const CollectorHubConfig* base) {
+    if (!path) {
+        printf("⚠️ [RT] SIGHUP: no config file (-c)\n");
+        return;
+    }
+    CollectorHubConfig c = *base;
+    HubConfigStrings strs;
+    if (hub_config_load(path, &c, &strs) < 0) {
+        fprintf(stderr, "❌ [RT] reload %s failed\n", path);
+        return;
+    }
+    int rc = h->group ? collector_hub_group_reconfigure(h->group, &c) : collector_hub_reconfigure(h->one, &c);
+    printf("🔁 [RT] reload %s → %s\n", path, rc == 0 ? "ok" : "partial");
+}
+
+static void hubs_print_flow(RtHubs* h) {
+    printf("🚦 [RT] hub state=%s\n", hub_life_state_name(hubs_state(h)));
+    for (int k = 0; k < h->shards; k++) {
+        FlowSnapshot fs[4];
+        int n = collector_hub_get_flow(hubs_shard(h, k), fs, 4);
+        for (int i = 0; i < n; i++) {
+            printf("📊 [RT] hub.%d %s level=%s depth=%d/%d lag=%lldms dropped=%llu\n", k, fs[i].name,
+                   flow_level_name(fs[i].level), fs[i].depth, fs[i].capacity, (long long)fs[i].lag_ms,
+                   (unsigned long long)fs[i].dropped);
+        }
+    }
+}
+
+// ============================
+// 시그널 / 시간
+// ============================
+static void block_signals(sigset_t* set) {
+    sigemptyset(set);
+    sigaddset(set, SIGINT);
+    sigaddset(set, SIGTERM);
+    sigaddset(set, SIGHUP);
+    sigaddset(set, SIGUSR1);
+    // 이후 만드는 스레드는 전부 이 mask를 물려받음 → 시그널은 메인의 sigtimedwait로만
+    pthread_sigmask(SIG_BLOCK, set, NULL);
+}
+
+static uint64_t mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000L);
+}
+
+// 종료 시그널이나 run_sec까지 대기, 그 사이 SIGHUP / SIGUSR1 / 주기 통계 처리
+typedef void (*RtTickFn)(void* ctx, int sig);
+
+static void wait_for_stop(const sigset_t* set, const RtOptions* o, RtTickFn on_event, void* ctx) {
+    uint64_t start = mono_ms();
+    uint64_t next_stats = o->stats_sec > 0 ? start + (uint64_t)o->stats_sec * 1000ULL : 0;
+
+    for (;;) {
+        struct timespec to = { 0, 200 * 1000000L };
+        int sig = sigtimedwait(set, NULL, &to);
+        if (sig == SIGINT || sig == SIGTERM) {
+            printf("\n🛑 [RT] %s → shutdown\n", sig == SIGINT ? "SIGINT" : "SIGTERM");
+            return;
+        }
+        if (sig == SIGHUP || sig == SIGUSR1) on_event(ctx, sig);
+
+        uint64_t now = mono_ms();
+        if (o->run_sec > 0 && now - start >= (uint64_t)o->run_sec * 1000ULL) {
+            printf("🛑 [RT] %d s elapsed → shutdown\n", o->run_sec);
+            return;
+        }
+        if (next_stats && now >= next_stats) {
+            on_event(ctx, 0);
+            next_stats = now + (uint64_t)o->stats_sec * 1000ULL;
+        }
+    }
+}
+
+static void print_cpu(const char* mode, uint64_t wall_ms) {
+    struct rusage self, kids;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &kids);
+    double user = (double)(self.ru_utime.tv_sec + kids.ru_utime.tv_sec) * 1000.0 +
+                  (double)(self.ru_utime.tv_usec + kids.ru_utime.tv_usec) / 1000.0;
+    double sys = (double)(self.ru_stime.tv_sec + kids.ru_stime.tv_sec) * 1000.0 +
+                 (double)(self.ru_stime.tv_usec + kids.ru_stime.tv_usec) / 1000.0;
+    printf("⏱ [RT] mode=%s wall=%llums cpu user=%.0fms sys=%.0fms (%.1f%% of 1 core) ctxsw vol=%ld invol=%ld\n", mode,
+           (unsigned long long)wall_ms, user, sys, wall_ms ? 100.0 * (user + sys) / (double)wall_ms : 0.0,
+           self.ru_nvcsw + kids.ru_nvcsw, self.ru_nivcsw + kids.ru_nivcsw);
+}
+
+// ============================
+// inproc: 풀 작업
+// ============================
+static void task_watch(void* arg) {
+    RtWatchTask* t = (RtWatchTask*)arg;
+    t->rc = watch_udp_run(t->cfg);
+    if (t->rc != 0) fprintf(stderr, "❌ [RT] watch_udp_run failed (%d)\n", t->rc);
+    atomic_store(&t->done, 1);
+}
+
+static int drain_once(RtDrain* d, WatchMsg* buf) {
+    int n = spsc_ring_pop_n(d->ring, buf, RT_DRAIN_BATCH);
+    if (n <= 0) return 0;
+
+    int64_t now = ts_now_ms();
+    for (int i = 0; i < n; i++) {
+        int64_t lat = now - buf[i].rx_ts_ms;
+        tick_jitter_record_us(&d->lat, lat > 0 ? (uint64_t)lat * 1000ULL : 0);
+    }
+    d->records += (uint64_t)n;
+    d->applied += (uint64_t)collector_hub_ingest_watch(d->hub, buf, n);
+    return n;
+}
+
+// shard 링 → 허브 (stop이 서고 링이 빌 때까지)
+static void task_drain(void* arg) {
+    RtDrain* d = (RtDrain*)arg;
+    WatchMsg buf[RT_DRAIN_BATCH];
+
+    while (!atomic_load(d->stop)) {
+        if (drain_once(d, buf) == 0) spsc_ring_wait(d->ring, RT_DRAIN_WAIT_MS);
+    }
+    while (drain_once(d, buf) > 0) {
+    }
+}
+
+static void task_stats(void* arg) {
+    RtStatsTask* s = (RtStatsTask*)arg;
+    rt_pool_print_stats(s->pool);
+    for (int k = 0; k < s->shards; k++) {
+        RtDrain* d = &s->drains[k];
+        printf("📊 [RT] ring.%d depth=%d/%d records=%llu applied=%llu lat p99<=%llums\n", k,
+               spsc_ring_count(d->ring), spsc_ring_capacity(d->ring), (unsigned long long)d->records,
+               (unsigned long long)d->applied, (unsigned long long)(tick_jitter_pct_us(&d->lat, 99.0) / 1000ULL));
+    }
+    hubs_print_flow(s->hubs);
+    atomic_store(&s->busy, 0);
+}
+
+typedef struct {
+    RtStatsTask* stats;
+    RtHubs* hubs;
+    const RtOptions* opt;
+    const CollectorHubConfig* base;
+} RtInprocCtx;
+
+static void inproc_event(void* arg, int sig) {
+    RtInprocCtx* c = (RtInprocCtx*)arg;
+    if (sig == SIGHUP) {
+        hubs_reload(c->hubs, c->opt->conf_path, c->base);
+        return;
+    }
+    // 통계는 풀의 짧은 작업으로 (이전 것이 아직 돌고 있으면 건너뜀)
+    int expect = 0;
+    if (atomic_compare_exchange_strong(&c->stats->busy, &expect, 1) &&
+        rt_pool_submit(c->stats->pool, task_stats, c->stats) != 0) {
+        atomic_store(&c->stats->busy, 0);
+    }
+}
+
+static int run_inproc(const RtOptions* o, const CollectorHubConfig* base, const sigset_t* set) {
+    CollectorHubConfig hc = *base;
+    hc.watch_ingest_external = 1;   // watch 리더 스레드 없음, 링 drain이 넣어줌
+    hc.watch_mq_name = NULL;
+
+    RtHubs hubs;
+    if (hubs_create(&hubs, &hc, o->shards) != 0) {
+        fprintf(stderr, "❌ [RT] hub create failed\n");
+        return 1;
+    }
+
+    SpscRing** rings = (SpscRing**)calloc((size_t)o->shards, sizeof(SpscRing*));
+    RtDrain* drains = (RtDrain*)calloc((size_t)o->shards, sizeof(RtDrain));
+    int ok = rings && drains;
+    for (int k = 0; ok && k < o->shards; k++) {
+        rings[k] = spsc_ring_create(sizeof(WatchMsg), o->ring_cap, 1);
+        ok = rings[k] != NULL;
+    }
+    // 워치 수신 루프 정지 (정지 요청이 eventfd로 바로 깨움)
+    WatchUdpStop wstop = { 0, -1 };
+    if (!ok || watch_udp_stop_init(&wstop) != 0 || hubs_start(&hubs) != 0) {
+        fprintf(stderr, "❌ [RT] ring alloc / hub start failed\n");
+        watch_udp_stop_destroy(&wstop);
+        for (int k = 0; rings && k < o->shards; k++) spsc_ring_destroy(rings[k]);
+        free(rings);
+        free(drains);
+        hubs_stop_destroy(&hubs);
+        return 1;
+    }
+
+    RtPool* pool = rt_pool_create(o->workers, "rt", NULL);
+    if (!pool) {
+        fprintf(stderr, "❌ [RT] pool create failed\n");
+        watch_udp_stop_destroy(&wstop);
+        for (int k = 0; k < o->shards; k++) spsc_ring_destroy(rings[k]);
+        free(rings);
+        free(drains);
+        hubs_stop_destroy(&hubs);
+        return 1;
+    }
+
+    uint64_t t0 = mono_ms();
+    atomic_int drain_stop = 0;
+    for (int k = 0; k < o->shards; k++) {
+        drains[k].k = k;
+        drains[k].ring = rings[k];
+        drains[k].hub = hubs_shard(&hubs, k);
+        drains[k].stop = &drain_stop;
+        rt_pool_submit(pool, task_drain, &drains[k]);
+    }
+
+    WatchUdpConfig wc;
+    watch_config_defaults(&wc, o);
+    wc.out_rings = rings;
+    wc.no_signal = 1;
+    wc.stop = &wstop;
+    RtWatchTask wt = { &wc, 0, 0 };
+    rt_pool_submit(pool, task_watch, &wt);
+
+    printf("▶ [RT] inproc: %d workers, %d shard ring(s) x %d, watch :%d\n", o->workers, o->shards,
+           spsc_ring_capacity(rings[0]), o->port);
+
+    RtStatsTask st = { pool, &hubs, drains, o->shards, 0 };
+    RtInprocCtx ctx = { &st, &hubs, o, base };
+    wait_for_stop(set, o, inproc_event, &ctx);
+
+    // 정지 순서: 워치(생산자) → drain(남은 것까지 허브에) → 풀 → 허브
+    uint64_t ts = mono_ms();
+    watch_udp_request_stop(&wstop);
+    while (!atomic_load(&wt.done)) usleep(1000);
+    uint64_t watch_ms = mono_ms() - ts;
+    printf("🛑 [RT] watch stopped in %llu ms\n", (unsigned long long)watch_ms);
+    if (watch_ms > RT_WATCH_STOP_MS) fprintf(stderr, "⚠️ [RT] watch stop took over %d ms\n", RT_WATCH_STOP_MS);
+    watch_udp_stop_destroy(&wstop);
+    atomic_store(&drain_stop, 1);
+    for (int k = 0; k < o->shards; k++) spsc_ring_kick(rings[k]);
+    rt_pool_destroy(pool);
+    pool = NULL;
+
+    uint64_t wall = mono_ms() - t0;
+    for (int k = 0; k < o->shards; k++) {
+        char name[32];
+        snprintf(name, sizeof(name), "[RT] ring.%d rx→hub", k);
+        printf("📊 [RT] ring.%d records=%llu applied=%llu\n", k, (unsigned long long)drains[k].records,
+               (unsigned long long)drains[k].applied);
+        tick_jitter_print(&drains[k].lat, name);
+    }
+    hubs_print_flow(&hubs);
+    hubs_stop_destroy(&hubs);
+    print_cpu("inproc", wall);
+
+    for (int k = 0; k < o->shards; k++) spsc_ring_destroy(rings[k]);
+    free(rings);
+    free(drains);
+    return wt.rc == 0 ? 0 : 1;
+}
+
+// ============================
+// mp: 프로세스 분리
+// ============================
+static void hub_child(const RtOptions* o, const CollectorHubConfig* base, const sigset_t* set) {
+    CollectorHubConfig hc = *base;
+    hc.watch_mq_name = WATCH_QUEUE_NAME;   // shards > 1 이면 그룹이 ".k"를 붙임
+    hc.watch_ingest_external = 0;
+
+    RtHubs hubs;
+    if (hubs_create(&hubs, &hc, o->shards) != 0 || hubs_start(&hubs) != 0) {
+        fprintf(stderr, "❌ [RT][hub] start failed\n");
+        hubs_stop_destroy(&hubs);
+        fflush(stdout);
+        _exit(1);
+    }
+
+    // 부모가 SIGTERM을 보낼 때까지 (mask는 부모에서 물려받아 block 상태)
+    for (;;) {
+        int sig = sigwaitinfo(set, NULL);
+        if (sig == SIGINT || sig == SIGTERM) break;
+        if (sig == SIGHUP) hubs_reload(&hubs, o->conf_path, base);
+        if (sig == SIGUSR1) hubs_print_flow(&hubs);
+    }
+    hubs_print_flow(&hubs);
+    hubs_stop_destroy(&hubs);
+    fflush(stdout); // _exit은 stdio를 안 비움 (파이프로 받으면 stop 통계 / 지연이 통째로 사라짐)
+    _exit(0);
+}
+
+static void watch_child(const RtOptions* o, const sigset_t* set) {
+    // 워치 모듈은 자기 SIGINT 핸들러로 멈춤
+    pthread_sigmask(SIG_UNBLOCK, set, NULL);
+    WatchUdpConfig wc;
+    watch_config_defaults(&wc, o);
+    int rc = watch_udp_run(&wc);
+    fflush(stdout);
+    _exit(rc == 0 ? 0 : 1);
+}
+
+// 허브 프로세스가 MQ를 만들었는지 (워치는 O_CREAT 없이 열기 때문에 먼저 있어야 함)
+static int wait_mq(int shards, int timeout_ms) {
+    char name[64];
+    if (shards > 1) snprintf(name, sizeof(name), WATCH_QUEUE_SHARD_FMT, shards - 1);
+    else snprintf(name, sizeof(name), "%s", WATCH_QUEUE_NAME);
+
+    for (int waited = 0; waited < timeout_ms; waited += 10) {
+        mqd_t q = mq_open(name, O_WRONLY | O_NONBLOCK);
+        if (q != (mqd_t)-1) {
+            mq_close(q);
+            return 0;
+        }
+        usleep(10000);
+    }
+    return -1;
+}
+
+typedef struct {
+    pid_t hub;
+    pid_t watch;
+} RtMpCtx;
+
+static void mp_event(void* arg, int sig) {
+    RtMpCtx* c = (RtMpCtx*)arg;
+    if (sig == SIGHUP) kill(c->hub, SIGHUP);
+    else kill(c->hub, SIGUSR1);
+}
+
+static int reap(pid_t pid, const char* name) {
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0) return -1;
+    if (WIFEXITED(status)) {
+        printf("🧹 [RT] %s exited (%d)\n", name, WEXITSTATUS(status));
+        return WEXITSTATUS(status);
+    }
+    printf("🧹 [RT] %s killed by signal %d\n", name, WTERMSIG(status));
+    return -1;
+}
+
+static int run_mp(const RtOptions* o, const CollectorHubConfig* base, const sigset_t* set) {
+    uint64_t t0 = mono_ms();
+    fflush(stdout);
+
+    RtMpCtx ctx = { -1, -1 };
+    ctx.hub = fork();
+    if (ctx.hub < 0) {
+        perror("fork hub");
+        return 1;
+    }
+    if (ctx.hub == 0) hub_child(o, base, set);
+
+    if (wait_mq(o->shards, RT_MQ_WAIT_MS) != 0) {
+        fprintf(stderr, "❌ [RT] hub did not create %s in %d ms\n", WATCH_QUEUE_NAME, RT_MQ_WAIT_MS);
+        kill(ctx.hub, SIGTERM);
+        reap(ctx.hub, "hub");
+        return 1;
+    }
+
+    fflush(stdout);
+    ctx.watch = fork();
+    if (ctx.watch < 0) {
+        perror("fork watch");
+        kill(ctx.hub, SIGTERM);
+        reap(ctx.hub, "hub");
+        return 1;
+    }
+    if (ctx.watch == 0) watch_child(o, set);
+
+    printf("▶ [RT] mp: hub pid=%d, watch pid=%d, %d shard MQ\n", (int)ctx.hub, (int)ctx.watch, o->shards);
+    wait_for_stop(set, o, mp_event, &ctx);
+
+    // 정지 순서는 inproc과 같음: 워치 먼저 (남은 배치 flush) → 허브
+    kill(ctx.watch, SIGINT);
+    int rc = reap(ctx.watch, "watch") != 0;
+    kill(ctx.hub, SIGTERM);
+    rc |= reap(ctx.hub, "hub") != 0;
+
+    print_cpu("mp", mono_ms() - t0);
+    return rc;
+}
+
+int main(int argc, char** argv) {
+    RtOptions o;
+    if (parse_options(argc, argv, &o) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    CollectorHubConfig base;
+    HubConfigStrings strs;
+    hub_config_defaults(&base);
+    if (o.conf_path && hub_config_load(o.conf_path, &base, &strs) < 0) {
+        fprintf(stderr, "❌ [RT] config %s open failed\n", o.conf_path);
+        return 1;
+    }
+    if (o.max_devices > 0) base.max_devices = o.max_devices;
+
+    sigset_t set;
+    block_signals(&set);
+
+    return o.inproc ? run_inproc(&o, &base, &set) : run_mp(&o, &base, &set);
+}
@@ -0,0 +1,104 @@
+#include "shard_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t hash;
+    int shard;
+} RingPoint;
+
+struct ShardRing {
+    int shards;
+    int npoints;
+    RingPoint* points; // hash 오름차순
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static int _cmp_point(const void* a, const void* b) {
+    const RingPoint* x = (const RingPoint*)a;
+    const RingPoint* y = (const RingPoint*)b;
+    if (x->hash < y->hash) return -1;
+    if (x->hash > y->hash) return 1;
+    return x->shard - y->shard;
+}
+
+// ================================
+// 외부 API
+// ================================
+uint64_t shard_hash(const char* key, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ULL;
+    }
+    // 비슷한 deviceId(끝자리만 다른 것)도 링 위에 고르게 퍼지도록 섞어줌 (splitmix64 finalizer)
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+ShardRing* shard_ring_create(int shards, int vnodes) {
+    if (shards <= 0) return NULL;
+    if (vnodes <= 0) vnodes = SHARD_RING_DEFAULT_VNODES;
+
+    ShardRing* r = (ShardRing*)calloc(1, sizeof(ShardRing));
+    if (!r) return NULL;
+
+    r->shards = shards;
+    r->npoints = shards * vnodes;
+    r->points = (RingPoint*)calloc((size_t)r->npoints, sizeof(RingPoint));
+    if (!r->points) {
+        free(r);
+        return NULL;
+    }
+
+    int k = 0;
+    for (int s = 0; s < shards; s++) {
+        for (int v = 0; v < vnodes; v++) {
+            char name[32];
+            int n = snprintf(name, sizeof(name), "shard-%d#%d", s, v);
+            r->points[k].hash = shard_hash(name, (size_t)n);
+            r->points[k].shard = s;
+            k++;
+        }
+    }
+    qsort(r->points, (size_t)r->npoints, sizeof(RingPoint), _cmp_point);
+    return r;
+}
+
+void shard_ring_destroy(ShardRing* r) {
+    if (!r) return;
+    free(r->points);
+    free(r);
+}
+
+int shard_ring_shards(const ShardRing* r) {
+    return r ? r->shards : 0;
+}
+
+int shard_ring_lookup_n(const ShardRing* r, const char* key, size_t len) {
+    if (!r || r->shards == 1 || !key) return 0;
+
+    uint64_t h = shard_hash(key, len);
+
+    // h 이상인 첫 점 (없으면 링 처음으로)
+    int lo = 0, hi = r->npoints;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (r->points[mid].hash < h) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == r->npoints) lo = 0;
+    return r->points[lo].shard;
+}
+
+int shard_ring_lookup(const ShardRing* r, const char* key) {
+    return shard_ring_lookup_n(r, key, key ? strlen(key) : 0);
+}
@@ -0,0 +1,36 @@
+#ifndef SHARD_RING_H
+#define SHARD_RING_H
+
+/*
+deviceId → shard 번호 consistent hash ring (워치 모듈 / 허브 공용)
+- shard마다 가상 노드 vnodes개를 링에 뿌려서 부하를 고르게
+- shard 수가 바뀌어도 대부분의 디바이스는 원래 shard에 남음
+- 워치 모듈과 허브가 같은 (shards, vnodes)로 만들면 같은 결과
+- 생성 후에는 읽기 전용이라 여러 스레드에서 락 없이 lookup 가능
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHARD_RING_DEFAULT_VNODES 128
+
+typedef struct ShardRing ShardRing;
+
+ShardRing* shard_ring_create(int shards, int vnodes); // vnodes <= 0 이면 기본값
+void shard_ring_destroy(ShardRing* r);
+
+int shard_ring_shards(const ShardRing* r);
+int shard_ring_lookup(const ShardRing* r, const char* key);          // 0 ~ shards-1
+int shard_ring_lookup_n(const ShardRing* r, const char* key, size_t len);
+
+uint64_t shard_hash(const char* key, size_t len); // FNV-1a 64 + finalizer
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
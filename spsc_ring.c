@@ -0,0 +1,145 @@
+#include "spsc_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define SPSC_CACHE_LINE 64
+
+struct SpscRing {
+    // 생산자 쪽
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint64_t head;
+    uint64_t tail_cache;       // 생산자가 마지막으로 본 tail (매번 상대 cache line을 안 읽게)
+
+    // 소비자 쪽
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint64_t tail;
+    uint64_t head_cache;
+
+    // 생성 후 안 바뀜
+    _Alignas(SPSC_CACHE_LINE) uint64_t mask;
+    size_t rec_size;
+    int efd;
+    unsigned char* buf;
+};
+
+SpscRing* spsc_ring_create(size_t rec_size, int capacity, int notify) {
+    if (rec_size == 0 || capacity <= 0) return NULL;
+
+    uint64_t cap = 1;
+    while (cap < (uint64_t)capacity) cap <<= 1;
+
+    SpscRing* r = (SpscRing*)aligned_alloc(SPSC_CACHE_LINE, sizeof(SpscRing));
+    if (!r) return NULL;
+    memset(r, 0, sizeof(*r));
+    r->mask = cap - 1;
+    r->rec_size = rec_size;
+    r->efd = -1;
+    r->buf = (unsigned char*)malloc((size_t)cap * rec_size);
+    if (!r->buf) {
+        free(r);
+        return NULL;
+    }
+
+    if (notify) {
+        r->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (r->efd < 0) {
+            perror("eventfd spsc_ring");
+            free(r->buf);
+            free(r);
+            return NULL;
+        }
+    }
+    return r;
+}
+
+void spsc_ring_destroy(SpscRing* r) {
+    if (!r) return;
+    if (r->efd >= 0) close(r->efd);
+    free(r->buf);
+    free(r);
+}
+
+static void _notify(SpscRing* r) {
+    uint64_t one = 1;
+    if (r->efd >= 0) (void)!write(r->efd, &one, sizeof(one));
+}
+
+int spsc_ring_push(SpscRing* r, const void* rec) {
+    uint64_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (h - r->tail_cache > r->mask) {
+        r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (h - r->tail_cache > r->mask) return -1;
+    }
+
+    memcpy(r->buf + (size_t)(h & r->mask) * r->rec_size, rec, r->rec_size);
+    atomic_store_explicit(&r->head, h + 1, memory_order_release);
+
+    if (r->efd >= 0) {
+        // 비어 있던 링이면 소비자가 자고 있을 수 있음
+        // (seq_cst fence: 소비자의 "tail store → head load"와 짝, 둘 다 못 보고 지나가는 일 없게)
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&r->tail, memory_order_relaxed) == h) _notify(r);
+    }
+    return 0;
+}
+
+int spsc_ring_pop_n(SpscRing* r, void* out, int max) {
+    uint64_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (r->head_cache == t) {
+        r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (r->head_cache == t) return 0;
+    }
+
+    uint64_t avail = r->head_cache - t;
+    int n = avail < (uint64_t)max ? (int)avail : max;
+    for (int i = 0; i < n; i++) {
+        memcpy((unsigned char*)out + (size_t)i * r->rec_size,
+               r->buf + (size_t)((t + (uint64_t)i) & r->mask) * r->rec_size, r->rec_size);
+    }
+    atomic_store_explicit(&r->tail, t + (uint64_t)n, memory_order_release);
+    return n;
+}
+
+int spsc_ring_pop(SpscRing* r, void* out) {
+    return spsc_ring_pop_n(r, out, 1);
+}
+
+int spsc_ring_wait(SpscRing* r, int timeout_ms) {
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&r->head, memory_order_acquire) != t) return 1;
+
+    if (r->efd < 0) {
+        if (timeout_ms > 0) usleep((useconds_t)timeout_ms * 1000);
+    } else {
+        struct pollfd p = { r->efd, POLLIN, 0 };
+        if (poll(&p, 1, timeout_ms) > 0) {
+            uint64_t v;
+            (void)!read(r->efd, &v, sizeof(v));
+        }
+    }
+    return atomic_load_explicit(&r->head, memory_order_acquire) != t;
+}
+
+void spsc_ring_kick(SpscRing* r) {
+    if (r) _notify(r);
+}
+
+int spsc_ring_count(const SpscRing* r) {
+    uint64_t h = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint64_t t = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return h >= t ? (int)(h - t) : 0;
+}
+
+int spsc_ring_capacity(const SpscRing* r) {
+    return (int)(r->mask + 1);
+}
+
+int spsc_ring_fd(const SpscRing* r) {
+    return r ? r->efd : -1;
+}
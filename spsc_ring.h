@@ -0,0 +1,41 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+/*
+고정 크기 레코드 lock-free 링 (생산자 1 / 소비자 1, 통합 실행 모드의 워치 → 허브 전달)
+- MQ 대신 같은 프로세스 안에서 WatchMsg를 넘김 (syscall / 복사 1번 없음)
+- head(생산자) / tail(소비자)은 서로 다른 cache line, 상대 쪽 index는 acquire load
+- 꽉 차면 push가 -1 (기다리지 않음, 생산자가 MQ 꽉 참과 같이 흐름 제어)
+- notify면 eventfd 1개: 빈 링에 처음 넣을 때만 write → 소비자는 spsc_ring_wait로 잠듦
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SpscRing SpscRing;
+
+// capacity는 2의 거듭제곱으로 올림, notify = 1이면 eventfd 생성
+SpscRing* spsc_ring_create(size_t rec_size, int capacity, int notify);
+void spsc_ring_destroy(SpscRing* r);
+
+int spsc_ring_push(SpscRing* r, const void* rec);        // 생산자: 0 성공, -1 꽉 참
+int spsc_ring_pop(SpscRing* r, void* out);               // 소비자: 1 꺼냄, 0 비어 있음
+int spsc_ring_pop_n(SpscRing* r, void* out, int max);    // 소비자: 꺼낸 개수
+
+// 소비자: 비어 있으면 push 알림이나 timeout까지 대기 (return: 1 데이터 있음, 0 timeout/알림 없음)
+int spsc_ring_wait(SpscRing* r, int timeout_ms);
+void spsc_ring_kick(SpscRing* r);                        // 대기 중인 소비자 깨우기 (종료할 때)
+
+int spsc_ring_count(const SpscRing* r);                  // 대략값 (어느 쪽에서 불러도 됨)
+int spsc_ring_capacity(const SpscRing* r);
+int spsc_ring_fd(const SpscRing* r);                     // eventfd (notify 아니면 -1)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
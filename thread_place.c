@@ -0,0 +1,179 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "thread_place.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define MPOL_PREFERRED_ 1 // <numaif.h> 없이 set_mempolicy 직접 호출
+
+// ================================
+// 내부 유틸
+// ================================
+static int _set_preferred_node(int node) {
+#ifdef SYS_set_mempolicy
+    unsigned long mask[4] = {0};
+    if (node < 0 || node >= (int)(sizeof(mask) * 8)) return -1;
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    return (int)syscall(SYS_set_mempolicy, MPOL_PREFERRED_, mask, sizeof(mask) * 8 + 1);
+#else
+    (void)node;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static int _current_node(void) {
+    unsigned cpu = 0, node = 0;
+#ifdef SYS_getcpu
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return -1;
+    return (int)node;
+#else
+    (void)cpu;
+    (void)node;
+    return -1;
+#endif
+}
+
+// ================================
+// 외부 API
+// ================================
+uint64_t thread_place_parse_cpus(const char* s) {
+    if (!s) return 0;
+
+    uint64_t mask = 0;
+    const char* p = s;
+    while (*p) {
+        char* end;
+        long a = strtol(p, &end, 10);
+        if (end == p || a < 0 || a > 63) return 0;
+        long b = a;
+        p = end;
+        if (*p == '-') {
+            b = strtol(p + 1, &end, 10);
+            if (end == p + 1 || b < a || b > 63) return 0;
+            p = end;
+        }
+        for (long c = a; c <= b; c++) mask |= 1ULL << c;
+
+        if (*p == ',') p++;
+        else if (*p != '\0') return 0;
+    }
+    return mask;
+}
+
+int thread_place_apply(const ThreadPlace* p, const char* name) {
+    if (!p) return 0;
+    if (!name) name = "thread";
+
+    int rc = 0;
+
+    char tname[16];
+    snprintf(tname, sizeof(tname), "%s", name);
+    pthread_setname_np(pthread_self(), tname);
+
+    if (p->cpu_mask) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c = 0; c < 64; c++) {
+            if (p->cpu_mask & (1ULL << c)) CPU_SET(c, &set);
+        }
+        int e = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (e != 0) {
+            fprintf(stderr, "⚠️ [PLACE][%s] setaffinity 0x%llx failed: %s\n", name,
+                    (unsigned long long)p->cpu_mask, strerror(e));
+            rc = -1;
+        }
+    }
+
+    if (p->rt_priority > 0) {
+        struct sched_param sp;
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = p->rt_priority;
+        int e = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (e != 0) {
+            // 보통 EPERM (CAP_SYS_NICE / RLIMIT_RTPRIO 필요)
+            fprintf(stderr, "⚠️ [PLACE][%s] SCHED_FIFO %d failed: %s\n", name, p->rt_priority, strerror(e));
+            rc = -1;
+        }
+    } else if (p->nice != 0) {
+        // Linux에서 setpriority(PRIO_PROCESS, tid)는 스레드 하나에만 적용
+        pid_t tid = (pid_t)syscall(SYS_gettid);
+        if (setpriority(PRIO_PROCESS, (id_t)tid, p->nice) != 0) {
+            fprintf(stderr, "⚠️ [PLACE][%s] nice %d failed: %s\n", name, p->nice, strerror(errno));
+            rc = -1;
+        }
+    }
+
+    if (p->numa_local) {
+        // affinity 적용 후 지금 돌고 있는 CPU의 노드 = 고정한 CPU의 노드
+        int node = _current_node();
+        if (node < 0 || _set_preferred_node(node) != 0) {
+            fprintf(stderr, "⚠️ [PLACE][%s] NUMA preferred node %d failed: %s\n", name, node, strerror(errno));
+            rc = -1;
+        }
+    }
+
+    if (p->cpu_mask || p->rt_priority || p->nice || p->numa_local) {
+        printf("📌 [PLACE][%s] cpus=0x%llx fifo=%d nice=%d numa=%d (node %d)\n", name,
+               (unsigned long long)p->cpu_mask, p->rt_priority, p->nice, p->numa_local, _current_node());
+    }
+    return rc;
+}
+
+void tick_jitter_record_us(TickJitter* j, uint64_t late_us) {
+    if (!j) return;
+    j->n++;
+    j->sum_us += late_us;
+    if (late_us > j->max_us) j->max_us = late_us;
+
+    int b = 0;
+    while (late_us > 0 && b < TICK_JITTER_BUCKETS - 1) {
+        late_us >>= 1;
+        b++;
+    }
+    j->hist[b]++;
+}
+
+void tick_jitter_record(TickJitter* j, const struct timespec* deadline) {
+    if (!j || !deadline) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t late_ns = (int64_t)(now.tv_sec - deadline->tv_sec) * 1000000000LL +
+                      (int64_t)(now.tv_nsec - deadline->tv_nsec);
+    tick_jitter_record_us(j, late_ns > 0 ? (uint64_t)(late_ns / 1000) : 0);
+}
+
+uint64_t tick_jitter_pct_us(const TickJitter* j, double pct) {
+    if (!j || j->n == 0) return 0;
+
+    uint64_t want = (uint64_t)((double)j->n * pct / 100.0);
+    if (want >= j->n) want = j->n - 1;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < TICK_JITTER_BUCKETS; b++) {
+        seen += j->hist[b];
+        if (seen > want) {
+            uint64_t upper = b == 0 ? 1 : (1ULL << b);
+            return upper < j->max_us ? upper : j->max_us;
+        }
+    }
+    return j->max_us;
+}
+
+void tick_jitter_print(const TickJitter* j, const char* name) {
+    if (!j || j->n == 0) return;
+    printf("📊 %s tick late: n=%llu avg=%lluus p50<=%lluus p99<=%lluus max=%lluus\n", name,
+           (unsigned long long)j->n, (unsigned long long)(j->sum_us / j->n),
+           (unsigned long long)tick_jitter_pct_us(j, 50.0), (unsigned long long)tick_jitter_pct_us(j, 99.0),
+           (unsigned long long)j->max_us);
+}
@@ -0,0 +1,60 @@
+#ifndef THREAD_PLACE_H
+#define THREAD_PLACE_H
+
+/*
+스레드 배치 (워치 모듈 / 허브 공용)
+- CPU 고정 (cpu_mask, bit i = CPU i)
+- SCHED_FIFO 우선순위 또는 nice (권한 없으면 경고만 찍고 계속)
+- NUMA: 고정한 CPU의 노드를 이 스레드의 preferred 메모리 노드로 (이후 할당/first-touch가 로컬 노드로)
+- 스레드 안에서 시작하자마자 호출 (버퍼 할당 전에)
+
+tick jitter 측정
+- 주기 루프에서 "깨어나야 했던 시각" 대비 실제로 깨어난 지연을 기록
+- 평균/최대 + log2(us) 히스토그램으로 p99 추정
+*/
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t cpu_mask;   // 0이면 고정 안 함 (CPU 0~63)
+    int rt_priority;     // 1~99면 SCHED_FIFO, 0이면 SCHED_OTHER 유지
+    int nice;            // rt_priority가 0일 때만, 0이면 안 바꿈
+    int numa_local;      // 1이면 현재 CPU의 NUMA 노드에서 메모리 우선 할당
+} ThreadPlace;
+
+// "2", "2-3", "0,2,4-5" → cpu_mask (형식 오류면 0)
+uint64_t thread_place_parse_cpus(const char* s);
+
+// 호출한 스레드에 적용. name은 로그/스레드 이름용 (15자까지)
+// return: 0 전부 적용, -1 일부 실패 (실패 항목은 stderr에 경고)
+int thread_place_apply(const ThreadPlace* p, const char* name);
+
+// ============================
+// tick jitter
+// ============================
+#define TICK_JITTER_BUCKETS 24   // 1us ~ 8s (log2)
+
+typedef struct {
+    uint64_t n;
+    uint64_t sum_us;
+    uint64_t max_us;
+    uint64_t hist[TICK_JITTER_BUCKETS]; // [0]: <1us, [k]: 2^(k-1) ~ 2^k us
+} TickJitter;
+
+// deadline(CLOCK_MONOTONIC) 대비 지금 얼마나 늦었는지 기록 (일찍 깨면 0)
+void tick_jitter_record(TickJitter* j, const struct timespec* deadline);
+void tick_jitter_record_us(TickJitter* j, uint64_t late_us);
+
+uint64_t tick_jitter_pct_us(const TickJitter* j, double pct); // 상한 추정 (버킷 경계)
+void tick_jitter_print(const TickJitter* j, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
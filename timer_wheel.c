@@ -0,0 +1,204 @@
+#include "timer_wheel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TW_BITS   6
+#define TW_SLOTS  (1 << TW_BITS)
+#define TW_MASK   (TW_SLOTS - 1)
+#define TW_LEVELS 4
+#define TW_MAX_DELTA ((1ULL << (TW_BITS * TW_LEVELS)) - 1)
+
+struct TimerWheel {
+    int capacity;
+    int tick_ms;
+    uint64_t cur;        // 현재 tick (처리 완료된 마지막 tick)
+    int active;
+
+    int head[TW_LEVELS * TW_SLOTS]; // 슬롯별 리스트 head (-1 비어있음)
+
+    // id별 노드 (intrusive 이중 연결 리스트)
+    int* next;
+    int* prev;
+    int* slot;           // level*TW_SLOTS + idx, -1이면 대기중 아님
+    uint64_t* expires;   // 만료 tick
+};
+
+// ================================
+// 내부 유틸
+// ================================
+static void _unlink(TimerWheel* tw, int id) {
+    int s = tw->slot[id];
+    if (tw->prev[id] >= 0) tw->next[tw->prev[id]] = tw->next[id];
+    else tw->head[s] = tw->next[id];
+    if (tw->next[id] >= 0) tw->prev[tw->next[id]] = tw->prev[id];
+
+    tw->slot[id] = -1;
+    tw->next[id] = tw->prev[id] = -1;
+    tw->active--;
+}
+
+// 만료 tick 기준으로 단/칸 결정 (Linux 예전 timer wheel 방식)
+// min_exp: 넣을 수 있는 가장 이른 tick
+//  - 일반 schedule: cur는 이미 처리됐으므로 cur+1
+//  - cascade: cur의 0단 슬롯은 아직 처리 전이므로 cur
+static void _insert(TimerWheel* tw, int id, uint64_t min_exp) {
+    uint64_t exp = tw->expires[id];
+    if (exp < min_exp) exp = min_exp;  // 이미 지났으면 가장 이른 tick에
+    uint64_t delta = exp - tw->cur;
+    if (delta > TW_MAX_DELTA) {
+        // 범위 밖: 맨 끝에 넣고 도착했을 때 다시 계산
+        delta = TW_MAX_DELTA;
+        exp = tw->cur + delta;
+    }
+
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= (1ULL << (TW_BITS * (level + 1)))) level++;
+
+    int s = level * TW_SLOTS + (int)((exp >> (TW_BITS * level)) & TW_MASK);
+
+    tw->slot[id] = s;
+    tw->prev[id] = -1;
+    tw->next[id] = tw->head[s];
+    if (tw->head[s] >= 0) tw->prev[tw->head[s]] = id;
+    tw->head[s] = id;
+    tw->active++;
+}
+
+// 상위 단 슬롯을 풀어서 다시 배치
+static void _cascade(TimerWheel* tw, int level) {
+    int s = level * TW_SLOTS + (int)((tw->cur >> (TW_BITS * level)) & TW_MASK);
+    int id;
+    while ((id = tw->head[s]) >= 0) {
+        _unlink(tw, id);
+        _insert(tw, id, tw->cur);
+    }
+}
+
+static int _grow_arrays(TimerWheel* tw, int capacity) {
+    int* n = (int*)realloc(tw->next, sizeof(int) * (size_t)capacity);
+    if (!n) return -1;
+    tw->next = n;
+    int* p = (int*)realloc(tw->prev, sizeof(int) * (size_t)capacity);
+    if (!p) return -1;
+    tw->prev = p;
+    int* sl = (int*)realloc(tw->slot, sizeof(int) * (size_t)capacity);
+    if (!sl) return -1;
+    tw->slot = sl;
+    uint64_t* e = (uint64_t*)realloc(tw->expires, sizeof(uint64_t) * (size_t)capacity);
+    if (!e) return -1;
+    tw->expires = e;
+
+    for (int i = tw->capacity; i < capacity; i++) {
+        tw->next[i] = tw->prev[i] = tw->slot[i] = -1;
+        tw->expires[i] = 0;
+    }
+    return 0;
+}
+
+// ================================
+// 외부 API
+// ================================
+TimerWheel* timer_wheel_create(int capacity, int tick_ms, uint64_t now_ms) {
+    if (capacity <= 0 || tick_ms <= 0) return NULL;
+
+    TimerWheel* tw = (TimerWheel*)calloc(1, sizeof(TimerWheel));
+    if (!tw) return NULL;
+
+    tw->tick_ms = tick_ms;
+    tw->cur = now_ms / (uint64_t)tick_ms;
+    for (int i = 0; i < TW_LEVELS * TW_SLOTS; i++) tw->head[i] = -1;
+
+    if (_grow_arrays(tw, capacity) != 0) {
+        timer_wheel_destroy(tw);
+        return NULL;
+    }
+    tw->capacity = capacity;
+    return tw;
+}
+
+void timer_wheel_destroy(TimerWheel* tw) {
+    if (!tw) return;
+    free(tw->next);
+    free(tw->prev);
+    free(tw->slot);
+    free(tw->expires);
+    free(tw);
+}
+
+int timer_wheel_resize(TimerWheel* tw, int capacity) {
+    if (!tw || capacity <= 0) return -1;
+
+    if (capacity < tw->capacity) {
+        for (int i = capacity; i < tw->capacity; i++) {
+            if (tw->slot[i] >= 0) return -1;
+        }
+        tw->capacity = capacity; // 배열은 그대로 두고 범위만 줄임
+        return 0;
+    }
+
+    if (_grow_arrays(tw, capacity) != 0) return -1;
+    tw->capacity = capacity;
+    return 0;
+}
+
+int timer_wheel_schedule(TimerWheel* tw, int id, uint64_t deadline_ms) {
+    if (!tw || id < 0 || id >= tw->capacity) return -1;
+    if (tw->slot[id] >= 0) _unlink(tw, id);
+
+    // 올림: deadline보다 일찍 만료되지 않도록
+    tw->expires[id] = (deadline_ms + (uint64_t)tw->tick_ms - 1) / (uint64_t)tw->tick_ms;
+    _insert(tw, id, tw->cur + 1);
+    return 0;
+}
+
+void timer_wheel_cancel(TimerWheel* tw, int id) {
+    if (!tw || id < 0 || id >= tw->capacity) return;
+    if (tw->slot[id] >= 0) _unlink(tw, id);
+}
+
+int timer_wheel_pending(const TimerWheel* tw, int id) {
+    if (!tw || id < 0 || id >= tw->capacity) return 0;
+    return tw->slot[id] >= 0;
+}
+
+int timer_wheel_active(const TimerWheel* tw) {
+    return tw ? tw->active : 0;
+}
+
+int timer_wheel_advance(TimerWheel* tw, uint64_t now_ms, TimerWheelFn fn, void* ctx) {
+    if (!tw) return 0;
+
+    uint64_t target = now_ms / (uint64_t)tw->tick_ms;
+    int fired = 0;
+
+    while (tw->cur < target) {
+        // 대기중인 타이머가 없으면 한 번에 건너뜀
+        if (tw->active == 0) {
+            tw->cur = target;
+            break;
+        }
+
+        tw->cur++;
+
+        // 하위 단이 한 바퀴 돌았으면 상위 단 슬롯을 내려보냄
+        for (int level = 1; level < TW_LEVELS; level++) {
+            if ((tw->cur & ((1ULL << (TW_BITS * level)) - 1)) != 0) break;
+            _cascade(tw, level);
+        }
+
+        int s = (int)(tw->cur & TW_MASK);
+        int id;
+        while ((id = tw->head[s]) >= 0) {
+            _unlink(tw, id);
+            if (tw->expires[id] > tw->cur) {
+                // 범위 밖으로 잘렸던 타이머: 남은 시간으로 다시 배치
+                _insert(tw, id, tw->cur + 1);
+                continue;
+            }
+            fired++;
+            if (fn) fn(ctx, id, now_ms);
+        }
+    }
+    return fired;
+}
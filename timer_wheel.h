@@ -0,0 +1,42 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/*
+계층형 타이머 휠 (워치 모듈 / 허브 공용)
+- 타이머 id는 0 ~ capacity-1 정수 (보통 디바이스 슬롯 번호)
+- id마다 타이머 1개, 다시 schedule하면 이전 deadline은 취소됨
+- schedule/cancel O(1), advance는 지나간 tick 수 + 만료 개수에 비례
+- 64칸 x 4단 → tick 10ms 기준 약 46시간까지 표현 (넘으면 끝에서 다시 계산)
+- 스레드 안전하지 않음: 호출하는 쪽에서 락으로 보호
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TimerWheel TimerWheel;
+
+// 만료 콜백 (콜백 안에서 같은 id나 다른 id를 schedule/cancel 해도 됨)
+typedef void (*TimerWheelFn)(void* ctx, int id, uint64_t now_ms);
+
+TimerWheel* timer_wheel_create(int capacity, int tick_ms, uint64_t now_ms);
+void timer_wheel_destroy(TimerWheel* tw);
+
+// capacity 변경 (줄일 때는 잘려나가는 id의 타이머가 모두 취소돼 있어야 함)
+int timer_wheel_resize(TimerWheel* tw, int capacity);
+
+int  timer_wheel_schedule(TimerWheel* tw, int id, uint64_t deadline_ms); // 0 성공, -1 잘못된 id
+void timer_wheel_cancel(TimerWheel* tw, int id);
+int  timer_wheel_pending(const TimerWheel* tw, int id);                   // 1 대기중, 0 아님
+int  timer_wheel_active(const TimerWheel* tw);                            // 대기중인 타이머 수
+
+// now_ms까지 시간을 진행하며 만료된 타이머 콜백 호출 (return: 만료 개수)
+int timer_wheel_advance(TimerWheel* tw, uint64_t now_ms, TimerWheelFn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
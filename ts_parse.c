@@ -0,0 +1,129 @@
+#include "ts_parse.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// 시간대 오프셋 캐시 (여러 스레드에서 읽음, 갱신은 아무나 해도 같은 값)
+static _Atomic long    g_tz_off = 0;
+static _Atomic int64_t g_tz_valid_from_ms = 0;  // 캐시가 맞는 구간 [from, until) = 1시간
+static _Atomic int64_t g_tz_valid_until_ms = 0;
+
+// ================================
+// 내부 유틸 (proleptic 그레고리력, Howard Hinnant 알고리즘)
+// ================================
+static int64_t _days_from_civil(int y, int m, int d) {
+    y -= (m <= 2);
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void _civil_from_days(int64_t z, int* y, int* m, int* d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+// 숫자 n자리 읽기 (숫자 아니면 -1)
+static int _digits(const char* p, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        v = v * 10 + (p[i] - '0');
+    }
+    return v;
+}
+
+static int64_t _floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+// ================================
+// 외부 API
+// ================================
+int64_t ts_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + (int64_t)(ts.tv_nsec / 1000000);
+}
+
+long ts_tz_offset_sec(int64_t now_ms) {
+    if (now_ms < atomic_load_explicit(&g_tz_valid_until_ms, memory_order_acquire) &&
+        now_ms >= atomic_load_explicit(&g_tz_valid_from_ms, memory_order_relaxed)) {
+        return atomic_load_explicit(&g_tz_off, memory_order_relaxed);
+    }
+
+    // 정시마다 한 번 (서머타임 전환은 정시에 일어남)
+    time_t t = (time_t)(now_ms / 1000);
+    struct tm lt;
+    localtime_r(&t, &lt);
+    long off = lt.tm_gmtoff;
+
+    int64_t hour = _floor_div(now_ms, 3600000) * 3600000;
+    atomic_store_explicit(&g_tz_off, off, memory_order_relaxed);
+    atomic_store_explicit(&g_tz_valid_from_ms, hour, memory_order_relaxed);
+    atomic_store_explicit(&g_tz_valid_until_ms, hour + 3600000, memory_order_release);
+    return off;
+}
+
+int ts_parse_local(const char* s, size_t len, int64_t now_ms, int64_t* out_ms) {
+    if (!s || !out_ms) return -1;
+    if (len == 0) len = strlen(s);
+
+    // "yy-MM-dd HH:mm:ss"(17) 또는 "yyyy-MM-dd HH:mm:ss"(19)
+    int y;
+    const char* p;
+    if (len == 17) {
+        y = _digits(s, 2);
+        if (y < 0) return -1;
+        y += 2000;
+        p = s + 2;
+    } else if (len == 19) {
+        y = _digits(s, 4);
+        if (y < 0) return -1;
+        p = s + 4;
+    } else {
+        return -1;
+    }
+
+    if (p[0] != '-' || p[3] != '-' || (p[6] != ' ' && p[6] != 'T') || p[9] != ':' || p[12] != ':') return -1;
+
+    int mo = _digits(p + 1, 2);
+    int d  = _digits(p + 4, 2);
+    int hh = _digits(p + 7, 2);
+    int mi = _digits(p + 10, 2);
+    int ss = _digits(p + 13, 2);
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || hh < 0 || hh > 23 || mi < 0 || mi > 59 || ss < 0 || ss > 60) {
+        return -1;
+    }
+
+    int64_t local_sec = _days_from_civil(y, mo, d) * 86400 + hh * 3600 + mi * 60 + ss;
+    *out_ms = (local_sec - ts_tz_offset_sec(now_ms)) * 1000;
+    return 0;
+}
+
+void ts_format_local_iso(int64_t epoch_ms, char* out, size_t outsz) {
+    if (!out || outsz == 0) return;
+
+    int64_t local_sec = _floor_div(epoch_ms, 1000) + ts_tz_offset_sec(epoch_ms);
+    int64_t days = _floor_div(local_sec, 86400);
+    int64_t sod = local_sec - days * 86400;
+
+    int y, m, d;
+    _civil_from_days(days, &y, &m, &d);
+
+    snprintf(out, outsz, "%04d-%02d-%02dT%02d:%02d:%02d",
+             y, m, d, (int)(sod / 3600), (int)(sod / 60 % 60), (int)(sod % 60));
+}
@@ -0,0 +1,34 @@
+#ifndef TS_PARSE_H
+#define TS_PARSE_H
+
+/*
+타임스탬프 유틸 (워치 모듈 / 허브 공용)
+- 워치 ts 문자열 "yy-MM-dd HH:mm:ss"(또는 "yyyy-MM-dd HH:mm:ss")를 epoch ms로 변환
+- 로컬 시간대 오프셋은 캐시해두고 정시마다 한 번만 갱신 (메시지마다 localtime 호출 안 함)
+- now_local 문자열도 캐시된 오프셋으로 직접 포맷
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t ts_now_ms(void);                 // CLOCK_REALTIME epoch ms
+
+// 현재 로컬 시간대 오프셋(초, UTC+9면 32400). now_ms가 캐시 유효 구간을 벗어나면 갱신
+long ts_tz_offset_sec(int64_t now_ms);
+
+// 로컬 시간 문자열 → epoch ms (0 성공, -1 형식 오류)
+// len이 0이면 strlen 사용
+int ts_parse_local(const char* s, size_t len, int64_t now_ms, int64_t* out_ms);
+
+// epoch ms → "YYYY-MM-DDTHH:MM:SS" (로컬 시간)
+void ts_format_local_iso(int64_t epoch_ms, char* out, size_t outsz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif